@@ -52,7 +52,16 @@ std::vector<std::string> keygenerator(std::size_t num_keys, double theta = 0, in
 
 int main() {
   size_t num_ops = 419430;
+  // Skew of key popularity, 0 is pure zipf and 1 uniform
+  double theta = 0.0;
+  std::size_t cache_capacity = HASH_TABLE_CACHE_DEFAULT_CAPACITY;
   std::vector<std::string> keys = keygenerator(num_ops);
+  zipfgenerator popularity(theta, num_ops);
+  std::vector<std::string> workload;
+  workload.reserve(num_ops);
+  for (size_t k = 0; k < num_ops; ++k) {
+    workload.push_back(keys[std::min<uint64_t>(popularity.next(), num_ops - 1)]);
+  }
   std::string address = "127.0.0.1";
   int service_port = 9090;
   int lease_port = 9091;
@@ -69,6 +78,8 @@ int main() {
   LOG(log_level::info) << "num-blocks: " << num_blocks;
   LOG(log_level::info) << "chain-length: " << chain_length;
   LOG(log_level::info) << "num-ops: " << num_ops;
+  LOG(log_level::info) << "theta: " << theta;
+  LOG(log_level::info) << "cache-capacity: " << cache_capacity;
   //LOG(log_level::info) << "data-size: " << data_size;
   LOG(log_level::info) << "test: " << op_type;
   LOG(log_level::info) << "path: " << path;
@@ -77,12 +88,16 @@ int main() {
   jiffy_client client(address, service_port, lease_port);
   std::shared_ptr<hash_table_client>
       ht_client = client.open_or_create_hash_table(path, backing_path, num_blocks, chain_length);
+  if (cache_capacity > 0) {
+    ht_client->enable_cache(cache_capacity);
+  }
   uint64_t get_tot_time = 0, get_t0 = 0, get_t1 = 0;
   std::ofstream out("get_latency.trace");
   while (1) {
     try {
+      auto pass_t0 = time_utils::now_us();
       for (size_t k = 0; k < num_ops; ++k) {
-        auto key = keys[k];
+        auto key = workload[k];
         get_t0 = time_utils::now_us();
         ht_client->get(key);
         get_t1 = time_utils::now_us();
@@ -90,6 +105,13 @@ int main() {
         auto cur_epoch = ts::duration_cast<ts::milliseconds>(ts::system_clock::now().time_since_epoch()).count();
         out << cur_epoch << " " << get_tot_time << " get " << key << std::endl;
       }
+      auto pass_t1 = time_utils::now_us();
+      LOG(log_level::info) << "Throughput: " << (num_ops * 1E6) / (pass_t1 - pass_t0) << " ops/s";
+      if (ht_client->cache() != nullptr) {
+        auto cache = ht_client->cache();
+        LOG(log_level::info) << "Cache hit rate: "
+                             << static_cast<double>(cache->hits()) / (cache->hits() + cache->misses());
+      }
     } catch (jiffy::directory::directory_service_exception &e) {
       break;
     }
@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <vector>
+#include <iostream>
+#include <string>
+#include <random>
+#include <boost/program_options.hpp>
+#include <jiffy/utils/logger.h>
+#include <jiffy/utils/time_utils.h>
+#include "jiffy/storage/hashtable/hash_slot.h"
+
+using namespace ::jiffy::storage;
+using namespace ::jiffy::utils;
+
+namespace  bpo = boost::program_options;
+
+typedef uint16_t (*crc16_fn)(const char *, size_t);
+
+/* Hash num_keys keys of key_size bytes repeatedly until total_bytes have been hashed */
+uint64_t crc16_benchmark(const std::string &name, crc16_fn fn, const std::vector<std::string> &keys,
+                         std::size_t total_bytes) {
+    auto key_size = keys.front().size();
+    auto num_ops = std::max<std::size_t>(total_bytes / key_size, keys.size());
+    uint16_t checksum = 0;
+    auto bench_begin = time_utils::now_us();
+    for (std::size_t i = 0; i < num_ops; ++i) {
+        const auto &key = keys[i % keys.size()];
+        checksum ^= fn(key.data(), key.size());
+    }
+    auto tot_time = std::max<uint64_t>(time_utils::now_us() - bench_begin, 1);
+    LOG(log_level::info) << "===== crc16_" << name << " (" << key_size << " B keys) ======";
+    LOG(log_level::info) << "\t" << num_ops << " hashes completed in " << tot_time << " us";
+    LOG(log_level::info) << "\tLatency: " << tot_time * 1E3 / num_ops << " ns per hash";
+    LOG(log_level::info) << "\tThroughput: " << num_ops * key_size / static_cast<double>(tot_time) << " MB/s";
+    return checksum;
+}
+
+uint16_t bytewise(const char *buf, size_t len) {
+    return hash_slot::crc16_bytewise(buf, len);
+}
+
+uint16_t sliced(const char *buf, size_t len) {
+    return hash_slot::crc16_sliced(buf, len);
+}
+
+int main(int argc, char const *argv[])
+{
+    bpo::options_description opts("all options");
+    bpo::variables_map vm;
+
+    opts.add_options()
+    ("min-key-size", bpo::value<std::size_t>()->default_value(8), "Smallest key size in bytes.")
+    ("max-key-size", bpo::value<std::size_t>()->default_value(65536), "Largest key size in bytes, key sizes double from the smallest.")
+    ("num-keys", bpo::value<std::size_t>()->default_value(1024), "Number of distinct keys per key size.")
+    ("total-bytes", bpo::value<std::size_t>()->default_value(256 * 1024 * 1024), "Bytes hashed per key size and implementation.")
+    ("help", "Compares the CRC16 implementations used to compute hash slots.");
+
+    try {
+        bpo::store(bpo::parse_command_line(argc, argv, opts), vm);
+    }
+    catch(...) {
+        std::cout << "Wrong command line arguments! Please use '-help' to see how to correctly use arguments.\n";
+        return 0;
+    }
+
+    if (vm.count("help")) {
+        std::cout << opts << std::endl;
+        return 0;
+    }
+
+    auto min_key_size = std::max<std::size_t>(vm["min-key-size"].as<std::size_t>(), 1);
+    auto max_key_size = vm["max-key-size"].as<std::size_t>();
+    auto num_keys = std::max<std::size_t>(vm["num-keys"].as<std::size_t>(), 1);
+    auto total_bytes = vm["total-bytes"].as<std::size_t>();
+    // Output all the configuration parameters:
+    LOG(log_level::info) << "min-key-size: " << min_key_size;
+    LOG(log_level::info) << "max-key-size: " << max_key_size;
+    LOG(log_level::info) << "num-keys: " << num_keys;
+    LOG(log_level::info) << "total-bytes: " << total_bytes;
+    LOG(log_level::info) << "clmul-supported: " << hash_slot::clmul_supported();
+
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<int> byte(0, 255);
+    for (auto key_size = min_key_size; key_size <= max_key_size; key_size *= 2) {
+        // Cap the working set so that long keys measure hashing rather than cache misses
+        auto n = std::max<std::size_t>(std::min(num_keys, (4 * 1024 * 1024) / key_size), 1);
+        std::vector<std::string> keys(n, std::string(key_size, '\0'));
+        for (auto &key: keys) {
+            for (auto &c: key) {
+                c = static_cast<char>(byte(gen));
+            }
+        }
+        auto expected = crc16_benchmark("bytewise", bytewise, keys, total_bytes);
+        if (crc16_benchmark("sliced", sliced, keys, total_bytes) != expected
+            || crc16_benchmark("clmul", hash_slot::crc16_clmul, keys, total_bytes) != expected
+            || crc16_benchmark("dispatch", hash_slot::crc16, keys, total_bytes) != expected) {
+            LOG(log_level::error) << "Mismatched CRC16 results for " << key_size << " B keys";
+            return 1;
+        }
+    }
+}
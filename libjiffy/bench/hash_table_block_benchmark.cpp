@@ -2,6 +2,7 @@
 #include <thread>
 #include <iostream>
 #include <string>
+#include <unordered_map>
 #include <boost/program_options.hpp>
 #include <jiffy/utils/logger.h>
 #include <jiffy/utils/signal_handling.h>
@@ -20,15 +21,72 @@ using namespace ::apache::thrift;
 
 namespace  bpo = boost::program_options;
 
+/* Hash function used by the node-based table before the flat hash map */
+struct legacy_hash_type {
+    template<typename KeyType>
+    std::size_t operator()(const KeyType &k) const {
+        std::size_t result = 0;
+        for (size_t i = 0; i < k.size(); i++) {
+            result = k[i] + (result * 31);
+        }
+        return result;
+    }
+};
+
+typedef std::unordered_map<key_type, value_type, legacy_hash_type, equal_type> legacy_hash_table_type;
+
+void report(const std::string &op, int num_ops, int data_size, uint64_t tot_time) {
+    LOG(log_level::info) << "===== " << op << " ======";
+    LOG(log_level::info) << "total_time: " << tot_time;
+    LOG(log_level::info) << "\t" << num_ops << " requests completed in " << tot_time << " us";
+    LOG(log_level::info) << "\t" << data_size << " payload";
+    LOG(log_level::info) << "\tThroughput: " << num_ops * 1E3 / tot_time << " requests per microsecond";
+}
+
+/* Insert, look up and erase num_ops entries directly on a table, bypassing the partition */
+template<typename Table>
+void table_benchmark(const std::string &name, Table &table, block_memory_manager &manager,
+                     const std::vector<std::string> &keys, int data_size) {
+    binary_allocator allocator(&manager);
+    std::string data_(data_size, 'x');
+    int num_ops = static_cast<int>(keys.size());
+
+    auto used_before = manager.mb_used();
+    auto bench_begin = time_utils::now_us();
+    for (const auto &key: keys) {
+        table.emplace(binary(key, allocator), binary(data_, allocator));
+    }
+    report(name + "_emplace", num_ops, data_size, time_utils::now_us() - bench_begin);
+    LOG(log_level::info) << "\tBlock memory used: " << manager.mb_used() - used_before << " bytes";
+
+    std::size_t found = 0;
+    bench_begin = time_utils::now_us();
+    for (const auto &key: keys) {
+        found += table.find(binary(key, allocator)) != table.end();
+    }
+    report(name + "_find", num_ops, data_size, time_utils::now_us() - bench_begin);
+
+    bench_begin = time_utils::now_us();
+    for (const auto &key: keys) {
+        found -= table.erase(binary(key, allocator));
+    }
+    report(name + "_erase", num_ops, data_size, time_utils::now_us() - bench_begin);
+    if (found != 0) {
+        LOG(log_level::error) << "Mismatched find/erase results for " << name;
+    }
+}
+
 int main(int argc, char const *argv[])
 {
 
-    bpo::options_description opts("all options"); 
+    bpo::options_description opts("all options");
     bpo::variables_map vm;
 
-    opts.add_options()  
+    opts.add_options()
     ("pmem", bpo::value<std::string>(), "Run the benchmark under PMEM mode. Usage: '-pmem=PMEM_ADDRESS'.")
     ("dram", "Run the benchmark under DRAM mode. Usage: '-dram'.")
+    ("num-ops", bpo::value<int>()->default_value(100000), "Number of operations per phase.")
+    ("data-size", bpo::value<int>()->default_value(1024), "Value size in bytes.")
     ("help", "This benchmark only runs by block.");
 
     try {
@@ -38,99 +96,72 @@ int main(int argc, char const *argv[])
         std::cout << "Wrong command line arguments! Please use '-help' to see how to correctly use arguments.\n";
         return 0;
     }
-    
-    if (vm.size() > 1 || vm.empty()) {
-        std::cout << "Please use one option. See '-help' for more information. \n";
-    }
+
     if (vm.count("help")) {
-        std::cout << opts << std::endl;   
-    }
-    
-    else if (vm.count("dram")) {
-        std::string memory_mode = "DRAM";
-        std::string pmem_path = "";
-        void* mem_kind = mem_utils::init_kind(memory_mode, pmem_path);
+        std::cout << opts << std::endl;
+        return 0;
     }
-    else if (vm.count("pmem")) {
-        std::string memory_mode = "PMEM";
-        std::string pmem_path = vm["pmem"].as<std::string>();
-        void* mem_kind = mem_utils::init_kind(memory_mode, pmem_path);
+
+    std::string memory_mode = "DRAM";
+    std::string pmem_path = "";
+    if (vm.count("pmem")) {
+        memory_mode = "PMEM";
+        pmem_path = vm["pmem"].as<std::string>();
     }
+    void* mem_kind = mem_utils::init_kind(memory_mode, pmem_path);
 
-    std::string address = "127.0.0.1";
-    int service_port = 9090;
-    int lease_port = 9091;
-    int num_blocks = 1;
-    int chain_length = 1;
-    int num_ops = 100000;
-    int data_size = 1024;
-    
-    std::string path = "/tmp";
+    int num_ops = vm["num-ops"].as<int>();
+    int data_size = vm["data-size"].as<int>();
     std::string backing_path = "local://tmp";
     // Output all the configuration parameters:
-    LOG(log_level::info) << "host: " << address;
-    LOG(log_level::info) << "service-port: " << service_port;
-    LOG(log_level::info) << "lease-port: " << lease_port;
-    LOG(log_level::info) << "num-blocks: " << num_blocks;
-    LOG(log_level::info) << "chain-length: " << chain_length;
+    LOG(log_level::info) << "memory-mode: " << memory_mode;
     LOG(log_level::info) << "num-ops: " << num_ops;
     LOG(log_level::info) << "data-size: " << data_size;
-    LOG(log_level::info) << "path: " << path;
     LOG(log_level::info) << "backing-path: " << backing_path;
 
     size_t capacity = 134217728;
+    std::vector<std::string> keys;
+    keys.reserve(static_cast<size_t>(num_ops));
+    for (int i = 0; i < num_ops; ++i) {
+        keys.push_back(std::to_string(i));
+    }
+
+    // Raw table comparison: node-based unordered_map vs. flat hash map
+    {
+        block_memory_manager manager(capacity * 8, memory_mode, mem_kind);
+        legacy_hash_table_type table;
+        table_benchmark("unordered_map", table, manager, keys, data_size);
+    }
+    {
+        block_memory_manager manager(capacity * 8, memory_mode, mem_kind);
+        flat_hash_table_type table{block_memory_allocator<kv_pair_type>(&manager)};
+        table_benchmark("flat_hash_map", table, manager, keys, data_size);
+    }
+
+    // End-to-end partition operations
     block_memory_manager manager(capacity, memory_mode, mem_kind);
     hash_table_partition block(&manager);
     block.slot_range(0, hash_slot::MAX);
 
     auto bench_begin = time_utils::now_us();
-    uint64_t tot_time = 0;
     std::string data_ (data_size, 'x');
-
     for (int i = 0; i < num_ops; ++i) {
         response resp;
-        block.put(resp, {"put", std::to_string(i), data_});
+        block.put(resp, {"put", keys[i], data_});
     }
-	auto bench_end = time_utils::now_us();
-	tot_time = bench_end - bench_begin;
-	LOG(log_level::info) << "===== " << "hash_table_put" << " ======";
-	LOG(log_level::info) << "total_time: " << tot_time;
-	LOG(log_level::info) << "\t" << num_ops << " requests completed in " << tot_time
-											<< " us";
-	LOG(log_level::info) << "\t" << data_size << " payload";
-	LOG(log_level::info) << "\tThroughput: " << num_ops * 1E3 / tot_time << " requests per microsecond";
+    report("hash_table_put", num_ops, data_size, time_utils::now_us() - bench_begin);
 
     bench_begin = time_utils::now_us();
-    tot_time = 0;
-
     for (int i = 0; i < num_ops; ++i) {
         response resp;
-        block.get(resp, {"get", std::to_string(i)});
+        block.get(resp, {"get", keys[i]});
     }
-	bench_end = time_utils::now_us();
-	tot_time = bench_end - bench_begin;
-	LOG(log_level::info) << "===== " << "hash_table_get" << " ======";
-	LOG(log_level::info) << "total_time: " << tot_time;
-	LOG(log_level::info) << "\t" << num_ops << " requests completed in " << tot_time
-											<< " us";
-	LOG(log_level::info) << "\t" << data_size << " payload";
-	LOG(log_level::info) << "\tThroughput: " << num_ops * 1E3 / tot_time << " requests per microsecond";
-  
-	bench_begin = time_utils::now_us();
-    tot_time = 0;
-
-	for (int i = 0; i < num_ops; ++i) {
+    report("hash_table_get", num_ops, data_size, time_utils::now_us() - bench_begin);
+
+    bench_begin = time_utils::now_us();
+    for (int i = 0; i < num_ops; ++i) {
         response resp;
-        block.remove(resp, {"remove", std::to_string(i)});
+        block.remove(resp, {"remove", keys[i]});
     }
-  
-	bench_end = time_utils::now_us();
-	tot_time = bench_end - bench_begin;
-	LOG(log_level::info) << "===== " << "hash_table_remove" << " ======";
-	LOG(log_level::info) << "total_time: " << tot_time;
-	LOG(log_level::info) << "\t" << num_ops << " requests completed in " << tot_time
-											<< " us";
-	LOG(log_level::info) << "\t" << data_size << " payload";
-	LOG(log_level::info) << "\tThroughput: " << num_ops * 1E3 / tot_time << " requests per microsecond";
-	
-}
\ No newline at end of file
+    report("hash_table_remove", num_ops, data_size, time_utils::now_us() - bench_begin);
+}
@@ -8,6 +8,7 @@
 #include "jiffy/utils/string_utils.h"
 #include <mutex>
 #include <chrono>
+#include <thread>
 #include <jiffy/storage/client/data_structure_client.h>
 
 namespace jiffy {
@@ -118,7 +119,12 @@ void auto_scaling_service_handler::auto_scaling(const std::vector<std::string> &
     auto finish_updating_partition_before = time_utils::now_us();
 
     // Transfer the data from source to destination
-    hash_table_transfer_data(src, dst, split_range_beg, split_range_end);
+    if (!hash_table_transfer_data(fs, path, src, dst, split_range_beg, split_range_end)) {
+      // Leave the slot ranges as they are; keys already moved stay reachable through the
+      // source's redirects to the destination
+      throw make_exception("Unable to transfer slot range (" + std::to_string(split_range_beg) + ", "
+                               + std::to_string(split_range_end) + ") of " + path);
+    }
     auto finish_data_transmission = time_utils::now_us();
 
     // Finalize slot range split at directory server
@@ -207,7 +213,12 @@ void auto_scaling_service_handler::auto_scaling(const std::vector<std::string> &
     auto finish_update_partition_before = time_utils::now_us();
 
     // Transfer data from source to destination
-    hash_table_transfer_data(src, dst, merge_range_beg, merge_range_end);
+    if (!hash_table_transfer_data(fs, path, src, dst, merge_range_beg, merge_range_end)) {
+      // Leave the slot ranges as they are; keys already moved stay reachable through the
+      // source's redirects to the destination
+      throw make_exception("Unable to transfer slot range (" + std::to_string(merge_range_beg) + ", "
+                               + std::to_string(merge_range_end) + ") of " + path);
+    }
     auto finish_data_transmission = time_utils::now_us();
 
     // Update partition at directory server
@@ -275,46 +286,128 @@ void auto_scaling_service_handler::auto_scaling(const std::vector<std::string> &
   }
 }
 
-void auto_scaling_service_handler::hash_table_transfer_data(const std::shared_ptr<storage::replica_chain_client> &src,
+bool auto_scaling_service_handler::hash_table_transfer_data(const std::shared_ptr<directory::directory_interface> &fs,
+                                                            const std::string &path,
+                                                            const std::shared_ptr<storage::replica_chain_client> &src,
                                                             const std::shared_ptr<storage::replica_chain_client> &dst,
                                                             size_t slot_beg,
                                                             size_t slot_end,
                                                             size_t batch_size) {
-
-  // Transfer the data from source to destination
-  bool has_more = true;
-  std::vector<std::string> read_args{"get_range_data",
-                                     std::to_string(slot_beg),
-                                     std::to_string(slot_end),
-                                     std::to_string(batch_size)};
-  while (has_more) {
-    // Read data to split
-    auto write_args = src->run_command(read_args);
-    if (write_args.back() == "!empty") {
-      break;
-    } else if (write_args.size() < batch_size) {
-      has_more = false;
+  // Reads from the source go through a client of their own, so that their responses are not
+  // interleaved with those of the removes sent to the source
+  auto reader = std::make_shared<replica_chain_client>(fs, path, src->chain(), HT_OPS);
+  std::vector<std::string> read_args;
+  std::vector<std::string> put_args;
+  std::vector<std::string> remove_args;
+  std::vector<std::string> sent_remove_args;
+  bool put_in_flight = false;
+  bool remove_in_flight = false;
+  auto backoff = [](std::size_t attempt) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10 << attempt));
+  };
+
+  auto send_read = [&](const std::string *after) {
+    read_args = {"get_range_data", std::to_string(slot_beg), std::to_string(slot_end), std::to_string(batch_size)};
+    if (after != nullptr) {
+      read_args.push_back(*after);
     }
-
-    // write_args.insert(write_args.begin(), "scale_put"); // Add scale_put command name
-    write_args[0] = "scale_put";
-
-    // Write data to dst partition
-    auto response = dst->run_command(write_args);
-
-    // Remove data from src partition
-    auto transfer_size = write_args.size() - 1; // Account for "scale_put" command name
-
-    std::vector<std::string> remove_args{"scale_remove"};
-    for (std::size_t i = 0; i < transfer_size; i++) {
-      if (i % 2) {
-        remove_args.push_back(write_args.back());
+    reader->send_command(read_args);
+  };
+  // Wait for src to ack the remove in flight, resending it if src failed to take it; returns
+  // false if src kept failing, as the rescan of the range would otherwise move its keys forever
+  auto wait_remove = [&]() {
+    for (std::size_t attempt = 1; remove_in_flight; ++attempt) {
+      auto resp = src->recv_response();
+      remove_in_flight = false;
+      if (resp.front() == "!ok") {
+        break;
+      }
+      LOG(log_level::warn) << "Unable to remove transferred keys from source: " << resp.front();
+      if (attempt == HASH_TABLE_TRANSFER_ATTEMPTS) {
+        return false;
+      }
+      backoff(attempt);
+      src->send_command(sent_remove_args);
+      remove_in_flight = true;
+    }
+    return true;
+  };
+  // Wait for dst to ack the batch in flight, resending it if dst failed to take it, then free
+  // it at the source; returns false if dst or the previous remove kept failing, leaving the
+  // batch at the source
+  auto wait_put = [&]() {
+    for (std::size_t attempt = 1; put_in_flight; ++attempt) {
+      auto resp = dst->recv_response();
+      put_in_flight = false;
+      if (resp.front() == "!ok") {
+        if (!wait_remove()) {
+          return false;
+        }
+        sent_remove_args = std::move(remove_args);
+        src->send_command(sent_remove_args);
+        remove_in_flight = true;
+        break;
+      }
+      LOG(log_level::warn) << "Unable to write transferred keys to destination: " << resp.front();
+      if (attempt == HASH_TABLE_TRANSFER_ATTEMPTS) {
+        return false;
+      }
+      backoff(attempt);
+      dst->send_command(put_args);
+      put_in_flight = true;
+    }
+    return true;
+  };
+
+  bool moved = false;
+  std::size_t read_attempt = 0;
+  send_read(nullptr);
+  while (true) {
+    auto batch = reader->recv_response();
+    bool empty = batch.front() != "!ok";
+    if (empty && batch.front() != "!empty") {
+      LOG(log_level::warn) << "Unable to read keys to transfer from source: " << batch.front();
+      if (++read_attempt == HASH_TABLE_TRANSFER_ATTEMPTS) {
+        wait_put();
+        wait_remove();
+        return false;
+      }
+      backoff(read_attempt);
+      reader->send_command(read_args);
+      continue;
+    }
+    read_attempt = 0;
+    if (!empty) {
+      // Prefetch the next batch, resuming after the last key of this one
+      send_read(&batch[batch.size() - 3]);
+    }
+    if (!wait_put()) {
+      wait_remove();
+      return false;
+    }
+    if (!empty) {
+      batch[0] = "scale_put";
+      put_args = std::move(batch);
+      dst->send_command(put_args);
+      put_in_flight = true;
+      remove_args.assign(1, "scale_remove");
+      remove_args.reserve(put_args.size() / 3 + 1);
+      for (std::size_t i = 1; i < put_args.size(); i += 3) {
+        remove_args.push_back(put_args[i]);
       }
-      write_args.pop_back();
+      moved = true;
+      continue;
+    }
+    // Scan reached the end of the range; once everything in flight has settled, rescan from the
+    // start to pick up any keys the scan missed, and stop when nothing is left
+    if (!wait_remove()) {
+      return false;
+    }
+    if (!moved) {
+      return true;
     }
-    assert(write_args.size() == 1);
-    assert(remove_args.size() == transfer_size / 2 + 1);
-    auto ret = src->run_command(remove_args);
+    moved = false;
+    send_read(nullptr);
   }
 }
 
@@ -4,6 +4,7 @@
 #include <jiffy/storage/client/replica_chain_client.h>
 #include "auto_scaling_service.h"
 #include "jiffy/storage/client/replica_chain_client.h"
+#include "jiffy/storage/hashtable/hash_table_defs.h"
 
 namespace jiffy {
 namespace auto_scaling {
@@ -28,6 +29,30 @@ class auto_scaling_service_handler : public auto_scaling_serviceIf {
                     const std::string &path,
                     const std::map<std::string, std::string> &conf) override;
 
+  /**
+   * @brief Data transfer for hash table
+   * Reading the next batch from the source, writing the current batch to the
+   * destination and removing the previous batch from the source are overlapped;
+   * a batch is only removed from the source once the destination has acked it.
+   * Failed reads, writes and removes of a batch are retried; if a batch still fails,
+   * the transfer stops with the keys not yet moved left at the source.
+   * @param fs Directory service client
+   * @param path Path for hash table
+   * @param src Source partition client
+   * @param dst Destination partition client
+   * @param slot_beg Beginning of slot range for data transfer
+   * @param slot_end End of slot range for data transfer
+   * @param batch_size Batch size for data transfer
+   * @return True if the whole slot range was transferred
+   */
+  static bool hash_table_transfer_data(const std::shared_ptr<directory::directory_interface> &fs,
+                                       const std::string &path,
+                                       const std::shared_ptr<storage::replica_chain_client>& src,
+                                       const std::shared_ptr<storage::replica_chain_client>& dst,
+                                       size_t slot_beg,
+                                       size_t slot_end,
+                                       size_t batch_size = storage::HASH_TABLE_TRANSFER_BATCH_SIZE);
+
  private:
   /**
    * @brief Packs chain into a single string
@@ -67,19 +92,6 @@ class auto_scaling_service_handler : public auto_scaling_serviceIf {
                                 int32_t slot_beg,
                                 int32_t slot_end);
 
-  /**
-   * @brief Data transfer for hash table
-   * @param src Source partition client
-   * @param dst Destination partition client
-   * @param slot_beg Beginning of slot range for data transfer
-   * @param slot_end End of slot range for data transfer
-   * @param batch_size Batch size for data transfer
-   */
-  static void hash_table_transfer_data(const std::shared_ptr<storage::replica_chain_client>& src,
-                                       const std::shared_ptr<storage::replica_chain_client>& dst,
-                                       size_t slot_beg,
-                                       size_t slot_end,
-                                       size_t batch_size = 2);
   /* Directory server host name */
   std::string directory_host_;
   /* Directory server port number */
@@ -71,6 +71,24 @@ std::shared_ptr<storage::file_client> jiffy_client::create_file(const std::strin
   return std::make_shared<storage::file_client>(fs_, path, s);
 }
 
+std::shared_ptr<storage::file_client> jiffy_client::create_striped_file(const std::string &path,
+                                                                        const std::string &backing_path,
+                                                                        int32_t stripe_width,
+                                                                        std::size_t stripe_unit,
+                                                                        int32_t chain_length,
+                                                                        int32_t flags,
+                                                                        int32_t permissions,
+                                                                        const std::map<std::string,
+                                                                                       std::string> &tags) {
+  if (stripe_width < 1 || stripe_unit == 0) {
+    throw std::invalid_argument("Stripe width and stripe unit must be positive");
+  }
+  auto striped_tags = tags;
+  striped_tags[storage::file_layout::STRIPE_WIDTH_TAG] = std::to_string(stripe_width);
+  striped_tags[storage::file_layout::STRIPE_UNIT_TAG] = std::to_string(stripe_unit);
+  return create_file(path, backing_path, stripe_width, chain_length, flags, permissions, striped_tags);
+}
+
 std::shared_ptr<storage::fifo_queue_client> jiffy_client::create_fifo_queue(const std::string &path,
                                                                             const std::string &backing_path,
                                                                             int32_t num_blocks,
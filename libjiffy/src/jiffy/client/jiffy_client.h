@@ -86,6 +86,29 @@ class jiffy_client {
                                                     int32_t permissions = directory::perms::all(),
                                                     const std::map<std::string, std::string> &tags = {});
 
+  /**
+   * @brief Create file striped over several partitions
+   * Consecutive stripe units of the file go to different partitions, so that
+   * large reads and writes are served by several storage servers at once.
+   * @param path File path
+   * @param backing_path File backing path
+   * @param stripe_width Number of partitions data is striped over
+   * @param stripe_unit Stripe unit in bytes, a divisor of the block size
+   * @param chain_length Replication chain length
+   * @param flags Flags
+   * @param permissions Permissions
+   * @param tags Tags
+   * @return File writer
+   */
+  std::shared_ptr<storage::file_client> create_striped_file(const std::string &path,
+                                                            const std::string &backing_path,
+                                                            int32_t stripe_width,
+                                                            std::size_t stripe_unit = storage::FILE_DEFAULT_STRIPE_UNIT,
+                                                            int32_t chain_length = 1,
+                                                            int32_t flags = 0,
+                                                            int32_t permissions = directory::perms::all(),
+                                                            const std::map<std::string, std::string> &tags = {});
+
 /**
    * @brief Create shared_log
    * @param path shared_log path
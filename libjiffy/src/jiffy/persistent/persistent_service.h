@@ -101,6 +101,14 @@ class persistent_service {
 
   virtual void virtual_write(const storage::hash_table_type &table, const std::string &out_path) = 0;
 
+  /**
+   * @brief Virtual write for hash table with spilled values
+   * @param table Tiered hash table
+   * @param out_path Persistent store path
+   */
+
+  virtual void virtual_write(const storage::tiered_hash_table_type &table, const std::string &out_path) = 0;
+
   /**
    * @brief Virtual read for fifo queue
    * @param in_path Persistent store path
@@ -190,6 +198,16 @@ class derived_persistent : public persistent_service_impl {
     return persistent_service_impl::write_impl(table, out_path);
   }
 
+  /**
+   * @brief Virtual write for hash table with spilled values
+   * @param table Tiered hash table
+   * @param out_path Persistent store path
+   */
+
+  void virtual_write(const storage::tiered_hash_table_type &table, const std::string &out_path) final {
+    return persistent_service_impl::write_impl(table, out_path);
+  }
+
   /**
    * @brief Virtual read for fifo queue
    * @param in_path Persistent store path
@@ -0,0 +1,78 @@
+#include "batch_frame.h"
+#include <stdexcept>
+
+namespace jiffy {
+namespace storage {
+
+const std::string batch_frame::ACCESSOR = "batch_read";
+const std::string batch_frame::MUTATOR = "batch_write";
+
+bool batch_frame::is_batch(const std::string &cmd_name) {
+  return cmd_name == ACCESSOR || cmd_name == MUTATOR;
+}
+
+command_info batch_frame::info(const std::string &cmd_name) {
+  return command_info{cmd_name == MUTATOR ? command_type::mutator : command_type::accessor, UINT32_MAX};
+}
+
+std::vector<std::string> batch_frame::encode(const std::vector<std::vector<std::string>> &cmds,
+                                             const command_map &ops) {
+  std::size_t n = 1;
+  bool mutator = false;
+  for (const auto &cmd: cmds) {
+    n += cmd.size() + 1;
+    mutator = mutator || ops.at(cmd.front()).is_mutator();
+  }
+  std::vector<std::string> frame;
+  frame.reserve(n);
+  frame.push_back(mutator ? MUTATOR : ACCESSOR);
+  for (const auto &cmd: cmds) {
+    frame.push_back(std::to_string(cmd.size()));
+    frame.insert(frame.end(), cmd.begin(), cmd.end());
+  }
+  return frame;
+}
+
+std::vector<std::vector<std::string>> batch_frame::decode(const std::vector<std::string> &frame) {
+  std::vector<std::vector<std::string>> cmds;
+  std::size_t i = 1;
+  while (i < frame.size()) {
+    auto n = static_cast<std::size_t>(std::stoull(frame[i++]));
+    if (n > frame.size() - i) {
+      throw std::logic_error("Malformed batch frame");
+    }
+    cmds.emplace_back(frame.begin() + i, frame.begin() + i + n);
+    i += n;
+  }
+  return cmds;
+}
+
+std::vector<std::string> batch_frame::encode_responses(const std::vector<std::vector<std::string>> &responses) {
+  std::size_t n = 1;
+  for (const auto &resp: responses) {
+    n += resp.size() + 1;
+  }
+  std::vector<std::string> packed;
+  packed.reserve(n);
+  packed.emplace_back("!ok");
+  for (const auto &resp: responses) {
+    packed.push_back(std::to_string(resp.size()));
+    packed.insert(packed.end(), resp.begin(), resp.end());
+  }
+  return packed;
+}
+
+std::vector<std::vector<std::string>> batch_frame::decode_responses(const std::vector<std::string> &packed,
+                                                                    std::size_t count) {
+  if (packed.empty() || packed.front() != "!ok") {
+    return std::vector<std::vector<std::string>>(count, packed);
+  }
+  auto responses = decode(packed);
+  if (responses.size() != count) {
+    throw std::logic_error("Malformed batch response");
+  }
+  return responses;
+}
+
+}
+}
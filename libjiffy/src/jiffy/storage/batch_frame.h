@@ -0,0 +1,78 @@
+#ifndef JIFFY_BATCH_FRAME_H
+#define JIFFY_BATCH_FRAME_H
+
+#include <string>
+#include <vector>
+#include "jiffy/storage/command.h"
+
+namespace jiffy {
+namespace storage {
+
+/**
+ * @brief Batch of commands for a single partition, carried as one command.
+ *
+ * A frame is the frame name followed by each command prefixed with its
+ * number of arguments. The partition runs the commands back-to-back and
+ * replies with "!ok" followed by each response prefixed with its length.
+ * A frame holding any mutator travels down the chain like a mutator;
+ * otherwise it is served by the tail like an accessor.
+ */
+class batch_frame {
+ public:
+  /* Name of a frame holding accessors only */
+  static const std::string ACCESSOR;
+  /* Name of a frame holding at least one mutator */
+  static const std::string MUTATOR;
+
+  /**
+   * @brief Check if command is a batch frame
+   * @param cmd_name Command name
+   * @return Bool value, true if command is a batch frame
+   */
+  static bool is_batch(const std::string &cmd_name);
+
+  /**
+   * @brief Fetch command information for a batch frame
+   * @param cmd_name Frame name
+   * @return Command information
+   */
+  static command_info info(const std::string &cmd_name);
+
+  /**
+   * @brief Pack commands into a batch frame
+   * @param cmds Commands
+   * @param ops Operations of the data structure, to tell accessors from mutators
+   * @return Batch frame
+   */
+  static std::vector<std::string> encode(const std::vector<std::vector<std::string>> &cmds, const command_map &ops);
+
+  /**
+   * @brief Unpack commands from a batch frame
+   * @param frame Batch frame
+   * @return Commands
+   */
+  static std::vector<std::vector<std::string>> decode(const std::vector<std::string> &frame);
+
+  /**
+   * @brief Pack responses of the commands in a batch frame
+   * @param responses Responses
+   * @return Packed response
+   */
+  static std::vector<std::string> encode_responses(const std::vector<std::vector<std::string>> &responses);
+
+  /**
+   * @brief Unpack responses of the commands in a batch frame
+   * A response that is not a packed batch response, e.g. "!block_moved" from the
+   * client side, is returned as the response of every command.
+   * @param packed Packed response
+   * @param count Number of commands in the batch frame
+   * @return Responses
+   */
+  static std::vector<std::vector<std::string>> decode_responses(const std::vector<std::string> &packed,
+                                                                std::size_t count);
+};
+
+}
+}
+
+#endif //JIFFY_BATCH_FRAME_H
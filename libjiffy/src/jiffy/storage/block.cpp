@@ -13,9 +13,12 @@ block::block(const std::string &id,
              const std::string memory_mode,
              void* mem_kind,
              const std::string &auto_scaling_host,
-             const int auto_scaling_port)
+             const int auto_scaling_port,
+             const int numa_node,
+             const bool prefault,
+             const std::string &tier_path)
     : id_(id),
-      manager_(capacity, memory_mode, mem_kind),
+      manager_(capacity, memory_mode, mem_kind, numa_node, prefault),
       impl_(partition_manager::build_partition(&manager_,
                                                "default",
                                                "local://tmp",
@@ -25,7 +28,8 @@ block::block(const std::string &id,
                                                auto_scaling_host,
                                                auto_scaling_port)),
       auto_scaling_host_(auto_scaling_host),
-      auto_scaling_port_(auto_scaling_port) {
+      auto_scaling_port_(auto_scaling_port),
+      tier_path_(tier_path) {
   if (impl_ == nullptr) {
     throw std::invalid_argument("No such type ");
   }
@@ -47,12 +51,17 @@ void block::setup(const std::string &type,
                   const std::string &name,
                   const std::string &metadata,
                   const utils::property_map &conf) {
+  // The value tier lives on the storage server's local disk, so its directory comes from the server
+  auto part_conf = conf;
+  if (!tier_path_.empty()) {
+    part_conf.set("hashtable.tier_path", tier_path_);
+  }
   impl_ = partition_manager::build_partition(&manager_,
                                              type,
                                              backing_path,
                                              name,
                                              metadata,
-                                             conf,
+                                             part_conf,
                                              auto_scaling_host_,
                                              auto_scaling_port_);
   if (impl_ == nullptr) {
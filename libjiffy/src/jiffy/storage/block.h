@@ -18,13 +18,19 @@ class block {
    * @param capacity The block memory capacity.
    * @param directory_host The directory host.
    * @param directory_port The directory port.
+   * @param numa_node The NUMA node to place block memory on, -1 to leave placement to the OS.
+   * @param prefault Fault in huge page memory as it is allocated, in HUGEPAGE mode.
+   * @param tier_path Local SSD directory hash table partitions spill cold values to, empty to keep them in memory.
    */
   explicit block(const std::string &id,
         const size_t capacity = 134217728,
         const std::string memory_mode = "DRAM",
         void* mem_kind = nullptr,
         const std::string &auto_scaling_host = "127.0.0.1",
-        const int auto_scaling_port = 9095);
+        const int auto_scaling_port = 9095,
+        const int numa_node = -1,
+        const bool prefault = false,
+        const std::string &tier_path = "");
 
   /**
    * @brief Get memory block identifier.
@@ -89,6 +95,8 @@ class block {
 
   std::string auto_scaling_host_;
   int auto_scaling_port_;
+
+  std::string tier_path_;
 };
 
 }
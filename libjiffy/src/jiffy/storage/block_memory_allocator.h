@@ -60,13 +60,18 @@ class block_memory_allocator {
     return manager_->mb_capacity() / sizeof(T);
   }
 
+  // size of the pages backing large allocations
+  size_type page_size() const {
+    return manager_->mb_page_size();
+  }
+
   // allocate but don't initialize num elements of type T
   pointer allocate(size_type num, const void * = 0) {
     size_t requested_bytes = num * sizeof(T);
     if (requested_bytes == 0) return nullptr;
     auto p = static_cast<pointer>(manager_->mb_malloc(num * sizeof(T)));
     if (p == nullptr) {
-      if (manager_->mb_used() + requested_bytes > manager_->mb_capacity()) {
+      if (!manager_->mb_fits(requested_bytes)) {
         throw memory_block_overflow();
       } else {
         throw std::bad_alloc();
@@ -92,11 +97,11 @@ class block_memory_allocator {
     p->~T();
   }
 
-  // deallocate storage p of deleted elements
-  void deallocate(pointer p, size_type size) {
+  // deallocate storage p of num deleted elements
+  void deallocate(pointer p, size_type num) {
     if (p == nullptr)
       return;
-    manager_->mb_free(p, size);
+    manager_->mb_free(p, num * sizeof(T));
   }
 
   template<typename U>
@@ -4,59 +4,458 @@
   #include <jemalloc/jemalloc.h>
 #endif
 #include <new>
+#include <set>
+#include <vector>
+#include <sys/mman.h>
+#include <unistd.h>
 #include "block_memory_manager.h"
 #include "jiffy/utils/logger.h"
+#include "jiffy/utils/numa_utils.h"
 using namespace jiffy::utils;
 
 namespace jiffy {
 namespace storage {
 
-block_memory_manager::block_memory_manager(size_t capacity, const std::string memory_mode, void* mem_kind)
-    : capacity_(capacity), used_(0), memory_mode_(memory_mode), mem_kind_(mem_kind) {}
+namespace {
 
-void *block_memory_manager::mb_malloc(size_t size) {
-  if (used_.load() > capacity_) {
-    return nullptr;
+#ifndef MEMKIND_IN_USE
+/* Allocation flags for the jemalloc arena of a NUMA node, creating the arena on first use */
+int node_alloc_flags(int node) {
+  static std::mutex lock;
+  static std::map<int, int> flags;
+  std::lock_guard<std::mutex> guard(lock);
+  auto it = flags.find(node);
+  if (it != flags.end()) {
+    return it->second;
+  }
+  unsigned arena = 0;
+  size_t size = sizeof(arena);
+  if (mallctl("arenas.create", &arena, &size, nullptr, 0) != 0) {
+    LOG(log_level::warn) << "Could not create memory arena for NUMA node " << node;
+    return flags[node] = 0;
   }
+  // Bypass the thread caches, which would hand memory freed to this arena to any other
+  return flags[node] = static_cast<int>(MALLOCX_ARENA(arena) | MALLOCX_TCACHE_NONE);
+}
+#endif
+
+}
+
+block_memory_manager::block_memory_manager(size_t capacity,
+                                           const std::string memory_mode,
+                                           void* mem_kind,
+                                           int numa_node,
+                                           bool prefault)
+    : capacity_(capacity),
+      used_(0),
+      charged_(0),
+      reclaim_mark_(0),
+      memory_mode_(memory_mode),
+      mem_kind_(mem_kind),
+      numa_node_(memory_mode == "DRAM" || memory_mode == "HUGEPAGE" ? numa_node : -1),
+      alloc_flags_(0),
+      huge_pages_(memory_mode == "HUGEPAGE"),
+      prefault_(prefault) {
   #ifdef MEMKIND_IN_USE
-    if (memory_mode_ == "DRAM") {
+    if (memory_mode_ == "DRAM" || memory_mode_ == "HUGEPAGE") {
       mem_kind_ = MEMKIND_DEFAULT;
     }
-    auto ptr = memkind_malloc((struct memkind*)mem_kind_, size);
   #else
-    auto ptr = mallocx(size, 0);
-  #endif 
-  used_ += size;
+    if (numa_node_ >= 0) {
+      alloc_flags_ = node_alloc_flags(numa_node_);
+    }
+  #endif
+}
+
+block_memory_manager::~block_memory_manager() {
+  release_pages_and_large();
+}
+
+void *block_memory_manager::mb_malloc(size_t size) {
+  if (size <= SLAB_MAX_SIZE) {
+    auto cls = size_class(size);
+    auto ptr = slab_malloc(cls);
+    if (ptr == nullptr && reclaim_pages()) {
+      ptr = slab_malloc(cls);
+    }
+    if (ptr != nullptr) {
+      used_ += class_size(cls);
+    }
+    return ptr;
+  }
+  if (!reserve(size) && !(reclaim_pages() && reserve(size))) {
+    return nullptr;
+  }
+  auto ptr = raw_malloc(size);
+  if (ptr == nullptr) {
+    charged_ -= size;
+    return nullptr;
+  }
+  try {
+    std::lock_guard<std::mutex> lock(pages_lock_);
+    large_.insert(ptr);
+  } catch (std::bad_alloc &e) {
+    raw_free(ptr);
+    charged_ -= size;
+    return nullptr;
+  }
+  // Charge the slack the underlying allocator rounded the request up to
+  auto usable = raw_usable_size(ptr);
+  charged_ += usable - size;
+  used_ += usable;
   return ptr;
 }
 
 void block_memory_manager::mb_free(void *ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  auto addr = reinterpret_cast<uintptr_t>(ptr);
+  auto cls = NUM_SIZE_CLASSES;
+  {
+    std::lock_guard<std::mutex> lock(pages_lock_);
+    auto it = pages_.upper_bound(addr);
+    if (it != pages_.begin() && addr < (--it)->first + SLAB_PAGE_SIZE) {
+      cls = it->second;
+    }
+  }
+  if (cls == NUM_SIZE_CLASSES) {
+    free_large(ptr);
+    return;
+  }
+  slab_free(ptr, cls);
+  used_ -= class_size(cls);
+}
+
+void block_memory_manager::mb_free(void *ptr, size_t size) {
+  if (ptr == nullptr) {
+    return;
+  }
+  if (size > SLAB_MAX_SIZE) {
+    free_large(ptr);
+    return;
+  }
+  auto cls = size_class(size);
+  slab_free(ptr, cls);
+  used_ -= class_size(cls);
+}
+
+void block_memory_manager::mb_release_all() {
+  std::vector<std::unique_lock<std::mutex>> locks;
+  locks.reserve(SLAB_NUM_ARENAS);
+  for (auto &a: arenas_) {
+    locks.emplace_back(a.mutex);
+    for (auto &c: a.classes) {
+      c = size_class_cache();
+    }
+  }
+  release_pages_and_large();
+  used_ = 0;
+  charged_ = 0;
+  reclaim_mark_ = 0;
+}
+
+bool block_memory_manager::mb_fits(size_t size) const {
+  auto charge = size <= SLAB_MAX_SIZE ? class_size(size_class(size)) : size;
+  return charged_.load() + charge <= capacity_;
+}
+
+size_t block_memory_manager::mb_capacity() const {
+  return capacity_;
+}
+
+size_t block_memory_manager::mb_used() const {
+  return used_.load();
+}
+
+int block_memory_manager::numa_node() const {
+  return numa_node_;
+}
+
+size_t block_memory_manager::mb_page_size() const {
+  return huge_pages_ ? HUGE_PAGE_SIZE : static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+size_t block_memory_manager::size_class(size_t size) {
+  // 16 byte steps up to 128, 32 byte steps up to 256, 64 byte steps up to 512
+  if (size <= 128) {
+    return size == 0 ? 0 : (size - 1) / 16;
+  }
+  if (size <= 256) {
+    return 8 + (size - 129) / 32;
+  }
+  return 12 + (size - 257) / 64;
+}
+
+size_t block_memory_manager::class_size(size_t size_class) {
+  if (size_class < 8) {
+    return (size_class + 1) * 16;
+  }
+  if (size_class < 12) {
+    return 128 + (size_class - 7) * 32;
+  }
+  return 256 + (size_class - 11) * 64;
+}
+
+block_memory_manager::arena &block_memory_manager::local_arena() {
+  static std::atomic<size_t> next_arena(0);
+  static thread_local size_t thread_arena = next_arena++ % SLAB_NUM_ARENAS;
+  return arenas_[thread_arena];
+}
+
+bool block_memory_manager::reserve(size_t size) {
+  auto charged = charged_.load();
+  do {
+    if (charged + size > capacity_) {
+      return false;
+    }
+  } while (!charged_.compare_exchange_weak(charged, charged + size));
+  return true;
+}
+
+void *block_memory_manager::slab_malloc(size_t size_class) {
+  auto &a = local_arena();
+  std::lock_guard<std::mutex> lock(a.mutex);
+  auto &c = a.classes[size_class];
+  // Chunks on the free list are charged already
+  if (c.free_list != nullptr) {
+    auto ptr = c.free_list;
+    c.free_list = *static_cast<void **>(ptr);
+    return ptr;
+  }
+  auto size = class_size(size_class);
+  if (!reserve(size)) {
+    return nullptr;
+  }
+  if (c.cursor == nullptr || c.cursor + size > c.limit) {
+    auto page = static_cast<char *>(raw_malloc(SLAB_PAGE_SIZE));
+    if (page == nullptr) {
+      charged_ -= size;
+      return nullptr;
+    }
+    try {
+      std::lock_guard<std::mutex> pages_lock(pages_lock_);
+      pages_.emplace(reinterpret_cast<uintptr_t>(page), size_class);
+    } catch (std::bad_alloc &e) {
+      raw_free(page);
+      charged_ -= size;
+      return nullptr;
+    }
+    c.cursor = page;
+    c.limit = page + SLAB_PAGE_SIZE;
+  }
+  auto ptr = c.cursor;
+  c.cursor += size;
+  return ptr;
+}
+
+void block_memory_manager::slab_free(void *ptr, size_t size_class) {
+  auto &a = local_arena();
+  std::lock_guard<std::mutex> lock(a.mutex);
+  auto &c = a.classes[size_class];
+  *static_cast<void **>(ptr) = c.free_list;
+  c.free_list = ptr;
+}
+
+bool block_memory_manager::reclaim_pages() {
+  // Only chunks freed since the last attempt can have emptied a page
+  auto charged = charged_.load();
+  auto used = used_.load();
+  if (charged <= used || charged - used == reclaim_mark_.load()) {
+    return false;
+  }
+  std::vector<std::unique_lock<std::mutex>> locks;
+  locks.reserve(SLAB_NUM_ARENAS);
+  for (auto &a: arenas_) {
+    locks.emplace_back(a.mutex);
+  }
+  std::lock_guard<std::mutex> pages_lock(pages_lock_);
+  auto page_of = [this](void *ptr) {
+    return (--pages_.upper_bound(reinterpret_cast<uintptr_t>(ptr)))->first;
+  };
+  // Chunks of a page may be on the free lists of any arena, since threads free to their own
+  std::map<uintptr_t, size_t> free_chunks;
+  for (auto &a: arenas_) {
+    for (auto &c: a.classes) {
+      for (auto ptr = c.free_list; ptr != nullptr; ptr = *static_cast<void **>(ptr)) {
+        ++free_chunks[page_of(ptr)];
+      }
+    }
+  }
+  std::map<uintptr_t, size_t> carved;
+  for (const auto &p: free_chunks) {
+    carved.emplace(p.first, SLAB_PAGE_SIZE / class_size(pages_.at(p.first)));
+  }
+  for (auto &a: arenas_) {
+    for (size_t cls = 0; cls < NUM_SIZE_CLASSES; ++cls) {
+      auto &c = a.classes[cls];
+      if (c.cursor != nullptr) {
+        auto page = reinterpret_cast<uintptr_t>(c.limit - SLAB_PAGE_SIZE);
+        auto it = carved.find(page);
+        if (it != carved.end()) {
+          it->second = static_cast<size_t>(c.cursor - c.limit + SLAB_PAGE_SIZE) / class_size(cls);
+        }
+      }
+    }
+  }
+  std::set<uintptr_t> empty;
+  for (const auto &p: free_chunks) {
+    if (p.second == carved[p.first]) {
+      empty.insert(p.first);
+    }
+  }
+  size_t released = 0;
+  if (!empty.empty()) {
+    for (auto &a: arenas_) {
+      for (size_t cls = 0; cls < NUM_SIZE_CLASSES; ++cls) {
+        auto &c = a.classes[cls];
+        void **link = &c.free_list;
+        while (*link != nullptr) {
+          if (empty.count(page_of(*link))) {
+            *link = *static_cast<void **>(*link);
+            released += class_size(cls);
+          } else {
+            link = static_cast<void **>(*link);
+          }
+        }
+        if (c.cursor != nullptr && empty.count(reinterpret_cast<uintptr_t>(c.limit - SLAB_PAGE_SIZE))) {
+          c.cursor = nullptr;
+          c.limit = nullptr;
+        }
+      }
+    }
+    for (auto page: empty) {
+      pages_.erase(page);
+      raw_free(reinterpret_cast<void *>(page));
+    }
+    charged_ -= released;
+  }
+  charged = charged_.load();
+  used = used_.load();
+  reclaim_mark_ = charged > used ? charged - used : 0;
+  return released > 0;
+}
+
+void *block_memory_manager::raw_malloc(size_t size) {
+  if (huge_pages_ && size >= HUGE_PAGE_SIZE) {
+    return huge_malloc(size);
+  }
   #ifdef MEMKIND_IN_USE
-    auto size = memkind_malloc_usable_size((struct memkind*)mem_kind_, ptr);
-    memkind_free((struct memkind*)mem_kind_, ptr);
-  #else 
-    auto size = sallocx(ptr, 0);
-    free(ptr);
+    auto ptr = memkind_malloc((struct memkind*)mem_kind_, size);
+  #else
+    auto ptr = mallocx(size, alloc_flags_);
   #endif
-  used_ -= size;
+  if (ptr != nullptr && numa_node_ >= 0 && size >= SLAB_PAGE_SIZE) {
+    numa_utils::bind_memory(ptr, size, numa_node_);
+  }
+  return ptr;
 }
 
-void block_memory_manager::mb_free(void *ptr, size_t size) {
+void block_memory_manager::raw_free(void *ptr) {
+  if (huge_pages_ && huge_free(ptr)) {
+    return;
+  }
   #ifdef MEMKIND_IN_USE
     memkind_free((struct memkind*)mem_kind_, ptr);
   #else
-    free(ptr);
+    dallocx(ptr, alloc_flags_);
   #endif
-  used_ -= size;
 }
 
-size_t block_memory_manager::mb_capacity() const {
-  return capacity_;
+size_t block_memory_manager::raw_usable_size(void *ptr) {
+  if (huge_pages_) {
+    std::lock_guard<std::mutex> lock(huge_lock_);
+    auto it = huge_.find(ptr);
+    if (it != huge_.end()) {
+      return it->second;
+    }
+  }
+  #ifdef MEMKIND_IN_USE
+    return memkind_malloc_usable_size((struct memkind*)mem_kind_, ptr);
+  #else
+    return sallocx(ptr, alloc_flags_);
+  #endif
 }
 
-size_t block_memory_manager::mb_used() const {
-  return used_.load();
+void *block_memory_manager::huge_malloc(size_t size) {
+  size = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+  void *ptr = MAP_FAILED;
+  #ifdef MAP_HUGETLB
+    ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  #endif
+  if (ptr == MAP_FAILED) {
+    // No hugetlbfs pages to spare, ask for transparent huge pages on an aligned mapping instead
+    auto raw = static_cast<char *>(mmap(nullptr, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (raw == MAP_FAILED) {
+      return nullptr;
+    }
+    auto offset = (HUGE_PAGE_SIZE - reinterpret_cast<uintptr_t>(raw) % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE;
+    if (offset > 0) {
+      munmap(raw, offset);
+    }
+    munmap(raw + offset + size, HUGE_PAGE_SIZE - offset);
+    ptr = raw + offset;
+    #ifdef MADV_HUGEPAGE
+      madvise(ptr, size, MADV_HUGEPAGE);
+    #endif
+  }
+  if (numa_node_ >= 0) {
+    numa_utils::bind_memory(ptr, size, numa_node_);
+  }
+  if (prefault_) {
+    auto page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    for (size_t off = 0; off < size; off += page) {
+      static_cast<volatile char *>(ptr)[off] = 0;
+    }
+  }
+  try {
+    std::lock_guard<std::mutex> lock(huge_lock_);
+    huge_.emplace(ptr, size);
+  } catch (std::bad_alloc &e) {
+    munmap(ptr, size);
+    return nullptr;
+  }
+  return ptr;
+}
+
+bool block_memory_manager::huge_free(void *ptr) {
+  size_t size;
+  {
+    std::lock_guard<std::mutex> lock(huge_lock_);
+    auto it = huge_.find(ptr);
+    if (it == huge_.end()) {
+      return false;
+    }
+    size = it->second;
+    huge_.erase(it);
+  }
+  munmap(ptr, size);
+  return true;
+}
+
+void block_memory_manager::free_large(void *ptr) {
+  auto size = raw_usable_size(ptr);
+  {
+    std::lock_guard<std::mutex> lock(pages_lock_);
+    large_.erase(ptr);
+  }
+  raw_free(ptr);
+  used_ -= size;
+  charged_ -= size;
+}
+
+void block_memory_manager::release_pages_and_large() {
+  std::lock_guard<std::mutex> lock(pages_lock_);
+  for (const auto &page: pages_) {
+    raw_free(reinterpret_cast<void *>(page.first));
+  }
+  pages_.clear();
+  for (auto ptr: large_) {
+    raw_free(ptr);
+  }
+  large_.clear();
 }
 
 }
-}
\ No newline at end of file
+}
@@ -4,8 +4,12 @@
 #include <cstdint>
 #include <cstddef>
 #include <atomic>
+#include <map>
+#include <mutex>
 #include <new>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace jiffy {
 namespace storage {
@@ -14,18 +18,64 @@ struct memory_block_overflow : std::bad_alloc {
   using std::bad_alloc::bad_alloc;
 };
 
+// Largest allocation served from slab pages; larger ones go to the underlying allocator
+constexpr size_t SLAB_MAX_SIZE = 512;
+
+// Size of a slab page, carved into chunks of a single size class
+constexpr size_t SLAB_PAGE_SIZE = 65536;
+
+// Number of slab arenas that threads are spread across
+constexpr size_t SLAB_NUM_ARENAS = 8;
+
+// Size of a huge page; in HUGEPAGE mode allocations of at least this size are mapped on huge pages
+constexpr size_t HUGE_PAGE_SIZE = 2097152;
+
 /**
  * @brief Memory allocator that tracks size internally.
+ *
+ * Allocations of up to SLAB_MAX_SIZE bytes are rounded up to a size class and
+ * carved out of slab pages; freed chunks are kept on per class free lists for
+ * reuse. Each thread is mapped to one of SLAB_NUM_ARENAS arenas, so threads
+ * working on the same block rarely contend on a free list. Larger allocations
+ * go straight to the underlying allocator.
+ *
+ * Used bytes count the size class of slab chunks and the usable size of large
+ * allocations. Chunks on free lists stay charged against the capacity, as only
+ * their size class can reuse them; when the capacity runs out, slab pages whose
+ * chunks are all free are returned to the underlying allocator. Capacity is
+ * reserved before memory is allocated, so the charged bytes never exceed the
+ * capacity because of concurrent allocations.
+ *
+ * A manager placed on a NUMA node allocates from a jemalloc arena dedicated to
+ * that node and binds slab pages and other page sized allocations to it.
+ * Smaller allocations land on the node of the thread that first touches them.
+ *
+ * In HUGEPAGE mode, allocations of HUGE_PAGE_SIZE bytes or more are mapped
+ * directly on huge pages, from the hugetlbfs pool if pages are reserved and as
+ * transparent huge pages otherwise; they may be prefaulted so that the first
+ * writes to them take no page faults. Smaller allocations are served as in
+ * DRAM mode.
  */
 class block_memory_manager {
  public:
   /**
    * @brief Constructor.
    * @param capacity Maximum capacity of block.
+   * @param memory_mode Memory mode, DRAM, HUGEPAGE or PMEM.
+   * @param mem_kind Memory kind for PMEM mode.
+   * @param numa_node NUMA node to place DRAM on, -1 to leave placement to the OS.
+   * @param prefault Fault in huge page allocations when they are made, in HUGEPAGE mode.
    */
   explicit block_memory_manager(size_t capacity = 134217728,
                                 const std::string memory_mode = "DRAM",
-                                void* mem_kind = nullptr);
+                                void* mem_kind = nullptr,
+                                int numa_node = -1,
+                                bool prefault = false);
+
+  /**
+   * @brief Destructor, returns all slab pages and large allocations.
+   */
+  ~block_memory_manager();
 
   /**
    * @brief Allocate memory.
@@ -47,6 +97,20 @@ class block_memory_manager {
    */
   void mb_free(void *ptr, size_t size);
 
+  /**
+   * @brief Release all memory at once.
+   * Every allocation made through this manager becomes invalid; containers
+   * holding such memory must be dropped without freeing their elements.
+   */
+  void mb_release_all();
+
+  /**
+   * @brief Check if an allocation fits in the remaining capacity.
+   * @param size Number of bytes to allocate.
+   * @return True if the allocation fits, false otherwise.
+   */
+  bool mb_fits(size_t size) const;
+
   /**
    * @brief Get capacity of memory block.
    * @return Capacity of memory block.
@@ -59,6 +123,18 @@ class block_memory_manager {
    */
   size_t mb_used() const;
 
+  /**
+   * @brief Get NUMA node memory is placed on.
+   * @return NUMA node, -1 if unplaced.
+   */
+  int numa_node() const;
+
+  /**
+   * @brief Get size of the pages backing large allocations.
+   * @return HUGE_PAGE_SIZE in HUGEPAGE mode, the system page size otherwise.
+   */
+  size_t mb_page_size() const;
+
   /**
    * @brief Check if two block memory managers are the same.
    * @param other Instance of other block memory manager.
@@ -78,10 +154,95 @@ class block_memory_manager {
   }
 
  private:
+  /* Number of slab size classes */
+  static const size_t NUM_SIZE_CLASSES = 16;
+
+  /* Slab state of one size class within an arena */
+  struct size_class_cache {
+    /* Freed chunks, linked through their first word */
+    void *free_list = nullptr;
+    /* Next uncarved chunk in the current page */
+    char *cursor = nullptr;
+    /* End of the current page */
+    char *limit = nullptr;
+  };
+
+  /* Slab caches shared by the threads mapped to an arena */
+  struct arena {
+    /* Arena lock */
+    std::mutex mutex;
+    /* Per size class caches */
+    size_class_cache classes[NUM_SIZE_CLASSES];
+  };
+
+  static size_t size_class(size_t size);
+
+  static size_t class_size(size_t size_class);
+
+  arena &local_arena();
+
+  bool reserve(size_t size);
+
+  void *slab_malloc(size_t size_class);
+
+  void slab_free(void *ptr, size_t size_class);
+
+  bool reclaim_pages();
+
+  void *raw_malloc(size_t size);
+
+  void raw_free(void *ptr);
+
+  size_t raw_usable_size(void *ptr);
+
+  void *huge_malloc(size_t size);
+
+  bool huge_free(void *ptr);
+
+  void free_large(void *ptr);
+
+  void release_pages_and_large();
+
   size_t capacity_;
   std::atomic<size_t> used_;
+
+  /* Used bytes plus the bytes of chunks on free lists, held against the capacity */
+  std::atomic<size_t> charged_;
+
+  /* Bytes on free lists when pages were last reclaimed, so that a fruitless attempt is not repeated */
+  std::atomic<size_t> reclaim_mark_;
   std::string memory_mode_;
   void* mem_kind_;
+
+  /* NUMA node memory is placed on, -1 if unplaced */
+  int numa_node_;
+
+  /* Flags for the underlying allocator, selecting the NUMA node's arena */
+  int alloc_flags_;
+
+  /* Map large allocations on huge pages */
+  bool huge_pages_;
+
+  /* Fault in huge page allocations when they are made */
+  bool prefault_;
+
+  /* Slab arenas */
+  arena arenas_[SLAB_NUM_ARENAS];
+
+  /* Lock for slab pages and large allocations */
+  std::mutex pages_lock_;
+
+  /* Slab pages, by start address, with the size class they are carved into */
+  std::map<uintptr_t, size_t> pages_;
+
+  /* Allocations larger than SLAB_MAX_SIZE */
+  std::unordered_set<void *> large_;
+
+  /* Lock for huge page mappings */
+  std::mutex huge_lock_;
+
+  /* Huge page mappings, with their mapped size */
+  std::unordered_map<void *, size_t> huge_;
 };
 
 }
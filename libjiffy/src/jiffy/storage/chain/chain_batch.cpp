@@ -0,0 +1,60 @@
+#include "chain_batch.h"
+#include <stdexcept>
+
+namespace jiffy {
+namespace storage {
+
+// Number of frame fields preceding the arguments of each operation
+constexpr std::size_t CHAIN_BATCH_OP_HEADER = 4;
+
+const std::string chain_batch::NAME = "chain_batch";
+
+bool chain_batch::is_batch(const std::vector<std::string> &args) {
+  return !args.empty() && args.front() == NAME;
+}
+
+void chain_batch::begin(std::vector<std::string> &frame) {
+  frame.clear();
+  frame.push_back(NAME);
+}
+
+void chain_batch::append(std::vector<std::string> &frame, const chain_op &op) {
+  frame.push_back(std::to_string(op.seq.client_id));
+  frame.push_back(std::to_string(op.seq.client_seq_no));
+  frame.push_back(std::to_string(op.seq.server_seq_no));
+  frame.push_back(std::to_string(op.args.size()));
+  frame.insert(frame.end(), op.args.begin(), op.args.end());
+}
+
+std::vector<chain_op> chain_batch::decode(const std::vector<std::string> &frame) {
+  std::vector<chain_op> ops;
+  std::size_t i = 1;
+  while (i < frame.size()) {
+    if (frame.size() - i < CHAIN_BATCH_OP_HEADER) {
+      throw std::logic_error("Malformed chain batch");
+    }
+    chain_op op;
+    op.seq.client_id = std::stoll(frame[i++]);
+    op.seq.client_seq_no = std::stoll(frame[i++]);
+    op.seq.server_seq_no = std::stoll(frame[i++]);
+    auto n = static_cast<std::size_t>(std::stoull(frame[i++]));
+    if (n > frame.size() - i) {
+      throw std::logic_error("Malformed chain batch");
+    }
+    op.args.assign(frame.begin() + i, frame.begin() + i + n);
+    i += n;
+    ops.push_back(std::move(op));
+  }
+  return ops;
+}
+
+std::size_t chain_batch::size(const chain_op &op) {
+  std::size_t n = 0;
+  for (const auto &arg: op.args) {
+    n += arg.size();
+  }
+  return n;
+}
+
+}
+}
@@ -0,0 +1,73 @@
+#ifndef JIFFY_CHAIN_BATCH_H
+#define JIFFY_CHAIN_BATCH_H
+
+#include <string>
+#include <vector>
+#include "jiffy/storage/service/block_service_types.h"
+
+namespace jiffy {
+namespace storage {
+
+/*
+ * Chain operation
+ */
+
+struct chain_op {
+  /* Command sequence identifier */
+  sequence_id seq;
+  /* Command arguments */
+  std::vector<std::string> args;
+};
+
+/**
+ * @brief Batch of chain operations forwarded to the next chain module as one chain request.
+ *
+ * A frame is the frame name followed by each operation's client identifier,
+ * client sequence number, server sequence number and number of arguments,
+ * then its arguments. Operations keep the order they were executed in, so
+ * the last operation carries the highest server sequence number.
+ */
+class chain_batch {
+ public:
+  /* Frame name */
+  static const std::string NAME;
+
+  /**
+   * @brief Check if chain request is a batch frame
+   * @param args Chain request arguments
+   * @return Bool value, true if the chain request is a batch frame
+   */
+  static bool is_batch(const std::vector<std::string> &args);
+
+  /**
+   * @brief Start an empty batch frame
+   * @param frame Frame to reset
+   */
+  static void begin(std::vector<std::string> &frame);
+
+  /**
+   * @brief Append an operation to a batch frame
+   * @param frame Batch frame
+   * @param op Chain operation
+   */
+  static void append(std::vector<std::string> &frame, const chain_op &op);
+
+  /**
+   * @brief Unpack operations from a batch frame
+   * @param frame Batch frame
+   * @return Chain operations
+   */
+  static std::vector<chain_op> decode(const std::vector<std::string> &frame);
+
+  /**
+   * @brief Fetch the number of bytes an operation adds to a frame
+   * @param op Chain operation
+   * @return Number of bytes
+   */
+  static std::size_t size(const chain_op &op);
+};
+
+}
+}
+
+#endif //JIFFY_CHAIN_BATCH_H
@@ -14,10 +14,16 @@ chain_module::chain_module(block_memory_manager *manager,
                            const command_map &supported_cmds)
     : partition(manager, backing_path, name, metadata, supported_cmds),
       next_(std::make_unique<next_chain_module_cxn>("nil")),
-      prev_(std::make_unique<prev_chain_module_cxn>()),
-      pending_(0) {}
+      prev_(std::make_unique<prev_chain_module_cxn>()) {}
 
 chain_module::~chain_module() {
+  {
+    std::lock_guard<std::mutex> lock(pending_lock_);
+    stop_sender_ = true;
+  }
+  pending_cv_.notify_one();
+  if (batch_sender_.joinable())
+    batch_sender_.join();
   next_->reset("nil");
   if (response_processor_.joinable())
     response_processor_.join();
@@ -30,7 +36,18 @@ void chain_module::setup(const std::string &path,
   path_ = path;
   chain_ = chain;
   role_ = role;
-  auto protocol = next_->reset(next_block_id);
+  if (is_tail()) {
+    // Nothing downstream is left to acknowledge forwarded operations
+    std::lock_guard<std::mutex> lock(pending_lock_);
+    pending_.clear();
+    unsent_ = 0;
+    unsent_bytes_ = 0;
+  }
+  std::shared_ptr<apache::thrift::protocol::TProtocol> protocol;
+  {
+    std::lock_guard<std::mutex> lock(next_lock_);
+    protocol = next_->reset(next_block_id);
+  }
   if (protocol && role_ != chain_role::tail) {
     auto handler = std::make_shared<chain_response_handler>(this);
     auto processor = std::make_shared<block_response_serviceProcessor>(handler);
@@ -50,17 +67,97 @@ void chain_module::setup(const std::string &path,
   }
 }
 
+void chain_module::add_pending(const sequence_id &seq, const arg_list &args) {
+  {
+    std::lock_guard<std::mutex> lock(pending_lock_);
+    pending_.push_back(chain_op{seq, args});
+    ++unsent_;
+    unsent_bytes_ += chain_batch::size(pending_.back());
+    if (!batch_sender_.joinable()) {
+      batch_sender_ = std::thread(&chain_module::send_batches, this);
+    }
+  }
+  pending_cv_.notify_one();
+}
+
+void chain_module::forward(const arg_list &args) {
+  if (is_tail())
+    return;
+  sequence_id seq;
+  seq.client_id = -1;
+  seq.server_seq_no = ++chain_seq_no_;
+  add_pending(seq, args);
+}
+
+void chain_module::remove_pending(const sequence_id &seq) {
+  std::lock_guard<std::mutex> lock(pending_lock_);
+  // Only sent operations can have been acknowledged
+  while (pending_.size() > unsent_ && pending_.front().seq.server_seq_no <= seq.server_seq_no) {
+    pending_.pop_front();
+  }
+}
+
 void chain_module::resend_pending() {
-  auto ops = pending_.lock_table();
-  try {
-    for (const auto &op: ops) {
-      next_->request(op.second.seq, op.second.args);
+  {
+    std::lock_guard<std::mutex> lock(pending_lock_);
+    unsent_ = pending_.size();
+    unsent_bytes_ = 0;
+    for (const auto &op: pending_) {
+      unsent_bytes_ += chain_batch::size(op);
+    }
+    if (unsent_ == 0)
+      return;
+    if (!batch_sender_.joinable()) {
+      batch_sender_ = std::thread(&chain_module::send_batches, this);
     }
-  } catch (...) {
-    ops.unlock();
-    std::rethrow_exception(std::current_exception());
   }
-  ops.unlock();
+  pending_cv_.notify_one();
+}
+
+void chain_module::send_batches() {
+  std::vector<std::string> frame;
+  chain_op single;
+  std::unique_lock<std::mutex> lock(pending_lock_);
+  while (true) {
+    pending_cv_.wait(lock, [this] { return stop_sender_ || unsent_ > 0; });
+    if (!stop_sender_ && !batch_full()) {
+      // Group commit: let operations arriving within the window share the batch
+      pending_cv_.wait_for(lock, std::chrono::microseconds(CHAIN_BATCH_WINDOW_US),
+                           [this] { return stop_sender_ || batch_full(); });
+    }
+    if (stop_sender_)
+      break;
+
+    auto first = pending_.size() - unsent_;
+    std::size_t n = 0;
+    std::size_t bytes = 0;
+    while (n < unsent_ && n < CHAIN_BATCH_MAX_OPS && bytes < CHAIN_BATCH_MAX_BYTES) {
+      bytes += chain_batch::size(pending_[first + n]);
+      ++n;
+    }
+    // A lone operation is sent as is, sparing the frame
+    if (n == 1) {
+      single = pending_[first];
+    } else {
+      chain_batch::begin(frame);
+      for (std::size_t i = first; i < first + n; ++i) {
+        chain_batch::append(frame, pending_[i]);
+      }
+      single.seq = pending_[first + n - 1].seq;
+    }
+    unsent_ -= n;
+    unsent_bytes_ -= bytes;
+    lock.unlock();
+
+    try {
+      std::lock_guard<std::mutex> next_lock(next_lock_);
+      next_->request(single.seq, n == 1 ? single.args : frame);
+    } catch (std::exception &e) {
+      // Operations stay in the pending log, and are resent once the chain is repaired
+      LOG(log_level::warn) << "Failed to forward " << n << " operations: " << e.what();
+    }
+    lock.lock();
+  }
 }
 
 void chain_module::ack(const sequence_id &seq) {
@@ -79,47 +176,88 @@ void chain_module::request(sequence_id seq, const arg_list &args) {
     return;
   }
 
+  auto lock = serialize(!is_tail());
   std::vector<std::string> result;
-  run_command(result, args);
+  try {
+    execute(result, args);
+  } catch (std::exception &e) {
+    if (!is_tail())
+      throw;
+    // Requests are oneway, so the tail answers with an error rather than leave the client waiting
+    LOG(log_level::error) << "Error running " << args.front() << ": " << e.what();
+    result = {"!error", e.what()};
+  }
 
   auto cmd_name = args.front();
   if (is_tail()) {
     clients().respond_client(seq, result);
-    subscriptions().notify(cmd_name, args[1]); // TODO: Fix
+    // Clients also send reads to the tail as requests, which subscribers are not notified of
+    if (!is_accessor(cmd_name))
+      notify(args); // TODO: Fix
   } else {
     if (is_accessor(cmd_name)) {
       LOG(log_level::error) << "Invalid state: Accessor request on non-tail node";
       return;
     }
+    // Appended under the ordering lock, so that the log stays in sequence order
     seq.server_seq_no = ++chain_seq_no_;
-    next_->request(seq, args);
+    add_pending(seq, args);
   }
-  add_pending(seq, args);
 }
 
 void chain_module::chain_request(const sequence_id &seq, const arg_list &args) {
-  auto cmd_name = args.front();
   if (is_head()) {
-    LOG(log_level::error) << "Invalid state: Chain request " << cmd_name << " on head node";
+    LOG(log_level::error) << "Invalid state: Chain request " << args.front() << " on head node";
     return;
   }
+
+  if (chain_batch::is_batch(args)) {
+    auto ops = chain_batch::decode(args);
+    if (ops.empty())
+      return;
+    auto lock = serialize(!is_tail());
+    for (const auto &op: ops) {
+      chain_execute(op.seq, op.args);
+    }
+    if (is_tail()) {
+      // One cumulative acknowledgement covers the whole batch
+      ack(ops.back().seq);
+    }
+    return;
+  }
+
+  auto lock = serialize(!is_tail());
+  chain_execute(seq, args);
+  if (is_tail()) {
+    ack(seq);
+  }
+}
+
+void chain_module::chain_execute(const sequence_id &seq, const arg_list &args) {
+  auto cmd_name = args.front();
   if (is_accessor(cmd_name)) {
     LOG(log_level::error) << "Invalid state: Accessor " << cmd_name << " as chain request";
     return;
   }
 
   std::vector<std::string> result;
-  run_command(result, args);
+  try {
+    execute(result, args);
+  } catch (std::exception &e) {
+    if (!is_tail())
+      throw;
+    // The tail answers with an error and carries on, so that the rest of a batch still runs and is acknowledged
+    LOG(log_level::error) << "Error running " << cmd_name << ": " << e.what();
+    result = {"!error", e.what()};
+  }
 
   if (is_tail()) {
     clients().respond_client(seq, result);
-    subscriptions().notify(cmd_name, args[1]); // TODO: Fix
-    ack(seq);
+    notify(args); // TODO: Fix
   } else {
-    // Do not need a lock since this is the only thread handling chain requests
-    next_->request(seq, args);
+    add_pending(seq, args);
   }
 }
 
 }
-}
\ No newline at end of file
+}
@@ -2,16 +2,20 @@
 #define JIFFY_CHAIN_MODULE_H
 
 #include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <memory>
 #include <set>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
-#include <libcuckoo/cuckoohash_map.hh>
+#include <mutex>
 #include <shared_mutex>
 #include "jiffy/storage/client/block_client.h"
 #include "jiffy/storage/manager/detail/block_id_parser.h"
 #include "jiffy/storage/partition.h"
+#include "jiffy/storage/chain/chain_batch.h"
 #include "jiffy/storage/chain/chain_request_client.h"
 #include "jiffy/storage/chain/chain_response_client.h"
 #include "jiffy/storage/notification/subscription_map.h"
@@ -35,16 +39,14 @@ enum chain_role {
   tail = 3
 };
 
-/*
- * Chain operation
- */
+// Microseconds a chain module waits for more operations before forwarding a batch, its group commit window
+constexpr int64_t CHAIN_BATCH_WINDOW_US = 50;
 
-struct chain_op {
-  /* Command sequence identifier */
-  sequence_id seq;
-  /* Command arguments */
-  std::vector<std::string> args;
-};
+// Maximum number of operations forwarded to the next chain module in one batch
+constexpr std::size_t CHAIN_BATCH_MAX_OPS = 256;
+
+// Argument bytes past which a batch is forwarded without waiting for the window to close
+constexpr std::size_t CHAIN_BATCH_MAX_BYTES = 1 << 20;
 
 /* Connection to next chain module */
 class next_chain_module_cxn {
@@ -299,29 +301,33 @@ class chain_module : public partition {
    * @param args Command arguments
    */
   void run_command_on_next(response &result, const arg_list &args) {
+    std::lock_guard<std::mutex> lock(next_lock_);
     next_->run_command(result, args);
   }
 
   /**
-   * @brief Add request to pending
+   * @brief Append request to the pending log, to be forwarded to the next block with the next batch
    * @param seq Request sequence identifier
    * @param args Command arguments
    */
+  void add_pending(const sequence_id &seq, const arg_list &args);
 
-  void add_pending(const sequence_id &seq, const arg_list &args) {
-    pending_.insert(seq.server_seq_no, chain_op{seq, args});
-  }
+  /**
+   * @brief Forward a command the head runs on its own account, such as the remove of an evicted key.
+   * Called while the head runs a request, so that the command takes its place in sequence order
+   * ahead of the request; no client is answered at the tail.
+   * @param args Command arguments
+   */
+  void forward(const arg_list &args);
 
   /**
-   * @brief Remove a pending request
-   * @param seq Sequence identifier
+   * @brief Truncate the pending log up to an acknowledged request
+   * @param seq Sequence identifier of the highest acknowledged request
    */
-  void remove_pending(const sequence_id &seq) {
-    pending_.erase(seq.server_seq_no);
-  }
+  void remove_pending(const sequence_id &seq);
 
   /**
-   * @brief Resend the pending request
+   * @brief Resend the pending requests
    */
   void resend_pending();
 
@@ -345,14 +351,35 @@ class chain_module : public partition {
   void chain_request(const sequence_id &seq, const arg_list &args);
 
   /**
-   * @brief Acknowledge the previous block
-   * @param seq Sequence identifier
+   * @brief Acknowledge the previous block; acknowledgements are cumulative
+   * @param seq Sequence identifier of the highest request applied down the chain
    */
   void ack(const sequence_id &seq);
 
+  /**
+   * @brief Check if the partition supports running commands from several threads at once
+   * @return Bool value, true if run_command() is safe to call concurrently
+   */
+  virtual bool is_concurrent() const {
+    return false;
+  }
+
+  /**
+   * @brief Serialize a command with other commands on this partition if required.
+   * Commands on partitions that are not concurrent always run one at a time; commands that
+   * must keep their order along the chain are serialized even on concurrent partitions.
+   * @param ordered Bool value, true if the command must keep its order with other commands
+   * @return Lock held for the duration of the command, unlocked if none is required
+   */
+  std::unique_lock<std::mutex> serialize(bool ordered = false) {
+    if (ordered || !is_concurrent())
+      return std::unique_lock<std::mutex>(op_lock_);
+    return std::unique_lock<std::mutex>(op_lock_, std::defer_lock);
+  }
+
  protected:
   /* Role of chain module */
-  chain_role role_{singleton};
+  std::atomic<chain_role> role_{singleton};
   /* Chain sequence number */
   int64_t chain_seq_no_{0};
   /* Next partition connection */
@@ -363,8 +390,45 @@ class chain_module : public partition {
   std::vector<std::string> chain_;
   /* Response processor thread */
   std::thread response_processor_;
-  /* Pending operations */
-  cuckoohash_map<int64_t, chain_op> pending_;
+  /* Operations forwarded to the next module and not acknowledged yet, in sequence order */
+  std::deque<chain_op> pending_;
+  /* Number of operations at the back of the pending log not sent yet */
+  std::size_t unsent_{0};
+  /* Argument bytes of the operations not sent yet */
+  std::size_t unsent_bytes_{0};
+  /* Guards the pending log */
+  std::mutex pending_lock_;
+  /* Wakes the batch sender up */
+  std::condition_variable pending_cv_;
+  /* Bool value, true if the batch sender should exit */
+  bool stop_sender_{false};
+  /* Batch sender thread, started when the first operation is forwarded */
+  std::thread batch_sender_;
+  /* Serializes sends on, and reconnections of, the next partition connection */
+  std::mutex next_lock_;
+  /* Serializes commands on partitions that are not concurrent, and ordered commands on all partitions */
+  std::mutex op_lock_;
+
+ private:
+  /**
+   * @brief Execute a chain request, then respond at the tail or queue it for the next block otherwise
+   * @param seq Sequence identifier
+   * @param args Command arguments
+   */
+  void chain_execute(const sequence_id &seq, const arg_list &args);
+
+  /**
+   * @brief Check if the unsent operations fill a batch
+   * @return Bool value, true if a batch is full
+   */
+  bool batch_full() const {
+    return unsent_ >= CHAIN_BATCH_MAX_OPS || unsent_bytes_ >= CHAIN_BATCH_MAX_BYTES;
+  }
+
+  /**
+   * @brief Batch sender loop, forwarding unsent operations to the next block in batches
+   */
+  void send_batches();
 };
 
 }
@@ -0,0 +1,139 @@
+#ifndef JIFFY_ASYNC_RESULT_H
+#define JIFFY_ASYNC_RESULT_H
+
+#include <exception>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include "jiffy/storage/client/event_loop.h"
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define JIFFY_HAS_COROUTINES 1
+#endif
+#endif
+
+namespace jiffy {
+namespace storage {
+
+/**
+ * @brief Result of an asynchronous data structure client operation.
+ *
+ * Results complete as the calling thread's event loop dispatches responses:
+ * get() runs the loop until the result is ready, then returns its value or
+ * rethrows its error. Callbacks registered with then() run on the thread
+ * running the loop. Where the compiler supports C++20 coroutines, results can
+ * also be awaited with co_await, resuming the coroutine from the loop.
+ * Copies share the same result.
+ */
+template<typename T>
+class async_result {
+ public:
+  typedef std::function<void(async_result<T>)> callback;
+
+  /**
+   * @brief Constructor
+   */
+  async_result() : state_(std::make_shared<state>()) {}
+
+  /**
+   * @brief Check if result is ready
+   * @return Bool value, true if a value or an error is set
+   */
+  bool ready() const {
+    return state_->ready;
+  }
+
+  /**
+   * @brief Run the event loop until the result is ready, then fetch it
+   * @return Value, or rethrows the error the operation failed with
+   */
+  T get() {
+    auto &loop = event_loop::instance();
+    while (!state_->ready) {
+      if (loop.pending() == 0) {
+        throw std::logic_error("Result cannot complete: nothing pending on this thread's event loop");
+      }
+      loop.poll();
+    }
+    if (state_->error)
+      std::rethrow_exception(state_->error);
+    return state_->value;
+  }
+
+  /**
+   * @brief Register callback to run once the result is ready, right away if it is already
+   * @param cb Callback, given the result
+   */
+  void then(callback cb) {
+    if (state_->ready) {
+      cb(*this);
+    } else {
+      state_->cb = std::move(cb);
+    }
+  }
+
+  /**
+   * @brief Set value, making the result ready
+   * @param value Value
+   */
+  void set_value(T value) {
+    state_->value = std::move(value);
+    complete();
+  }
+
+  /**
+   * @brief Set error, making the result ready
+   * @param error Error
+   */
+  void set_exception(std::exception_ptr error) {
+    state_->error = std::move(error);
+    complete();
+  }
+
+#ifdef JIFFY_HAS_COROUTINES
+  bool await_ready() const {
+    return ready();
+  }
+
+  void await_suspend(std::coroutine_handle<> handle) {
+    then([handle](async_result<T>) { handle.resume(); });
+  }
+
+  T await_resume() {
+    return get();
+  }
+#endif
+
+ private:
+  /* Shared result state */
+  struct state {
+    /* Bool value, true if ready */
+    bool ready{false};
+    /* Value */
+    T value{};
+    /* Error */
+    std::exception_ptr error;
+    /* Callback to run once ready */
+    callback cb;
+  };
+
+  void complete() {
+    state_->ready = true;
+    if (state_->cb) {
+      auto cb = std::move(state_->cb);
+      state_->cb = nullptr;
+      cb(*this);
+    }
+  }
+
+  /* Result state */
+  std::shared_ptr<state> state_;
+};
+
+}
+}
+
+#endif //JIFFY_ASYNC_RESULT_H
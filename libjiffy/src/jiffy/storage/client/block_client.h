@@ -1,14 +1,12 @@
 #ifndef JIFFY_BLOCK_CLIENT_H
 #define JIFFY_BLOCK_CLIENT_H
 
-#include <thrift/transport/TSocket.h>
-#include "jiffy/storage/service/block_request_service.h"
-#include "jiffy/storage/service/block_response_service.h"
-#include "jiffy/utils/client_cache.h"
+#include "jiffy/storage/client/block_connection.h"
 
 namespace jiffy {
 namespace storage {
-/* Block client class */
+/* Block client class
+ * A handle on a block, over a connection shared with other block clients */
 class block_client {
  public:
   /* Command response reader class */
@@ -18,10 +16,11 @@ class block_client {
 
     /**
      * @brief Constructor
-     * @param prot Protocol
+     * @param stream Response stream
+     * @param timeout_ms Time out
      */
 
-    explicit command_response_reader(std::shared_ptr<apache::thrift::protocol::TProtocol> prot);
+    command_response_reader(std::shared_ptr<response_stream> stream, int timeout_ms);
 
     /**
      * @brief Receive response
@@ -31,16 +30,20 @@ class block_client {
 
     int64_t recv_response(std::vector<std::string> &out);
 
+    /**
+     * @brief Fetch client identifier the responses are addressed to
+     * @return Client identifier
+     */
+
+    int64_t client_id() const;
+
    private:
-    /* Thrift protocol */
-    std::shared_ptr<apache::thrift::protocol::TProtocol> prot_;
-    /* Thrift protocol */
-    apache::thrift::protocol::TProtocol *iprot_{};
+    /* Response stream */
+    std::shared_ptr<response_stream> stream_;
+    /* Time out */
+    int timeout_ms_{0};
   };
 
-  typedef block_request_serviceClient thrift_client;
-  typedef utils::client_cache<thrift_client> client_cache;
-
   block_client() = default;
 
   /**
@@ -49,13 +52,6 @@ class block_client {
 
   ~block_client();
 
-  /**
-   * @brief Fetch client identifier
-   * @return Client identifier
-   */
-
-  int64_t get_client_id();
-
   /**
    * @brief Connect block server
    * @param hostname Block server hostname
@@ -80,12 +76,19 @@ class block_client {
   bool is_connected() const;
 
   /**
-   * @brief Register client identifier with block identifier and return command response reader
-   * @param client_id Client identifier
+   * @brief Fetch file descriptor to wait for responses on
+   * @return File descriptor, or -1 if not connected or registered
+   */
+
+  int response_fd() const;
+
+  /**
+   * @brief Register with the block and return command response reader
+   * The server assigns the client identifier, which the reader carries
    * @return Command response reader
    */
 
-  command_response_reader get_command_response_reader(int64_t client_id);
+  command_response_reader get_command_response_reader();
 
   /**
    * @brief Request command
@@ -95,28 +98,15 @@ class block_client {
 
   void command_request(const sequence_id &seq, const std::vector<std::string> &args);
 
-  /**
-   * @brief Send run command
-   * @param block_id Block identifier
-   * @param arguments Command arguments
-   */
-  void send_run_command(const int32_t block_id, const std::vector<std::string> &arguments);
-
-  /**
-   * @brief Receive response from run command
-   * @param _return Response
-   */
-  void recv_run_command(std::vector<std::string> &_return);
-
  private:
-  /* Transport */
-  std::shared_ptr<apache::thrift::transport::TTransport> transport_{};
-  /* Protocol */
-  std::shared_ptr<apache::thrift::protocol::TProtocol> protocol_{};
-  /* Block request client */
-  std::shared_ptr<thrift_client> client_{};
+  /* Shared connection */
+  std::shared_ptr<block_connection> connection_{};
+  /* Response stream, once registered */
+  std::shared_ptr<response_stream> stream_{};
   /* Block identifier */
   int block_id_{-1};
+  /* Time out */
+  int timeout_ms_{0};
 };
 
 }
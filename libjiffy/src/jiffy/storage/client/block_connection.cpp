@@ -0,0 +1,246 @@
+#include "block_connection.h"
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <system_error>
+#include <thrift/protocol/TBinaryProtocol.h>
+#include <thrift/transport/TBufferTransports.h>
+#include "jiffy/storage/client_registration.h"
+#include "jiffy/storage/service/block_response_service.h"
+#include "jiffy/utils/logger.h"
+
+namespace jiffy {
+namespace storage {
+
+using namespace ::apache::thrift;
+using namespace ::apache::thrift::protocol;
+using namespace ::apache::thrift::transport;
+using namespace utils;
+
+response_stream::response_stream(int64_t client_id) : client_id_(client_id) {}
+
+response_stream::~response_stream() {
+  if (pipe_[0] >= 0) {
+    ::close(pipe_[0]);
+    ::close(pipe_[1]);
+  }
+}
+
+int64_t response_stream::client_id() const {
+  return client_id_;
+}
+
+void response_stream::push(int64_t client_seq_no, std::vector<std::string> result) {
+  {
+    std::unique_lock<std::mutex> lock(mtx_);
+    responses_.emplace_back(client_seq_no, std::move(result));
+    signal();
+  }
+  cv_.notify_all();
+}
+
+void response_stream::fail(const std::string &message) {
+  {
+    std::unique_lock<std::mutex> lock(mtx_);
+    if (!error_.empty()) {
+      return;
+    }
+    error_ = message.empty() ? "Connection closed" : message;
+    signal();
+  }
+  cv_.notify_all();
+}
+
+int64_t response_stream::pop(std::vector<std::string> &out, int timeout_ms) {
+  std::unique_lock<std::mutex> lock(mtx_);
+  auto ready = [this] { return !responses_.empty() || !error_.empty(); };
+  if (timeout_ms > 0) {
+    if (!cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready)) {
+      throw TTransportException(TTransportException::TIMED_OUT, "Timed out waiting for response");
+    }
+  } else {
+    cv_.wait(lock, ready);
+  }
+  if (responses_.empty()) {
+    throw TTransportException(TTransportException::NOT_OPEN, error_);
+  }
+  auto client_seq_no = responses_.front().first;
+  out = std::move(responses_.front().second);
+  responses_.pop_front();
+  if (pipe_[0] >= 0) {
+    char c;
+    if (::read(pipe_[0], &c, 1) < 0) {
+      // Signals were dropped while the pipe was full; it stays readable until drained
+    }
+  }
+  return client_seq_no;
+}
+
+int response_stream::fd() {
+  std::unique_lock<std::mutex> lock(mtx_);
+  if (pipe_[0] < 0) {
+    if (::pipe(pipe_) != 0) {
+      throw std::system_error(errno, std::generic_category(), "pipe");
+    }
+    ::fcntl(pipe_[0], F_SETFL, O_NONBLOCK);
+    ::fcntl(pipe_[1], F_SETFL, O_NONBLOCK);
+    for (std::size_t i = 0; i < responses_.size(); ++i) {
+      signal();
+    }
+    if (!error_.empty()) {
+      signal();
+    }
+  }
+  return pipe_[0];
+}
+
+void response_stream::signal() {
+  if (pipe_[1] >= 0) {
+    char c = 0;
+    if (::write(pipe_[1], &c, 1) < 0) {
+      // Pipe full, already readable
+    }
+  }
+}
+
+block_connection::block_connection(const std::string &host, int port) {
+  socket_ = std::make_shared<TSocket>(host, port);
+  transport_ = std::shared_ptr<TTransport>(new TFramedTransport(socket_));
+  in_protocol_ = std::shared_ptr<TProtocol>(new TBinaryProtocol(std::make_shared<TFramedTransport>(socket_)));
+  client_ = std::make_shared<thrift_client>(std::shared_ptr<TProtocol>(new TBinaryProtocol(transport_)));
+  transport_->open();
+  open_ = true;
+  receiver_ = std::thread([this] { receive(); });
+}
+
+block_connection::~block_connection() {
+  open_ = false;
+  // Shutting the socket down wakes up the receiver
+  ::shutdown(static_cast<int>(socket_->getSocketFD()), SHUT_RDWR);
+  if (receiver_.joinable()) {
+    receiver_.join();
+  }
+  transport_->close();
+}
+
+std::shared_ptr<response_stream> block_connection::open_stream(int32_t block_id, int timeout_ms) {
+  std::shared_ptr<response_stream> stream;
+  {
+    std::unique_lock<std::mutex> lock(mtx_);
+    if (!open_) {
+      throw TTransportException(TTransportException::NOT_OPEN, "Connection closed");
+    }
+    stream = std::make_shared<response_stream>(next_registration_--);
+    streams_.emplace(stream->client_id_, stream);
+  }
+  sequence_id seq;
+  seq.client_id = stream->client_id_;
+  seq.client_seq_no = -1;
+  seq.server_seq_no = -1;
+  std::vector<std::string> ret;
+  try {
+    command_request(seq, block_id, {client_registration::REGISTER});
+    stream->pop(ret, timeout_ms);
+  } catch (...) {
+    std::unique_lock<std::mutex> lock(mtx_);
+    streams_.erase(seq.client_id);
+    throw;
+  }
+
+  std::unique_lock<std::mutex> lock(mtx_);
+  streams_.erase(seq.client_id);
+  if (ret.size() != 2 || ret.front() != "!ok") {
+    throw std::logic_error("Could not register client: " + (ret.empty() ? std::string() : ret.front()));
+  }
+  stream->client_id_ = std::stoll(ret.back());
+  streams_.emplace(stream->client_id_, stream);
+  if (!open_) {
+    stream->fail("Connection closed");
+  }
+  return stream;
+}
+
+void block_connection::close_stream(int32_t block_id, const std::shared_ptr<response_stream> &stream) {
+  {
+    std::unique_lock<std::mutex> lock(mtx_);
+    streams_.erase(stream->client_id());
+  }
+  if (!open_) {
+    return;
+  }
+  sequence_id seq;
+  seq.client_id = stream->client_id();
+  seq.client_seq_no = -1;
+  seq.server_seq_no = -1;
+  try {
+    command_request(seq, block_id, {client_registration::UNREGISTER});
+  } catch (TException &e) {
+    LOG(log_level::info) << "Could not unregister client " << seq.client_id << ": " << e.what();
+  }
+}
+
+void block_connection::command_request(const sequence_id &seq,
+                                       int32_t block_id,
+                                       const std::vector<std::string> &args) {
+  std::unique_lock<std::mutex> lock(send_mtx_);
+  client_->command_request(seq, block_id, args);
+}
+
+bool block_connection::is_open() const {
+  return open_;
+}
+
+std::size_t block_connection::streams() const {
+  std::unique_lock<std::mutex> lock(mtx_);
+  return streams_.size();
+}
+
+void block_connection::receive() {
+  auto iprot = in_protocol_.get();
+  std::string error;
+  try {
+    while (true) {
+      int32_t rseqid = 0;
+      std::string fname;
+      TMessageType mtype;
+      iprot->readMessageBegin(fname, mtype, rseqid);
+      if (mtype == T_EXCEPTION || fname != "response") {
+        iprot->skip(T_STRUCT);
+        iprot->readMessageEnd();
+        iprot->getTransport()->readEnd();
+        continue;
+      }
+      block_response_service_response_args args;
+      args.read(iprot);
+      iprot->readMessageEnd();
+      iprot->getTransport()->readEnd();
+
+      std::shared_ptr<response_stream> stream;
+      {
+        std::unique_lock<std::mutex> lock(mtx_);
+        auto it = streams_.find(args.seq.client_id);
+        if (it != streams_.end()) {
+          stream = it->second;
+        }
+      }
+      if (stream != nullptr) {
+        stream->push(args.seq.client_seq_no, std::move(args.result));
+      }
+    }
+  } catch (TException &e) {
+    error = e.what();
+  }
+  if (open_) {
+    LOG(log_level::info) << "Connection to " << socket_->getHost() << ":" << socket_->getPort()
+                         << " closed: " << error;
+  }
+  std::unique_lock<std::mutex> lock(mtx_);
+  open_ = false;
+  for (auto &s: streams_) {
+    s.second->fail(error);
+  }
+}
+
+}
+}
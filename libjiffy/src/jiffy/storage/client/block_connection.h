@@ -0,0 +1,183 @@
+#ifndef JIFFY_BLOCK_CONNECTION_H
+#define JIFFY_BLOCK_CONNECTION_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <thrift/transport/TSocket.h>
+#include "jiffy/storage/service/block_request_service.h"
+
+namespace jiffy {
+namespace storage {
+
+/**
+ * @brief Responses addressed to one client on a shared connection.
+ *
+ * Responses are queued by the connection's receiver and taken by the client.
+ * For clients that wait on many streams with poll, a stream also offers a
+ * descriptor that is readable while responses are queued; the pipe behind it
+ * is only created when the descriptor is first asked for.
+ */
+class response_stream {
+ public:
+  /**
+   * @brief Constructor
+   * @param client_id Client identifier the responses are addressed to
+   */
+  explicit response_stream(int64_t client_id);
+
+  /**
+   * @brief Destructor
+   */
+  ~response_stream();
+
+  /**
+   * @brief Fetch client identifier
+   * @return Client identifier
+   */
+  int64_t client_id() const;
+
+  /**
+   * @brief Queue response
+   * @param client_seq_no Client sequence number
+   * @param result Response
+   */
+  void push(int64_t client_seq_no, std::vector<std::string> result);
+
+  /**
+   * @brief Fail stream, waking up readers
+   * @param message Error message
+   */
+  void fail(const std::string &message);
+
+  /**
+   * @brief Take response, waiting for one if none is queued
+   * @param out Response
+   * @param timeout_ms Time out, no time out if not positive
+   * @return Client sequence number
+   */
+  int64_t pop(std::vector<std::string> &out, int timeout_ms);
+
+  /**
+   * @brief Fetch descriptor readable while responses are queued, or the stream failed
+   * @return File descriptor
+   */
+  int fd();
+
+ private:
+  friend class block_connection;
+
+  /**
+   * @brief Signal the descriptor once
+   */
+  void signal();
+
+  /* Client identifier, rewritten once the server assigns one */
+  int64_t client_id_;
+  /* Mutex */
+  std::mutex mtx_;
+  /* Condition variable */
+  std::condition_variable cv_;
+  /* Queued responses and their client sequence numbers */
+  std::deque<std::pair<int64_t, std::vector<std::string>>> responses_;
+  /* Error message, non-empty once the stream failed */
+  std::string error_;
+  /* Pipe backing the descriptor, -1 until asked for */
+  int pipe_[2]{-1, -1};
+};
+
+/**
+ * @brief Connection to a storage server, shared by the block clients of a process.
+ *
+ * Requests for any block go out on the connection tagged with their block
+ * identifier and sequence identifier. A receiver thread reads responses and
+ * hands each to the response stream of the client identifier it is addressed
+ * to; the server assigns client identifiers when clients register, so they
+ * are unique among the streams of a connection.
+ */
+class block_connection {
+ public:
+  typedef block_request_serviceClient thrift_client;
+
+  /**
+   * @brief Constructor, opens the connection and starts the receiver
+   * @param host Storage server hostname
+   * @param port Port number
+   */
+  block_connection(const std::string &host, int port);
+
+  /**
+   * @brief Destructor, closes the connection and stops the receiver
+   */
+  ~block_connection();
+
+  /**
+   * @brief Register a client with the block and open its response stream
+   * @param block_id Block identifier
+   * @param timeout_ms Time out waiting for the server to answer
+   * @return Response stream, carrying the client identifier the server assigned
+   */
+  std::shared_ptr<response_stream> open_stream(int32_t block_id, int timeout_ms);
+
+  /**
+   * @brief Remove the registration of a client and close its response stream
+   * @param block_id Block identifier
+   * @param stream Response stream
+   */
+  void close_stream(int32_t block_id, const std::shared_ptr<response_stream> &stream);
+
+  /**
+   * @brief Request command
+   * @param seq Sequence identifier
+   * @param block_id Block identifier
+   * @param args Command arguments
+   */
+  void command_request(const sequence_id &seq, int32_t block_id, const std::vector<std::string> &args);
+
+  /**
+   * @brief Check if connection is opened
+   * @return Bool value, true if connection is opened
+   */
+  bool is_open() const;
+
+  /**
+   * @brief Fetch number of open response streams
+   * @return Number of open response streams
+   */
+  std::size_t streams() const;
+
+ private:
+  /**
+   * @brief Read responses and dispatch them to their streams until the connection closes
+   */
+  void receive();
+
+  /* Socket */
+  std::shared_ptr<apache::thrift::transport::TSocket> socket_{};
+  /* Transport requests are written to */
+  std::shared_ptr<apache::thrift::transport::TTransport> transport_{};
+  /* Protocol responses are read with, on a transport of its own */
+  std::shared_ptr<apache::thrift::protocol::TProtocol> in_protocol_{};
+  /* Block request client */
+  std::shared_ptr<thrift_client> client_{};
+  /* Lock serializing requests */
+  std::mutex send_mtx_;
+  /* Lock protecting the streams */
+  mutable std::mutex mtx_;
+  /* Response streams by client identifier */
+  std::unordered_map<int64_t, std::shared_ptr<response_stream>> streams_;
+  /* Identifier of the next registration, negative so as not to clash with client identifiers */
+  int64_t next_registration_{-1};
+  /* Bool value, true while the connection is open */
+  std::atomic<bool> open_{false};
+  /* Receiver thread */
+  std::thread receiver_;
+};
+
+}
+}
+
+#endif //JIFFY_BLOCK_CONNECTION_H
@@ -0,0 +1,52 @@
+#include "block_connection_pool.h"
+#include <algorithm>
+
+namespace jiffy {
+namespace storage {
+
+block_connection_pool &block_connection_pool::instance() {
+  static block_connection_pool pool;
+  return pool;
+}
+
+block_connection_pool::block_connection_pool(std::size_t connections_per_server)
+    : connections_per_server_(std::max<std::size_t>(connections_per_server, 1)) {}
+
+std::shared_ptr<block_connection> block_connection_pool::connect(const std::string &host, int port) {
+  std::unique_lock<std::mutex> lock(mtx_);
+  auto &conns = connections_[server_key(host, port)];
+  prune(conns);
+  if (conns.size() < connections_per_server_) {
+    auto conn = std::make_shared<block_connection>(host, port);
+    conns.push_back(conn);
+    return conn;
+  }
+  std::shared_ptr<block_connection> least_used;
+  for (const auto &c: conns) {
+    auto conn = c.lock();
+    if (conn != nullptr && (least_used == nullptr || conn.use_count() < least_used.use_count())) {
+      least_used = conn;
+    }
+  }
+  return least_used;
+}
+
+std::size_t block_connection_pool::connections(const std::string &host, int port) {
+  std::unique_lock<std::mutex> lock(mtx_);
+  auto it = connections_.find(server_key(host, port));
+  if (it == connections_.end()) {
+    return 0;
+  }
+  prune(it->second);
+  return it->second.size();
+}
+
+void block_connection_pool::prune(std::vector<std::weak_ptr<block_connection>> &conns) {
+  conns.erase(std::remove_if(conns.begin(), conns.end(), [](const std::weak_ptr<block_connection> &c) {
+    auto conn = c.lock();
+    return conn == nullptr || !conn->is_open();
+  }), conns.end());
+}
+
+}
+}
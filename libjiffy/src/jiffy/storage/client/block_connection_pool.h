@@ -0,0 +1,77 @@
+#ifndef JIFFY_BLOCK_CONNECTION_POOL_H
+#define JIFFY_BLOCK_CONNECTION_POOL_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "jiffy/storage/client/block_connection.h"
+
+namespace jiffy {
+namespace storage {
+
+// Maximum number of connections to each storage server
+constexpr std::size_t BLOCK_CONNECTIONS_PER_SERVER = 4;
+
+/**
+ * @brief Pool of connections to storage servers, one per process.
+ *
+ * Block clients of any chain or data structure share the pool's connections
+ * to each storage server: a new connection is opened until the server has
+ * the maximum number of them, after which the connection serving the fewest
+ * clients is handed out. The pool does not keep connections alive; a
+ * connection closes when the last block client using it disconnects, and
+ * connections found closed are replaced.
+ */
+class block_connection_pool {
+ public:
+  /**
+   * @brief Fetch the pool of the process
+   * @return Connection pool
+   */
+  static block_connection_pool &instance();
+
+  /**
+   * @brief Constructor
+   * @param connections_per_server Maximum number of connections to each storage server
+   */
+  explicit block_connection_pool(std::size_t connections_per_server = BLOCK_CONNECTIONS_PER_SERVER);
+
+  /**
+   * @brief Fetch a connection to a storage server
+   * @param host Storage server hostname
+   * @param port Port number
+   * @return Connection
+   */
+  std::shared_ptr<block_connection> connect(const std::string &host, int port);
+
+  /**
+   * @brief Fetch number of open connections to a storage server
+   * @param host Storage server hostname
+   * @param port Port number
+   * @return Number of open connections
+   */
+  std::size_t connections(const std::string &host, int port);
+
+ private:
+  typedef std::pair<std::string, int> server_key;
+
+  /**
+   * @brief Drop the connections to a storage server that are no longer used or open
+   * @param conns Connections to the storage server
+   */
+  static void prune(std::vector<std::weak_ptr<block_connection>> &conns);
+
+  /* Maximum number of connections to each storage server */
+  std::size_t connections_per_server_;
+  /* Mutex */
+  std::mutex mtx_;
+  /* Connections by storage server */
+  std::map<server_key, std::vector<std::weak_ptr<block_connection>>> connections_;
+};
+
+}
+}
+
+#endif //JIFFY_BLOCK_CONNECTION_POOL_H
@@ -1,7 +1,10 @@
 #ifndef JIFFY_DATA_STRUCTURE_CLIENT_H
 #define JIFFY_DATA_STRUCTURE_CLIENT_H
 
+#include <functional>
 #include "jiffy/directory/client/directory_client.h"
+#include "jiffy/storage/client/async_result.h"
+#include "jiffy/storage/client/event_loop.h"
 #include "jiffy/storage/client/replica_chain_client.h"
 #include "jiffy/utils/client_cache.h"
 
@@ -56,6 +59,101 @@ class data_structure_client {
 
   virtual void handle_redirect(std::vector<std::string> &_return, const std::vector<std::string> &args) = 0;
 
+  /**
+   * @brief Send command without waiting for its response, running the event loop while the window is full
+   * @param block Replica chain client
+   * @param args Command arguments
+   * @return Client sequence number of the request
+   */
+  static int64_t send_async(const std::shared_ptr<replica_chain_client> &block, const std::vector<std::string> &args) {
+    while (block->in_flight() >= block->max_in_flight() && event_loop::instance().pending() > 0) {
+      event_loop::instance().poll();
+    }
+    return block->send_command(args);
+  }
+
+  /**
+   * @brief Run command asynchronously.
+   * The response goes through handle_redirect like that of a synchronous command; a command
+   * that must be redone, or could not be sent, is redone synchronously on the thread running
+   * the event loop. The client must outlive the result.
+   * @param block Replica chain client
+   * @param args Command arguments
+   * @param redo Function running the command synchronously
+   * @param finish Function turning the response into the result value
+   * @return Result
+   */
+  template<typename T>
+  async_result<T> run_async(const std::shared_ptr<replica_chain_client> &block,
+                            const std::vector<std::string> &args,
+                            std::function<std::vector<std::string>()> redo,
+                            std::function<T(std::vector<std::string> &)> finish) {
+    async_result<T> result;
+    auto complete = [this, args, redo, finish, result](std::vector<std::string> &_return, bool sent) mutable {
+      try {
+        if (sent) {
+          try {
+            handle_redirect(_return, args);
+          } catch (redo_error &e) {
+            _return = redo();
+          }
+        } else {
+          _return = redo();
+        }
+        result.set_value(finish(_return));
+      } catch (...) {
+        result.set_exception(std::current_exception());
+      }
+    };
+    int64_t seq_no;
+    try {
+      seq_no = send_async(block, args);
+    } catch (std::exception &e) {
+      std::vector<std::string> _return;
+      complete(_return, false);
+      return result;
+    }
+    event_loop::instance().submit(block, seq_no, [complete](std::vector<std::string> &_return) mutable {
+      complete(_return, true);
+    });
+    return result;
+  }
+
+  /**
+   * @brief Collect responses of requests sent to several partitions as one result
+   * @param sent Replica chain clients and client sequence numbers of the requests
+   * @param finish Function turning the responses, in request order, into the result value
+   * @return Result
+   */
+  template<typename T>
+  static async_result<T> gather_async(const std::vector<std::pair<std::shared_ptr<replica_chain_client>, int64_t>> &sent,
+                                      std::function<T(std::vector<std::vector<std::string>> &)> finish) {
+    async_result<T> result;
+    auto responses = std::make_shared<std::vector<std::vector<std::string>>>(sent.size());
+    auto remaining = std::make_shared<std::size_t>(sent.size());
+    auto complete = [responses, finish, result]() mutable {
+      try {
+        result.set_value(finish(*responses));
+      } catch (...) {
+        result.set_exception(std::current_exception());
+      }
+    };
+    if (sent.empty()) {
+      complete();
+      return result;
+    }
+    for (std::size_t i = 0; i < sent.size(); ++i) {
+      event_loop::instance().submit(sent[i].first, sent[i].second,
+                                    [i, responses, remaining, complete](std::vector<std::string> &_return) mutable {
+                                      (*responses)[i] = std::move(_return);
+                                      if (--*remaining == 0) {
+                                        complete();
+                                      }
+                                    });
+    }
+    return result;
+  }
+
   /* Directory client */
   std::shared_ptr<directory::directory_interface> fs_;
   /* Key value partition path */
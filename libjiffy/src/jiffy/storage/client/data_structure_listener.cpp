@@ -1,4 +1,5 @@
 #include <thrift/transport/TTransportException.h>
+#include <algorithm>
 #include "jiffy/storage/client/data_structure_listener.h"
 #include "jiffy/storage/manager/detail/block_id_parser.h"
 #include "jiffy/utils/logger.h"
@@ -10,14 +11,13 @@ namespace jiffy {
 namespace storage {
 
 data_structure_listener::data_structure_listener(const std::string &path, const directory::data_status &status)
-    : path_(path), status_(status), worker_(notifications_, controls_) {
+    : path_(path), status_(status) {
   for (const auto &block: status_.data_blocks()) {
-    auto t = block_id_parser::parse(block.block_ids.back());
-    block_ids_.push_back(t.id);
-    listeners_.push_back(std::make_shared<block_listener>(t.host, t.service_port, controls_));
-    worker_.add_protocol(listeners_.back()->protocol());
+    listen(block);
+  }
+  for (auto &worker: workers_) {
+    worker->start();
   }
-  worker_.start();
 }
 
 data_structure_listener::~data_structure_listener() {
@@ -25,7 +25,9 @@ data_structure_listener::~data_structure_listener() {
     for (auto &listener: listeners_) {
       listener->disconnect();
     }
-    worker_.stop();
+    for (auto &worker: workers_) {
+      worker->stop();
+    }
   } catch (TTransportException &e) {
     LOG(log_level::info) << "Could not destruct: " << e.what();
   }
@@ -35,12 +37,16 @@ void data_structure_listener::subscribe(const std::vector<std::string> &ops) {
   for (size_t i = 0; i < listeners_.size(); i++) {
     listeners_[i]->subscribe(block_ids_[i], ops);
   }
+  ops_.insert(ops.begin(), ops.end());
 }
 
 void data_structure_listener::unsubscribe(const std::vector<std::string> &ops) {
   for (size_t i = 0; i < listeners_.size(); i++) {
     listeners_[i]->unsubscribe(block_ids_[i], ops);
   }
+  for (const auto &op: ops) {
+    ops_.erase(op);
+  }
 }
 
 data_structure_listener::notification_t data_structure_listener::get_notification(int64_t timeout_ms) {
@@ -51,5 +57,47 @@ data_structure_listener::notification_t data_structure_listener::get_notificatio
   return notification;
 }
 
+bool data_structure_listener::try_get_notification(notification_t &notification) {
+  return notifications_.try_pop(notification);
+}
+
+void data_structure_listener::add_block(const directory::replica_chain &block) {
+  if (std::find(block_names_.begin(), block_names_.end(), block.tail()) != block_names_.end()) {
+    return;
+  }
+  listen(block);
+  workers_.back()->start();
+  if (!ops_.empty()) {
+    listeners_.back()->subscribe(block_ids_.back(), std::vector<std::string>(ops_.begin(), ops_.end()));
+  }
+}
+
+void data_structure_listener::remove_block(const directory::replica_chain &block) {
+  auto it = std::find(block_names_.begin(), block_names_.end(), block.tail());
+  if (it == block_names_.end()) {
+    return;
+  }
+  auto i = static_cast<std::size_t>(it - block_names_.begin());
+  try {
+    listeners_[i]->disconnect();
+    workers_[i]->stop();
+  } catch (TTransportException &e) {
+    LOG(log_level::info) << "Could not stop listening to " << block_names_[i] << ": " << e.what();
+  }
+  listeners_.erase(listeners_.begin() + i);
+  workers_.erase(workers_.begin() + i);
+  block_ids_.erase(block_ids_.begin() + i);
+  block_names_.erase(block_names_.begin() + i);
+}
+
+void data_structure_listener::listen(const directory::replica_chain &block) {
+  auto t = block_id_parser::parse(block.tail());
+  block_ids_.push_back(t.id);
+  block_names_.push_back(block.tail());
+  listeners_.push_back(std::make_shared<block_listener>(t.host, t.service_port, controls_));
+  workers_.push_back(std::unique_ptr<notification_worker>(new notification_worker(notifications_, controls_)));
+  workers_.back()->add_protocol(listeners_.back()->protocol());
+}
+
 }
 }
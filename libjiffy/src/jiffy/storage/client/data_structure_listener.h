@@ -1,6 +1,8 @@
 #ifndef JIFFY_KV_LISTENER_H
 #define JIFFY_KV_LISTENER_H
 
+#include <memory>
+#include <set>
 #include "jiffy/directory/directory_ops.h"
 #include "block_listener.h"
 #include "jiffy/storage/notification/notification_worker.h"
@@ -51,7 +53,35 @@ class data_structure_listener {
 
   notification_t get_notification(int64_t timeout_ms = -1);
 
+  /**
+   * @brief Get notification if there is one, without waiting
+   * @param notification Notification pair, if any
+   * @return Bool value, true if a notification was received
+   */
+
+  bool try_get_notification(notification_t &notification);
+
+  /**
+   * @brief Listen to one more block, subscribing it to the operations subscribed so far
+   * @param block Replica chain of the block, listened to at its tail
+   */
+
+  void add_block(const directory::replica_chain &block);
+
+  /**
+   * @brief Stop listening to a block
+   * @param block Replica chain of the block
+   */
+
+  void remove_block(const directory::replica_chain &block);
+
  private:
+  /**
+   * @brief Connect to the tail of a block and start a notification worker for it
+   * @param block Replica chain of the block
+   */
+
+  void listen(const directory::replica_chain &block);
 
   /* Notification mailbox
    * The notification mailbox is like a notification
@@ -71,12 +101,16 @@ class data_structure_listener {
   std::string path_;
   /* Data status */
   directory::data_status status_;
-  /* Notification worker */
-  notification_worker worker_;
+  /* Notification workers, one per block so that no block waits on another */
+  std::vector<std::unique_ptr<notification_worker>> workers_;
   /* Block listeners */
   std::vector<std::shared_ptr<block_listener>> listeners_;
   /* Block identifiers */
   std::vector<int32_t> block_ids_;
+  /* Tail block names, to find the block of a chain */
+  std::vector<std::string> block_names_;
+  /* Operations subscribed */
+  std::set<std::string> ops_;
 };
 
 }
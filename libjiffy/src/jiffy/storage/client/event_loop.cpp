@@ -0,0 +1,133 @@
+#include "event_loop.h"
+#include <poll.h>
+#include <algorithm>
+#include <cerrno>
+#include <system_error>
+#include "jiffy/storage/client/replica_chain_client.h"
+#include "jiffy/utils/logger.h"
+
+namespace jiffy {
+namespace storage {
+
+using namespace utils;
+
+event_loop &event_loop::instance() {
+  static thread_local event_loop loop;
+  return loop;
+}
+
+void event_loop::submit(const std::shared_ptr<replica_chain_client> &client,
+                        int64_t seq_no,
+                        response_handler handler) {
+  completion c{client, seq_no, std::move(handler), time_point(), client->timeout_ms() > 0, false};
+  if (c.timed) {
+    c.deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(client->timeout_ms());
+  }
+  completions_.push_back(std::move(c));
+}
+
+std::size_t event_loop::poll(int timeout_ms) {
+  auto n = dispatch();
+  if (n > 0 || completions_.empty()) {
+    return n;
+  }
+
+  // Wait on every client with requests pending, at most until the earliest deadline
+  std::vector<pollfd> fds;
+  std::vector<replica_chain_client *> clients;
+  auto now = std::chrono::steady_clock::now();
+  auto wait_ms = timeout_ms;
+  bool disconnected = false;
+  for (const auto &c: completions_) {
+    if (c.timed) {
+      auto left = std::max<int64_t>(
+          std::chrono::duration_cast<std::chrono::milliseconds>(c.deadline - now).count() + 1, 0);
+      if (wait_ms < 0 || left < wait_ms) {
+        wait_ms = static_cast<int>(left);
+      }
+    }
+    if (std::find(clients.begin(), clients.end(), c.client.get()) == clients.end()) {
+      clients.push_back(c.client.get());
+      fds.push_back(pollfd{c.client->response_fd(), POLLIN, 0});
+      disconnected = disconnected || fds.back().fd < 0;
+    }
+  }
+  if (disconnected) {
+    for (std::size_t i = 0; i < fds.size(); ++i) {
+      if (fds[i].fd < 0) {
+        fail(clients[i]);
+      }
+    }
+    return dispatch();
+  }
+
+  auto ready = ::poll(fds.data(), static_cast<nfds_t>(fds.size()), wait_ms);
+  if (ready < 0 && errno != EINTR) {
+    throw std::system_error(errno, std::generic_category(), "poll");
+  }
+  for (std::size_t i = 0; ready > 0 && i < fds.size(); ++i) {
+    if (fds[i].revents == 0) {
+      continue;
+    }
+    try {
+      clients[i]->read_response();
+    } catch (std::exception &e) {
+      LOG(log_level::info) << "Error in connection to chain: " << e.what();
+      fail(clients[i]);
+    }
+  }
+
+  now = std::chrono::steady_clock::now();
+  for (auto &c: completions_) {
+    if (c.timed && !c.failed && c.deadline <= now && !c.client->has_response(c.seq_no)) {
+      c.failed = true;
+    }
+  }
+  return dispatch();
+}
+
+void event_loop::run() {
+  while (!completions_.empty()) {
+    poll();
+  }
+}
+
+std::size_t event_loop::pending() const {
+  return completions_.size();
+}
+
+std::size_t event_loop::dispatch() {
+  std::vector<completion> remaining;
+  std::vector<std::pair<response_handler, std::vector<std::string>>> done;
+  for (auto &c: completions_) {
+    if (c.failed) {
+      c.client->abandon(c.seq_no);
+      done.emplace_back(std::move(c.handler), std::vector<std::string>{"!block_moved"});
+    } else if (c.client->has_response(c.seq_no)) {
+      done.emplace_back(std::move(c.handler), c.client->recv_response(c.seq_no));
+    } else {
+      remaining.push_back(std::move(c));
+    }
+  }
+  completions_.swap(remaining);
+  // Handlers run last, as they may submit new requests
+  for (auto &d: done) {
+    try {
+      d.first(d.second);
+    } catch (std::exception &e) {
+      LOG(log_level::error) << "Response handler failed: " << e.what();
+    }
+  }
+  return done.size();
+}
+
+void event_loop::fail(const replica_chain_client *client) {
+  for (auto &c: completions_) {
+    if (c.client.get() == client) {
+      c.failed = true;
+    }
+  }
+}
+
+}
+}
@@ -0,0 +1,102 @@
+#ifndef JIFFY_EVENT_LOOP_H
+#define JIFFY_EVENT_LOOP_H
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace jiffy {
+namespace storage {
+
+class replica_chain_client;
+
+/**
+ * @brief Event loop dispatching responses of asynchronous requests.
+ *
+ * Each thread has one loop, multiplexing the connections of all the replica
+ * chain clients it sent requests on: the loop waits on their response
+ * streams with poll(), reads responses as they arrive and runs the handler of
+ * every request whose response is in. Clients are not thread safe, so the
+ * loop is run by the thread using them, e.g. while it waits on a result.
+ *
+ * A request that gets no response within its client's time out, or whose
+ * connection fails, is handed a "!block_moved" response, so that the data
+ * structure client recovers the way it does for synchronous requests.
+ */
+class event_loop {
+ public:
+  typedef std::function<void(std::vector<std::string> &)> response_handler;
+
+  /**
+   * @brief Fetch the event loop of the calling thread
+   * @return Event loop
+   */
+  static event_loop &instance();
+
+  /**
+   * @brief Register handler for the response of a request in flight
+   * @param client Replica chain client the request was sent on
+   * @param seq_no Client sequence number of the request
+   * @param handler Handler, run with the response
+   */
+  void submit(const std::shared_ptr<replica_chain_client> &client, int64_t seq_no, response_handler handler);
+
+  /**
+   * @brief Wait for responses and run their handlers
+   * @param timeout_ms Maximum time to wait in milliseconds, -1 to wait until a handler runs
+   * @return Number of handlers run
+   */
+  std::size_t poll(int timeout_ms = -1);
+
+  /**
+   * @brief Run handlers until no request is pending
+   */
+  void run();
+
+  /**
+   * @brief Fetch number of requests pending
+   * @return Number of requests whose handlers have not run yet
+   */
+  std::size_t pending() const;
+
+ private:
+  typedef std::chrono::steady_clock::time_point time_point;
+
+  /* Request awaiting its response */
+  struct completion {
+    /* Replica chain client */
+    std::shared_ptr<replica_chain_client> client;
+    /* Client sequence number */
+    int64_t seq_no;
+    /* Response handler */
+    response_handler handler;
+    /* Time by which the response must arrive, if the client has a time out */
+    time_point deadline;
+    /* Bool value, true if the client has a time out */
+    bool timed;
+    /* Bool value, true if the request failed */
+    bool failed;
+  };
+
+  /**
+   * @brief Run handlers of requests whose responses are in or that failed
+   * @return Number of handlers run
+   */
+  std::size_t dispatch();
+
+  /**
+   * @brief Fail all requests pending on a client
+   * @param client Replica chain client
+   */
+  void fail(const replica_chain_client *client);
+
+  /* Pending requests */
+  std::vector<completion> completions_;
+};
+
+}
+}
+
+#endif //JIFFY_EVENT_LOOP_H
@@ -0,0 +1,102 @@
+#include "file_cache.h"
+#include <algorithm>
+#include <iterator>
+
+namespace jiffy {
+namespace storage {
+
+file_cache::file_cache(std::size_t capacity, std::size_t block_size)
+    : capacity_(capacity), block_size_(block_size) {}
+
+const std::string *file_cache::find(std::size_t partition, std::size_t offset) {
+  auto it = blocks_.find(block_key(partition, offset));
+  if (it == blocks_.end()) {
+    ++misses_;
+    return nullptr;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second);
+  ++hits_;
+  return &it->second->data;
+}
+
+void file_cache::put(std::size_t partition, std::size_t offset, const std::string &data) {
+  for (std::size_t i = 0; i < data.size(); i += block_size_) {
+    insert(block_key(partition, offset + i), data.substr(i, block_size_));
+  }
+}
+
+void file_cache::write(std::size_t partition, std::size_t offset, const std::string &data) {
+  if (data.empty()) {
+    return;
+  }
+  auto end = offset + data.size();
+  for (auto start = offset / block_size_ * block_size_; start < end; start += block_size_) {
+    auto it = blocks_.find(block_key(partition, start));
+    if (it == blocks_.end()) {
+      continue;
+    }
+    auto &cached = it->second->data;
+    auto from = std::max(start, offset);
+    auto to = std::min(start + block_size_, end);
+    if (from - start > cached.size()) {
+      // The write leaves a gap after the cached data, which the cache does not know the contents of
+      erase(it->second);
+      continue;
+    }
+    if (to - start > cached.size()) {
+      bytes_ += to - start - cached.size();
+      cached.resize(to - start);
+    }
+    cached.replace(from - start, to - from, data, from - offset, to - from);
+  }
+  while (bytes_ > capacity_ && !lru_.empty()) {
+    erase(std::prev(lru_.end()));
+  }
+}
+
+void file_cache::clear() {
+  lru_.clear();
+  blocks_.clear();
+  bytes_ = 0;
+}
+
+std::size_t file_cache::block_size() const {
+  return block_size_;
+}
+
+std::size_t file_cache::bytes() const {
+  return bytes_;
+}
+
+std::size_t file_cache::hits() const {
+  return hits_;
+}
+
+std::size_t file_cache::misses() const {
+  return misses_;
+}
+
+void file_cache::insert(const block_key &key, std::string data) {
+  auto it = blocks_.find(key);
+  if (it != blocks_.end()) {
+    erase(it->second);
+  }
+  if (data.size() > capacity_) {
+    return;
+  }
+  while (bytes_ + data.size() > capacity_) {
+    erase(std::prev(lru_.end()));
+  }
+  bytes_ += data.size();
+  lru_.push_front(block{key, std::move(data)});
+  blocks_.emplace(key, lru_.begin());
+}
+
+void file_cache::erase(block_ref it) {
+  bytes_ -= it->data.size();
+  blocks_.erase(it->key);
+  lru_.erase(it);
+}
+
+}
+}
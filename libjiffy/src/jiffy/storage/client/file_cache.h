@@ -0,0 +1,140 @@
+#ifndef JIFFY_FILE_CACHE_H
+#define JIFFY_FILE_CACHE_H
+
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+
+namespace jiffy {
+namespace storage {
+
+// Size of a client cache block in bytes
+constexpr std::size_t FILE_CACHE_BLOCK_SIZE = 64 * 1024;
+
+// Default capacity of the client cache in bytes
+constexpr std::size_t FILE_CACHE_DEFAULT_CAPACITY = 64 * 1024 * 1024;
+
+// Maximum number of cache blocks read ahead of a sequential reader
+constexpr std::size_t FILE_CACHE_MAX_READAHEAD = 16;
+
+// Bytes of sequential writes buffered before they are sent
+constexpr std::size_t FILE_CACHE_WRITE_BEHIND_SIZE = 1024 * 1024;
+
+/**
+ * @brief Client cache of file data, least recently used block first out.
+ *
+ * Data is cached in blocks of a fixed size, aligned within each partition;
+ * the last block of a partition, or of the file, may be shorter. Writes of the
+ * owning client are applied to the cached blocks they touch, so the cache
+ * holds the file as the client last wrote or read it.
+ */
+class file_cache {
+ public:
+  /**
+   * @brief Constructor
+   * @param capacity Capacity in bytes
+   * @param block_size Cache block size in bytes
+   */
+  explicit file_cache(std::size_t capacity = FILE_CACHE_DEFAULT_CAPACITY,
+                      std::size_t block_size = FILE_CACHE_BLOCK_SIZE);
+
+  /**
+   * @brief Look up cache block
+   * @param partition Partition number
+   * @param offset Offset of the block in the partition, a multiple of the block size
+   * @return Block data, null if not cached
+   */
+  const std::string *find(std::size_t partition, std::size_t offset);
+
+  /**
+   * @brief Cache data read from a partition, split in blocks
+   * @param partition Partition number
+   * @param offset Offset of the data in the partition, a multiple of the block size
+   * @param data Data
+   */
+  void put(std::size_t partition, std::size_t offset, const std::string &data);
+
+  /**
+   * @brief Apply a write to the cached blocks it touches
+   * @param partition Partition number
+   * @param offset Offset of the write in the partition
+   * @param data Data written
+   */
+  void write(std::size_t partition, std::size_t offset, const std::string &data);
+
+  /**
+   * @brief Drop all cached blocks
+   */
+  void clear();
+
+  /**
+   * @brief Fetch cache block size
+   * @return Block size in bytes
+   */
+  std::size_t block_size() const;
+
+  /**
+   * @brief Fetch bytes cached
+   * @return Bytes cached
+   */
+  std::size_t bytes() const;
+
+  /**
+   * @brief Fetch number of lookups that found their block
+   * @return Number of hits
+   */
+  std::size_t hits() const;
+
+  /**
+   * @brief Fetch number of lookups that missed
+   * @return Number of misses
+   */
+  std::size_t misses() const;
+
+ private:
+  typedef std::pair<std::size_t, std::size_t> block_key;
+
+  /* Cached block */
+  struct block {
+    /* Partition number and offset */
+    block_key key;
+    /* Data */
+    std::string data;
+  };
+
+  typedef std::list<block>::iterator block_ref;
+
+  /**
+   * @brief Cache one block, evicting least recently used blocks to make room
+   * @param key Partition number and offset
+   * @param data Block data
+   */
+  void insert(const block_key &key, std::string data);
+
+  /**
+   * @brief Remove block
+   * @param it Block
+   */
+  void erase(block_ref it);
+
+  /* Capacity in bytes */
+  std::size_t capacity_;
+  /* Block size in bytes */
+  std::size_t block_size_;
+  /* Blocks, most recently used first */
+  std::list<block> lru_;
+  /* Blocks by partition and offset */
+  std::map<block_key, block_ref> blocks_;
+  /* Bytes cached */
+  std::size_t bytes_{0};
+  /* Number of hits */
+  std::size_t hits_{0};
+  /* Number of misses */
+  std::size_t misses_{0};
+};
+
+}
+}
+
+#endif //JIFFY_FILE_CACHE_H
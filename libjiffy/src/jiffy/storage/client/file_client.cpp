@@ -3,6 +3,7 @@
 #include "jiffy/utils/string_utils.h"
 #include "jiffy/directory/directory_ops.h"
 #include <algorithm>
+#include <map>
 #include <thread>
 #include <utility>
 
@@ -19,15 +20,37 @@ file_client::file_client(std::shared_ptr<directory::directory_interface> fs,
       cur_partition_(0),
       cur_offset_(0),
       last_partition_(0),
-      last_offset_(0) {
+      last_offset_(0),
+      max_readahead_(0),
+      readahead_(1),
+      read_end_(0),
+      write_behind_size_(0),
+      write_failed_(false) {
   for (const auto &block: status.data_blocks()) {
     blocks_.push_back(std::make_shared<replica_chain_client>(fs_, path_, block, FILE_OPS, timeout_ms_));
   }
-  last_partition_ = status.data_blocks().size() - 1;
   std::vector<std::string> get_storage_capacity_args{"get_storage_capacity"};
-  auto ret = blocks_[block_id()]->run_command(get_storage_capacity_args);
+  auto ret = blocks_[block_id(0)]->run_command(get_storage_capacity_args);
   THROW_IF_NOT_OK(ret);
   block_size_ = std::stoul(ret[1]);
+  std::size_t stripe_unit = 0;
+  std::size_t stripe_width = 1;
+  try {
+    stripe_unit = std::stoul(status.get_tag(file_layout::STRIPE_UNIT_TAG));
+  } catch (directory::directory_ops_exception &e) {
+    stripe_unit = 0;
+  }
+  try {
+    stripe_width = std::stoul(status.get_tag(file_layout::STRIPE_WIDTH_TAG));
+  } catch (directory::directory_ops_exception &e) {
+    stripe_width = 1;
+  }
+  layout_ = file_layout(block_size_, stripe_unit, stripe_width);
+  if (blocks_.size() % stripe_width != 0) {
+    throw std::logic_error("Partitions of " + path_ + " do not form whole stripe groups");
+  }
+  // All groups but the last are taken to be full
+  last_partition_ = blocks_.size() - stripe_width;
   try {
     auto_scaling_ = (status.get_tag("file.auto_scale") == "true");
   } catch (directory::directory_ops_exception &e) {
@@ -35,7 +58,85 @@ file_client::file_client(std::shared_ptr<directory::directory_interface> fs,
   }
 }
 
+file_client::~file_client() {
+  try {
+    flush();
+  } catch (std::exception &e) {
+    LOG(log_level::warn) << "Could not complete buffered writes: " << e.what();
+  }
+}
+
+void file_client::enable_cache(std::size_t capacity,
+                               std::size_t block_size,
+                               std::size_t max_readahead,
+                               std::size_t write_behind_size) {
+  flush();
+  cache_.reset(new file_cache(capacity, block_size));
+  max_readahead_ = std::max<std::size_t>(max_readahead, 1);
+  readahead_ = 1;
+  read_end_ = std::string::npos;
+  write_behind_size_ = write_behind_size;
+}
+
+int file_client::disable_cache() {
+  auto ret = flush();
+  cache_.reset();
+  return ret;
+}
+
+const file_cache *file_client::cache() const {
+  return cache_.get();
+}
+
+const file_layout &file_client::layout() const {
+  return layout_;
+}
+
+int file_client::flush() {
+  send_write_buffer();
+  collect_writes(true);
+  auto ret = write_failed_ ? -1 : 0;
+  write_failed_ = false;
+  return ret;
+}
+
 int file_client::read(std::string &buf, size_t size) {
+  if (cache_ != nullptr) {
+    return read_cached(buf, size);
+  }
+  std::vector<std::pair<std::shared_ptr<replica_chain_client>, int64_t>> sent;
+  std::vector<file_layout::extent> extents;
+  auto ret = send_reads(sent, extents, size);
+  if (ret <= 0)
+    return ret;
+  std::vector<std::vector<std::string>> responses;
+  for (const auto &s: sent) {
+    responses.push_back(s.first->recv_response(s.second));
+  }
+  auto data = assemble(extents, responses);
+  buf += data;
+  return static_cast<int>(data.size());
+}
+
+async_result<std::string> file_client::read_async(size_t size) {
+  // Reads bypass the cache, but must see the writes buffered
+  if (cache_ != nullptr) {
+    flush();
+  }
+  std::vector<std::pair<std::shared_ptr<replica_chain_client>, int64_t>> sent;
+  std::vector<file_layout::extent> extents;
+  send_reads(sent, extents, size);
+  return gather_async<std::string>(sent, [extents](std::vector<std::vector<std::string>> &responses) {
+    for (const auto &resp: responses) {
+      THROW_IF_NOT_OK(resp);
+    }
+    return assemble(extents, responses);
+  });
+}
+
+int file_client::send_reads(std::vector<std::pair<std::shared_ptr<replica_chain_client>, int64_t>> &sent,
+                            std::vector<file_layout::extent> &extents,
+                            size_t size) {
   std::size_t file_size = last_partition_ * block_size_ + last_offset_;
   if (file_size <= cur_partition_ * block_size_ + cur_offset_)
     return -1;
@@ -44,14 +145,10 @@ int file_client::read(std::string &buf, size_t size) {
   if (remaining_data == 0)
     return 0;
   // Parallel read here
-  std::size_t start_partition = block_id();
-  std::size_t count = 0;
   while (remaining_data > 0) {
-    count++;
     std::size_t data_to_read = std::min(remaining_data, block_size_ - cur_offset_);
-    std::vector<std::string>
-        args{"read", std::to_string(cur_offset_), std::to_string(data_to_read)};
-    blocks_[block_id()]->send_command(args);
+    auto range = layout_.split(cur_partition_, cur_offset_, data_to_read);
+    extents.insert(extents.end(), range.begin(), range.end());
     remaining_data -= data_to_read;
     cur_offset_ += data_to_read;
     if (cur_offset_ == block_size_ && cur_partition_ != last_partition_) {
@@ -59,31 +156,200 @@ int file_client::read(std::string &buf, size_t size) {
       cur_partition_++;
     }
   }
+  send_range_reads(sent, extents);
+  return 1;
+}
+
+void file_client::send_range_reads(std::vector<std::pair<std::shared_ptr<replica_chain_client>, int64_t>> &sent,
+                                   const std::vector<file_layout::extent> &extents) {
+  // A single request per partition, so that a range never holds more of a chain's window than one place
+  for (const auto &e: file_layout::merge(extents)) {
+    std::vector<std::string>
+        args{command_codec::opcode(file_cmd_id::file_read), command_codec::encode_int(static_cast<int64_t>(e.offset)),
+             command_codec::encode_int(static_cast<int64_t>(e.size))};
+    auto block = blocks_[block_id(e.partition)];
+    sent.emplace_back(block, send_async(block, args));
+  }
+}
+
+std::string file_client::assemble(const std::vector<file_layout::extent> &extents,
+                                  const std::vector<std::vector<std::string>> &responses) {
+  // Responses follow the order of the partitions' first extent, each holding its extents in order
+  std::map<std::size_t, std::size_t> index;
+  std::vector<std::size_t> pos;
+  std::string data;
+  for (const auto &e: extents) {
+    auto it = index.emplace(e.partition, pos.size()).first;
+    if (it->second == pos.size()) {
+      pos.push_back(0);
+    }
+    const auto &read = responses.at(it->second).back();
+    auto &p = pos[it->second];
+    if (p < read.size()) {
+      data.append(read, p, std::min(e.size, read.size() - p));
+    }
+    p += e.size;
+  }
+  return data;
+}
+
+void file_client::send_range_writes(std::vector<std::pair<std::shared_ptr<replica_chain_client>, int64_t>> &sent,
+                                    const std::vector<file_layout::extent> &extents,
+                                    const std::string &data) {
+  auto merged = file_layout::merge(extents);
+  std::map<std::size_t, std::size_t> index;
+  for (std::size_t i = 0; i < merged.size(); ++i) {
+    index.emplace(merged[i].partition, i);
+  }
+  std::vector<std::string> parts(merged.size());
+  std::size_t pos = 0;
+  for (const auto &e: extents) {
+    parts[index[e.partition]].append(data, pos, e.size);
+    pos += e.size;
+  }
+  // A single request per partition, so that a range never holds more of a chain's window than one place
+  for (std::size_t i = 0; i < merged.size(); ++i) {
+    std::vector<std::string>
+        args{command_codec::opcode(file_cmd_id::file_write), std::move(parts[i]),
+             command_codec::encode_int(static_cast<int64_t>(merged[i].offset))};
+    auto block = blocks_[block_id(merged[i].partition)];
+    sent.emplace_back(block, send_async(block, args));
+  }
+}
+
+int file_client::read_cached(std::string &buf, size_t size) {
+  flush();
+  std::size_t file_size = last_partition_ * block_size_ + last_offset_;
+  std::size_t pos = cur_partition_ * block_size_ + cur_offset_;
+  if (file_size <= pos)
+    return -1;
+  std::size_t remaining_data = std::min(file_size - pos, size);
+  if (remaining_data == 0)
+    return 0;
+  // Sequential readers get a window twice as large on every read, random readers a single block
+  readahead_ = pos == read_end_ ? std::min(readahead_ * 2, max_readahead_) : 1;
+  auto cache_block_size = cache_->block_size();
   auto previous_size = buf.size();
-  for (std::size_t k = 0; k < count; k++) {
-    buf += blocks_[start_partition + k]->recv_response().back();
+  while (remaining_data > 0) {
+    auto in_block = cur_offset_ % cache_block_size;
+    auto block_start = cur_offset_ - in_block;
+    std::size_t data_to_read = std::min({remaining_data, cache_block_size - in_block, block_size_ - cur_offset_});
+    auto cached = cache_->find(cur_partition_, block_start);
+    if (cached == nullptr || cached->size() < in_block + data_to_read) {
+      std::size_t partition_size = cur_partition_ == last_partition_ ? last_offset_ : block_size_;
+      std::size_t ahead = std::min(readahead_ * cache_block_size, partition_size - block_start);
+      std::vector<std::pair<std::shared_ptr<replica_chain_client>, int64_t>> sent;
+      auto extents = layout_.split(cur_partition_, block_start, ahead);
+      send_range_reads(sent, extents);
+      std::vector<std::vector<std::string>> responses;
+      for (const auto &s: sent) {
+        responses.push_back(s.first->recv_response(s.second));
+        THROW_IF_NOT_OK(responses.back());
+      }
+      auto data = assemble(extents, responses);
+      cache_->put(cur_partition_, block_start, data);
+      cached = cache_->find(cur_partition_, block_start);
+      if (cached == nullptr || cached->size() <= in_block) {
+        // Less data than the file size suggests, or a block too large to cache
+        if (data.size() > in_block) {
+          data_to_read = std::min(data_to_read, data.size() - in_block);
+          buf.append(data, in_block, data_to_read);
+        } else {
+          break;
+        }
+      } else {
+        data_to_read = std::min(data_to_read, cached->size() - in_block);
+        buf.append(*cached, in_block, data_to_read);
+      }
+    } else {
+      buf.append(*cached, in_block, data_to_read);
+    }
+    remaining_data -= data_to_read;
+    cur_offset_ += data_to_read;
+    if (cur_offset_ == block_size_ && cur_partition_ != last_partition_) {
+      cur_offset_ = 0;
+      cur_partition_++;
+    }
   }
-  auto after_size = buf.size();
-  return static_cast<int>(after_size - previous_size);
+  read_end_ = cur_partition_ * block_size_ + cur_offset_;
+  return static_cast<int>(buf.size() - previous_size);
 }
 
 int file_client::write(const std::string &data) {
-  std::size_t file_size = (last_partition_ + 1) * block_size_;
-  std::vector<std::string> _return;
+  if (cache_ != nullptr) {
+    std::size_t end = cur_partition_ * block_size_ + cur_offset_ + write_buffer_.size() + data.size();
+    if (!auto_scaling_ && end > blocks_.size() * block_size_) {
+      send_write_buffer();
+      return -1;
+    }
+    write_buffer_ += data;
+    if (write_buffer_.size() >= write_behind_size_) {
+      send_write_buffer();
+    }
+    return data.size();
+  }
+  std::vector<std::pair<std::shared_ptr<replica_chain_client>, int64_t>> sent;
+  if (send_writes(sent, data) < 0)
+    return -1;
+  for (const auto &s: sent) {
+    s.first->recv_response(s.second);
+  }
+  return data.size();
+}
 
-  std::size_t remain_size;
-  std::size_t num_chain_needed = 0;
+async_result<int> file_client::write_async(const std::string &data) {
+  send_write_buffer();
+  return send_write(data);
+}
+
+void file_client::send_write_buffer() {
+  if (write_buffer_.empty()) {
+    return;
+  }
+  writes_in_flight_.push_back(send_write(write_buffer_));
+  write_buffer_.clear();
+  collect_writes(false);
+}
 
-  if (cur_partition_ * block_size_ + cur_offset_ > file_size) {
-    num_chain_needed = cur_partition_ - last_partition_;
-    file_size = (cur_partition_ + 1) * block_size_;
-    remain_size = file_size - cur_partition_ * block_size_ - cur_offset_;
-    num_chain_needed += (data.size() - remain_size) / block_size_ + ((data.size() - remain_size) % block_size_ != 0);
-  } else {
-    remain_size = file_size - cur_partition_ * block_size_ - cur_offset_;
-    if (remain_size < data.size()) {
-      num_chain_needed = (data.size() - remain_size) / block_size_ + ((data.size() - remain_size) % block_size_ != 0);
+void file_client::collect_writes(bool wait) {
+  std::vector<async_result<int>> remaining;
+  for (auto &result: writes_in_flight_) {
+    if (wait || result.ready()) {
+      if (result.get() < 0)
+        write_failed_ = true;
+    } else {
+      remaining.push_back(result);
+    }
+  }
+  writes_in_flight_.swap(remaining);
+}
+
+async_result<int> file_client::send_write(const std::string &data) {
+  std::vector<std::pair<std::shared_ptr<replica_chain_client>, int64_t>> sent;
+  if (send_writes(sent, data) < 0) {
+    async_result<int> result;
+    result.set_value(-1);
+    return result;
+  }
+  auto size = static_cast<int>(data.size());
+  return gather_async<int>(sent, [size](std::vector<std::vector<std::string>> &responses) {
+    for (const auto &resp: responses) {
+      THROW_IF_NOT_OK(resp);
     }
+    return size;
+  });
+}
+
+int file_client::send_writes(std::vector<std::pair<std::shared_ptr<replica_chain_client>, int64_t>> &sent,
+                             const std::string &data) {
+  std::vector<std::string> _return;
+
+  // Partitions the file spans once written, allocated by whole stripe groups
+  std::size_t end = cur_partition_ * block_size_ + cur_offset_ + data.size();
+  std::size_t partitions_needed = (end + block_size_ - 1) / block_size_;
+  std::size_t num_chain_needed = 0;
+  if (partitions_needed > blocks_.size()) {
+    num_chain_needed = layout_.round_up(partitions_needed) - blocks_.size();
   }
 
   if (num_chain_needed && !auto_scaling_) {
@@ -92,12 +358,12 @@ int file_client::write(const std::string &data) {
 
   // First allocate new blocks if needed
   std::vector<std::string> add_block_args
-      {"add_blocks", std::to_string(last_partition_), std::to_string(num_chain_needed)};
+      {"add_blocks", std::to_string(blocks_.size() - 1), std::to_string(num_chain_needed)};
 
   while (num_chain_needed != 0) {
-    _return = blocks_[last_partition_]->run_command(add_block_args);
+    _return = blocks_.back()->run_command(add_block_args);
     if (_return[0] == "!block_allocated") {
-      last_partition_ += num_chain_needed;
+      last_partition_ = partitions_needed - 1;
       last_offset_ = 0;
       num_chain_needed = 0;
       try {
@@ -116,31 +382,30 @@ int file_client::write(const std::string &data) {
   }
   // Parallel write
   std::size_t remaining_data = data.size();
-  std::size_t start_partition = block_id();
-  std::size_t count = 0;
+  std::vector<file_layout::extent> extents;
 
   while (remaining_data > 0) {
-    count++;
+    // Writes past the end of a striped file may start beyond its last partition
+    update_last_partition();
     std::string
         data_to_write = data.substr(data.size() - remaining_data, std::min(remaining_data, block_size_ - cur_offset_));
-    std::vector<std::string>
-        args{"write", data_to_write, std::to_string(cur_offset_)};
-    blocks_[block_id()]->send_command(args);
+    auto range = layout_.split(cur_partition_, cur_offset_, data_to_write.size());
+    extents.insert(extents.end(), range.begin(), range.end());
+    if (cache_ != nullptr) {
+      cache_->write(cur_partition_, cur_offset_, data_to_write);
+    }
     remaining_data -= data_to_write.size();
     cur_offset_ += data_to_write.size();
     update_last_offset();
-    if (cur_offset_ == block_size_ && cur_partition_ != last_partition_) {
+    if (cur_offset_ == block_size_ && cur_partition_ + 1 < blocks_.size()) {
       cur_offset_ = 0;
       cur_partition_++;
       update_last_partition();
     }
   }
+  send_range_writes(sent, extents, data);
 
-  for (std::size_t i = 0; i < count; i++) {
-    blocks_[start_partition + i]->recv_response();
-  }
-  return data.size();
-
+  return 0;
 }
 
 void file_client::refresh() {
@@ -160,6 +425,7 @@ void file_client::refresh() {
 }
 
 bool file_client::seek(const std::size_t offset) {
+  send_write_buffer();
   cur_partition_ = offset / block_size_;
   cur_offset_ = offset % block_size_;
   return true;
@@ -169,11 +435,11 @@ bool file_client::need_chain() const {
   return cur_partition_ >= blocks_.size() - 1;
 }
 
-std::size_t file_client::block_id() const {
-  if (cur_partition_ >= blocks_.size()) {
+std::size_t file_client::block_id(std::size_t partition) const {
+  if (partition >= blocks_.size()) {
     throw std::logic_error("Blocks are insufficient, need to add more");
   }
-  return cur_partition_;
+  return partition;
 }
 
 void file_client::handle_redirect(std::vector<std::string> &, const std::vector<std::string> &) {
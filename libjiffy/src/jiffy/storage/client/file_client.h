@@ -6,6 +6,8 @@
 #include "jiffy/utils/client_cache.h"
 #include "jiffy/storage/file/file_ops.h"
 #include "jiffy/storage/client/data_structure_client.h"
+#include "jiffy/storage/client/file_cache.h"
+#include "jiffy/storage/client/file_layout.h"
 
 namespace jiffy {
 namespace storage {
@@ -28,8 +30,9 @@ class file_client : public data_structure_client {
 
   /**
    * @brief Destructor
+   * Complete buffered writes
    */
-  virtual ~file_client() = default;
+  virtual ~file_client();
 
   /**
    * @brief Refresh the slot and blocks from directory service
@@ -51,6 +54,61 @@ class file_client : public data_structure_client {
    */
   int write(const std::string &data);
 
+  /**
+   * @brief Cache file data in the client.
+   * Reads are served from cached blocks, missing blocks being read ahead of a
+   * sequential reader in growing windows; writes are buffered and sent in the
+   * background once enough sequential data is buffered, or before the client
+   * reads, seeks or flushes. The cache assumes no other client writes the file
+   * meanwhile.
+   * @param capacity Capacity of the cache in bytes
+   * @param block_size Cache block size in bytes
+   * @param max_readahead Maximum number of cache blocks read ahead
+   * @param write_behind_size Bytes of sequential writes buffered before they are sent
+   */
+  void enable_cache(std::size_t capacity = FILE_CACHE_DEFAULT_CAPACITY,
+                    std::size_t block_size = FILE_CACHE_BLOCK_SIZE,
+                    std::size_t max_readahead = FILE_CACHE_MAX_READAHEAD,
+                    std::size_t write_behind_size = FILE_CACHE_WRITE_BEHIND_SIZE);
+
+  /**
+   * @brief Complete buffered writes and stop caching file data
+   * @return 0, or -1 if a buffered write failed as blocks are insufficient
+   */
+  int disable_cache();
+
+  /**
+   * @brief Fetch client cache
+   * @return Client cache, null if caching is disabled
+   */
+  const file_cache *cache() const;
+
+  /**
+   * @brief Fetch layout of file data over the partitions
+   * @return File layout
+   */
+  const file_layout &layout() const;
+
+  /**
+   * @brief Send buffered writes and wait for all writes in flight to complete
+   * @return 0, or -1 if a buffered write failed as blocks are insufficient
+   */
+  int flush();
+
+  /**
+   * @brief Read data from file asynchronously; the file offset moves right away
+   * @param size Size to be read
+   * @return Result, the data read, empty at the end of the file
+   */
+  async_result<std::string> read_async(size_t size);
+
+  /**
+   * @brief Write data to file asynchronously; the file offset moves right away
+   * @param data Data
+   * @return Result, the number of bytes written, or -1 if blocks are insufficient
+   */
+  async_result<int> write_async(const std::string &data);
+
   /**
    * @brief Seek to a location of the file
    * @param offset File offset to seek
@@ -76,11 +134,84 @@ class file_client : public data_structure_client {
   bool need_chain() const;
 
   /**
-   * @brief Fetch block identifier for specified operation
-   * @param op Operation
+   * @brief Send the reads of a file read, one per partition, moving the file offset
+   * @param sent Replica chain clients and client sequence numbers of the reads sent
+   * @param extents Extents read, in the order of the file
+   * @param size Size to be read
+   * @return -1 if reach EOF, 0 if there is nothing to read, 1 otherwise
+   */
+  int send_reads(std::vector<std::pair<std::shared_ptr<replica_chain_client>, int64_t>> &sent,
+                 std::vector<file_layout::extent> &extents,
+                 size_t size);
+
+  /**
+   * @brief Send the reads of a range of the file, one per partition touched
+   * @param sent Replica chain clients and client sequence numbers of the reads sent
+   * @param extents Extents of the range, in the order of the range
+   */
+  void send_range_reads(std::vector<std::pair<std::shared_ptr<replica_chain_client>, int64_t>> &sent,
+                        const std::vector<file_layout::extent> &extents);
+
+  /**
+   * @brief Reassemble the data of a range of the file from the responses of its reads
+   * @param extents Extents of the range, in the order of the range
+   * @param responses Responses of the reads sent by send_range_reads, in the order they were sent
+   * @return Data
+   */
+  static std::string assemble(const std::vector<file_layout::extent> &extents,
+                              const std::vector<std::vector<std::string>> &responses);
+
+  /**
+   * @brief Send the writes of a range of the file, one per partition touched
+   * @param sent Replica chain clients and client sequence numbers of the writes sent
+   * @param extents Extents of the range, in the order of the range
+   * @param data Data of the range
+   */
+  void send_range_writes(std::vector<std::pair<std::shared_ptr<replica_chain_client>, int64_t>> &sent,
+                         const std::vector<file_layout::extent> &extents,
+                         const std::string &data);
+
+  /**
+   * @brief Send the writes of a file write, one per partition, allocating blocks and moving the file offset
+   * @param sent Replica chain clients and client sequence numbers of the writes sent
+   * @param data Data
+   * @return -1 if blocks are insufficient, 0 otherwise
+   */
+  int send_writes(std::vector<std::pair<std::shared_ptr<replica_chain_client>, int64_t>> &sent,
+                  const std::string &data);
+
+  /**
+   * @brief Send writes and collect their responses as one result
+   * @param data Data
+   * @return Result, the number of bytes written, or -1 if blocks are insufficient
+   */
+  async_result<int> send_write(const std::string &data);
+
+  /**
+   * @brief Send buffered writes without waiting for them
+   */
+  void send_write_buffer();
+
+  /**
+   * @brief Collect results of writes in flight
+   * @param wait Bool value, true to wait for all of them, false to collect only those complete
+   */
+  void collect_writes(bool wait);
+
+  /**
+   * @brief Read data from file through the client cache
+   * @param buf Buffer
+   * @param size Size
+   * @return Read status, -1 if reach EOF, number of bytes read otherwise
+   */
+  int read_cached(std::string &buf, size_t size);
+
+  /**
+   * @brief Fetch block identifier of a partition, checking that it is allocated
+   * @param partition Partition number
    * @return Block identifier
    */
-  std::size_t block_id() const;
+  std::size_t block_id(std::size_t partition) const;
 
   /**
    * @brief Track the last partition of the file
@@ -100,11 +231,11 @@ class file_client : public data_structure_client {
       last_offset_ = cur_offset_;
   }
 
-  /* Current partition number */
+  /* Current logical partition number */
   std::size_t cur_partition_;
   /* Current offset in a partition */
   std::size_t cur_offset_;
-  /* Last partition of the file */
+  /* Last logical partition of the file */
   std::size_t last_partition_;
   /* Max partition of the file */
   std::size_t max_partition_;
@@ -114,8 +245,26 @@ class file_client : public data_structure_client {
   std::vector<std::shared_ptr<replica_chain_client>> blocks_;
   /* Block size */
   std::size_t block_size_;
+  /* Layout of file data over the partitions */
+  file_layout layout_;
   /* Auto scaling support */
   bool auto_scaling_;
+  /* Client cache, null if disabled */
+  std::unique_ptr<file_cache> cache_;
+  /* Maximum number of cache blocks read ahead */
+  std::size_t max_readahead_;
+  /* Number of cache blocks read ahead on the next miss */
+  std::size_t readahead_;
+  /* File offset the last read ended at */
+  std::size_t read_end_;
+  /* Bytes of sequential writes buffered before they are sent */
+  std::size_t write_behind_size_;
+  /* Writes not sent yet, continuing from the current offset */
+  std::string write_buffer_;
+  /* Results of writes sent but not collected */
+  std::vector<async_result<int>> writes_in_flight_;
+  /* Bool value, true if a write sent from the buffer failed as blocks are insufficient */
+  bool write_failed_;
 };
 
 }
@@ -0,0 +1,86 @@
+#include "file_layout.h"
+#include <algorithm>
+#include <map>
+#include <stdexcept>
+
+namespace jiffy {
+namespace storage {
+
+const std::string file_layout::STRIPE_UNIT_TAG = "file.stripe_unit";
+const std::string file_layout::STRIPE_WIDTH_TAG = "file.stripe_width";
+
+file_layout::file_layout(std::size_t block_size, std::size_t stripe_unit, std::size_t stripe_width)
+    : block_size_(block_size),
+      stripe_unit_(stripe_unit == 0 ? block_size : stripe_unit),
+      stripe_width_(stripe_width) {
+  if (block_size_ == 0 || stripe_width_ == 0) {
+    throw std::invalid_argument("Partition size and stripe width must be positive");
+  }
+  if (stripe_unit_ > block_size_ || block_size_ % stripe_unit_ != 0) {
+    throw std::invalid_argument("Stripe unit " + std::to_string(stripe_unit_)
+                                    + " does not divide partition size " + std::to_string(block_size_));
+  }
+}
+
+file_layout::extent file_layout::locate(std::size_t partition, std::size_t offset) const {
+  auto group = partition / stripe_width_;
+  auto in_group = (partition % stripe_width_) * block_size_ + offset;
+  auto unit = in_group / stripe_unit_;
+  auto in_unit = in_group % stripe_unit_;
+  return extent{group * stripe_width_ + unit % stripe_width_,
+                (unit / stripe_width_) * stripe_unit_ + in_unit,
+                stripe_unit_ - in_unit};
+}
+
+std::vector<file_layout::extent> file_layout::split(std::size_t partition,
+                                                    std::size_t offset,
+                                                    std::size_t size) const {
+  std::vector<extent> extents;
+  while (size > 0) {
+    auto e = locate(partition, offset);
+    e.size = std::min(e.size, size);
+    if (!extents.empty() && extents.back().partition == e.partition
+        && extents.back().offset + extents.back().size == e.offset) {
+      extents.back().size += e.size;
+    } else {
+      extents.push_back(e);
+    }
+    offset += e.size;
+    size -= e.size;
+  }
+  return extents;
+}
+
+std::vector<file_layout::extent> file_layout::merge(const std::vector<extent> &extents) {
+  std::vector<extent> merged;
+  std::map<std::size_t, std::size_t> index;
+  for (const auto &e: extents) {
+    auto it = index.find(e.partition);
+    if (it == index.end()) {
+      index.emplace(e.partition, merged.size());
+      merged.push_back(e);
+    } else {
+      merged[it->second].size += e.size;
+    }
+  }
+  return merged;
+}
+
+std::size_t file_layout::round_up(std::size_t partitions) const {
+  return (partitions + stripe_width_ - 1) / stripe_width_ * stripe_width_;
+}
+
+bool file_layout::striped() const {
+  return stripe_width_ > 1;
+}
+
+std::size_t file_layout::stripe_unit() const {
+  return stripe_unit_;
+}
+
+std::size_t file_layout::stripe_width() const {
+  return stripe_width_;
+}
+
+}
+}
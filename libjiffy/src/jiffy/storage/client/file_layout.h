@@ -0,0 +1,112 @@
+#ifndef JIFFY_FILE_LAYOUT_H
+#define JIFFY_FILE_LAYOUT_H
+
+#include <string>
+#include <vector>
+
+namespace jiffy {
+namespace storage {
+
+// Default stripe unit of striped files in bytes
+constexpr std::size_t FILE_DEFAULT_STRIPE_UNIT = 1024 * 1024;
+
+/**
+ * @brief Layout of file data over the partitions of a file.
+ *
+ * The client addresses file data by logical partition and offset, logical
+ * partition i holding bytes [i * block size, (i + 1) * block size) of the
+ * file. A file striped over a width of w partitions groups its partitions by
+ * w: the data of a group is cut in stripe units, and consecutive stripe units
+ * go to consecutive partitions of the group, round robin. Sequential files
+ * have a width of one partition and a stripe unit of the block size, so that
+ * logical and physical partitions coincide. Files grow by whole groups.
+ */
+class file_layout {
+ public:
+  /* Tag holding the stripe unit of a file, in bytes */
+  static const std::string STRIPE_UNIT_TAG;
+  /* Tag holding the stripe width of a file, in partitions */
+  static const std::string STRIPE_WIDTH_TAG;
+
+  /* Contiguous range of a physical partition */
+  struct extent {
+    /* Partition number */
+    std::size_t partition;
+    /* Offset in the partition */
+    std::size_t offset;
+    /* Size */
+    std::size_t size;
+  };
+
+  /**
+   * @brief Constructor
+   * @param block_size Partition size in bytes
+   * @param stripe_unit Stripe unit in bytes, a divisor of the partition size, or 0 for the partition size
+   * @param stripe_width Stripe width in partitions
+   */
+  explicit file_layout(std::size_t block_size = 1, std::size_t stripe_unit = 0, std::size_t stripe_width = 1);
+
+  /**
+   * @brief Locate a byte of a logical partition
+   * @param partition Logical partition number
+   * @param offset Offset in the logical partition
+   * @return Extent from the byte to the end of its stripe unit
+   */
+  extent locate(std::size_t partition, std::size_t offset) const;
+
+  /**
+   * @brief Split a range of a logical partition in extents, one per stripe unit touched
+   * @param partition Logical partition number
+   * @param offset Offset of the range in the logical partition
+   * @param size Size of the range, not past the end of the logical partition
+   * @return Extents, in the order of the range
+   */
+  std::vector<extent> split(std::size_t partition, std::size_t offset, std::size_t size) const;
+
+  /**
+   * @brief Merge the extents of a range of the file in one extent per partition
+   * A contiguous range of the file is contiguous on every partition it touches,
+   * so that it is read or written with a single request per partition.
+   * @param extents Extents of the range, in the order of the range
+   * @return Extents, one per partition, in the order of their first byte in the range
+   */
+  static std::vector<extent> merge(const std::vector<extent> &extents);
+
+  /**
+   * @brief Round a number of partitions up to whole groups
+   * @param partitions Number of partitions
+   * @return Number of partitions
+   */
+  std::size_t round_up(std::size_t partitions) const;
+
+  /**
+   * @brief Check if the layout stripes data over several partitions
+   * @return Bool value, true if striped
+   */
+  bool striped() const;
+
+  /**
+   * @brief Fetch stripe unit
+   * @return Stripe unit in bytes
+   */
+  std::size_t stripe_unit() const;
+
+  /**
+   * @brief Fetch stripe width
+   * @return Stripe width in partitions
+   */
+  std::size_t stripe_width() const;
+
+ private:
+  /* Partition size in bytes */
+  std::size_t block_size_;
+  /* Stripe unit in bytes */
+  std::size_t stripe_unit_;
+  /* Stripe width in partitions */
+  std::size_t stripe_width_;
+};
+
+}
+}
+
+#endif //JIFFY_FILE_LAYOUT_H
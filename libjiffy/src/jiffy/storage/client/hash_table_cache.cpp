@@ -0,0 +1,82 @@
+#include "hash_table_cache.h"
+#include <iterator>
+
+namespace jiffy {
+namespace storage {
+
+hash_table_cache::hash_table_cache(std::size_t capacity, int64_t max_age_ms)
+    : capacity_(capacity), max_age_ms_(max_age_ms) {}
+
+bool hash_table_cache::get(const std::string &key, std::string &value) {
+  auto it = entries_.find(key);
+  if (it == entries_.end()) {
+    ++misses_;
+    return false;
+  }
+  if (max_age_ms_ >= 0 && std::chrono::steady_clock::now() - it->second->cached
+      > std::chrono::milliseconds(max_age_ms_)) {
+    erase(it->second);
+    ++misses_;
+    return false;
+  }
+  lru_.splice(lru_.begin(), lru_, it->second);
+  value = it->second->value;
+  ++hits_;
+  return true;
+}
+
+void hash_table_cache::put(const std::string &key, const std::string &value) {
+  invalidate(key);
+  auto n = key.size() + value.size();
+  if (n > capacity_) {
+    return;
+  }
+  while (bytes_ + n > capacity_) {
+    erase(std::prev(lru_.end()));
+  }
+  lru_.push_front(entry{key, value, std::chrono::steady_clock::now()});
+  entries_.emplace(key, lru_.begin());
+  bytes_ += n;
+}
+
+void hash_table_cache::invalidate(const std::string &key) {
+  auto it = entries_.find(key);
+  if (it != entries_.end()) {
+    erase(it->second);
+  }
+}
+
+void hash_table_cache::clear() {
+  lru_.clear();
+  entries_.clear();
+  bytes_ = 0;
+}
+
+std::size_t hash_table_cache::size() const {
+  return entries_.size();
+}
+
+std::size_t hash_table_cache::bytes() const {
+  return bytes_;
+}
+
+std::size_t hash_table_cache::capacity() const {
+  return capacity_;
+}
+
+std::size_t hash_table_cache::hits() const {
+  return hits_;
+}
+
+std::size_t hash_table_cache::misses() const {
+  return misses_;
+}
+
+void hash_table_cache::erase(entry_ref it) {
+  bytes_ -= it->key.size() + it->value.size();
+  entries_.erase(it->key);
+  lru_.erase(it);
+}
+
+}
+}
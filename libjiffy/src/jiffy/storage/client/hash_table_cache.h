@@ -0,0 +1,133 @@
+#ifndef JIFFY_HASH_TABLE_CACHE_H
+#define JIFFY_HASH_TABLE_CACHE_H
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+namespace jiffy {
+namespace storage {
+
+// Default capacity of the client read cache in bytes
+constexpr std::size_t HASH_TABLE_CACHE_DEFAULT_CAPACITY = 32 * 1024 * 1024;
+
+// Default time after which cached values are read from the server again
+constexpr int64_t HASH_TABLE_CACHE_MAX_AGE_MS = 1000;
+
+/**
+ * @brief Bounded read cache of hash table values, least recently used first out.
+ *
+ * The cache only holds values; keeping them coherent with the server is up to
+ * its owner, which invalidates keys as it learns of writes to them. Entries
+ * older than the maximum age are dropped on lookup, which bounds how stale a
+ * value can get when a write goes unnoticed, e.g. a key expiring on the server.
+ */
+class hash_table_cache {
+ public:
+  /**
+   * @brief Constructor
+   * @param capacity Capacity in bytes of cached keys and values
+   * @param max_age_ms Maximum age of cached values in milliseconds, -1 to keep them until invalidated
+   */
+  explicit hash_table_cache(std::size_t capacity = HASH_TABLE_CACHE_DEFAULT_CAPACITY,
+                            int64_t max_age_ms = HASH_TABLE_CACHE_MAX_AGE_MS);
+
+  /**
+   * @brief Look up value of key
+   * @param key Key
+   * @param value Value, if cached
+   * @return Bool value, true if the key was cached
+   */
+  bool get(const std::string &key, std::string &value);
+
+  /**
+   * @brief Cache value of key, evicting least recently used keys to make room
+   * @param key Key
+   * @param value Value
+   */
+  void put(const std::string &key, const std::string &value);
+
+  /**
+   * @brief Drop key from the cache
+   * @param key Key
+   */
+  void invalidate(const std::string &key);
+
+  /**
+   * @brief Drop all keys from the cache
+   */
+  void clear();
+
+  /**
+   * @brief Fetch number of cached keys
+   * @return Number of cached keys
+   */
+  std::size_t size() const;
+
+  /**
+   * @brief Fetch bytes of cached keys and values
+   * @return Bytes cached
+   */
+  std::size_t bytes() const;
+
+  /**
+   * @brief Fetch capacity
+   * @return Capacity in bytes
+   */
+  std::size_t capacity() const;
+
+  /**
+   * @brief Fetch number of lookups that found their key
+   * @return Number of hits
+   */
+  std::size_t hits() const;
+
+  /**
+   * @brief Fetch number of lookups that missed
+   * @return Number of misses
+   */
+  std::size_t misses() const;
+
+ private:
+  typedef std::chrono::steady_clock::time_point time_point;
+
+  /* Cached key value pair */
+  struct entry {
+    /* Key */
+    std::string key;
+    /* Value */
+    std::string value;
+    /* Time the value was cached */
+    time_point cached;
+  };
+
+  typedef std::list<entry>::iterator entry_ref;
+
+  /**
+   * @brief Remove entry
+   * @param it Entry
+   */
+  void erase(entry_ref it);
+
+  /* Capacity in bytes */
+  std::size_t capacity_;
+  /* Maximum age of values, -1 for none */
+  int64_t max_age_ms_;
+  /* Entries, most recently used first */
+  std::list<entry> lru_;
+  /* Entries by key */
+  std::unordered_map<std::string, entry_ref> entries_;
+  /* Bytes cached */
+  std::size_t bytes_{0};
+  /* Number of hits */
+  std::size_t hits_{0};
+  /* Number of misses */
+  std::size_t misses_{0};
+};
+
+}
+}
+
+#endif //JIFFY_HASH_TABLE_CACHE_H
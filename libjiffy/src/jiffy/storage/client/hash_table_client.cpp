@@ -2,6 +2,7 @@
 #include "jiffy/utils/string_utils.h"
 #include "jiffy/storage/hashtable/hash_slot.h"
 #include "jiffy/utils/logger.h"
+#include <algorithm>
 #include <thread>
 #include <cmath>
 
@@ -10,139 +11,243 @@ namespace storage {
 
 using namespace jiffy::utils;
 
+namespace {
+/* Opcodes of the hash table commands sent by the client */
+const std::string PUT = command_codec::opcode(hash_table_cmd_id::ht_put);
+const std::string GET = command_codec::opcode(hash_table_cmd_id::ht_get);
+const std::string UPDATE = command_codec::opcode(hash_table_cmd_id::ht_update);
+const std::string UPSERT = command_codec::opcode(hash_table_cmd_id::ht_upsert);
+const std::string REMOVE = command_codec::opcode(hash_table_cmd_id::ht_remove);
+const std::string EXISTS = command_codec::opcode(hash_table_cmd_id::ht_exists);
+const std::string PUT_TTL = command_codec::opcode(hash_table_cmd_id::ht_put_ttl);
+const std::string UPSERT_TTL = command_codec::opcode(hash_table_cmd_id::ht_upsert_ttl);
+}
+
 hash_table_client::hash_table_client(std::shared_ptr<directory::directory_interface> fs,
                                      const std::string &path,
                                      const directory::data_status &status,
                                      int timeout_ms)
     : data_structure_client(fs, path, status, timeout_ms) {
-  blocks_.clear();
-  for (auto &block: status.data_blocks()) {
-    blocks_.emplace(std::make_pair(static_cast<int32_t>(std::stoi(utils::string_utils::split(block.name, '_')[0])),
-                                   std::make_shared<replica_chain_client>(fs_, path_, block, HT_OPS, timeout_ms_)));
-  }
+  partitions_.update(status_, [this](const directory::replica_chain &chain) {
+    return std::make_shared<replica_chain_client>(fs_, path_, chain, HT_OPS, timeout_ms_);
+  });
 }
 
 void hash_table_client::refresh() {
-  status_ = fs_->dstatus(path_);
-  blocks_.clear();
-  bool redo;
-  do {
+  auto version = partitions_.version();
+  auto old = partitions_.partitions();
+  std::size_t connected = 0;
+  for (std::size_t attempt = 1;; ++attempt) {
     try {
-      for (auto &block: status_.data_blocks()) {
-        if (block.metadata != "split_importing" && block.metadata != "importing") {
-          blocks_.emplace(std::make_pair(static_cast<int32_t>(std::stoi(utils::string_utils::split(block.name,
-                                                                                                   '_')[0])),
-                                         std::make_shared<replica_chain_client>(fs_,
-                                                                                path_,
-                                                                                block,
-                                                                                HT_OPS,
-                                                                                timeout_ms_)));
-        }
-      }
-      redo = false;
+      status_ = fs_->dstatus(path_);
+      connected = partitions_.update(status_, [this](const directory::replica_chain &chain) {
+        return std::make_shared<replica_chain_client>(fs_, path_, chain, HT_OPS, timeout_ms_);
+      });
+      break;
     } catch (std::exception &e) {
-      redo = true;
+      if (attempt == HASH_TABLE_REFRESH_ATTEMPTS) {
+        throw;
+      }
+      LOG(log_level::info) << "Could not refresh partitions of " << path_ << ": " << e.what();
+      std::this_thread::sleep_for(std::chrono::milliseconds(1 << attempt));
     }
-  } while (redo);
+  }
+  if (partitions_.version() == version) {
+    return;
+  }
+  LOG(log_level::trace) << "Partition map of " << path_ << " at version " << partitions_.version() << ", "
+                        << connected << " of " << partitions_.size() << " chains reconnected";
+  if (map_listener_ != nullptr) {
+    for (const auto &p: old) {
+      auto it = std::find_if(partitions_.partitions().begin(), partitions_.partitions().end(),
+                             [&p](const partition_map::partition &q) {
+                               return q.chain.tail() == p.chain.tail();
+                             });
+      if (it == partitions_.partitions().end()) {
+        map_listener_->remove_block(p.chain);
+      }
+    }
+    for (const auto &p: partitions_.partitions()) {
+      map_listener_->add_block(p.chain);
+    }
+  }
   redirect_blocks_.clear();
+  reset_cache();
+}
+
+void hash_table_client::enable_cache(std::size_t capacity, int64_t max_age_ms) {
+  cache_.reset(new hash_table_cache(capacity, max_age_ms));
+  reset_cache();
+}
+
+void hash_table_client::disable_cache() {
+  cache_listener_.reset();
+  cache_.reset();
+}
+
+const hash_table_cache *hash_table_client::cache() const {
+  return cache_.get();
+}
+
+void hash_table_client::enable_map_updates() {
+  std::unique_ptr<data_structure_listener> listener(new data_structure_listener(path_, directory::data_status()));
+  listener->subscribe({"update_partition"});
+  for (const auto &p: partitions_.partitions()) {
+    listener->add_block(p.chain);
+  }
+  map_listener_ = std::move(listener);
+}
+
+void hash_table_client::disable_map_updates() {
+  map_listener_.reset();
+}
+
+const hash_table_client::partition_map &hash_table_client::partitions() const {
+  return partitions_;
 }
 
 void hash_table_client::put(const std::string &key, const std::string &value) {
-  std::vector<std::string> _return;
-  std::vector<std::string> args{"put", key, value};
-  bool redo;
-  do {
-    try {
-      _return = blocks_[block_id(key)]->run_command(args);
-      handle_redirect(_return, args);
-      redo = false;
-      redo_times_ = 0;
-    } catch (redo_error &e) {
-      redo = true;
-    }
-  } while (redo);
+  auto _return = run_command({PUT, key, value});
+  THROW_IF_NOT_OK(_return);
+}
+
+void hash_table_client::put(const std::string &key, const std::string &value, int64_t ttl_ms) {
+  auto _return = run_command({PUT_TTL, key, value, command_codec::encode_int(ttl_ms)});
   THROW_IF_NOT_OK(_return);
 }
 
 std::string hash_table_client::get(const std::string &key) {
-  std::vector<std::string> _return;
-  std::vector<std::string> args{"get", key};
-  bool redo;
-  do {
-    try {
-      _return = blocks_[block_id(key)]->run_command(args);
-      handle_redirect(_return, args);
-      redo = false;
-      redo_times_ = 0;
-    } catch (redo_error &e) {
-      redo = true;
-    }
-  } while (redo);
+  std::string value;
+  if (cache_get(key, value)) {
+    return value;
+  }
+  auto epoch = cache_epoch_;
+  auto _return = run_command({GET, key});
   THROW_IF_NOT_OK(_return);
+  cache_put(key, _return[1], epoch);
   return _return[1];
 }
 
-std::string hash_table_client::update(const std::string &key, const std::string &value) {
-  std::vector<std::string> _return;
-  std::vector<std::string> args{"update", key, value};
-  bool redo;
-  do {
-    try {
-      _return = blocks_[block_id(key)]->run_command(args);
-      handle_redirect(_return, args);
-      redo = false;
-      redo_times_ = 0;
-    } catch (redo_error &e) {
-      redo = true;
+void hash_table_client::put(const std::vector<std::pair<std::string, std::string>> &kvs) {
+  std::vector<std::vector<std::string>> cmds;
+  cmds.reserve(kvs.size());
+  for (const auto &kv: kvs) {
+    cmds.push_back({PUT, kv.first, kv.second});
+  }
+  for (const auto &resp: run_scattered(cmds)) {
+    THROW_IF_NOT_OK(resp);
+  }
+}
+
+std::vector<std::string> hash_table_client::get(const std::vector<std::string> &keys) {
+  std::vector<std::string> values(keys.size());
+  std::vector<std::vector<std::string>> cmds;
+  std::vector<std::size_t> missed;
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    if (!cache_get(keys[i], values[i])) {
+      cmds.push_back({GET, keys[i]});
+      missed.push_back(i);
     }
-  } while (redo);
+  }
+  if (cmds.empty()) {
+    return values;
+  }
+  auto epoch = cache_epoch_;
+  auto responses = run_scattered(cmds);
+  for (std::size_t j = 0; j < responses.size(); ++j) {
+    THROW_IF_NOT_OK(responses[j]);
+    values[missed[j]] = std::move(responses[j][1]);
+    cache_put(keys[missed[j]], values[missed[j]], epoch);
+  }
+  return values;
+}
+
+std::string hash_table_client::update(const std::string &key, const std::string &value) {
+  auto _return = run_command({UPDATE, key, value});
   THROW_IF_NOT_OK(_return);
   return _return[0];
 }
 
 std::string hash_table_client::upsert(const std::string &key, const std::string &value) {
-  std::vector<std::string> _return;
-  std::vector<std::string> args{"upsert", key, value};
-  bool redo;
-  do {
-    try {
-      _return = blocks_[block_id(key)]->run_command(args);
-      handle_redirect(_return, args);
-      redo = false;
-      redo_times_ = 0;
-    } catch (redo_error &e) {
-      redo = true;
-    }
-  } while (redo);
+  auto _return = run_command({UPSERT, key, value});
+  THROW_IF_NOT_OK(_return);
+  return _return[1];
+}
+
+std::string hash_table_client::upsert(const std::string &key, const std::string &value, int64_t ttl_ms) {
+  auto _return = run_command({UPSERT_TTL, key, value, command_codec::encode_int(ttl_ms)});
   THROW_IF_NOT_OK(_return);
   return _return[1];
 }
 
 std::string hash_table_client::remove(const std::string &key) {
-  std::vector<std::string> _return;
-  std::vector<std::string> args{"remove", key};
-  bool redo;
-  do {
-    try {
-      _return = blocks_[block_id(key)]->run_command(args);
-      handle_redirect(_return, args);
-      redo = false;
-      redo_times_ = 0;
-    } catch (redo_error &e) {
-      redo = true;
-    }
-  } while (redo);
+  auto _return = run_command({REMOVE, key});
   THROW_IF_NOT_OK(_return);
   return _return[0];
 }
 
 bool hash_table_client::exists(const std::string &key) {
+  auto _return = run_command({EXISTS, key});
+  return _return[0] == "!ok";
+}
+
+async_result<std::string> hash_table_client::put_async(const std::string &key, const std::string &value) {
+  return run_command_async<std::string>({PUT, key, value}, [](std::vector<std::string> &_return) {
+    THROW_IF_NOT_OK(_return);
+    return _return[0];
+  });
+}
+
+async_result<std::string> hash_table_client::get_async(const std::string &key) {
+  std::string value;
+  if (cache_get(key, value)) {
+    async_result<std::string> result;
+    result.set_value(std::move(value));
+    return result;
+  }
+  auto epoch = cache_epoch_;
+  return run_command_async<std::string>({GET, key}, [this, key, epoch](std::vector<std::string> &_return) {
+    THROW_IF_NOT_OK(_return);
+    cache_put(key, _return[1], epoch);
+    return _return[1];
+  });
+}
+
+async_result<std::string> hash_table_client::update_async(const std::string &key, const std::string &value) {
+  return run_command_async<std::string>({UPDATE, key, value}, [](std::vector<std::string> &_return) {
+    THROW_IF_NOT_OK(_return);
+    return _return[0];
+  });
+}
+
+async_result<std::string> hash_table_client::upsert_async(const std::string &key, const std::string &value) {
+  return run_command_async<std::string>({UPSERT, key, value}, [](std::vector<std::string> &_return) {
+    THROW_IF_NOT_OK(_return);
+    return _return[1];
+  });
+}
+
+async_result<std::string> hash_table_client::remove_async(const std::string &key) {
+  return run_command_async<std::string>({REMOVE, key}, [](std::vector<std::string> &_return) {
+    THROW_IF_NOT_OK(_return);
+    return _return[0];
+  });
+}
+
+async_result<bool> hash_table_client::exists_async(const std::string &key) {
+  return run_command_async<bool>({EXISTS, key}, [](std::vector<std::string> &_return) {
+    return _return[0] == "!ok";
+  });
+}
+
+std::vector<std::string> hash_table_client::run_command(const std::vector<std::string> &args) {
+  apply_map_updates();
+  cache_invalidate(args);
   std::vector<std::string> _return;
-  std::vector<std::string> args{"exists", key};
   bool redo;
   do {
     try {
-      _return = blocks_[block_id(key)]->run_command(args);
+      _return = block(args[1])->run_command(args);
       handle_redirect(_return, args);
       redo = false;
       redo_times_ = 0;
@@ -150,17 +255,139 @@ bool hash_table_client::exists(const std::string &key) {
       redo = true;
     }
   } while (redo);
-  return _return[0] == "!ok";
+  return _return;
 }
 
-std::size_t hash_table_client::block_id(const std::string &key) {
-  return static_cast<size_t>((*std::prev(blocks_.upper_bound(hash_slot::get(key)))).first);
+std::vector<std::vector<std::string>> hash_table_client::run_scattered(const std::vector<std::vector<std::string>> &cmds) {
+  apply_map_updates();
+  // Group commands by partition
+  std::map<std::size_t, std::vector<std::size_t>> groups;
+  for (std::size_t i = 0; i < cmds.size(); ++i) {
+    cache_invalidate(cmds[i]);
+    groups[partitions_.index(hash_slot::get(cmds[i][1]))].push_back(i);
+  }
+
+  // Send a batch frame to every partition, then collect the responses
+  std::vector<std::vector<std::string>> responses(cmds.size());
+  std::vector<std::pair<std::shared_ptr<replica_chain_client>, const std::vector<std::size_t> *>> sent;
+  bool failed = false;
+  for (const auto &group: groups) {
+    std::vector<std::vector<std::string>> batch;
+    batch.reserve(group.second.size());
+    for (auto i: group.second) {
+      batch.push_back(cmds[i]);
+    }
+    auto client = partitions_.at(group.first).client;
+    try {
+      client->send_batch(batch);
+      sent.emplace_back(client, &group.second);
+    } catch (std::exception &e) {
+      failed = true;
+    }
+  }
+  for (const auto &s: sent) {
+    try {
+      auto batch_responses = s.first->recv_batch();
+      for (std::size_t j = 0; j < s.second->size(); ++j) {
+        responses[(*s.second)[j]] = std::move(batch_responses[j]);
+      }
+    } catch (std::exception &e) {
+      failed = true;
+    }
+  }
+  if (failed) {
+    refresh();
+  }
+
+  // Commands that hit a partition being scaled, a full partition or a failure go one by one
+  for (std::size_t i = 0; i < cmds.size(); ++i) {
+    const auto &resp = responses[i];
+    if (resp.empty() || resp[0] == "!exporting" || resp[0] == "!block_moved" || resp[0] == "!full"
+        || resp[0] == "!redo") {
+      responses[i] = run_command(cmds[i]);
+    }
+  }
+  return responses;
+}
+
+void hash_table_client::apply_map_updates() {
+  if (map_listener_ == nullptr) {
+    return;
+  }
+  bool changed = false;
+  data_structure_listener::notification_t n;
+  while (map_listener_->try_get_notification(n)) {
+    changed = true;
+  }
+  if (changed) {
+    refresh();
+  }
+}
+
+std::shared_ptr<replica_chain_client> hash_table_client::block(const std::string &key) const {
+  return partitions_.route(hash_slot::get(key)).client;
+}
+
+bool hash_table_client::cache_get(const std::string &key, std::string &value) {
+  if (cache_listener_ == nullptr) {
+    return false;
+  }
+  data_structure_listener::notification_t n;
+  while (cache_listener_->try_get_notification(n)) {
+    if (n.first == "error") {
+      // Writes may go unnoticed from here on
+      reset_cache();
+      return false;
+    }
+    cache_->invalidate(n.second);
+  }
+  return cache_->get(key, value);
+}
+
+void hash_table_client::cache_put(const std::string &key, const std::string &value, std::size_t epoch) {
+  if (cache_listener_ != nullptr && epoch == cache_epoch_) {
+    cache_->put(key, value);
+  }
+}
+
+void hash_table_client::cache_invalidate(const std::vector<std::string> &args) {
+  if (cache_ != nullptr && args[0] != GET && args[0] != EXISTS) {
+    cache_->invalidate(args[1]);
+    ++cache_epoch_;
+  }
+}
+
+void hash_table_client::reset_cache() {
+  if (cache_ == nullptr) {
+    return;
+  }
+  cache_->clear();
+  ++cache_epoch_;
+  cache_listener_.reset();
+  std::vector<std::string> ops;
+  for (const auto &op: HT_OPS) {
+    if (!op.second.is_accessor()) {
+      ops.push_back(op.first);
+    }
+  }
+  try {
+    std::unique_ptr<data_structure_listener> listener(new data_structure_listener(path_, status_));
+    listener->subscribe(ops);
+    cache_listener_ = std::move(listener);
+  } catch (std::exception &e) {
+    LOG(log_level::warn) << "Suspending client cache, could not subscribe to writes: " << e.what();
+  }
 }
 
 void hash_table_client::handle_redirect(std::vector<std::string> &_return, const std::vector<std::string> &args) {
+  if (_return[0] == "!exporting" && cache_ != nullptr) {
+    // Keys being exported are written on partitions the cache does not listen to
+    cache_->clear();
+    ++cache_epoch_;
+  }
   while (_return[0] == "!exporting") {
     auto args_copy = args;
-    if (args[0] == "update" || args[0] == "upsert") {
+    if (args[0] == UPDATE || args[0] == UPSERT || args[0] == UPSERT_TTL) {
       args_copy.emplace_back(_return[2]);
       args_copy.emplace_back(_return[3]);
     }
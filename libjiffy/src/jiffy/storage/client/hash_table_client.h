@@ -5,14 +5,22 @@
 #include "jiffy/storage/client/replica_chain_client.h"
 #include "jiffy/utils/client_cache.h"
 #include "jiffy/storage/client/data_structure_client.h"
+#include "jiffy/storage/client/data_structure_listener.h"
+#include "jiffy/storage/client/hash_table_cache.h"
+#include "jiffy/storage/client/hash_table_partition_map.h"
 #include "jiffy/storage/hashtable/hash_table_ops.h"
 
 namespace jiffy {
 namespace storage {
 
+// Number of attempts at fetching and connecting to the partitions before a refresh gives up
+constexpr std::size_t HASH_TABLE_REFRESH_ATTEMPTS = 10;
+
 /* Hash table client */
 class hash_table_client : public data_structure_client {
  public:
+  typedef hash_table_partition_map<replica_chain_client> partition_map;
+
   /**
    * @brief Constructor
    * Store all replica chain and their begin slot
@@ -33,6 +41,8 @@ class hash_table_client : public data_structure_client {
 
   /**
    * @brief Refresh the slot and blocks from directory service
+   * Only chains of partitions that changed are reconnected; failures to fetch or connect
+   * are retried with backoff up to HASH_TABLE_REFRESH_ATTEMPTS times before giving up.
    */
   void refresh() override;
 
@@ -44,6 +54,14 @@ class hash_table_client : public data_structure_client {
    */
   void put(const std::string &key, const std::string &value);
 
+  /**
+   * @brief Put key value pair that expires after a time to live
+   * @param key Key
+   * @param value Value
+   * @param ttl_ms Time to live in milliseconds
+   */
+  void put(const std::string &key, const std::string &value, int64_t ttl_ms);
+
   /**
    * @brief Get value for specified key
    * @param key Key
@@ -51,6 +69,19 @@ class hash_table_client : public data_structure_client {
    */
   std::string get(const std::string &key);
 
+  /**
+   * @brief Put key value pairs, batching the pairs for each partition into one request
+   * @param kvs Key value pairs
+   */
+  void put(const std::vector<std::pair<std::string, std::string>> &kvs);
+
+  /**
+   * @brief Get values for specified keys, batching the keys for each partition into one request
+   * @param keys Keys
+   * @return Values, in key order
+   */
+  std::vector<std::string> get(const std::vector<std::string> &keys);
+
   /**
    * @brief Update key value pair
    * @param key Key
@@ -67,6 +98,15 @@ class hash_table_client : public data_structure_client {
    */
   std::string upsert(const std::string &key, const std::string &value);
 
+  /**
+   * @brief Put key value pair that expires after a time to live, update value and time to live if key exists
+   * @param key Key
+   * @param value Value
+   * @param ttl_ms Time to live in milliseconds
+   * @return Response of the command
+   */
+  std::string upsert(const std::string &key, const std::string &value, int64_t ttl_ms);
+
   /**
    * @brief Remove key value pair
    * @param key Key
@@ -81,15 +121,163 @@ class hash_table_client : public data_structure_client {
    */
   bool exists(const std::string &key);
 
+  /**
+   * @brief Cache values read in the client.
+   * Cached values are invalidated as the partitions notify writes to their keys,
+   * so that repeated reads of hot keys need no round trip; notifications arrive
+   * shortly after a write completes, so reads may briefly return the old value.
+   * Writes the partitions do not notify, such as keys expiring, are bounded by
+   * the maximum age of cached values.
+   * @param capacity Capacity of the cache in bytes
+   * @param max_age_ms Maximum age of cached values in milliseconds, -1 for none
+   */
+  void enable_cache(std::size_t capacity = HASH_TABLE_CACHE_DEFAULT_CAPACITY,
+                    int64_t max_age_ms = HASH_TABLE_CACHE_MAX_AGE_MS);
+
+  /**
+   * @brief Stop caching values read in the client
+   */
+  void disable_cache();
+
+  /**
+   * @brief Fetch client cache
+   * @return Client cache, null if caching is disabled
+   */
+  const hash_table_cache *cache() const;
+
+  /**
+   * @brief Follow changes to the partition map as the partitions push them.
+   * Partitions notify the client when their slot range changes, and the client
+   * refreshes its map before its next command rather than on the first command
+   * that reaches a partition no longer serving the key.
+   */
+  void enable_map_updates();
+
+  /**
+   * @brief Stop following pushed changes to the partition map
+   */
+  void disable_map_updates();
+
+  /**
+   * @brief Fetch partition map
+   * @return Partition map
+   */
+  const partition_map &partitions() const;
+
+  /**
+   * @brief Put key value pair asynchronously
+   * @param key Key
+   * @param value Value
+   * @return Result, the response status
+   */
+  async_result<std::string> put_async(const std::string &key, const std::string &value);
+
+  /**
+   * @brief Get value for specified key asynchronously
+   * @param key Key
+   * @return Result, the value
+   */
+  async_result<std::string> get_async(const std::string &key);
+
+  /**
+   * @brief Update the value for specified key asynchronously
+   * @param key Key
+   * @param value Value
+   * @return Result, the response status
+   */
+  async_result<std::string> update_async(const std::string &key, const std::string &value);
+
+  /**
+   * @brief Update or insert key value pair asynchronously
+   * @param key Key
+   * @param value Value
+   * @return Result, the old value or the response status like upsert()
+   */
+  async_result<std::string> upsert_async(const std::string &key, const std::string &value);
+
+  /**
+   * @brief Remove key value pair asynchronously
+   * @param key Key
+   * @return Result, the response status
+   */
+  async_result<std::string> remove_async(const std::string &key);
+
+  /**
+   * @brief Check if key exists asynchronously
+   * @param key Key
+   * @return Result, true if key exists
+   */
+  async_result<bool> exists_async(const std::string &key);
 
  private:
   /**
-   * @brief Fetch block identifier for particular key
+   * @brief Run a single key command asynchronously, redoing it synchronously if it needs a retry
+   * @param args Command arguments, the key is the second argument
+   * @param finish Function turning the response into the result value
+   * @return Result
+   */
+  template<typename T>
+  async_result<T> run_command_async(const std::vector<std::string> &args,
+                                    std::function<T(std::vector<std::string> &)> finish) {
+    apply_map_updates();
+    cache_invalidate(args);
+    return run_async<T>(block(args[1]), args, [this, args] { return run_command(args); }, finish);
+  }
+
+  /**
+   * @brief Look up key in the client cache, applying the invalidations received first
    * @param key Key
-   * @return Block identifier
+   * @param value Value, if cached
+   * @return Bool value, true if the key was cached
    */
+  bool cache_get(const std::string &key, std::string &value);
 
-  std::size_t block_id(const std::string &key);
+  /**
+   * @brief Cache value read, unless a write may have been missed since the read was sent
+   * @param key Key
+   * @param value Value
+   * @param epoch Cache epoch when the read was sent
+   */
+  void cache_put(const std::string &key, const std::string &value, std::size_t epoch);
+
+  /**
+   * @brief Invalidate key written by a command of this client
+   * @param args Command arguments, the key is the second argument
+   */
+  void cache_invalidate(const std::vector<std::string> &args);
+
+  /**
+   * @brief Empty the client cache and subscribe to writes on the current partitions
+   */
+  void reset_cache();
+
+  /**
+   * @brief Refresh the partition map if partitions pushed changes to it
+   */
+  void apply_map_updates();
+
+  /**
+   * @brief Fetch replica chain client for particular key
+   * @param key Key
+   * @return Replica chain client
+   */
+
+  std::shared_ptr<replica_chain_client> block(const std::string &key) const;
+
+  /**
+   * @brief Run a single key command, following redirects and retrying until it completes
+   * @param args Command arguments, the key is the second argument
+   * @return Response of the command
+   */
+  std::vector<std::string> run_command(const std::vector<std::string> &args);
+
+  /**
+   * @brief Run single key commands, sending one batch frame per partition to all partitions
+   * before collecting any response; commands that need a redirect or a retry are rerun one by one
+   * @param cmds Commands, the key is the second argument of each
+   * @return Responses, in command order
+   */
+  std::vector<std::vector<std::string>> run_scattered(const std::vector<std::vector<std::string>> &cmds);
 
   /**
    * @brief Handle command in redirect case
@@ -102,8 +290,20 @@ class hash_table_client : public data_structure_client {
   /* Redo times */
   std::size_t redo_times_ = 0;
 
-  /* Map from slot begin to replica chain client pointer */
-  std::map<int32_t, std::shared_ptr<replica_chain_client>> blocks_;
+  /* Partition map */
+  partition_map partitions_;
+
+  /* Listener for partition map changes, null unless following them */
+  std::unique_ptr<data_structure_listener> map_listener_;
+
+  /* Client cache, null if disabled */
+  std::unique_ptr<hash_table_cache> cache_;
+
+  /* Listener for writes invalidating cached keys, null if caching is suspended */
+  std::unique_ptr<data_structure_listener> cache_listener_;
+
+  /* Cache epoch, advanced whenever reads in flight may have missed a write */
+  std::size_t cache_epoch_ = 0;
 
   /* Caching created connections */
   std::map<std::string, std::shared_ptr<replica_chain_client>> redirect_blocks_;
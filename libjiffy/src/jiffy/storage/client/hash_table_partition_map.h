@@ -0,0 +1,167 @@
+#ifndef JIFFY_HASH_TABLE_PARTITION_MAP_H
+#define JIFFY_HASH_TABLE_PARTITION_MAP_H
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+#include "jiffy/directory/directory_ops.h"
+#include "jiffy/storage/hashtable/hash_slot.h"
+#include "jiffy/utils/string_utils.h"
+
+namespace jiffy {
+namespace storage {
+
+/**
+ * @brief Partition map of a hash table client, routing each hash slot to the chain serving it.
+ *
+ * Slots are routed through a flat table of hash_slot::MAX entries, each
+ * holding the index of the partition whose range starts at or before the
+ * slot. Updating the map from a new data status keeps the chain clients of
+ * partitions that did not change, and connects only to new or changed
+ * chains; the version advances whenever an update changes the map.
+ * @tparam C Chain client type
+ */
+template<typename C>
+class hash_table_partition_map {
+ public:
+  typedef std::shared_ptr<C> client_ref;
+  typedef std::function<client_ref(const directory::replica_chain &)> connector;
+
+  /* Partition serving a range of hash slots */
+  struct partition {
+    /* First slot of the partition */
+    int32_t slot_begin;
+    /* Replica chain */
+    directory::replica_chain chain;
+    /* Chain client */
+    client_ref client;
+  };
+
+  /**
+   * @brief Constructor, the map routes no slot until updated
+   */
+  hash_table_partition_map() : slots_(hash_slot::MAX, 0) {}
+
+  /**
+   * @brief Update the map to the partitions of a data status
+   * Partitions still importing their slots are left out, since the partitions
+   * exporting the slots keep serving them. Chain clients of partitions whose
+   * slot range and chain are unchanged are kept, unless they lost their connection.
+   * @param status Data status
+   * @param connect Function connecting to a replica chain
+   * @return Number of chains connected to
+   */
+  std::size_t update(const directory::data_status &status, const connector &connect) {
+    std::vector<partition> updated;
+    for (const auto &block: status.data_blocks()) {
+      if (block.metadata != "split_importing" && block.metadata != "importing") {
+        auto begin = static_cast<int32_t>(std::stoi(utils::string_utils::split(block.name, '_')[0]));
+        updated.push_back(partition{begin, block, nullptr});
+      }
+    }
+    std::sort(updated.begin(), updated.end(), [](const partition &a, const partition &b) {
+      return a.slot_begin < b.slot_begin;
+    });
+
+    // Connect first, so that the map stays as it was if a connection fails
+    std::unordered_map<std::string, const partition *> current;
+    for (const auto &p: partitions_) {
+      current.emplace(p.chain.name, &p);
+    }
+    std::size_t connected = 0;
+    bool changed = updated.size() != partitions_.size();
+    for (auto &p: updated) {
+      auto it = current.find(p.chain.name);
+      if (it != current.end() && it->second->chain.block_ids == p.chain.block_ids
+          && it->second->client != nullptr && it->second->client->is_connected()) {
+        p.client = it->second->client;
+      } else {
+        p.client = connect(p.chain);
+        ++connected;
+        changed = true;
+      }
+    }
+    if (!changed) {
+      return 0;
+    }
+
+    partitions_ = std::move(updated);
+    for (std::size_t i = 0; i < partitions_.size(); ++i) {
+      auto begin = i == 0 ? 0 : static_cast<std::size_t>(partitions_[i].slot_begin);
+      auto end = i + 1 == partitions_.size() ? slots_.size() : static_cast<std::size_t>(partitions_[i + 1].slot_begin);
+      std::fill(slots_.begin() + begin, slots_.begin() + std::max(begin, end), static_cast<uint16_t>(i));
+    }
+    ++version_;
+    return connected;
+  }
+
+  /**
+   * @brief Fetch index of the partition serving a slot
+   * @param slot Hash slot
+   * @return Partition index
+   */
+  std::size_t index(int32_t slot) const {
+    if (partitions_.empty()) {
+      throw std::logic_error("Partition map is empty");
+    }
+    return slots_[static_cast<std::size_t>(slot)];
+  }
+
+  /**
+   * @brief Fetch partition serving a slot
+   * @param slot Hash slot
+   * @return Partition
+   */
+  const partition &route(int32_t slot) const {
+    return partitions_[index(slot)];
+  }
+
+  /**
+   * @brief Fetch partition
+   * @param i Partition index
+   * @return Partition
+   */
+  const partition &at(std::size_t i) const {
+    return partitions_.at(i);
+  }
+
+  /**
+   * @brief Fetch partitions, in slot order
+   * @return Partitions
+   */
+  const std::vector<partition> &partitions() const {
+    return partitions_;
+  }
+
+  /**
+   * @brief Fetch number of partitions
+   * @return Number of partitions
+   */
+  std::size_t size() const {
+    return partitions_.size();
+  }
+
+  /**
+   * @brief Fetch map version, advanced by every update changing the map
+   * @return Map version
+   */
+  std::size_t version() const {
+    return version_;
+  }
+
+ private:
+  /* Partitions, in slot order */
+  std::vector<partition> partitions_;
+  /* Index of the partition serving each slot */
+  std::vector<uint16_t> slots_;
+  /* Map version */
+  std::size_t version_{0};
+};
+
+}
+}
+
+#endif //JIFFY_HASH_TABLE_PARTITION_MAP_H
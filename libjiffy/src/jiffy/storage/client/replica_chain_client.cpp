@@ -3,6 +3,7 @@
 #include "jiffy/utils/string_utils.h"
 #include "jiffy/utils/logger.h"
 #include "jiffy/storage/command.h"
+#include "jiffy/storage/batch_frame.h"
 #include "jiffy/storage/manager/detail/block_id_parser.h"
 
 namespace jiffy {
@@ -14,13 +15,19 @@ replica_chain_client::replica_chain_client(std::shared_ptr<directory::directory_
                                            const std::string &path,
                                            const directory::replica_chain &chain,
                                            const command_map &OPS,
-                                           int timeout_ms) : fs_(fs), path_(path), in_flight_(false), OPS_(OPS) {
+                                           int timeout_ms,
+                                           std::size_t max_in_flight)
+    : fs_(fs), path_(path), max_in_flight_(max_in_flight), OPS_(OPS) {
   seq_.client_id = -1;
   seq_.client_seq_no = 0;
-  accessor_ = false;
-  send_run_command_exception_ = false;
+  // Commands may also be named by opcode
+  for (const auto &op: OPS) {
+    OPS_.emplace(command_codec::opcode(op.second.id), op.second);
+  }
+  OPS_.emplace(batch_frame::ACCESSOR, batch_frame::info(batch_frame::ACCESSOR));
+  OPS_.emplace(batch_frame::MUTATOR, batch_frame::info(batch_frame::MUTATOR));
   connect(chain, timeout_ms);
-  for (auto &op: OPS) {
+  for (auto &op: OPS_) {
     cmd_client_[op.first] = op.second.is_accessor() ? &tail_ : &head_;
   }
 }
@@ -39,64 +46,131 @@ const directory::replica_chain &replica_chain_client::chain() const {
 }
 
 void replica_chain_client::connect(const directory::replica_chain &chain, int timeout_ms) {
+  disconnect();
   chain_ = chain;
   timeout_ms_ = timeout_ms;
   auto h = block_id_parser::parse(chain_.block_ids.front());
   head_.connect(h.host, h.service_port, h.id, timeout_ms);
-  seq_.client_id = head_.get_client_id();
   if (chain_.block_ids.size() == 1) {
     tail_ = head_;
   } else {
     auto t = block_id_parser::parse(chain_.block_ids.back());
     tail_.connect(t.host, t.service_port, t.id, timeout_ms);
   }
-  response_reader_ = tail_.get_command_response_reader(seq_.client_id);
-  in_flight_ = false;
+  // The tail assigns the client identifier, so it is unique among the clients it responds to
+  response_reader_ = tail_.get_command_response_reader();
+  seq_.client_id = response_reader_.client_id();
+  // Responses to requests sent on the old connections never arrive
+  in_flight_.clear();
+  abandoned_.clear();
+}
+
+std::size_t replica_chain_client::in_flight() const {
+  return in_flight_.size();
+}
+
+std::size_t replica_chain_client::max_in_flight() const {
+  return max_in_flight_;
 }
 
-void replica_chain_client::send_command(const std::vector<std::string> &args) {
-  if (in_flight_) {
-    throw std::length_error("Cannot have more than one request in-flight");
+int replica_chain_client::timeout_ms() const {
+  return timeout_ms_;
+}
+
+int replica_chain_client::response_fd() const {
+  return tail_.response_fd();
+}
+
+bool replica_chain_client::has_response(int64_t seq_no) {
+  auto req = find_request(seq_no);
+  return req != nullptr && req->done && !req->received;
+}
+
+int64_t replica_chain_client::send_command(const std::vector<std::string> &args) {
+  if (in_flight_.size() >= max_in_flight_) {
+    throw std::length_error("Cannot have more than " + std::to_string(max_in_flight_) + " requests in-flight");
   }
-  if (OPS_[args[0]].is_accessor()) {
+  request req{seq_.client_seq_no, OPS_[args[0]].is_accessor(), 0, false, false, {}};
+  if (req.accessor) {
     try {
-      accessor_ = true;
-      cmd_client_.at(args.front())->send_run_command(std::stoi(string_utils::split(chain_.tail(), ':').back()), args);
+      cmd_client_.at(args.front())->command_request(seq_, args);
     } catch (std::exception &e) {
-      send_run_command_exception_ = true;
+      req.response.emplace_back("!block_moved");
+      req.done = true;
     }
   } else {
     cmd_client_.at(args.front())->command_request(seq_, args);
   }
-  in_flight_ = true;
+  in_flight_.push_back(std::move(req));
+  return seq_.client_seq_no++;
 }
 
 std::vector<std::string> replica_chain_client::recv_response() {
-  std::vector<std::string> ret;
-  int64_t rseq;
-  if (accessor_) {
-    if (send_run_command_exception_) {
-      ret.emplace_back("!block_moved");
-    } else {
-      try {
-        tail_.recv_run_command(ret);
-      } catch (std::exception &e) {
-        if (!send_run_command_exception_) {
-          ret.emplace_back("!block_moved");
-        }
+  if (in_flight_.empty()) {
+    throw std::logic_error("SEQ: No request in flight");
+  }
+  return recv_response(in_flight_.front().seq_no);
+}
+
+std::vector<std::string> replica_chain_client::recv_response(int64_t seq_no) {
+  auto req = find_request(seq_no);
+  if (req == nullptr || req->received) {
+    throw std::logic_error("SEQ: No request in flight with sequence number " + std::to_string(seq_no));
+  }
+  while (!req->done) {
+    try {
+      read_response();
+    } catch (apache::thrift::TException &e) {
+      if (!req->accessor) {
+        throw;
       }
+      // A tail that does not answer a read is taken to have moved
+      req->response.emplace_back("!block_moved");
+      req->done = true;
     }
-    send_run_command_exception_ = false;
-  } else {
-    rseq = response_reader_.recv_response(ret);
-    if (rseq != seq_.client_seq_no) {
-      throw std::logic_error(
-          "SEQ: Expected=" + std::to_string(seq_.client_seq_no) + " Received=" + std::to_string(rseq));
+  }
+  return take_response(*req);
+}
+
+void replica_chain_client::read_response() {
+  std::vector<std::string> ret;
+  auto rseq = response_reader_.recv_response(ret);
+  if (abandoned_.erase(rseq) > 0) {
+    return;
+  }
+  auto r = find_request(rseq);
+  if (r == nullptr || r->done) {
+    throw std::logic_error("SEQ: Unexpected response, Received=" + std::to_string(rseq));
+  }
+  r->response = std::move(ret);
+  r->done = true;
+}
+
+void replica_chain_client::abandon(int64_t seq_no) {
+  auto req = find_request(seq_no);
+  if (req != nullptr && !req->received) {
+    if (!req->done) {
+      abandoned_.insert(seq_no);
     }
+    take_response(*req);
+  }
+}
+
+replica_chain_client::request *replica_chain_client::find_request(int64_t seq_no) {
+  if (in_flight_.empty() || seq_no < in_flight_.front().seq_no) {
+    return nullptr;
+  }
+  // Sequence numbers in the window are consecutive
+  auto i = static_cast<std::size_t>(seq_no - in_flight_.front().seq_no);
+  return i < in_flight_.size() ? &in_flight_[i] : nullptr;
+}
+
+std::vector<std::string> replica_chain_client::take_response(request &req) {
+  auto ret = std::move(req.response);
+  req.received = true;
+  while (!in_flight_.empty() && in_flight_.front().received) {
+    in_flight_.pop_front();
   }
-  seq_.client_seq_no++;
-  in_flight_ = false;
-  accessor_ = false;
   return ret;
 }
 
@@ -105,8 +179,7 @@ std::vector<std::string> replica_chain_client::run_command(const std::vector<std
   bool retry = false;
   while (response.empty()) {
     try {
-      send_command(args);
-      response = recv_response();
+      response = recv_response(send_command(args));
       if (retry && response[0] == "!duplicate_key") { // TODO: This is hash table specific logic
         response[0] = "!ok";
       }
@@ -117,6 +190,9 @@ std::vector<std::string> replica_chain_client::run_command(const std::vector<std
         LOG(log_level::info) << x;
       connect(fs_->resolve_failures(path_, chain_), timeout_ms_);
       retry = true;
+    } catch (std::length_error &e) {
+      // The window is full of asynchronous requests, whose owners must receive them first
+      throw;
     } catch (std::logic_error &e) { // TODO: This is very iffy, we need to fix this
       response.clear();
       response.emplace_back("!block_moved");
@@ -130,8 +206,30 @@ std::vector<std::string> replica_chain_client::run_command_redirected(const std:
   auto args_copy = args;
   if (args_copy.back() != "!redirected")
     args_copy.emplace_back("!redirected");
-  send_command(args_copy);
-  return recv_response();
+  return recv_response(send_command(args_copy));
+}
+
+int64_t replica_chain_client::send_batch(const std::vector<std::vector<std::string>> &cmds) {
+  auto seq_no = send_command(batch_frame::encode(cmds, OPS_));
+  in_flight_.back().batch_count = cmds.size();
+  return seq_no;
+}
+
+std::vector<std::vector<std::string>> replica_chain_client::recv_batch() {
+  if (in_flight_.empty()) {
+    throw std::logic_error("SEQ: No request in flight");
+  }
+  return recv_batch(in_flight_.front().seq_no);
+}
+
+std::vector<std::vector<std::string>> replica_chain_client::recv_batch(int64_t seq_no) {
+  auto req = find_request(seq_no);
+  auto count = req != nullptr ? req->batch_count : 0;
+  return batch_frame::decode_responses(recv_response(seq_no), count);
+}
+
+std::vector<std::vector<std::string>> replica_chain_client::run_batch(const std::vector<std::vector<std::string>> &cmds) {
+  return batch_frame::decode_responses(run_command(batch_frame::encode(cmds, OPS_)), cmds.size());
 }
 
 void replica_chain_client::set_chain_name_metadata(std::string &name, std::string &metadata) {
@@ -1,7 +1,9 @@
 #ifndef JIFFY_REPLICA_CHAIN_CLIENT_H
 #define JIFFY_REPLICA_CHAIN_CLIENT_H
 
+#include <deque>
 #include <map>
+#include <set>
 #include "block_client.h"
 #include "jiffy/directory/client/directory_client.h"
 #include "jiffy/storage/command.h"
@@ -9,7 +11,14 @@
 namespace jiffy {
 namespace storage {
 
-/* Replica chain client class */
+// Default maximum number of requests a replica chain client keeps in flight
+constexpr std::size_t REPLICA_CHAIN_MAX_IN_FLIGHT = 64;
+
+/* Replica chain client class
+ * Mutators are sent to the head and accessors to the tail, each tagged with
+ * the next client sequence number; the tail responds to both on the response
+ * stream of its connection, so that up to a window of requests can be in
+ * flight and complete out of order, matched by sequence number. */
 class replica_chain_client {
  public:
   typedef block_client *client_ref;
@@ -19,13 +28,15 @@ class replica_chain_client {
    * @param path File path
    * @param chain Directory replica chain
    * @param timeout_ms Timeout
+   * @param max_in_flight Maximum number of requests in flight
    */
 
   explicit replica_chain_client(std::shared_ptr<directory::directory_interface> fs,
                                 const std::string &path,
                                 const directory::replica_chain &chain,
                                 const command_map &OPS,
-                                int timeout_ms = 1000);
+                                int timeout_ms = 1000,
+                                std::size_t max_in_flight = REPLICA_CHAIN_MAX_IN_FLIGHT);
 
   /**
    * @brief Destructor
@@ -47,25 +58,77 @@ class replica_chain_client {
 
   bool is_connected() const;
 
+  /**
+   * @brief Fetch number of requests in flight
+   * @return Number of requests from the oldest one whose response was not received yet
+   */
+  std::size_t in_flight() const;
+
+  /**
+   * @brief Fetch maximum number of requests in flight
+   * @return Maximum number of requests in flight
+   */
+  std::size_t max_in_flight() const;
+
+  /**
+   * @brief Fetch time out
+   * @return Time out in milliseconds, 0 if none
+   */
+  int timeout_ms() const;
+
+  /**
+   * @brief Fetch file descriptor responses arrive on, to wait for them without blocking in a receive
+   * @return File descriptor, or -1 if not connected
+   */
+  int response_fd() const;
+
+  /**
+   * @brief Check if the response of a request in flight has arrived
+   * @param seq_no Client sequence number of the request
+   * @return Bool value, true if recv_response(seq_no) returns without waiting
+   */
+  bool has_response(int64_t seq_no);
+
+  /**
+   * @brief Receive one response, of whichever request in flight it belongs to
+   */
+  void read_response();
+
+  /**
+   * @brief Give up on a request in flight, freeing its place in the window
+   * Its response, if it arrives later, is dropped.
+   * @param seq_no Client sequence number of the request
+   */
+  void abandon(int64_t seq_no);
+
   /**
    * @brief Send out command
    * For each command, we either save tail block client or
    * head block client into command client, so we can use
    * command identifier to locate the right block
    * @param args Command arguments
+   * @return Client sequence number of the request
    */
-  void send_command(const std::vector<std::string> &args);
+  int64_t send_command(const std::vector<std::string> &args);
 
   /**
-   * @brief Receive response of command
-   * Check whether response equals client sequence number
+   * @brief Receive response of the oldest request in flight
    * @return Response
    */
   std::vector<std::string> recv_response();
 
+  /**
+   * @brief Receive response of a request in flight
+   * Responses of other requests arriving first are kept until they are received
+   * @param seq_no Client sequence number of the request
+   * @return Response
+   */
+  std::vector<std::string> recv_response(int64_t seq_no);
+
   /**
    * @brief Run command, first send command to the correct block(head or tail)
    * Then receive the response
+   * Throws std::length_error if the window is full of requests in flight.
    * @param cmd_id Command identifier
    * @param args Command argument
    * @return Response of the command
@@ -81,6 +144,33 @@ class replica_chain_client {
 
   std::vector<std::string> run_command_redirected(const std::vector<std::string> &args);
 
+  /**
+   * @brief Send out commands as a single batch frame
+   * @param cmds Commands
+   * @return Client sequence number of the batch frame
+   */
+  int64_t send_batch(const std::vector<std::vector<std::string>> &cmds);
+
+  /**
+   * @brief Receive responses of the commands in the oldest batch frame in flight
+   * @return Responses, in command order
+   */
+  std::vector<std::vector<std::string>> recv_batch();
+
+  /**
+   * @brief Receive responses of the commands in a batch frame in flight
+   * @param seq_no Client sequence number of the batch frame
+   * @return Responses, in command order
+   */
+  std::vector<std::vector<std::string>> recv_batch(int64_t seq_no);
+
+  /**
+   * @brief Run commands as a single batch frame, executed back-to-back by the partition
+   * @param cmds Commands
+   * @return Responses, in command order
+   */
+  std::vector<std::vector<std::string>> run_batch(const std::vector<std::vector<std::string>> &cmds);
+
   /**
    * @brief Set replica chain name and metadata
    * @param name Replica chain name
@@ -102,6 +192,37 @@ class replica_chain_client {
    */
 
   void disconnect();
+
+  /* Request in flight */
+  struct request {
+    /* Client sequence number */
+    int64_t seq_no;
+    /* Bool value, true if the command is an accessor */
+    bool accessor;
+    /* Number of commands if the request is a batch frame */
+    std::size_t batch_count;
+    /* Bool value, true if the response has arrived */
+    bool done;
+    /* Bool value, true if the response has been handed out */
+    bool received;
+    /* Response */
+    std::vector<std::string> response;
+  };
+
+  /**
+   * @brief Find a request in flight
+   * @param seq_no Client sequence number
+   * @return Request, or null if the request is not in flight
+   */
+  request *find_request(int64_t seq_no);
+
+  /**
+   * @brief Hand out the response of a request and retire received requests at the front of the window
+   * @param req Request whose response has arrived
+   * @return Response
+   */
+  std::vector<std::string> take_response(request &req);
+
   /* Directory client */
   std::shared_ptr<directory::directory_interface> fs_;
   /* File path */
@@ -119,16 +240,16 @@ class replica_chain_client {
   block_client::command_response_reader response_reader_;
   /* Clients for each commands */
   std::unordered_map<std::string, client_ref> cmd_client_;
-  /* Bool value, true if request is in flight */
-  bool in_flight_;
+  /* Requests in flight, in sequence number order */
+  std::deque<request> in_flight_;
+  /* Abandoned requests whose response has not arrived yet */
+  std::set<int64_t> abandoned_;
+  /* Maximum number of requests in flight */
+  std::size_t max_in_flight_;
   /* Time out */
   int timeout_ms_;
   /* Operations for the data structure */
   command_map OPS_;
-  /* Bool indicating if the command is accessor type */
-  bool accessor_;
-  /* Bool indicating if send run command throws an exception */
-  bool send_run_command_exception_;
 };
 
 }
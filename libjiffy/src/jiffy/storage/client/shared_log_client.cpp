@@ -36,21 +36,11 @@ shared_log_client::shared_log_client(std::shared_ptr<directory::directory_interf
 }
 
 int shared_log_client::scan(std::vector<std::string> &buf, const std::string &start_pos, const std::string &end_pos, const std::vector<std::string> &logical_streams) {
-  // Parallel scan here
-  std::size_t start_partition = 0;
-  std::size_t count = 0;
-  while (start_partition + count < blocks_.size()) {
-    std::vector<std::string>
-        args{"scan", start_pos, end_pos};
-    for (std::size_t i = 0; i < logical_streams.size(); i++) {
-      args.push_back(logical_streams[i]);
-    }
-    blocks_[start_partition+count]->send_command(args);
-    count++;
-  }
+  std::vector<std::pair<std::shared_ptr<replica_chain_client>, int64_t>> sent;
+  send_scans(sent, start_pos, end_pos, logical_streams);
   auto previous_size = buf.size();
-  for (std::size_t k = 0; k < count; k++) {
-    std::vector<std::string> resp = blocks_[start_partition + k]->recv_response();
+  for (const auto &s: sent) {
+    std::vector<std::string> resp = s.first->recv_response(s.second);
     for (std::size_t i = 1; i < resp.size(); i++) {
       buf.push_back(resp[i]);
     }
@@ -59,7 +49,69 @@ int shared_log_client::scan(std::vector<std::string> &buf, const std::string &st
   return static_cast<int>(after_size - previous_size);
 }
 
+async_result<std::vector<std::string>> shared_log_client::scan_async(const std::string &start_pos,
+                                                                     const std::string &end_pos,
+                                                                     const std::vector<std::string> &logical_streams) {
+  std::vector<std::pair<std::shared_ptr<replica_chain_client>, int64_t>> sent;
+  send_scans(sent, start_pos, end_pos, logical_streams);
+  return gather_async<std::vector<std::string>>(sent, [](std::vector<std::vector<std::string>> &responses) {
+    std::vector<std::string> buf;
+    for (auto &resp: responses) {
+      THROW_IF_NOT_OK(resp);
+      buf.insert(buf.end(), std::make_move_iterator(resp.begin() + 1), std::make_move_iterator(resp.end()));
+    }
+    return buf;
+  });
+}
+
+void shared_log_client::send_scans(std::vector<std::pair<std::shared_ptr<replica_chain_client>, int64_t>> &sent,
+                                   const std::string &start_pos,
+                                   const std::string &end_pos,
+                                   const std::vector<std::string> &logical_streams) {
+  // Parallel scan here
+  for (const auto &block: blocks_) {
+    std::vector<std::string>
+        args{"scan", start_pos, end_pos};
+    for (std::size_t i = 0; i < logical_streams.size(); i++) {
+      args.push_back(logical_streams[i]);
+    }
+    sent.emplace_back(block, send_async(block, args));
+  }
+}
+
 int shared_log_client::write(const std::string &position, const std::string &data_, const std::vector<std::string> &logical_streams) {
+  std::vector<std::pair<std::shared_ptr<replica_chain_client>, int64_t>> sent;
+  auto ret = send_writes(sent, position, data_, logical_streams);
+  if (ret < 0)
+    return ret;
+  for (const auto &s: sent) {
+    s.first->recv_response(s.second);
+  }
+  return ret;
+}
+
+async_result<int> shared_log_client::write_async(const std::string &position,
+                                                 const std::string &data_,
+                                                 const std::vector<std::string> &logical_streams) {
+  std::vector<std::pair<std::shared_ptr<replica_chain_client>, int64_t>> sent;
+  auto ret = send_writes(sent, position, data_, logical_streams);
+  if (ret < 0) {
+    async_result<int> result;
+    result.set_value(ret);
+    return result;
+  }
+  return gather_async<int>(sent, [ret](std::vector<std::vector<std::string>> &responses) {
+    for (const auto &resp: responses) {
+      THROW_IF_NOT_OK(resp);
+    }
+    return ret;
+  });
+}
+
+int shared_log_client::send_writes(std::vector<std::pair<std::shared_ptr<replica_chain_client>, int64_t>> &sent,
+                                   const std::string &position,
+                                   const std::string &data_,
+                                   const std::vector<std::string> &logical_streams) {
   std::size_t file_size = (last_partition_ + 1) * block_size_;
   std::vector<std::string> _return;
 
@@ -118,11 +170,8 @@ int shared_log_client::write(const std::string &position, const std::string &dat
   }
   // Parallel write
   std::size_t remaining_data = data.size();
-  std::size_t start_partition = block_id();
-  std::size_t count = 0;
 
   while (remaining_data > 0) {
-    count++;
     if (data.size() > block_size_ - cur_offset_) {
       cur_offset_ = 0;
       cur_partition_++;
@@ -133,17 +182,13 @@ int shared_log_client::write(const std::string &position, const std::string &dat
     for (std::size_t i = 0; i < logical_streams.size(); i++) {
       args.push_back(logical_streams[i]);
     }
-    blocks_[block_id()]->send_command(args);
+    auto block = blocks_[block_id()];
+    sent.emplace_back(block, send_async(block, args));
     remaining_data -= data.size();
     cur_offset_ += data.size();
     update_last_offset();
   }
-
-  for (std::size_t i = 0; i < count; i++) {
-    blocks_[start_partition + i]->recv_response();
-  }
-  return data.size();
-
+  return static_cast<int>(data.size());
 }
 
 bool shared_log_client::trim(const std::string &start_pos, const std::string &end_pos) {
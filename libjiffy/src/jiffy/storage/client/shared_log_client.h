@@ -50,6 +50,28 @@ class shared_log_client : public data_structure_client {
    */
   int write(const std::string &position, const std::string &data_, const std::vector<std::string> &logical_streams);
 
+  /**
+   * @brief Scan shared_log asynchronously
+   * @param start_pos Start position
+   * @param end_pos End position
+   * @param logical_streams Logical streams
+   * @return Result, the entries scanned
+   */
+  async_result<std::vector<std::string>> scan_async(const std::string &start_pos,
+                                                    const std::string &end_pos,
+                                                    const std::vector<std::string> &logical_streams);
+
+  /**
+   * @brief Write data to shared_log asynchronously; the write position moves right away
+   * @param position Position
+   * @param data_ Data
+   * @param logical_streams Logical streams
+   * @return Result, the number of bytes written, or -1 if blocks are insufficient
+   */
+  async_result<int> write_async(const std::string &position,
+                                const std::string &data_,
+                                const std::vector<std::string> &logical_streams);
+
   /**
    * @brief Seek to a location of the shared_log
    * @param offset shared_log offset to seek
@@ -74,6 +96,31 @@ class shared_log_client : public data_structure_client {
    */
   bool need_chain() const;
 
+  /**
+   * @brief Send a scan to every partition
+   * @param sent Replica chain clients and client sequence numbers of the scans sent
+   * @param start_pos Start position
+   * @param end_pos End position
+   * @param logical_streams Logical streams
+   */
+  void send_scans(std::vector<std::pair<std::shared_ptr<replica_chain_client>, int64_t>> &sent,
+                  const std::string &start_pos,
+                  const std::string &end_pos,
+                  const std::vector<std::string> &logical_streams);
+
+  /**
+   * @brief Send the writes of a shared_log write, allocating blocks and moving the write position
+   * @param sent Replica chain clients and client sequence numbers of the writes sent
+   * @param position Position
+   * @param data_ Data
+   * @param logical_streams Logical streams
+   * @return Number of bytes written, or -1 if blocks are insufficient
+   */
+  int send_writes(std::vector<std::pair<std::shared_ptr<replica_chain_client>, int64_t>> &sent,
+                  const std::string &position,
+                  const std::string &data_,
+                  const std::vector<std::string> &logical_streams);
+
   /**
    * @brief Fetch block identifier for specified operation
    * @param op Operation
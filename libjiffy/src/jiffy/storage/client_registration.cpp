@@ -0,0 +1,14 @@
+#include "client_registration.h"
+
+namespace jiffy {
+namespace storage {
+
+const std::string client_registration::REGISTER = "!register";
+const std::string client_registration::UNREGISTER = "!unregister";
+
+bool client_registration::is_registration(const std::vector<std::string> &args) {
+  return args.size() == 1 && (args.front() == REGISTER || args.front() == UNREGISTER);
+}
+
+}
+}
@@ -0,0 +1,38 @@
+#ifndef JIFFY_CLIENT_REGISTRATION_H
+#define JIFFY_CLIENT_REGISTRATION_H
+
+#include <string>
+#include <vector>
+
+namespace jiffy {
+namespace storage {
+
+/**
+ * @brief Registration of response clients, carried as commands.
+ *
+ * Clients sharing a connection register with a block by sending a command
+ * request instead of the two-way register call, so that the registration
+ * is acknowledged through the response stream rather than interleaved with
+ * it. The server answers a registration with "!ok" followed by the client
+ * identifier it assigned, addressed to the sequence identifier of the
+ * request; an unregistration is not answered.
+ */
+class client_registration {
+ public:
+  /* Name of the command registering a client with a block */
+  static const std::string REGISTER;
+  /* Name of the command removing the registration of a client */
+  static const std::string UNREGISTER;
+
+  /**
+   * @brief Check if command is a registration command
+   * @param args Command arguments
+   * @return Bool value, true if command registers or unregisters a client
+   */
+  static bool is_registration(const std::vector<std::string> &args);
+};
+
+}
+}
+
+#endif //JIFFY_CLIENT_REGISTRATION_H
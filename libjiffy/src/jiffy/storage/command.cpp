@@ -1,4 +1,5 @@
 #include "command.h"
+#include <stdexcept>
 
 namespace jiffy {
 namespace storage {
@@ -11,5 +12,45 @@ bool command_info::is_mutator() const {
   return type == command_type::mutator;
 }
 
+std::string command_codec::opcode(uint32_t id) {
+  std::string cmd(5, '\0');
+  for (std::size_t i = 0; i < 4; ++i) {
+    cmd[i + 1] = static_cast<char>((id >> (8 * i)) & 0xFF);
+  }
+  return cmd;
+}
+
+bool command_codec::is_opcode(const std::string &cmd) {
+  return cmd.size() == 5 && cmd[0] == '\0';
+}
+
+uint32_t command_codec::opcode_id(const std::string &cmd) {
+  uint32_t id = 0;
+  for (std::size_t i = 0; i < 4; ++i) {
+    id |= static_cast<uint32_t>(static_cast<uint8_t>(cmd[i + 1])) << (8 * i);
+  }
+  return id;
+}
+
+std::string command_codec::encode_int(int64_t value) {
+  auto v = static_cast<uint64_t>(value);
+  std::string arg(8, '\0');
+  for (std::size_t i = 0; i < 8; ++i) {
+    arg[i] = static_cast<char>((v >> (8 * i)) & 0xFF);
+  }
+  return arg;
+}
+
+int64_t command_codec::decode_int(const std::string &arg) {
+  if (arg.size() != 8) {
+    throw std::invalid_argument("Malformed integer argument");
+  }
+  uint64_t v = 0;
+  for (std::size_t i = 0; i < 8; ++i) {
+    v |= static_cast<uint64_t>(static_cast<uint8_t>(arg[i])) << (8 * i);
+  }
+  return static_cast<int64_t>(v);
+}
+
 }
 }
\ No newline at end of file
@@ -41,6 +41,51 @@ struct command_info {
 
 typedef std::unordered_map<std::string, command_info> command_map;
 
+/**
+ * Compact command encoding (protocol v2)
+ * The command name is replaced by an opcode: a zero byte followed by the
+ * command identifier as a 32 bit little endian integer. Numeric arguments of
+ * such commands travel as 64 bit little endian integers instead of decimal
+ * strings. Commands named by string keep their string arguments.
+ */
+class command_codec {
+ public:
+  /**
+   * @brief Encode command identifier as opcode
+   * @param id Command identifier
+   * @return Opcode
+   */
+  static std::string opcode(uint32_t id);
+
+  /**
+   * @brief Check if command is an opcode
+   * @param cmd Command name or opcode
+   * @return Bool value, true if command is an opcode
+   */
+  static bool is_opcode(const std::string &cmd);
+
+  /**
+   * @brief Decode command identifier from opcode
+   * @param cmd Opcode
+   * @return Command identifier
+   */
+  static uint32_t opcode_id(const std::string &cmd);
+
+  /**
+   * @brief Encode numeric argument
+   * @param value Value
+   * @return Encoded argument
+   */
+  static std::string encode_int(int64_t value);
+
+  /**
+   * @brief Decode numeric argument
+   * @param arg Encoded argument
+   * @return Value
+   */
+  static int64_t decode_int(const std::string &arg);
+};
+
 }
 
 }
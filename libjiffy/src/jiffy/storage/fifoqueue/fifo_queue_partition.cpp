@@ -105,7 +105,7 @@ void fifo_queue_partition::dequeue(response &_return, const arg_list &args) {
     update_read_head();
     update_read_head_index();
     dequeue_data_size_ += ret.second.size();
-    RETURN_OK(ret.second);
+    RETURN_OK(std::move(ret.second));
   }
   if (ret.second == "!not_available") {
     RETURN_ERR("!msg_not_found");
@@ -241,7 +241,7 @@ void fifo_queue_partition::read_next(response &_return, const arg_list &args) {
   if (ret.first) {
     read_head_ += (string_array::METADATA_LEN + ret.second.size());
     read_head_index_ += 1;
-    RETURN_OK(ret.second);
+    RETURN_OK(std::move(ret.second));
   }
   if (ret.second == "!not_available") {
     RETURN_ERR("!msg_not_found");
@@ -323,7 +323,7 @@ void fifo_queue_partition::length(response &_return, const arg_list &args) {
   if (!(args.size() == 2 || (args.size() == 3 && args[2] == "!redirected"))) {
     RETURN_ERR("!args_error");
   }
-  switch (std::stoi(args[1])) {
+  switch (int_arg(args, 1)) {
     case fifo_queue_size_type::head_size:
       if (overload() && enqueue_redirected_) {
         RETURN_ERR("!redirected_length", next_target_str_);
@@ -372,7 +372,7 @@ void fifo_queue_partition::front(response &_return, const arg_list &args) {
   }
   auto ret = partition_.at(head_);
   if (ret.first) {
-    RETURN_OK(ret.second);
+    RETURN_OK(std::move(ret.second));
   }
   if (ret.second == "!not_available") {
     RETURN_ERR("!msg_not_found");
@@ -388,9 +388,9 @@ void fifo_queue_partition::front(response &_return, const arg_list &args) {
 }
 
 void fifo_queue_partition::run_command(response &_return, const arg_list &args) {
-  auto cmd_name = args[0];
+  auto cmd_id = command_id(args[0]);
   update_rate();
-  switch (command_id(cmd_name)) {
+  switch (cmd_id) {
     case fifo_queue_cmd_id::fq_enqueue:enqueue(_return, args);
       break;
     case fifo_queue_cmd_id::fq_dequeue:dequeue(_return, args);
@@ -420,10 +420,11 @@ void fifo_queue_partition::run_command(response &_return, const arg_list &args)
       return;
     }
   }
-  if (is_mutator(cmd_name)) {
+  bool mutator = is_mutator(cmd_id);
+  if (mutator) {
     dirty_ = true;
   }
-  if (auto_scale_ && is_mutator(cmd_name) && overload() && is_tail() && !scaling_up_ && !scaling_down_) {
+  if (auto_scale_ && mutator && overload() && is_tail() && !scaling_up_ && !scaling_down_) {
     LOG(log_level::info) << "Overloaded partition: " << name() << " storage = " << storage_size() << " capacity = "
                          << storage_capacity() << " partition size = " << size() << "partition capacity "
                          << partition_.capacity();
@@ -440,7 +441,7 @@ void fifo_queue_partition::run_command(response &_return, const arg_list &args)
       LOG(log_level::warn) << "Adding new message queue partition failed: " << e.what();
     }
   }
-  if (auto_scale_ && cmd_name == "dequeue" && underload() && is_tail() && !scaling_down_
+  if (auto_scale_ && cmd_id == fifo_queue_cmd_id::fq_dequeue && underload() && is_tail() && !scaling_down_
       && dequeue_redirected_ && !next_target_str_.empty()) {
     try {
       LOG(log_level::info) << "Underloaded partition: " << name() << " storage = " << storage_size() << " capacity = "
@@ -5,19 +5,16 @@ namespace jiffy {
 namespace storage {
 using namespace utils;
 
-string_array::string_array(std::size_t max_size, block_memory_allocator<char> alloc) : alloc_(alloc), max_(max_size) {
-  data_ = alloc_.allocate(max_);
+string_array::string_array(std::size_t max_size, block_memory_allocator<char> alloc)
+    : max_(max_size), data_(max_size, alloc) {
   tail_ = 0;
   last_element_offset_ = 0;
   split_string_ = false;
 }
 
-string_array::~string_array() {
-  alloc_.deallocate(data_, max_);
-}
+string_array::~string_array() = default;
 
 string_array::string_array(const string_array &other) {
-  alloc_ = other.alloc_;
   max_ = other.max_;
   data_ = other.data_;
   tail_ = other.tail_;
@@ -26,7 +23,6 @@ string_array::string_array(const string_array &other) {
 }
 
 string_array &string_array::operator=(const string_array &other) {
-  alloc_ = other.alloc_;
   max_ = other.max_;
   data_ = other.data_;
   tail_ = other.tail_;
@@ -36,7 +32,7 @@ string_array &string_array::operator=(const string_array &other) {
 }
 
 bool string_array::operator==(const string_array &other) const {
-  return data_ == other.data_ && tail_ == other.tail_ && alloc_ == other.alloc_ && max_ == other.max_
+  return data_ == other.data_ && tail_ == other.tail_ && max_ == other.max_
       && last_element_offset_ == other.last_element_offset_
       && split_string_ == other.split_string_;
 }
@@ -45,12 +41,12 @@ std::pair<bool, std::string> string_array::push_back(const std::string &item) {
   auto len = item.size();
   if (len + tail_ + METADATA_LEN <= max_ && !split_string_) { // Complete item will be written
     // Write length
-    std::memcpy(data_ + tail_, (char *) &len, METADATA_LEN);
+    data_.write(tail_, (char *) &len, METADATA_LEN);
     last_element_offset_ = tail_;
     tail_ += METADATA_LEN;
 
     // Write data
-    std::memcpy(data_ + tail_, item.c_str(), len);
+    data_.write(tail_, item.data(), len);
     tail_ += len;
     return std::make_pair(true, std::string("!success"));
   } else { // Item will not be written, full item will be returned
@@ -59,19 +55,22 @@ std::pair<bool, std::string> string_array::push_back(const std::string &item) {
   }
 }
 
-const std::pair<bool, std::string> string_array::at(std::size_t offset) const {
+std::pair<bool, std::string> string_array::at(std::size_t offset) const {
   if (offset > last_element_offset_ || empty()) {
     if (split_string_)
       return std::make_pair(false, "");
     return std::make_pair(false, std::string("!not_available"));
   }
-  auto len = *((std::size_t * )(data_ + offset));
-  return std::make_pair(true, std::string(data_ + offset + METADATA_LEN, len));
+  std::size_t len;
+  data_.read(offset, (char *) &len, METADATA_LEN);
+  return std::make_pair(true, data_.read(offset + METADATA_LEN, len));
 }
 
 std::size_t string_array::find_next(std::size_t offset) const {
   if (offset >= last_element_offset_ || offset >= tail_) return 0;
-  return offset + *reinterpret_cast<size_t *>(data_ + offset) + METADATA_LEN;
+  std::size_t len;
+  data_.read(offset, (char *) &len, METADATA_LEN);
+  return offset + len + METADATA_LEN;
 }
 
 std::size_t string_array::size() const {
@@ -89,6 +88,7 @@ std::size_t string_array::capacity() {
 void string_array::clear() {
   tail_ = 0;
   last_element_offset_ = 0;
+  data_.clear();
 }
 
 bool string_array::empty() const {
@@ -7,6 +7,7 @@
 #include <map>
 #include <iterator>
 #include "jiffy/storage/block_memory_allocator.h"
+#include "jiffy/storage/types/chunked_buffer.h"
 
 namespace jiffy {
 namespace storage {
@@ -85,7 +86,7 @@ class string_array {
    * @param offset Read offset
    * @param Pair, a status boolean and the read string
    */
-  const std::pair<bool, std::string> at(std::size_t offset) const;
+  std::pair<bool, std::string> at(std::size_t offset) const;
 
   /**
    * @brief Find next string for the given offset string
@@ -113,7 +114,7 @@ class string_array {
   std::size_t capacity();
 
   /**
-   * @brief Clear the content of string array
+   * @brief Clear the content of string array, releasing its memory
    */
   void clear();
 
@@ -166,17 +167,14 @@ class string_array {
   std::size_t num_elements() const;
 
  private:
-  /* Block memory allocator */
-  block_memory_allocator<char> alloc_;
-
   /* Offset of the last element */
   std::size_t last_element_offset_;
 
   /* Maximum capacity */
   std::size_t max_{};
 
-  /* Data pointer */
-  char *data_{};
+  /* Data, committed in chunks as it is written */
+  chunked_buffer data_;
 
   /* Tail position */
   std::size_t tail_{};
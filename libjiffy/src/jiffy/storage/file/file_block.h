@@ -7,6 +7,7 @@
 #include <map>
 #include <iterator>
 #include "jiffy/storage/block_memory_allocator.h"
+#include "jiffy/storage/types/chunked_buffer.h"
 
 namespace jiffy {
 namespace storage {
@@ -80,7 +81,7 @@ class file_block {
    * @param Pair, a status boolean and the read string
    */
 
-  const std::pair<bool, std::string> read(std::size_t offset, std::size_t size) const;
+  std::pair<bool, std::string> read(std::size_t offset, std::size_t size) const;
 
   /**
    * @brief Fetch total size of the block
@@ -96,21 +97,14 @@ class file_block {
   void clear();
 
   /**
-   * @brief Fetch data pointer
-   * @return Data pointer of the block
+   * @brief Fetch number of bytes of memory committed to the block
+   * @return Committed bytes
    */
-
-  char *data() const;
+  std::size_t committed() const;
 
  private:
-  /* Block memory allocator */
-  block_memory_allocator<char> alloc_;
-
-  /* Maximum capacity */
-  std::size_t max_{};
-
-  /* Data pointer */
-  char *data_{};
+  /* Data, committed in chunks as it is written */
+  chunked_buffer data_;
 };
 
 }
@@ -40,20 +40,20 @@ void file_partition::write(response &_return, const arg_list &args) {
   if (args.size() != 5 && args.size() != 3) {
     RETURN_ERR("!args_error");
   }
-  auto off = std::stoi(args[2]);
+  auto off = static_cast<int>(int_arg(args, 2));
   auto ret = partition_.write(args[1], off);
   if (!ret.first) {
     throw std::logic_error("Write failed");
   }
   if (args.size() == 5) {
-    int cache_block_size = std::stoi(args[3]);
-    int last_offset = std::stoi(args[4]) + args[1].size();
+    int cache_block_size = static_cast<int>(int_arg(args, 3));
+    int last_offset = static_cast<int>(int_arg(args, 4) + args[1].size());
     int start_offset = (int(off)) / cache_block_size * cache_block_size;
     int end_offset = (int(off) + args[1].size() - 1) / cache_block_size * cache_block_size;
     int num_of_blocks = (end_offset - start_offset) / cache_block_size + 1;
     auto full_block_data = partition_.read(static_cast<std::size_t>(start_offset), static_cast<std::size_t>(std::min(last_offset - start_offset, cache_block_size * num_of_blocks)));
     if (full_block_data.first) {
-      RETURN_OK(full_block_data.second);
+      RETURN_OK(std::move(full_block_data.second));
     }
   }
   RETURN_OK();
@@ -64,12 +64,12 @@ void file_partition::read(response &_return, const arg_list &args) {
   if (args.size() != 3) {
     RETURN_ERR("!args_error");
   }
-  auto pos = std::stoi(args[1]);
-  auto size = std::stoi(args[2]);
+  auto pos = static_cast<int>(int_arg(args, 1));
+  auto size = static_cast<int>(int_arg(args, 2));
   if (pos < 0) throw std::invalid_argument("read position invalid");
   auto ret = partition_.read(static_cast<std::size_t>(pos), static_cast<std::size_t>(size));
   if (ret.first) {
-    RETURN_OK(ret.second);
+    RETURN_OK(std::move(ret.second));
   }
 
 }
@@ -79,7 +79,7 @@ void file_partition::write_ls(response &_return, const arg_list &args) {
     RETURN_ERR("!args_error");
   }
   std::string file_path, data;
-  int pos = std::stoi(args[2]);
+  int pos = static_cast<int>(int_arg(args, 2));
   file_path = directory_utils::remove_uri(backing_path());
   directory_utils::push_path_element(file_path,name());
   std::ofstream out(file_path,std::ios::in|std::ios::out);
@@ -89,8 +89,8 @@ void file_partition::write_ls(response &_return, const arg_list &args) {
     out << data;
     out.close();
     if (args.size() == 5) {
-      int cache_block_size = std::stoi(args[3]);
-      int last_offset = std::stoi(args[4]) + args[1].size();
+      int cache_block_size = static_cast<int>(int_arg(args, 3));
+      int last_offset = static_cast<int>(int_arg(args, 4) + args[1].size());
       int start_offset = (int(pos)) / cache_block_size * cache_block_size;
       int end_offset = (int(pos) + args[1].size() - 1) / cache_block_size * cache_block_size;
       int num_of_blocks = (end_offset - start_offset) / cache_block_size + 1;
@@ -118,8 +118,8 @@ void file_partition::read_ls(response &_return, const arg_list &args) {
     RETURN_ERR("!args_error");
   }
   std::string file_path, ret_str;
-  auto pos = std::stoi(args[1]);
-  auto size = std::stoi(args[2]);
+  auto pos = static_cast<int>(int_arg(args, 1));
+  auto size = static_cast<int>(int_arg(args, 2));
   file_path = directory_utils::remove_uri(backing_path());
   directory_utils::push_path_element(file_path,name());
   std::ifstream in(file_path,std::ios::in);
@@ -189,8 +189,8 @@ void file_partition::get_storage_capacity(response &_return, const arg_list &arg
 }
 
 void file_partition::run_command(response &_return, const arg_list &args) {
-  auto cmd_name = args[0];
-  switch (command_id(cmd_name)) {
+  auto cmd_id = command_id(args[0]);
+  switch (cmd_id) {
     case file_cmd_id::file_write:write(_return, args);
       break;
     case file_cmd_id::file_read:read(_return, args);
@@ -212,7 +212,8 @@ void file_partition::run_command(response &_return, const arg_list &args) {
       return;
     }
   }
-  if (is_mutator(cmd_name)) {
+  bool mutator = is_mutator(cmd_id);
+  if (mutator) {
     dirty_ = true;
   }
 }
@@ -263,7 +264,7 @@ bool file_partition::dump(const std::string &path) {
 
 void file_partition::forward_all() {
   std::vector<std::string> result;
-  run_command_on_next(result, {"write", std::string(partition_.data(), partition_.size())});
+  run_command_on_next(result, {"write", partition_.read(0, partition_.size()).second});
 }
 
 REGISTER_IMPLEMENTATION("file", file_partition);
@@ -0,0 +1,757 @@
+#ifndef JIFFY_FLAT_HASH_MAP_H
+#define JIFFY_FLAT_HASH_MAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace jiffy {
+namespace storage {
+namespace detail {
+
+/* Control byte; full slots hold the low 7 bits of the key hash, other states are negative */
+typedef int8_t ctrl_t;
+
+constexpr ctrl_t CTRL_EMPTY = -128;
+constexpr ctrl_t CTRL_DELETED = -2;
+
+/* Group of control bytes probed together */
+class probe_group {
+ public:
+  static constexpr std::size_t WIDTH = 16;
+
+  /**
+   * @brief Load WIDTH control bytes starting at ctrl
+   * @param ctrl Control bytes
+   */
+  explicit probe_group(const ctrl_t *ctrl) {
+#if defined(__SSE2__)
+    ctrl_ = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl));
+#else
+    std::memcpy(ctrl_, ctrl, WIDTH);
+#endif
+  }
+
+  /**
+   * @brief Fetch bit mask of slots whose control byte equals h2
+   * @param h2 Control byte to match
+   * @return Bit mask, bit i set if slot i matches
+   */
+  uint32_t match(ctrl_t h2) const {
+#if defined(__SSE2__)
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_)));
+#else
+    uint32_t mask = 0;
+    for (std::size_t i = 0; i < WIDTH; ++i) {
+      if (ctrl_[i] == h2)
+        mask |= 1U << i;
+    }
+    return mask;
+#endif
+  }
+
+  /**
+   * @brief Fetch bit mask of empty slots
+   * @return Bit mask, bit i set if slot i is empty
+   */
+  uint32_t match_empty() const {
+    return match(CTRL_EMPTY);
+  }
+
+  /**
+   * @brief Fetch bit mask of empty or deleted slots
+   * @return Bit mask, bit i set if slot i can take a new entry
+   */
+  uint32_t match_empty_or_deleted() const {
+#if defined(__SSE2__)
+    return static_cast<uint32_t>(_mm_movemask_epi8(ctrl_));
+#else
+    uint32_t mask = 0;
+    for (std::size_t i = 0; i < WIDTH; ++i) {
+      if (ctrl_[i] < 0)
+        mask |= 1U << i;
+    }
+    return mask;
+#endif
+  }
+
+ private:
+#if defined(__SSE2__)
+  __m128i ctrl_;
+#else
+  ctrl_t ctrl_[WIDTH];
+#endif
+};
+
+inline uint32_t trailing_zeros(uint32_t mask) {
+  return static_cast<uint32_t>(__builtin_ctz(mask));
+}
+
+inline uint32_t leading_zeros(uint32_t mask) {
+  return static_cast<uint32_t>(__builtin_clz(mask)) - (32 - probe_group::WIDTH);
+}
+
+}
+
+/**
+ * @brief Open addressing hash map with one control byte per slot.
+ *
+ * Slots and control bytes live in a single flat allocation obtained from the
+ * supplied allocator. A lookup compares 16 control bytes at a time (SSE2 when
+ * available) against 7 bits of the key hash and only touches the slots that
+ * match, so most lookups read one control group and one slot.
+ *
+ * Growing does not move every entry at once. The old slots are kept next to
+ * the new ones and each insert or erase moves the entries of the next
+ * MIGRATE_SLOTS old slots, so no single operation pays for the whole rehash.
+ * Lookups check the new slots first and then the old ones until the move is
+ * complete. Moving an entry moves its key and value objects, so pointers to
+ * entries are only stable between inserts and erases.
+ *
+ * Lookups are heterogeneous: any key type accepted by Hash and KeyEqual
+ * (e.g. std::string for binary keys) may be passed to find/erase/count.
+ * Keys must not be modified through iterators.
+ */
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+class flat_hash_map {
+ public:
+  typedef Key key_type;
+  typedef Value mapped_type;
+  typedef std::pair<Key, Value> value_type;
+  typedef std::size_t size_type;
+  typedef Hash hasher;
+  typedef KeyEqual key_equal;
+  typedef Allocator allocator_type;
+
+  template<bool IsConst>
+  class iterator_base {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef typename flat_hash_map::value_type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef typename std::conditional<IsConst, const value_type *, value_type *>::type pointer;
+    typedef typename std::conditional<IsConst, const value_type &, value_type &>::type reference;
+
+    iterator_base()
+        : ctrl_(nullptr), end_(nullptr), slot_(nullptr), next_ctrl_(nullptr), next_end_(nullptr), next_slot_(nullptr) {}
+
+    template<bool C = IsConst, typename = typename std::enable_if<C>::type>
+    iterator_base(const iterator_base<false> &other) // NOLINT
+        : ctrl_(other.ctrl_),
+          end_(other.end_),
+          slot_(other.slot_),
+          next_ctrl_(other.next_ctrl_),
+          next_end_(other.next_end_),
+          next_slot_(other.next_slot_) {}
+
+    reference operator*() const {
+      return *slot_;
+    }
+
+    pointer operator->() const {
+      return slot_;
+    }
+
+    iterator_base &operator++() {
+      ++ctrl_;
+      ++slot_;
+      skip_empty();
+      return *this;
+    }
+
+    iterator_base operator++(int) {
+      auto tmp = *this;
+      ++(*this);
+      return tmp;
+    }
+
+    bool operator==(const iterator_base &other) const {
+      return ctrl_ == other.ctrl_;
+    }
+
+    bool operator!=(const iterator_base &other) const {
+      return ctrl_ != other.ctrl_;
+    }
+
+   private:
+    friend class flat_hash_map;
+    template<bool> friend
+    class iterator_base;
+
+    /* Iterates [ctrl, end) and then [next_ctrl, next_end), if given */
+    iterator_base(const detail::ctrl_t *ctrl, const detail::ctrl_t *end, pointer slot,
+                  const detail::ctrl_t *next_ctrl = nullptr, const detail::ctrl_t *next_end = nullptr,
+                  pointer next_slot = nullptr)
+        : ctrl_(ctrl), end_(end), slot_(slot), next_ctrl_(next_ctrl), next_end_(next_end), next_slot_(next_slot) {
+      skip_empty();
+    }
+
+    void skip_empty() {
+      while (true) {
+        while (ctrl_ != end_ && *ctrl_ < 0) {
+          ++ctrl_;
+          ++slot_;
+        }
+        if (ctrl_ != end_ || next_ctrl_ == nullptr)
+          return;
+        ctrl_ = next_ctrl_;
+        end_ = next_end_;
+        slot_ = next_slot_;
+        next_ctrl_ = nullptr;
+        next_end_ = nullptr;
+        next_slot_ = nullptr;
+      }
+    }
+
+    const detail::ctrl_t *ctrl_;
+    const detail::ctrl_t *end_;
+    pointer slot_;
+    const detail::ctrl_t *next_ctrl_;
+    const detail::ctrl_t *next_end_;
+    pointer next_slot_;
+  };
+
+  typedef iterator_base<false> iterator;
+  typedef iterator_base<true> const_iterator;
+
+  static constexpr size_type MIN_CAPACITY = detail::probe_group::WIDTH;
+
+  /* Number of old slots moved to the new slots by each insert or erase while growing */
+  static constexpr size_type MIGRATE_SLOTS = 64;
+
+  /**
+   * @brief Constructor
+   * @param alloc Allocator for slots and control bytes
+   * @param hash Hash function
+   * @param equal Key equality function
+   */
+  explicit flat_hash_map(const allocator_type &alloc = allocator_type(),
+                         const hasher &hash = hasher(),
+                         const key_equal &equal = key_equal())
+      : ctrl_(nullptr),
+        slots_(nullptr),
+        capacity_(0),
+        size_(0),
+        deleted_(0),
+        old_ctrl_(nullptr),
+        old_slots_(nullptr),
+        old_capacity_(0),
+        old_size_(0),
+        migrate_pos_(0),
+        hasher_(hash),
+        equal_(equal),
+        alloc_(alloc) {}
+
+  flat_hash_map(const flat_hash_map &) = delete;
+
+  flat_hash_map &operator=(const flat_hash_map &) = delete;
+
+  flat_hash_map(flat_hash_map &&other) noexcept
+      : ctrl_(other.ctrl_),
+        slots_(other.slots_),
+        capacity_(other.capacity_),
+        size_(other.size_),
+        deleted_(other.deleted_),
+        old_ctrl_(other.old_ctrl_),
+        old_slots_(other.old_slots_),
+        old_capacity_(other.old_capacity_),
+        old_size_(other.old_size_),
+        migrate_pos_(other.migrate_pos_),
+        hasher_(std::move(other.hasher_)),
+        equal_(std::move(other.equal_)),
+        alloc_(other.alloc_) {
+    other.abandon();
+  }
+
+  /**
+   * @brief Destructor
+   */
+  ~flat_hash_map() {
+    clear();
+  }
+
+  iterator begin() {
+    if (old_capacity_ != 0)
+      return iterator(old_ctrl_, old_ctrl_ + old_capacity_, old_slots_, ctrl_, ctrl_ + capacity_, slots_);
+    return iterator(ctrl_, ctrl_ + capacity_, slots_);
+  }
+
+  iterator end() {
+    return iterator(ctrl_ + capacity_, ctrl_ + capacity_, slots_ + capacity_);
+  }
+
+  const_iterator begin() const {
+    if (old_capacity_ != 0)
+      return const_iterator(old_ctrl_, old_ctrl_ + old_capacity_, old_slots_, ctrl_, ctrl_ + capacity_, slots_);
+    return const_iterator(ctrl_, ctrl_ + capacity_, slots_);
+  }
+
+  const_iterator end() const {
+    return const_iterator(ctrl_ + capacity_, ctrl_ + capacity_, slots_ + capacity_);
+  }
+
+  /**
+   * @brief Fetch number of entries
+   * @return Number of entries
+   */
+  size_type size() const {
+    return size_;
+  }
+
+  /**
+   * @brief Check if map is empty
+   * @return Bool value, true if empty
+   */
+  bool empty() const {
+    return size_ == 0;
+  }
+
+  /**
+   * @brief Fetch number of slots
+   * @return Number of slots
+   */
+  size_type capacity() const {
+    return capacity_;
+  }
+
+  /**
+   * @brief Check if entries are still being moved to grown slots
+   * @return Bool value, true while old slots remain
+   */
+  bool resizing() const {
+    return old_capacity_ != 0;
+  }
+
+  /**
+   * @brief Fetch number of slot positions, old slots included while growing
+   * @return Number of slot positions
+   */
+  size_type num_slots() const {
+    return old_capacity_ + capacity_;
+  }
+
+  /**
+   * @brief Fetch iterator to the first entry at or after a slot position, so that
+   * scans can resume where they stopped. Positions number the old slots first.
+   * @param pos Slot position
+   * @return Iterator to entry, end() if no entry follows
+   */
+  iterator from_slot(size_type pos) {
+    if (pos < old_capacity_)
+      return iterator(old_ctrl_ + pos, old_ctrl_ + old_capacity_, old_slots_ + pos, ctrl_, ctrl_ + capacity_, slots_);
+    pos -= old_capacity_;
+    if (pos >= capacity_)
+      return end();
+    return iterator(ctrl_ + pos, ctrl_ + capacity_, slots_ + pos);
+  }
+
+  /**
+   * @brief Fetch slot position of an entry
+   * @param it Iterator to entry
+   * @return Slot position
+   */
+  size_type slot_position(const_iterator it) const {
+    std::less<const detail::ctrl_t *> less;
+    if (old_capacity_ != 0 && !less(it.ctrl_, old_ctrl_) && less(it.ctrl_, old_ctrl_ + old_capacity_))
+      return static_cast<size_type>(it.ctrl_ - old_ctrl_);
+    return old_capacity_ + static_cast<size_type>(it.ctrl_ - ctrl_);
+  }
+
+  /**
+   * @brief Find entry for key
+   * @param key Key
+   * @return Iterator to entry, end() if not found
+   */
+  template<typename K>
+  iterator find(const K &key) {
+    auto pos = locate(key, hasher_(key));
+    return pos.idx == NPOS ? end() : iterator_at(pos);
+  }
+
+  template<typename K>
+  const_iterator find(const K &key) const {
+    auto pos = locate(key, hasher_(key));
+    if (pos.idx == NPOS)
+      return end();
+    if (pos.old)
+      return const_iterator(old_ctrl_ + pos.idx, old_ctrl_ + old_capacity_, old_slots_ + pos.idx,
+                            ctrl_, ctrl_ + capacity_, slots_);
+    return const_iterator(ctrl_ + pos.idx, ctrl_ + capacity_, slots_ + pos.idx);
+  }
+
+  /**
+   * @brief Count entries for key
+   * @param key Key
+   * @return 1 if key exists, 0 otherwise
+   */
+  template<typename K>
+  size_type count(const K &key) const {
+    return locate(key, hasher_(key)).idx == NPOS ? 0 : 1;
+  }
+
+  /**
+   * @brief Fetch value for key
+   * @param key Key
+   * @return Value reference
+   */
+  template<typename K>
+  mapped_type &at(const K &key) {
+    auto pos = locate(key, hasher_(key));
+    if (pos.idx == NPOS)
+      throw std::out_of_range("flat_hash_map::at: key not found");
+    return (pos.old ? old_slots_ : slots_)[pos.idx].second;
+  }
+
+  template<typename K>
+  const mapped_type &at(const K &key) const {
+    auto pos = locate(key, hasher_(key));
+    if (pos.idx == NPOS)
+      throw std::out_of_range("flat_hash_map::at: key not found");
+    return (pos.old ? old_slots_ : slots_)[pos.idx].second;
+  }
+
+  /**
+   * @brief Insert key value pair if key does not exist
+   * @param kv Key value pair
+   * @return Iterator to entry and bool value, true if inserted
+   */
+  std::pair<iterator, bool> emplace(value_type &&kv) {
+    return emplace(std::move(kv.first), std::move(kv.second));
+  }
+
+  /**
+   * @brief Insert key value pair if key does not exist
+   * @param key Key
+   * @param value Value
+   * @return Iterator to entry and bool value, true if inserted
+   */
+  template<typename K, typename V>
+  std::pair<iterator, bool> emplace(K &&key, V &&value) {
+    migrate(MIGRATE_SLOTS);
+    auto hash = hasher_(key);
+    auto pos = locate(key, hash);
+    if (pos.idx != NPOS)
+      return std::make_pair(iterator_at(pos), false);
+    auto idx = prepare_insert(hash);
+    ::new(static_cast<void *>(slots_ + idx)) value_type(std::forward<K>(key), std::forward<V>(value));
+    if (ctrl_[idx] == detail::CTRL_DELETED)
+      --deleted_;
+    set_ctrl(ctrl_, capacity_, idx, h2(hash));
+    ++size_;
+    return std::make_pair(iterator_at(position{idx, false}), true);
+  }
+
+  /**
+   * @brief Remove entry for key
+   * @param key Key
+   * @return Number of entries removed
+   */
+  template<typename K>
+  size_type erase(const K &key) {
+    migrate(MIGRATE_SLOTS);
+    auto pos = locate(key, hasher_(key));
+    if (pos.idx == NPOS)
+      return 0;
+    erase_at(pos);
+    return 1;
+  }
+
+  /**
+   * @brief Remove entry at iterator
+   * @param it Iterator
+   * @return Iterator to next entry
+   */
+  iterator erase(iterator it) {
+    std::less<const detail::ctrl_t *> less;
+    bool old = old_capacity_ != 0 && !less(it.ctrl_, old_ctrl_) && less(it.ctrl_, old_ctrl_ + old_capacity_);
+    position pos{static_cast<size_type>(it.ctrl_ - (old ? old_ctrl_ : ctrl_)), old};
+    // Advance first: erasing the last entry of the old slots releases them
+    ++it;
+    erase_at(pos);
+    return it;
+  }
+
+  /**
+   * @brief Remove all entries and release slot memory
+   */
+  void clear() {
+    destroy(old_ctrl_, old_slots_, old_capacity_);
+    destroy(ctrl_, slots_, capacity_);
+    abandon();
+  }
+
+  /**
+   * @brief Forget all entries without destroying them or returning their memory.
+   * Only valid when the allocator's memory is released in bulk right after.
+   */
+  void abandon() {
+    ctrl_ = nullptr;
+    slots_ = nullptr;
+    capacity_ = 0;
+    size_ = 0;
+    deleted_ = 0;
+    old_ctrl_ = nullptr;
+    old_slots_ = nullptr;
+    old_capacity_ = 0;
+    old_size_ = 0;
+    migrate_pos_ = 0;
+  }
+
+  /**
+   * @brief Make room for at least n entries without growing, moving all entries at once
+   * @param n Number of entries
+   */
+  void reserve(size_type n) {
+    auto cap = MIN_CAPACITY;
+    while (max_load(cap) < n)
+      cap *= 2;
+    if (cap > capacity_) {
+      migrate(old_capacity_);
+      start_resize(cap);
+      migrate(old_capacity_);
+    }
+  }
+
+ private:
+  typedef typename std::allocator_traits<Allocator>::template rebind_alloc<uint8_t> byte_allocator;
+
+  static constexpr size_type NPOS = static_cast<size_type>(-1);
+  static constexpr size_type WIDTH = detail::probe_group::WIDTH;
+
+  /* Slot index, in the old slots while resizing or in the current ones */
+  struct position {
+    size_type idx;
+    bool old;
+  };
+
+  static size_type h1(size_type hash) {
+    return hash >> 7;
+  }
+
+  static detail::ctrl_t h2(size_type hash) {
+    return static_cast<detail::ctrl_t>(hash & 0x7F);
+  }
+
+  /* Maximum number of entries (including tombstones) before growing, 7/8 of capacity */
+  static size_type max_load(size_type capacity) {
+    return capacity - capacity / 8;
+  }
+
+  static size_type ctrl_bytes(size_type capacity) {
+    auto align = alignof(value_type);
+    return (capacity + WIDTH + align - 1) / align * align;
+  }
+
+  static size_type storage_bytes(size_type capacity) {
+    return ctrl_bytes(capacity) + capacity * sizeof(value_type);
+  }
+
+  iterator iterator_at(position pos) {
+    if (pos.old)
+      return iterator(old_ctrl_ + pos.idx, old_ctrl_ + old_capacity_, old_slots_ + pos.idx,
+                      ctrl_, ctrl_ + capacity_, slots_);
+    return iterator(ctrl_ + pos.idx, ctrl_ + capacity_, slots_ + pos.idx);
+  }
+
+  template<typename K>
+  position locate(const K &key, size_type hash) const {
+    auto idx = find_index(ctrl_, slots_, capacity_, key, hash);
+    if (idx != NPOS || old_capacity_ == 0)
+      return position{idx, false};
+    return position{find_index(old_ctrl_, old_slots_, old_capacity_, key, hash), true};
+  }
+
+  template<typename K>
+  size_type find_index(const detail::ctrl_t *ctrl, const value_type *slots, size_type capacity,
+                       const K &key, size_type hash) const {
+    if (capacity == 0)
+      return NPOS;
+    auto mask = capacity - 1;
+    auto tag = h2(hash);
+    auto pos = h1(hash) & mask;
+    size_type step = 0;
+    while (true) {
+      detail::probe_group g(ctrl + pos);
+      for (auto m = g.match(tag); m != 0; m &= m - 1) {
+        auto idx = (pos + detail::trailing_zeros(m)) & mask;
+        if (equal_(slots[idx].first, key))
+          return idx;
+      }
+      if (g.match_empty())
+        return NPOS;
+      step += WIDTH;
+      pos = (pos + step) & mask;
+    }
+  }
+
+  size_type find_first_non_full(size_type hash) const {
+    auto mask = capacity_ - 1;
+    auto pos = h1(hash) & mask;
+    size_type step = 0;
+    while (true) {
+      auto m = detail::probe_group(ctrl_ + pos).match_empty_or_deleted();
+      if (m)
+        return (pos + detail::trailing_zeros(m)) & mask;
+      step += WIDTH;
+      pos = (pos + step) & mask;
+    }
+  }
+
+  size_type prepare_insert(size_type hash) {
+    // Counts entries still in the old slots, so that they are guaranteed to fit once moved
+    if (size_ + deleted_ >= max_load(capacity_)) {
+      // Inserts outpaced the move; finish it before starting another
+      migrate(old_capacity_);
+      try {
+        if (capacity_ != 0 && size_ * 32 <= capacity_ * 25) {
+          // Mostly tombstones; reclaim them without growing
+          start_resize(capacity_);
+        } else {
+          start_resize(capacity_ == 0 ? MIN_CAPACITY : capacity_ * 2);
+        }
+      } catch (std::bad_alloc &) {
+        // Keep filling the current slots while at least one empty slot remains
+        if (capacity_ == 0 || size_ + deleted_ + 1 >= capacity_)
+          throw;
+      }
+    }
+    return find_first_non_full(hash);
+  }
+
+  static void set_ctrl(detail::ctrl_t *ctrl, size_type capacity, size_type idx, detail::ctrl_t c) {
+    ctrl[idx] = c;
+    if (idx < WIDTH)
+      ctrl[capacity + idx] = c;
+  }
+
+  void erase_at(position pos) {
+    --size_;
+    if (pos.old) {
+      // Old slots only drain, so tombstones there are never reused
+      old_slots_[pos.idx].~value_type();
+      set_ctrl(old_ctrl_, old_capacity_, pos.idx, detail::CTRL_DELETED);
+      if (--old_size_ == 0)
+        release_old();
+      return;
+    }
+    auto idx = pos.idx;
+    slots_[idx].~value_type();
+    // A slot can go back to empty if no probe window could have skipped past it
+    auto mask = capacity_ - 1;
+    auto empty_after = detail::probe_group(ctrl_ + idx).match_empty();
+    auto empty_before = detail::probe_group(ctrl_ + ((idx - WIDTH) & mask)).match_empty();
+    if (empty_after && empty_before
+        && detail::trailing_zeros(empty_after) + detail::leading_zeros(empty_before) < WIDTH) {
+      set_ctrl(ctrl_, capacity_, idx, detail::CTRL_EMPTY);
+    } else {
+      set_ctrl(ctrl_, capacity_, idx, detail::CTRL_DELETED);
+      ++deleted_;
+    }
+  }
+
+  /* Allocate new slots and keep the current ones as old slots to move entries from */
+  void start_resize(size_type new_capacity) {
+    auto mem = alloc_.allocate(storage_bytes(new_capacity));
+    if (size_ == 0) {
+      destroy(ctrl_, slots_, capacity_);
+    } else {
+      old_ctrl_ = ctrl_;
+      old_slots_ = slots_;
+      old_capacity_ = capacity_;
+      old_size_ = size_;
+      migrate_pos_ = 0;
+    }
+    ctrl_ = reinterpret_cast<detail::ctrl_t *>(mem);
+    slots_ = reinterpret_cast<value_type *>(mem + ctrl_bytes(new_capacity));
+    capacity_ = new_capacity;
+    deleted_ = 0;
+    std::memset(ctrl_, static_cast<uint8_t>(detail::CTRL_EMPTY), new_capacity + WIDTH);
+  }
+
+  /* Move the entries of the next n old slots to the current slots */
+  void migrate(size_type n) {
+    if (old_capacity_ == 0)
+      return;
+    auto end = std::min(old_capacity_, migrate_pos_ + n);
+    for (; migrate_pos_ < end; ++migrate_pos_) {
+      if (old_ctrl_[migrate_pos_] < 0)
+        continue;
+      auto &entry = old_slots_[migrate_pos_];
+      auto hash = hasher_(entry.first);
+      auto idx = find_first_non_full(hash);
+      ::new(static_cast<void *>(slots_ + idx)) value_type(std::move(entry));
+      entry.~value_type();
+      if (ctrl_[idx] == detail::CTRL_DELETED)
+        --deleted_;
+      set_ctrl(ctrl_, capacity_, idx, h2(hash));
+      set_ctrl(old_ctrl_, old_capacity_, migrate_pos_, detail::CTRL_DELETED);
+      --old_size_;
+    }
+    if (migrate_pos_ == old_capacity_ || old_size_ == 0)
+      release_old();
+  }
+
+  void release_old() {
+    deallocate(old_ctrl_, old_capacity_);
+    old_ctrl_ = nullptr;
+    old_slots_ = nullptr;
+    old_capacity_ = 0;
+    old_size_ = 0;
+    migrate_pos_ = 0;
+  }
+
+  /* Destroy the entries in the given slots and free them */
+  void destroy(detail::ctrl_t *ctrl, value_type *slots, size_type capacity) {
+    if (capacity == 0)
+      return;
+    for (size_type i = 0; i < capacity; ++i) {
+      if (ctrl[i] >= 0)
+        slots[i].~value_type();
+    }
+    deallocate(ctrl, capacity);
+  }
+
+  void deallocate(detail::ctrl_t *ctrl, size_type capacity) {
+    alloc_.deallocate(reinterpret_cast<uint8_t *>(ctrl), storage_bytes(capacity));
+  }
+
+  detail::ctrl_t *ctrl_;
+  value_type *slots_;
+  size_type capacity_;
+  size_type size_;
+  size_type deleted_;
+  /* Slots being drained into the current ones while resizing, null otherwise */
+  detail::ctrl_t *old_ctrl_;
+  value_type *old_slots_;
+  size_type old_capacity_;
+  /* Entries left in the old slots */
+  size_type old_size_;
+  /* Next old slot to move */
+  size_type migrate_pos_;
+  hasher hasher_;
+  key_equal equal_;
+  byte_allocator alloc_;
+};
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+constexpr typename flat_hash_map<Key, Value, Hash, KeyEqual, Allocator>::size_type
+    flat_hash_map<Key, Value, Hash, KeyEqual, Allocator>::MIN_CAPACITY;
+
+template<typename Key, typename Value, typename Hash, typename KeyEqual, typename Allocator>
+constexpr typename flat_hash_map<Key, Value, Hash, KeyEqual, Allocator>::size_type
+    flat_hash_map<Key, Value, Hash, KeyEqual, Allocator>::MIGRATE_SLOTS;
+
+}
+}
+
+#endif //JIFFY_FLAT_HASH_MAP_H
@@ -1,6 +1,12 @@
 #include <cstdint>
 #include "hash_slot.h"
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define JIFFY_CRC16_CLMUL 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
 namespace jiffy {
 namespace storage {
 
@@ -39,5 +45,140 @@ const uint16_t hash_slot::crc16tab[256] = {
     0x6e17, 0x7e36, 0x4e55, 0x5e74, 0x2e93, 0x3eb2, 0x0ed1, 0x1ef0
 };
 
+namespace {
+
+constexpr uint16_t CRC16_POLY = 0x1021;
+
+// Buffers shorter than this are hashed with table lookups, which beat the setup cost of folding
+constexpr size_t CRC16_FOLD_MIN = 64;
+
+/* Slicing tables: t[k][v] is the CRC16 of byte v followed by k zero bytes */
+struct crc16_tables {
+  uint16_t t[16][256];
+
+  constexpr crc16_tables() : t() {
+    for (int v = 0; v < 256; ++v) {
+      auto c = static_cast<uint16_t>(v << 8);
+      for (int b = 0; b < 8; ++b)
+        c = static_cast<uint16_t>((c & 0x8000) ? (c << 1) ^ CRC16_POLY : c << 1);
+      t[0][v] = c;
+    }
+    for (int k = 1; k < 16; ++k) {
+      for (int v = 0; v < 256; ++v)
+        t[k][v] = static_cast<uint16_t>((t[k - 1][v] << 8) ^ t[0][t[k - 1][v] >> 8]);
+    }
+  }
+};
+
+constexpr crc16_tables CRC16_TABLES{};
+
+#if defined(JIFFY_CRC16_CLMUL)
+
+/* x^n mod the CRC16 polynomial, for folding n bits ahead */
+constexpr uint64_t x_pow_mod(int n) {
+  uint32_t r = 1;
+  for (int i = 0; i < n; ++i) {
+    r <<= 1;
+    if (r & 0x10000)
+      r ^= 0x10000 | CRC16_POLY;
+  }
+  return r;
+}
+
+/* Load 16 bytes as a polynomial, first byte in the highest degree coefficients */
+__attribute__((target("pclmul,ssse3")))
+inline __m128i load_be(const char *p) {
+  const __m128i reverse = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+  return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)), reverse);
+}
+
+/* Multiply a 128 bit polynomial by x^n modulo the CRC16 polynomial, with k holding x^(n+64) and x^n */
+__attribute__((target("pclmul,ssse3")))
+inline __m128i fold(__m128i x, __m128i k) {
+  return _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x11), _mm_clmulepi64_si128(x, k, 0x00));
+}
+
+/* Fold 64 byte blocks into four 128 bit lanes, then reduce the remainder with the slicing tables */
+__attribute__((target("pclmul,ssse3")))
+uint16_t crc16_fold(const char *buf, size_t len) {
+  const __m128i k512 = _mm_set_epi64x(static_cast<long long>(x_pow_mod(576)), static_cast<long long>(x_pow_mod(512)));
+  const __m128i k128 = _mm_set_epi64x(static_cast<long long>(x_pow_mod(192)), static_cast<long long>(x_pow_mod(128)));
+  auto x0 = load_be(buf);
+  auto x1 = load_be(buf + 16);
+  auto x2 = load_be(buf + 32);
+  auto x3 = load_be(buf + 48);
+  buf += 64;
+  len -= 64;
+  for (; len >= 64; buf += 64, len -= 64) {
+    x0 = _mm_xor_si128(fold(x0, k512), load_be(buf));
+    x1 = _mm_xor_si128(fold(x1, k512), load_be(buf + 16));
+    x2 = _mm_xor_si128(fold(x2, k512), load_be(buf + 32));
+    x3 = _mm_xor_si128(fold(x3, k512), load_be(buf + 48));
+  }
+  auto x = _mm_xor_si128(fold(x0, k128), x1);
+  x = _mm_xor_si128(fold(x, k128), x2);
+  x = _mm_xor_si128(fold(x, k128), x3);
+  for (; len >= 16; buf += 16, len -= 16) {
+    x = _mm_xor_si128(fold(x, k128), load_be(buf));
+  }
+  // The folded lanes are congruent to the bytes consumed so far, so hashing them in order yields their CRC
+  alignas(16) char folded[16];
+  const __m128i reverse = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+  _mm_store_si128(reinterpret_cast<__m128i *>(folded), _mm_shuffle_epi8(x, reverse));
+  auto crc = hash_slot::crc16_sliced(folded, sizeof(folded));
+  return hash_slot::crc16_sliced(buf, len, crc);
+}
+
+#endif
+
+}
+
+uint16_t hash_slot::crc16(const char *buf, size_t len) {
+  if (len < CRC16_FOLD_MIN)
+    return crc16_sliced(buf, len);
+  return crc16_clmul(buf, len);
+}
+
+uint16_t hash_slot::crc16_bytewise(const char *buf, size_t len, uint16_t crc) {
+  size_t counter;
+  for (counter = 0; counter < len; counter++)
+    crc = (crc << 8) ^ crc16tab[((crc >> 8) ^ *buf++) & 0x00FF];
+  return crc;
+}
+
+uint16_t hash_slot::crc16_sliced(const char *buf, size_t len, uint16_t crc) {
+  const auto &t = CRC16_TABLES.t;
+  auto p = reinterpret_cast<const uint8_t *>(buf);
+  for (; len >= 16; p += 16, len -= 16) {
+    auto c = static_cast<uint16_t>(t[15][(crc >> 8) ^ p[0]] ^ t[14][(crc & 0xFF) ^ p[1]]);
+    for (int i = 2; i < 16; ++i)
+      c ^= t[15 - i][p[i]];
+    crc = c;
+  }
+  for (; len > 0; ++p, --len)
+    crc = static_cast<uint16_t>((crc << 8) ^ t[0][(crc >> 8) ^ *p]);
+  return crc;
+}
+
+uint16_t hash_slot::crc16_clmul(const char *buf, size_t len) {
+#if defined(JIFFY_CRC16_CLMUL)
+  static const bool supported = clmul_supported();
+  if (supported && len >= CRC16_FOLD_MIN)
+    return crc16_fold(buf, len);
+#endif
+  return crc16_sliced(buf, len);
+}
+
+bool hash_slot::clmul_supported() {
+#if defined(JIFFY_CRC16_CLMUL)
+  unsigned int eax, ebx, ecx, edx;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+    return false;
+  return (ecx & bit_PCLMUL) && (ecx & bit_SSSE3);
+#else
+  return false;
+#endif
+}
+
 }
 }
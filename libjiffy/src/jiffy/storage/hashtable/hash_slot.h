@@ -62,16 +62,49 @@ class hash_slot {
   static int32_t get(const binary &key) {
     return crc16(reinterpret_cast<const char *>(key.data()), key.size());
   }
- private:
-  /* Hash function */
-  static uint16_t crc16(const char *buf, size_t len) {
-    size_t counter;
-    uint16_t crc = 0;
-    for (counter = 0; counter < len; counter++)
-      crc = (crc << 8) ^ crc16tab[((crc >> 8) ^ *buf++) & 0x00FF];
-    return crc;
-  }
 
+  /**
+   * @brief Hash function, using the fastest implementation the CPU supports
+   * @param buf Buffer
+   * @param len Buffer length
+   * @return CRC16 of buffer
+   */
+  static uint16_t crc16(const char *buf, size_t len);
+
+  /**
+   * @brief Hash function, one table lookup per byte
+   * @param buf Buffer
+   * @param len Buffer length
+   * @param crc CRC16 of the preceding bytes
+   * @return CRC16 of buffer
+   */
+  static uint16_t crc16_bytewise(const char *buf, size_t len, uint16_t crc = 0);
+
+  /**
+   * @brief Hash function, slicing-by-16 table lookups
+   * @param buf Buffer
+   * @param len Buffer length
+   * @param crc CRC16 of the preceding bytes
+   * @return CRC16 of buffer
+   */
+  static uint16_t crc16_sliced(const char *buf, size_t len, uint16_t crc = 0);
+
+  /**
+   * @brief Hash function, folding the buffer with carry-less multiplication.
+   * Falls back to slicing-by-16 if the CPU has no carry-less multiply.
+   * @param buf Buffer
+   * @param len Buffer length
+   * @return CRC16 of buffer
+   */
+  static uint16_t crc16_clmul(const char *buf, size_t len);
+
+  /**
+   * @brief Check if the CPU supports the carry-less multiply implementation
+   * @return Bool value, true if supported
+   */
+  static bool clmul_supported();
+
+ private:
   /* Hash function table */
   static const uint16_t crc16tab[256];
 
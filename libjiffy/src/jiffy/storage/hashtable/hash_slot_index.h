@@ -0,0 +1,168 @@
+#ifndef JIFFY_HASH_SLOT_INDEX_H
+#define JIFFY_HASH_SLOT_INDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <set>
+#include <string>
+#include "jiffy/storage/block_memory_allocator.h"
+#include "jiffy/storage/types/binary.h"
+
+namespace jiffy {
+namespace storage {
+
+/**
+ * @brief Index of hash table keys ordered by hash slot.
+ *
+ * Entries do not own their key bytes; they point into the key owned by the
+ * hash table, which keeps its buffer for as long as the entry lives. Entries
+ * must therefore be removed from the index before they are erased from the
+ * table.
+ */
+class hash_slot_index {
+ public:
+  /* Key in the index, a hash slot and a view of the key bytes */
+  class slot_key {
+   public:
+    slot_key(int32_t slot, const uint8_t *data, std::size_t size) : slot_(slot), data_(data), size_(size) {}
+
+    int32_t slot() const {
+      return slot_;
+    }
+
+    const uint8_t *data() const {
+      return data_;
+    }
+
+    std::size_t size() const {
+      return size_;
+    }
+
+    std::string to_string() const {
+      return std::string(reinterpret_cast<const char *>(data_), size_);
+    }
+
+   private:
+    int32_t slot_;
+    const uint8_t *data_;
+    std::size_t size_;
+  };
+
+  /* Orders keys by slot, then by key bytes; also compares against bare slots for range lookups */
+  struct slot_key_less {
+    typedef void is_transparent;
+
+    bool operator()(const slot_key &lhs, const slot_key &rhs) const {
+      if (lhs.slot() != rhs.slot())
+        return lhs.slot() < rhs.slot();
+      auto cmp = std::memcmp(lhs.data(), rhs.data(), std::min(lhs.size(), rhs.size()));
+      return cmp != 0 ? cmp < 0 : lhs.size() < rhs.size();
+    }
+
+    bool operator()(const slot_key &lhs, int32_t slot) const {
+      return lhs.slot() < slot;
+    }
+
+    bool operator()(int32_t slot, const slot_key &rhs) const {
+      return slot < rhs.slot();
+    }
+  };
+
+  typedef block_memory_allocator<slot_key> allocator_type;
+  typedef std::set<slot_key, slot_key_less, allocator_type> set_type;
+
+  /**
+   * @brief Constructor
+   * @param alloc Allocator for index entries
+   */
+  explicit hash_slot_index(const allocator_type &alloc) : keys_(slot_key_less(), alloc) {}
+
+  /**
+   * @brief Add key to the index
+   * @param slot Hash slot of the key
+   * @param key Key owned by the hash table
+   */
+  void add(int32_t slot, const binary &key) {
+    keys_.emplace(slot, key.data(), key.size());
+  }
+
+  /**
+   * @brief Remove key from the index
+   * @param slot Hash slot of the key
+   * @param key Key
+   */
+  void remove(int32_t slot, const binary &key) {
+    keys_.erase(slot_key(slot, key.data(), key.size()));
+  }
+
+  /**
+   * @brief Visit keys whose hash slot lies in [slot_begin, slot_end), in slot order
+   * @param slot_begin Begin slot
+   * @param slot_end End slot
+   * @param visit Visitor, returns false to stop the scan
+   * @return Number of keys visited
+   */
+  std::size_t for_each(int32_t slot_begin, int32_t slot_end, const std::function<bool(const slot_key &)> &visit) const {
+    return scan(keys_.lower_bound(slot_begin), slot_end, visit);
+  }
+
+  /**
+   * @brief Visit keys ordered after a given key whose hash slot lies below slot_end, in slot order
+   * @param after Key to resume after, need not be in the index
+   * @param slot_end End slot
+   * @param visit Visitor, returns false to stop the scan
+   * @return Number of keys visited
+   */
+  std::size_t for_each_after(const slot_key &after, int32_t slot_end,
+                             const std::function<bool(const slot_key &)> &visit) const {
+    return scan(keys_.upper_bound(after), slot_end, visit);
+  }
+
+  /**
+   * @brief Fetch number of keys in the index
+   * @return Number of keys
+   */
+  std::size_t size() const {
+    return keys_.size();
+  }
+
+  /**
+   * @brief Remove all keys from the index
+   */
+  void clear() {
+    keys_.clear();
+  }
+
+  /**
+   * @brief Forget all keys without returning their memory.
+   * Only valid when the allocator's memory is released in bulk right after.
+   */
+  void abandon() {
+    auto alloc = keys_.get_allocator();
+    // Replace the tree without running its destructor, which would free every node
+    new(&keys_) set_type(slot_key_less(), alloc);
+  }
+
+ private:
+  std::size_t scan(set_type::const_iterator it, int32_t slot_end,
+                   const std::function<bool(const slot_key &)> &visit) const {
+    std::size_t n = 0;
+    for (; it != keys_.end() && it->slot() < slot_end; ++it) {
+      ++n;
+      if (!visit(*it))
+        break;
+    }
+    return n;
+  }
+
+  /* Keys ordered by hash slot */
+  set_type keys_;
+};
+
+}
+}
+
+#endif //JIFFY_HASH_SLOT_INDEX_H
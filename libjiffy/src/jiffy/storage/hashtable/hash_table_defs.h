@@ -5,6 +5,9 @@
 #include "libcuckoo/cuckoohash_map.hh"
 #include "jiffy/storage/block_memory_allocator.h"
 #include "jiffy/storage/types/binary.h"
+#include "jiffy/storage/hashtable/flat_hash_map.h"
+#include "jiffy/storage/hashtable/striped_hash_map.h"
+#include "jiffy/utils/hash_utils.h"
 #include <unordered_map>
 
 namespace jiffy {
@@ -13,6 +16,18 @@ namespace storage {
 // The default number of elements in an empty hash table
 constexpr size_t HASH_TABLE_DEFAULT_SIZE = 0;
 
+// Number of independently locked stripes in a hash table partition
+constexpr size_t HASH_TABLE_NUM_STRIPES = 16;
+
+// Number of keys and values shipped per batch when moving a slot range between partitions
+constexpr size_t HASH_TABLE_TRANSFER_BATCH_SIZE = 2048;
+
+// Bytes of keys and values after which a slot range transfer batch is cut short
+constexpr size_t HASH_TABLE_TRANSFER_BATCH_BYTES = 4 * 1024 * 1024;
+
+// Attempts at reading or writing a slot range transfer batch before the transfer is given up
+constexpr size_t HASH_TABLE_TRANSFER_ATTEMPTS = 5;
+
 // Hash table max key size
 constexpr size_t HASH_TABLE_MAX_KEY_SIZE = 65536;
 
@@ -25,11 +40,7 @@ typedef std::pair<const key_type, value_type> kv_pair_type;
 struct hash_type {
   template<typename KeyType>
   std::size_t operator()(const KeyType &k) const {
-    std::size_t result = 0;
-    for (size_t i = 0; i < k.size(); i++) {
-      result = k[i] + (result * 31);
-    }
-    return result;
+    return static_cast<std::size_t>(utils::hash_utils::hash_bytes(k.data(), k.size()));
   }
 };
 
@@ -41,7 +52,8 @@ struct equal_type {
 };
 
 // Hash table definitions
-typedef std::unordered_map<key_type, value_type, hash_type, equal_type> hash_table_type;
+typedef flat_hash_map<key_type, value_type, hash_type, equal_type, block_memory_allocator<kv_pair_type>> flat_hash_table_type;
+typedef striped_hash_map<flat_hash_table_type, HASH_TABLE_NUM_STRIPES> hash_table_type;
 
 }
 }
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include "hash_table_eviction.h"
+
+namespace jiffy {
+namespace storage {
+
+namespace {
+
+uint64_t now_ms() {
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+std::minstd_rand &generator() {
+  static thread_local std::minstd_rand gen(std::random_device{}());
+  return gen;
+}
+
+}
+
+hash_table_eviction::policy_type hash_table_eviction::parse_policy(const std::string &name) {
+  if (name == "clock") {
+    return clock;
+  } else if (name == "lru") {
+    return lru;
+  } else if (name == "sampled-lfu") {
+    return sampled_lfu;
+  }
+  throw std::invalid_argument("No such eviction policy " + name);
+}
+
+hash_table_eviction::hash_table_eviction(policy_type policy, std::size_t capacity, std::size_t num_stripes)
+    : policy_(policy),
+      hands_(num_stripes, 0),
+      next_stripe_(0),
+      evicted_(0),
+      admitted_(0) {
+  std::size_t n = 1024;
+  while (n < capacity / HASH_TABLE_EVICTION_BYTES_PER_ENTRY)
+    n <<= 1;
+  lru_tick_ = std::max<uint64_t>(n / HASH_TABLE_LRU_TICK_ENTRIES, 1);
+  words_ = std::vector<std::atomic<uint16_t>>(n);
+  for (auto &w: words_)
+    w.store(0, std::memory_order_relaxed);
+  mask_ = n - 1;
+}
+
+hash_table_eviction::policy_type hash_table_eviction::policy() const {
+  return policy_;
+}
+
+void hash_table_eviction::admit(std::size_t hash) {
+  switch (policy_) {
+    case clock:word(hash).store(1, std::memory_order_relaxed);
+      break;
+    case lru:admitted_.fetch_add(1, std::memory_order_relaxed);
+      word(hash).store(lru_clock(), std::memory_order_relaxed);
+      break;
+    case sampled_lfu:
+      word(hash).store(static_cast<uint16_t>((lfu_minutes() << 8) | HASH_TABLE_LFU_INIT), std::memory_order_relaxed);
+      break;
+  }
+}
+
+void hash_table_eviction::touch(std::size_t hash) {
+  auto &w = word(hash);
+  switch (policy_) {
+    case clock: {
+      // Skip the write when the bit is set already, as it is for hot keys
+      if (w.load(std::memory_order_relaxed) == 0)
+        w.store(1, std::memory_order_relaxed);
+      break;
+    }
+    case lru: {
+      auto now = lru_clock();
+      if (w.load(std::memory_order_relaxed) != now)
+        w.store(now, std::memory_order_relaxed);
+      break;
+    }
+    case sampled_lfu: {
+      // Racing updates may lose an increment, which only blurs an approximate count
+      auto now = lfu_minutes();
+      auto old = w.load(std::memory_order_relaxed);
+      uint32_t counter = lfu_decayed(old, now);
+      if (counter < 255) {
+        auto base = counter > HASH_TABLE_LFU_INIT ? counter - HASH_TABLE_LFU_INIT : 0;
+        std::uniform_int_distribution<uint32_t> dist(0, base * HASH_TABLE_LFU_LOG_FACTOR);
+        if (dist(generator()) == 0)
+          ++counter;
+      }
+      auto updated = static_cast<uint16_t>((now << 8) | counter);
+      if (updated != old)
+        w.store(updated, std::memory_order_relaxed);
+      break;
+    }
+  }
+}
+
+bool hash_table_eviction::second_chance(std::size_t hash) {
+  auto &w = word(hash);
+  if (w.load(std::memory_order_relaxed) == 0)
+    return false;
+  w.store(0, std::memory_order_relaxed);
+  return true;
+}
+
+uint32_t hash_table_eviction::coldness(std::size_t hash) const {
+  auto w = word(hash).load(std::memory_order_relaxed);
+  if (policy_ == lru)
+    return static_cast<uint16_t>(lru_clock() - w);
+  return 255u - lfu_decayed(w, lfu_minutes());
+}
+
+std::size_t hash_table_eviction::random_slot(std::size_t num_slots) {
+  return std::uniform_int_distribution<std::size_t>(0, num_slots - 1)(generator());
+}
+
+std::size_t &hash_table_eviction::hand(std::size_t stripe) {
+  return hands_[stripe];
+}
+
+std::size_t hash_table_eviction::next_stripe() {
+  return next_stripe_.fetch_add(1, std::memory_order_relaxed) % hands_.size();
+}
+
+void hash_table_eviction::count_evicted(std::size_t n) {
+  evicted_.fetch_add(n, std::memory_order_relaxed);
+}
+
+std::size_t hash_table_eviction::evicted() const {
+  return evicted_.load(std::memory_order_relaxed);
+}
+
+std::atomic<uint16_t> &hash_table_eviction::word(std::size_t hash) {
+  return words_[hash & mask_];
+}
+
+const std::atomic<uint16_t> &hash_table_eviction::word(std::size_t hash) const {
+  return words_[hash & mask_];
+}
+
+uint16_t hash_table_eviction::lru_clock() const {
+  return static_cast<uint16_t>(admitted_.load(std::memory_order_relaxed) / lru_tick_);
+}
+
+uint16_t hash_table_eviction::lfu_minutes() {
+  return static_cast<uint16_t>((now_ms() / 60000) & 0xFF);
+}
+
+uint8_t hash_table_eviction::lfu_decayed(uint16_t w, uint16_t now) {
+  auto counter = static_cast<uint32_t>(w & 0xFF);
+  auto elapsed = static_cast<uint8_t>(now - (w >> 8)) / HASH_TABLE_LFU_DECAY_MINUTES;
+  return static_cast<uint8_t>(elapsed >= 8 ? 0 : counter >> elapsed);
+}
+
+}
+}
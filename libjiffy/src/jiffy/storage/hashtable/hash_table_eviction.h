@@ -0,0 +1,175 @@
+#ifndef JIFFY_HASH_TABLE_EVICTION_H
+#define JIFFY_HASH_TABLE_EVICTION_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace jiffy {
+namespace storage {
+
+// Bytes of partition capacity per access metadata entry, about one entry per small key value pair
+constexpr std::size_t HASH_TABLE_EVICTION_BYTES_PER_ENTRY = 256;
+
+// Maximum number of entries evicted from a stripe per lock acquisition, spreading evictions across stripes
+constexpr std::size_t HASH_TABLE_EVICTION_BATCH = 16;
+
+// Number of neighbouring entries sampled to pick an LRU or LFU victim
+constexpr std::size_t HASH_TABLE_EVICTION_SAMPLES = 8;
+
+// Fraction of the eviction threshold eviction brings memory usage down to, so that it is not run by every put
+constexpr double HASH_TABLE_EVICTION_TARGET = 0.95;
+
+// Access metadata entries per key admission of an LRU clock tick; 16-bit access times wrap around
+// once the partition has admitted 16 times as many keys as it has metadata entries
+constexpr std::size_t HASH_TABLE_LRU_TICK_ENTRIES = 4096;
+
+// Minutes after which an LFU counter is halved if its key is not accessed
+constexpr uint64_t HASH_TABLE_LFU_DECAY_MINUTES = 1;
+
+// Initial LFU counter of new keys, so that they are not evicted before they are accessed again
+constexpr uint8_t HASH_TABLE_LFU_INIT = 5;
+
+// LFU counter growth factor; the higher, the more accesses a counter needs to grow
+constexpr uint32_t HASH_TABLE_LFU_LOG_FACTOR = 10;
+
+/**
+ * @brief Access metadata of a hash table partition run as a capacity-bounded cache.
+ *
+ * Instead of failing writes or splitting once full, the partition evicts
+ * cold entries picked by one of three policies:
+ *  - clock: a reference bit per key, which a hand per stripe clears as it
+ *    sweeps the table, evicting keys not accessed since the last sweep.
+ *  - lru: a 16-bit last access time per key, on a clock that ticks as keys
+ *    are admitted, so that it orders accesses by the partition's turnover
+ *    rather than by wall time; the least recently used of a few sampled keys
+ *    is evicted.
+ *  - sampled-lfu: an 8-bit logarithmic access counter per key, halved every
+ *    minute it is not accessed, next to the minute of its last decay; the least
+ *    frequently used of a few sampled keys is evicted.
+ *
+ * Metadata are 16-bit words addressed by key hash rather than stored with the
+ * entries, so the table layout does not change and accesses under a shared
+ * stripe lock update them with relaxed atomics. Keys whose hashes collide share
+ * a word, which can only make a cold key look warmer. Clock hands are guarded
+ * by the stripe lock.
+ */
+class hash_table_eviction {
+ public:
+  /* Eviction policy */
+  enum policy_type {
+    clock,
+    lru,
+    sampled_lfu
+  };
+
+  /**
+   * @brief Parse eviction policy name
+   * @param name Policy name, one of clock, lru and sampled-lfu
+   * @return Eviction policy
+   */
+  static policy_type parse_policy(const std::string &name);
+
+  /**
+   * @brief Constructor
+   * @param policy Eviction policy
+   * @param capacity Partition capacity in bytes, which sizes the metadata
+   * @param num_stripes Number of hash table stripes
+   */
+  hash_table_eviction(policy_type policy, std::size_t capacity, std::size_t num_stripes);
+
+  /**
+   * @brief Fetch eviction policy
+   * @return Eviction policy
+   */
+  policy_type policy() const;
+
+  /**
+   * @brief Initialize metadata of a newly inserted key
+   * @param hash Key hash
+   */
+  void admit(std::size_t hash);
+
+  /**
+   * @brief Record access to a key
+   * @param hash Key hash
+   */
+  void touch(std::size_t hash);
+
+  /**
+   * @brief Clock policy: check if key was accessed since its reference bit was last cleared, and clear it
+   * @param hash Key hash
+   * @return Bool value, true if the key gets a second chance
+   */
+  bool second_chance(std::size_t hash);
+
+  /**
+   * @brief Sampling policies: fetch how cold a key is
+   * @param hash Key hash
+   * @return Coldness, higher for better eviction victims
+   */
+  uint32_t coldness(std::size_t hash) const;
+
+  /**
+   * @brief Fetch a random slot position to start sampling from
+   * @param num_slots Number of slots
+   * @return Slot position
+   */
+  static std::size_t random_slot(std::size_t num_slots);
+
+  /**
+   * @brief Fetch clock hand of a stripe, the slot position its sweep resumes at
+   * @param stripe Stripe index
+   * @return Clock hand
+   */
+  std::size_t &hand(std::size_t stripe);
+
+  /**
+   * @brief Fetch stripe eviction starts at, rotating so that stripes take turns
+   * @return Stripe index
+   */
+  std::size_t next_stripe();
+
+  /**
+   * @brief Count evicted entries
+   * @param n Number of entries evicted
+   */
+  void count_evicted(std::size_t n);
+
+  /**
+   * @brief Fetch number of entries evicted so far
+   * @return Number of entries evicted
+   */
+  std::size_t evicted() const;
+
+ private:
+  std::atomic<uint16_t> &word(std::size_t hash);
+  const std::atomic<uint16_t> &word(std::size_t hash) const;
+
+  uint16_t lru_clock() const;
+  static uint16_t lfu_minutes();
+  static uint8_t lfu_decayed(uint16_t w, uint16_t now);
+
+  /* Eviction policy */
+  policy_type policy_;
+  /* Access metadata words addressed by key hash */
+  std::vector<std::atomic<uint16_t>> words_;
+  /* Mask selecting a word from a key hash */
+  std::size_t mask_;
+  /* Clock hands, one per stripe */
+  std::vector<std::size_t> hands_;
+  /* Stripe the next eviction starts at */
+  std::atomic<std::size_t> next_stripe_;
+  /* Number of entries evicted */
+  std::atomic<std::size_t> evicted_;
+  /* Number of keys admitted, which drives the LRU clock */
+  std::atomic<uint64_t> admitted_;
+  /* Key admissions per LRU clock tick */
+  uint64_t lru_tick_;
+};
+
+}
+}
+
+#endif //JIFFY_HASH_TABLE_EVICTION_H
@@ -0,0 +1,274 @@
+#ifndef JIFFY_HASH_TABLE_EXPIRY_H
+#define JIFFY_HASH_TABLE_EXPIRY_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "jiffy/storage/block_memory_allocator.h"
+#include "jiffy/storage/types/binary.h"
+
+namespace jiffy {
+namespace storage {
+
+// Milliseconds per timing wheel tick, the resolution entries expire at
+constexpr uint64_t HASH_TABLE_TTL_TICK_MS = 10;
+
+// Bits of a tick each timing wheel level resolves, 64 slots per level
+constexpr std::size_t HASH_TABLE_TTL_WHEEL_BITS = 6;
+
+// Number of timing wheel levels; 4 levels span 64^4 ticks, about 46 hours
+constexpr std::size_t HASH_TABLE_TTL_WHEEL_LEVELS = 4;
+
+// Number of timing wheel entries a stripe processes per lock acquisition
+constexpr std::size_t HASH_TABLE_TTL_EXPIRE_BATCH = 256;
+
+/**
+ * @brief Expiry deadlines of the keys of a hash table stripe.
+ *
+ * Deadlines are indexed by key, so that accesses can check them and treat
+ * expired keys as absent, and scheduled on a hierarchical timing wheel, so
+ * that expired keys are found without scanning the table. A level-0 slot holds
+ * the deadlines of one tick; higher levels hold coarser ranges and cascade
+ * their deadlines down as the wheel turns. Deadlines past the top level wait
+ * in an overflow list until the top level wraps around.
+ *
+ * Like the slot index, entries point into the keys owned by the hash table.
+ * The wheel is not updated when a key's deadline changes or the key is
+ * removed; stale wheel entries are recognised by their deadline not matching
+ * the index and are skipped when they come due. The stripe lock guards the
+ * structure.
+ */
+class hash_table_expiry {
+ public:
+  /* Deadline scheduled on the wheel */
+  struct wheel_entry {
+    const uint8_t *key;
+    uint64_t deadline;
+  };
+
+  /* Deadline of a key, with the key size the wheel does not keep */
+  struct key_deadline {
+    uint64_t deadline;
+    std::size_t size;
+  };
+
+  typedef block_memory_allocator<wheel_entry> allocator_type;
+
+  /**
+   * @brief Constructor
+   * @param alloc Allocator for deadlines
+   */
+  explicit hash_table_expiry(const allocator_type &alloc)
+      : alloc_(alloc),
+        index_(0, std::hash<const uint8_t *>(), std::equal_to<const uint8_t *>(), index_allocator(alloc)),
+        overflow_(alloc),
+        tick_(to_tick(now_ms())),
+        scheduled_() {}
+
+  /**
+   * @brief Fetch current time in milliseconds, the clock deadlines are measured on
+   * @return Current time in milliseconds
+   */
+  static uint64_t now_ms() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+  }
+
+  /**
+   * @brief Set deadline of a key
+   * @param key Key owned by the hash table
+   * @param deadline Deadline in milliseconds
+   */
+  void set(const binary &key, uint64_t deadline) {
+    if (wheel_.empty()) {
+      // Only tables whose keys expire pay for the wheel
+      wheel_.assign(HASH_TABLE_TTL_WHEEL_LEVELS << HASH_TABLE_TTL_WHEEL_BITS, slot_type(alloc_));
+    }
+    index_[key.data()] = key_deadline{deadline, key.size()};
+    schedule(wheel_entry{key.data(), deadline});
+  }
+
+  /**
+   * @brief Clear deadline of a key, e.g. when it is removed or overwritten without one
+   * @param key Key owned by the hash table
+   * @return Bool value, true if the key had a deadline
+   */
+  bool clear(const binary &key) {
+    return index_.erase(key.data()) != 0;
+  }
+
+  /**
+   * @brief Check if key has expired
+   * @param key Key owned by the hash table
+   * @param now Current time in milliseconds
+   * @return Bool value, true if the key's deadline has passed
+   */
+  bool expired(const binary &key, uint64_t now) const {
+    if (index_.empty())
+      return false;
+    auto it = index_.find(key.data());
+    return it != index_.end() && it->second.deadline <= now;
+  }
+
+  /**
+   * @brief Fetch deadline of a key
+   * @param key Key owned by the hash table
+   * @param deadline Deadline in milliseconds, set if the key has one
+   * @return Bool value, true if the key has a deadline
+   */
+  bool deadline(const binary &key, uint64_t &deadline) const {
+    auto it = index_.find(key.data());
+    if (it == index_.end())
+      return false;
+    deadline = it->second.deadline;
+    return true;
+  }
+
+  /**
+   * @brief Fetch number of keys with a deadline
+   * @return Number of keys with a deadline
+   */
+  std::size_t size() const {
+    return index_.size();
+  }
+
+  /**
+   * @brief Turn the wheel up to the current time and erase keys that came due
+   * @param now Current time in milliseconds
+   * @param budget Maximum number of wheel entries to process; the wheel resumes where it stopped
+   * @param erase Function erasing a key from the hash table, given its bytes and size
+   * @return Number of wheel entries processed
+   */
+  std::size_t expire(uint64_t now, std::size_t budget, const std::function<void(const uint8_t *, std::size_t)> &erase) {
+    auto target = now / HASH_TABLE_TTL_TICK_MS;
+    std::size_t n = 0;
+    while (!wheel_.empty()) {
+      auto &slot = wheel_[tick_ & SLOT_MASK];
+      while (!slot.empty()) {
+        if (n == budget)
+          return n;
+        auto e = slot.back();
+        slot.pop_back();
+        --scheduled_[0];
+        ++n;
+        auto it = index_.find(e.key);
+        if (it != index_.end() && it->second.deadline == e.deadline) {
+          auto size = it->second.size;
+          index_.erase(it);
+          erase(e.key, size);
+        }
+      }
+      if (tick_ >= target)
+        return n;
+      tick_ = next_tick(target);
+      cascade();
+    }
+    tick_ = std::max(tick_, target);
+    return n;
+  }
+
+  /**
+   * @brief Forget all deadlines without returning their memory.
+   * Only valid when the allocator's memory is released in bulk right after.
+   */
+  void abandon() {
+    // Replace the containers without running their destructors, which would free the entries
+    new(&index_) index_type(0, std::hash<const uint8_t *>(), std::equal_to<const uint8_t *>(), index_allocator(alloc_));
+    for (auto &slot: wheel_)
+      new(&slot) slot_type(alloc_);
+    new(&overflow_) slot_type(alloc_);
+    scheduled_.fill(0);
+  }
+
+ private:
+  typedef std::vector<wheel_entry, allocator_type> slot_type;
+  typedef block_memory_allocator<std::pair<const uint8_t *const, key_deadline>> index_allocator;
+  typedef std::unordered_map<const uint8_t *, key_deadline, std::hash<const uint8_t *>,
+                             std::equal_to<const uint8_t *>, index_allocator> index_type;
+
+  static constexpr uint64_t SLOT_MASK = (uint64_t(1) << HASH_TABLE_TTL_WHEEL_BITS) - 1;
+
+  static uint64_t to_tick(uint64_t ms) {
+    // Round up, so that keys never expire early
+    return (ms + HASH_TABLE_TTL_TICK_MS - 1) / HASH_TABLE_TTL_TICK_MS;
+  }
+
+  uint64_t next_tick(uint64_t target) const {
+    // With the levels below l empty, nothing comes due before level l cascades down at the next
+    // multiple of its slot width, so the ticks in between are skipped
+    std::size_t l = 0;
+    while (l < HASH_TABLE_TTL_WHEEL_LEVELS && scheduled_[l] == 0)
+      ++l;
+    if (l == HASH_TABLE_TTL_WHEEL_LEVELS && scheduled_[l] == 0)
+      return target;
+    auto width = uint64_t(1) << (HASH_TABLE_TTL_WHEEL_BITS * l);
+    return std::min((tick_ | (width - 1)) + 1, target);
+  }
+
+  void schedule(const wheel_entry &e) {
+    auto t = std::max(to_tick(e.deadline), tick_);
+    // The level is given by the highest group of tick bits in which the deadline and the current tick differ
+    auto diff = t ^ tick_;
+    for (std::size_t l = 0; l < HASH_TABLE_TTL_WHEEL_LEVELS; ++l) {
+      if ((diff >> (HASH_TABLE_TTL_WHEEL_BITS * (l + 1))) == 0) {
+        wheel_[(l << HASH_TABLE_TTL_WHEEL_BITS) + ((t >> (HASH_TABLE_TTL_WHEEL_BITS * l)) & SLOT_MASK)].push_back(e);
+        ++scheduled_[l];
+        return;
+      }
+    }
+    overflow_.push_back(e);
+    ++scheduled_[HASH_TABLE_TTL_WHEEL_LEVELS];
+  }
+
+  void cascade() {
+    // Find the highest level whose slot boundary the tick crossed, then move entries down from there
+    std::size_t top = 0;
+    while (top < HASH_TABLE_TTL_WHEEL_LEVELS
+        && (tick_ & ((uint64_t(1) << (HASH_TABLE_TTL_WHEEL_BITS * (top + 1))) - 1)) == 0)
+      ++top;
+    if (top == HASH_TABLE_TTL_WHEEL_LEVELS) {
+      reschedule(overflow_, top);
+      --top;
+    }
+    for (auto l = top; l > 0; --l) {
+      reschedule(wheel_[(l << HASH_TABLE_TTL_WHEEL_BITS) + ((tick_ >> (HASH_TABLE_TTL_WHEEL_BITS * l)) & SLOT_MASK)], l);
+    }
+  }
+
+  void reschedule(slot_type &slot, std::size_t level) {
+    slot_type entries(alloc_);
+    entries.swap(slot);
+    scheduled_[level] -= entries.size();
+    for (const auto &e: entries)
+      schedule(e);
+  }
+
+  /* Allocator for wheel slots */
+  allocator_type alloc_;
+
+  /* Deadlines by key */
+  index_type index_;
+
+  /* Wheel slots, level by level; empty until a deadline is first set */
+  std::vector<slot_type> wheel_;
+
+  /* Deadlines past the top level */
+  slot_type overflow_;
+
+  /* Current tick */
+  uint64_t tick_;
+
+  /* Number of entries on each wheel level, then in the overflow list */
+  std::array<std::size_t, HASH_TABLE_TTL_WHEEL_LEVELS + 1> scheduled_;
+};
+
+}
+}
+
+#endif //JIFFY_HASH_TABLE_EXPIRY_H
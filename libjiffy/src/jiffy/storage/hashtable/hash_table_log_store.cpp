@@ -0,0 +1,501 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include "hash_table_log_store.h"
+#include "jiffy/utils/logger.h"
+
+namespace jiffy {
+namespace storage {
+
+using namespace utils;
+
+namespace {
+
+// Record header in the value log: record type, key size and value size
+constexpr std::size_t RECORD_HEADER_SIZE = sizeof(uint8_t) + 2 * sizeof(uint64_t);
+
+void check_io(bool ok, const std::string &what, const std::string &path) {
+  if (!ok) {
+    throw std::runtime_error("Could not " + what + " " + path + ": " + std::strerror(errno));
+  }
+}
+
+bool file_exists(const std::string &path) {
+  return ::access(path.c_str(), F_OK) == 0;
+}
+
+void sync_file(const std::string &path) {
+  auto fd = ::open(path.c_str(), O_RDONLY);
+  check_io(fd >= 0, "open", path);
+  bool ok = ::fsync(fd) == 0;
+  auto err = errno;
+  ::close(fd);
+  errno = err;
+  check_io(ok, "sync", path);
+}
+
+void sync_parent(const std::string &path) {
+  auto pos = path.find_last_of('/');
+  sync_file(pos == std::string::npos ? "." : (pos == 0 ? "/" : path.substr(0, pos)));
+}
+
+}
+
+hash_table_log_store::hash_table_log_store(const std::string &path, const std::string &format)
+    : path_(path),
+      format_(format),
+      log_size_(0),
+      live_bytes_(0),
+      dead_bytes_(0),
+      compacting_(false) {
+  if (format_ != "csv" && format_ != "binary") {
+    throw std::invalid_argument("No such serializer/deserializer " + format_);
+  }
+  for (auto &fd: fds_) {
+    fd = -1;
+  }
+  recover_base();
+  index_base();
+  bool recovering = file_exists(frozen_log_path(path_));
+  if (recovering) {
+    replay(frozen_log_path(path_), frozen_log_file);
+  }
+  if (file_exists(log_path(path_))) {
+    replay(log_path(path_), log_file);
+  }
+  if (recovering) {
+    // A compaction was interrupted; finish merging the frozen log
+    run_compaction();
+  }
+}
+
+hash_table_log_store::~hash_table_log_store() {
+  {
+    std::unique_lock<std::mutex> lock(compaction_lock_);
+    if (compaction_.joinable()) {
+      compaction_.join();
+    }
+  }
+  for (auto fd: fds_) {
+    if (fd >= 0) {
+      ::close(fd);
+    }
+  }
+}
+
+bool hash_table_log_store::exists(const std::string &key) const {
+  std::shared_lock<mutex_type> lock(mutex_);
+  return index_.find(key) != index_.end();
+}
+
+bool hash_table_log_store::get(std::string &value, const std::string &key) const {
+  std::shared_lock<mutex_type> lock(mutex_);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    return false;
+  }
+  value = read(it->second);
+  return true;
+}
+
+bool hash_table_log_store::put(const std::string &key, const std::string &value) {
+  {
+    std::unique_lock<mutex_type> lock(mutex_);
+    if (index_.find(key) != index_.end()) {
+      return false;
+    }
+    append(put_record, key, value);
+  }
+  maybe_compact();
+  return true;
+}
+
+bool hash_table_log_store::update(const std::string &key, const std::string &value) {
+  {
+    std::unique_lock<mutex_type> lock(mutex_);
+    if (index_.find(key) == index_.end()) {
+      return false;
+    }
+    append(put_record, key, value);
+  }
+  maybe_compact();
+  return true;
+}
+
+void hash_table_log_store::upsert(const std::string &key, const std::string &value) {
+  {
+    std::unique_lock<mutex_type> lock(mutex_);
+    append(put_record, key, value);
+  }
+  maybe_compact();
+}
+
+bool hash_table_log_store::remove(const std::string &key) {
+  {
+    std::unique_lock<mutex_type> lock(mutex_);
+    if (index_.find(key) == index_.end()) {
+      return false;
+    }
+    append(remove_record, key, "");
+  }
+  maybe_compact();
+  return true;
+}
+
+void hash_table_log_store::compact() {
+  {
+    std::unique_lock<std::mutex> lock(compaction_lock_);
+    if (compaction_.joinable()) {
+      compaction_.join();
+    }
+  }
+  run_compaction();
+}
+
+std::size_t hash_table_log_store::size() const {
+  std::shared_lock<mutex_type> lock(mutex_);
+  return index_.size();
+}
+
+const std::string &hash_table_log_store::path() const {
+  return path_;
+}
+
+bool hash_table_log_store::base_exists(const std::string &path, const std::string &format) {
+  return file_exists(path) && (format != "binary" || file_exists(offset_path(path)));
+}
+
+bool hash_table_log_store::has_log(const std::string &path) {
+  return file_exists(log_path(path)) || file_exists(frozen_log_path(path)) || file_exists(commit_path(path));
+}
+
+void hash_table_log_store::discard_log(const std::string &path) {
+  std::remove(commit_path(path).c_str());
+  std::remove(compact_path(path).c_str());
+  std::remove(compact_path(offset_path(path)).c_str());
+  std::remove(log_path(path).c_str());
+  std::remove(frozen_log_path(path).c_str());
+}
+
+void hash_table_log_store::recover_base() {
+  auto tmp_path = compact_path(path_);
+  auto tmp_offset_path = compact_path(offset_path(path_));
+  if (!file_exists(commit_path(path_))) {
+    // A compaction that did not commit leaves the old base file untouched
+    std::remove(tmp_path.c_str());
+    std::remove(tmp_offset_path.c_str());
+    std::remove((commit_path(path_) + ".tmp").c_str());
+    return;
+  }
+  // A committed compaction wrote both of its files; finish swapping in the ones left
+  LOG(log_level::info) << "Completing compaction of " << path_;
+  if (file_exists(tmp_offset_path)) {
+    check_io(std::rename(tmp_offset_path.c_str(), offset_path(path_).c_str()) == 0, "rename", tmp_offset_path);
+  }
+  if (file_exists(tmp_path)) {
+    check_io(std::rename(tmp_path.c_str(), path_.c_str()) == 0, "rename", tmp_path);
+  }
+  sync_parent(path_);
+  check_io(std::remove(commit_path(path_).c_str()) == 0, "remove", commit_path(path_));
+}
+
+void hash_table_log_store::index_base() {
+  fds_[base_file] = ::open(path_.c_str(), O_RDONLY);
+  check_io(fds_[base_file] >= 0, "open", path_);
+  if (format_ == "csv") {
+    std::ifstream in(path_);
+    std::string line;
+    uint64_t offset = 0;
+    while (std::getline(in, line)) {
+      auto split_index = line.find(',');
+      if (split_index != std::string::npos) {
+        set(line.substr(0, split_index), location{base_file, offset + split_index + 1, line.size() - split_index - 1});
+      }
+      offset += line.size() + 1;
+    }
+  } else {
+    std::ifstream offset_in(offset_path(path_), std::ios::binary);
+    check_io(static_cast<bool>(offset_in), "open", offset_path(path_));
+    std::string key;
+    uint64_t offset = 0;
+    std::size_t key_size = 0;
+    std::size_t value_size = 0;
+    while (offset_in.read(reinterpret_cast<char *>(&key_size), sizeof(key_size))) {
+      key.resize(key_size);
+      offset_in.read(&key[0], key_size);
+      if (!offset_in.read(reinterpret_cast<char *>(&value_size), sizeof(value_size)))
+        break;
+      set(key, location{base_file, offset, value_size});
+      offset += value_size;
+    }
+  }
+}
+
+void hash_table_log_store::replay(const std::string &log_path, uint8_t file) {
+  fds_[file] = ::open(log_path.c_str(), O_RDWR);
+  check_io(fds_[file] >= 0, "open", log_path);
+  auto file_size = static_cast<uint64_t>(::lseek(fds_[file], 0, SEEK_END));
+  std::ifstream in(log_path, std::ios::binary);
+  std::string key;
+  uint64_t offset = 0;
+  while (offset + RECORD_HEADER_SIZE <= file_size) {
+    uint8_t type;
+    uint64_t key_size, value_size;
+    in.read(reinterpret_cast<char *>(&type), sizeof(type));
+    in.read(reinterpret_cast<char *>(&key_size), sizeof(key_size));
+    in.read(reinterpret_cast<char *>(&value_size), sizeof(value_size));
+    auto value_offset = offset + RECORD_HEADER_SIZE + key_size;
+    if (!in || value_offset + value_size > file_size) {
+      break;
+    }
+    key.resize(key_size);
+    in.read(&key[0], key_size);
+    in.seekg(value_size, std::ios::cur);
+    if (type == put_record) {
+      set(key, location{file, value_offset, value_size});
+    } else {
+      erase(key);
+    }
+    offset = value_offset + value_size;
+  }
+  if (offset < file_size) {
+    // Drop a record torn by a crash
+    LOG(log_level::warn) << "Truncating value log " << log_path << " from " << file_size << " to " << offset << " bytes";
+    check_io(::ftruncate(fds_[file], static_cast<off_t>(offset)) == 0, "truncate", log_path);
+  }
+  if (file == log_file) {
+    log_size_ = offset;
+  }
+}
+
+void hash_table_log_store::append(record_type type, const std::string &key, const std::string &value) {
+  if (fds_[log_file] < 0) {
+    open_log();
+  }
+  uint64_t key_size = key.size();
+  uint64_t value_size = value.size();
+  std::string record;
+  record.reserve(RECORD_HEADER_SIZE + key.size() + value.size());
+  record.push_back(static_cast<char>(type));
+  record.append(reinterpret_cast<const char *>(&key_size), sizeof(key_size));
+  record.append(reinterpret_cast<const char *>(&value_size), sizeof(value_size));
+  record.append(key);
+  record.append(value);
+  std::size_t written = 0;
+  while (written < record.size()) {
+    auto n = ::pwrite(fds_[log_file], record.data() + written, record.size() - written,
+                      static_cast<off_t>(log_size_ + written));
+    if (n < 0 && errno == EINTR)
+      continue;
+    check_io(n > 0, "append to", log_path(path_));
+    written += static_cast<std::size_t>(n);
+  }
+  if (type == put_record) {
+    set(key, location{log_file, log_size_ + RECORD_HEADER_SIZE + key_size, value_size});
+  } else {
+    erase(key);
+    dead_bytes_ += record.size();
+  }
+  log_size_ += record.size();
+}
+
+void hash_table_log_store::set(const std::string &key, const location &loc) {
+  auto ret = index_.emplace(key, loc);
+  if (!ret.second) {
+    live_bytes_ -= ret.first->second.size;
+    dead_bytes_ += ret.first->second.size;
+    ret.first->second = loc;
+  }
+  live_bytes_ += loc.size;
+}
+
+void hash_table_log_store::erase(const std::string &key) {
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    return;
+  }
+  live_bytes_ -= it->second.size;
+  dead_bytes_ += it->second.size;
+  index_.erase(it);
+}
+
+void hash_table_log_store::open_log() {
+  auto path = log_path(path_);
+  fds_[log_file] = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  check_io(fds_[log_file] >= 0, "create", path);
+  log_size_ = 0;
+}
+
+void hash_table_log_store::maybe_compact() {
+  {
+    std::shared_lock<mutex_type> lock(mutex_);
+    if (dead_bytes_ < HASH_TABLE_LS_COMPACTION_BYTES || dead_bytes_ < live_bytes_) {
+      return;
+    }
+  }
+  if (compacting_.exchange(true)) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(compaction_lock_);
+  if (compaction_.joinable()) {
+    compaction_.join();
+  }
+  compaction_ = std::thread([this] {
+    try {
+      run_compaction();
+    } catch (std::exception &e) {
+      LOG(log_level::error) << "Compaction of " << path_ << " failed: " << e.what();
+    }
+    compacting_ = false;
+  });
+}
+
+void hash_table_log_store::run_compaction() {
+  std::unique_lock<std::mutex> merge_lock(merge_lock_);
+
+  // Freeze the current log and snapshot the values living in the base file and the frozen log;
+  // mutations from here on go to a new log
+  std::vector<std::pair<std::string, location>> snapshot;
+  std::size_t dead_bytes;
+  {
+    std::unique_lock<mutex_type> lock(mutex_);
+    if (fds_[frozen_log_file] < 0) {
+      if (fds_[log_file] < 0) {
+        return;
+      }
+      check_io(std::rename(log_path(path_).c_str(), frozen_log_path(path_).c_str()) == 0, "rename", log_path(path_));
+      fds_[frozen_log_file] = fds_[log_file];
+      fds_[log_file] = -1;
+      log_size_ = 0;
+      for (auto &e: index_) {
+        if (e.second.file == log_file) {
+          e.second.file = frozen_log_file;
+        }
+      }
+    }
+    snapshot.reserve(index_.size());
+    for (const auto &e: index_) {
+      if (e.second.file != log_file) {
+        snapshot.emplace_back(e.first, e.second);
+      }
+    }
+    dead_bytes = dead_bytes_;
+  }
+
+  // Write the snapshot as a new base file; the base file and the frozen log are not written
+  // to, so their values can be read without the lock
+  std::vector<location> merged;
+  merged.reserve(snapshot.size());
+  auto tmp_path = compact_path(path_);
+  auto tmp_offset_path = compact_path(offset_path(path_));
+  {
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    std::ofstream offset_out;
+    if (format_ == "binary") {
+      offset_out.open(tmp_offset_path, std::ios::binary | std::ios::trunc);
+    }
+    uint64_t offset = 0;
+    for (const auto &e: snapshot) {
+      auto value = read(e.second);
+      if (format_ == "csv") {
+        out << e.first << "," << value << "\n";
+        merged.push_back(location{base_file, offset + e.first.size() + 1, value.size()});
+        offset += e.first.size() + value.size() + 2;
+      } else {
+        std::size_t key_size = e.first.size();
+        std::size_t value_size = value.size();
+        offset_out.write(reinterpret_cast<const char *>(&key_size), sizeof(size_t));
+        offset_out.write(e.first.data(), key_size);
+        offset_out.write(reinterpret_cast<const char *>(&value_size), sizeof(size_t));
+        out.write(value.data(), value_size);
+        merged.push_back(location{base_file, offset, value.size()});
+        offset += value.size();
+      }
+    }
+    out.flush();
+    check_io(static_cast<bool>(out), "write", tmp_path);
+    if (format_ == "binary") {
+      offset_out.flush();
+      check_io(static_cast<bool>(offset_out), "write", tmp_offset_path);
+    }
+  }
+  sync_file(tmp_path);
+  if (format_ == "binary") {
+    sync_file(tmp_offset_path);
+  }
+
+  // Commit the new base file: once the commit file exists, recovery completes the swap of
+  // both files, and before that it keeps the old ones, so it never sees a mismatched pair
+  auto tmp_commit_path = commit_path(path_) + ".tmp";
+  {
+    std::ofstream commit_out(tmp_commit_path, std::ios::trunc);
+    check_io(static_cast<bool>(commit_out), "create", tmp_commit_path);
+  }
+  sync_file(tmp_commit_path);
+  sync_parent(path_);
+  check_io(std::rename(tmp_commit_path.c_str(), commit_path(path_).c_str()) == 0, "rename", tmp_commit_path);
+  sync_parent(path_);
+
+  // Swap in the new base file and point unchanged keys at it
+  std::unique_lock<mutex_type> lock(mutex_);
+  if (format_ == "binary") {
+    check_io(std::rename(tmp_offset_path.c_str(), offset_path(path_).c_str()) == 0, "rename", tmp_offset_path);
+  }
+  check_io(std::rename(tmp_path.c_str(), path_.c_str()) == 0, "rename", tmp_path);
+  sync_parent(path_);
+  auto base_fd = ::open(path_.c_str(), O_RDONLY);
+  check_io(base_fd >= 0, "open", path_);
+  ::close(fds_[base_file]);
+  fds_[base_file] = base_fd;
+  for (std::size_t i = 0; i < snapshot.size(); ++i) {
+    auto it = index_.find(snapshot[i].first);
+    if (it != index_.end() && it->second == snapshot[i].second) {
+      it->second = merged[i];
+    }
+  }
+  ::close(fds_[frozen_log_file]);
+  fds_[frozen_log_file] = -1;
+  std::remove(frozen_log_path(path_).c_str());
+  std::remove(commit_path(path_).c_str());
+  dead_bytes_ -= dead_bytes;
+}
+
+std::string hash_table_log_store::read(const location &loc) const {
+  std::string value(loc.size, '\0');
+  std::size_t done = 0;
+  while (done < value.size()) {
+    auto n = ::pread(fds_[loc.file], &value[done], value.size() - done, static_cast<off_t>(loc.offset + done));
+    if (n < 0 && errno == EINTR)
+      continue;
+    check_io(n > 0, "read", path_);
+    done += static_cast<std::size_t>(n);
+  }
+  return value;
+}
+
+std::string hash_table_log_store::log_path(const std::string &path) {
+  return path + "_log";
+}
+
+std::string hash_table_log_store::frozen_log_path(const std::string &path) {
+  return path + "_log.frozen";
+}
+
+std::string hash_table_log_store::offset_path(const std::string &path) {
+  return path + "_offset";
+}
+
+std::string hash_table_log_store::compact_path(const std::string &path) {
+  return path + ".compact";
+}
+
+std::string hash_table_log_store::commit_path(const std::string &path) {
+  return path + ".compact_commit";
+}
+
+}
+}
@@ -0,0 +1,235 @@
+#ifndef JIFFY_HASH_TABLE_LOG_STORE_H
+#define JIFFY_HASH_TABLE_LOG_STORE_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace jiffy {
+namespace storage {
+
+// Garbage bytes in a spilled hash table after which the value log is merged into the base file
+constexpr std::size_t HASH_TABLE_LS_COMPACTION_BYTES = 64 * 1024 * 1024;
+
+/**
+ * @brief On-disk engine for a hash table spilled to local storage.
+ *
+ * The base file is the table as written by the partition's serializer, in
+ * either csv ("key,value" lines) or binary (values file plus a "_offset" file
+ * of key and value sizes) format. Mutations are appended as records to a
+ * value log next to it and never rewrite the base file. An in-memory index
+ * maps every live key to the file, offset and size of its value, so point
+ * lookups take no disk reads and gets take a single pread.
+ *
+ * Once superseded and removed values make up more than half of the data and
+ * at least HASH_TABLE_LS_COMPACTION_BYTES, a background thread merges the log
+ * into a fresh base file. Operations continue against a new log meanwhile.
+ * The new base file is synced and committed with a commit file before it
+ * replaces the old one, so that a crash leaves either the old or the new
+ * base file, never the values of one with the offsets of the other.
+ */
+class hash_table_log_store {
+ public:
+  /**
+   * @brief Open the store, indexing the base file and replaying its log
+   * @param path Base file path
+   * @param format Base file format, either csv or binary
+   */
+  hash_table_log_store(const std::string &path, const std::string &format);
+
+  /**
+   * @brief Destructor, waits for a running compaction
+   */
+  ~hash_table_log_store();
+
+  hash_table_log_store(const hash_table_log_store &) = delete;
+  hash_table_log_store &operator=(const hash_table_log_store &) = delete;
+
+  /**
+   * @brief Check if key exists
+   * @param key Key
+   * @return Bool value, true if key exists
+   */
+  bool exists(const std::string &key) const;
+
+  /**
+   * @brief Fetch value for key
+   * @param value Value
+   * @param key Key
+   * @return Bool value, true if key exists
+   */
+  bool get(std::string &value, const std::string &key) const;
+
+  /**
+   * @brief Insert key if it does not exist
+   * @param key Key
+   * @param value Value
+   * @return Bool value, true if inserted
+   */
+  bool put(const std::string &key, const std::string &value);
+
+  /**
+   * @brief Replace value of key if it exists
+   * @param key Key
+   * @param value Value
+   * @return Bool value, true if updated
+   */
+  bool update(const std::string &key, const std::string &value);
+
+  /**
+   * @brief Insert key or replace its value
+   * @param key Key
+   * @param value Value
+   */
+  void upsert(const std::string &key, const std::string &value);
+
+  /**
+   * @brief Remove key if it exists
+   * @param key Key
+   * @return Bool value, true if removed
+   */
+  bool remove(const std::string &key);
+
+  /**
+   * @brief Merge the value log into the base file, waiting for it to finish
+   */
+  void compact();
+
+  /**
+   * @brief Fetch number of keys
+   * @return Number of keys
+   */
+  std::size_t size() const;
+
+  /**
+   * @brief Fetch base file path
+   * @return Base file path
+   */
+  const std::string &path() const;
+
+  /**
+   * @brief Check if a base file exists, so that a store can be opened on it
+   * @param path Base file path
+   * @param format Base file format
+   * @return Bool value, true if the base file exists
+   */
+  static bool base_exists(const std::string &path, const std::string &format);
+
+  /**
+   * @brief Check if a base file has a value log
+   * @param path Base file path
+   * @return Bool value, true if a log exists
+   */
+  static bool has_log(const std::string &path);
+
+  /**
+   * @brief Delete the value log of a base file, e.g. after the base file was rewritten
+   * @param path Base file path
+   */
+  static void discard_log(const std::string &path);
+
+ private:
+  typedef std::shared_timed_mutex mutex_type;
+
+  /* Files values are read from */
+  enum file_id : uint8_t {
+    base_file = 0,
+    log_file = 1,
+    frozen_log_file = 2,
+    num_files = 3
+  };
+
+  /* Record type in the value log */
+  enum record_type : uint8_t {
+    put_record = 0,
+    remove_record = 1
+  };
+
+  /* Location of a value on disk */
+  struct location {
+    uint8_t file;
+    uint64_t offset;
+    uint64_t size;
+
+    bool operator==(const location &other) const {
+      return file == other.file && offset == other.offset && size == other.size;
+    }
+  };
+
+  void recover_base();
+
+  void index_base();
+
+  void replay(const std::string &log_path, uint8_t file);
+
+  void append(record_type type, const std::string &key, const std::string &value);
+
+  void set(const std::string &key, const location &loc);
+
+  void erase(const std::string &key);
+
+  void open_log();
+
+  void maybe_compact();
+
+  void run_compaction();
+
+  std::string read(const location &loc) const;
+
+  static std::string log_path(const std::string &path);
+
+  static std::string frozen_log_path(const std::string &path);
+
+  static std::string offset_path(const std::string &path);
+
+  static std::string compact_path(const std::string &path);
+
+  static std::string commit_path(const std::string &path);
+
+  /* Base file path */
+  std::string path_;
+
+  /* Base file format */
+  std::string format_;
+
+  /* Guards the index, the log tail and the file descriptors */
+  mutable mutex_type mutex_;
+
+  /* Live keys and the location of their value */
+  std::unordered_map<std::string, location> index_;
+
+  /* Open file descriptors, by file_id */
+  int fds_[num_files];
+
+  /* Bytes written to the current log */
+  uint64_t log_size_;
+
+  /* Bytes of live values */
+  std::size_t live_bytes_;
+
+  /* Bytes of superseded or removed values and records */
+  std::size_t dead_bytes_;
+
+  /* Serializes compactions */
+  std::mutex merge_lock_;
+
+  /* Guards the background compaction thread */
+  std::mutex compaction_lock_;
+
+  /* Bool value, true while a background compaction is scheduled or running */
+  std::atomic<bool> compacting_;
+
+  /* Background compaction */
+  std::thread compaction_;
+};
+
+}
+}
+
+#endif //JIFFY_HASH_TABLE_LOG_STORE_H
@@ -23,13 +23,19 @@ hash_table_partition::hash_table_partition(block_memory_manager *manager,
                                            const std::string &auto_scaling_host,
                                            int auto_scaling_port)
     : chain_module(manager, backing_path, name, metadata, HT_OPS),
+      block_(build_allocator<kv_pair_type>()),
       scaling_up_(false),
       scaling_down_(false),
       dirty_(false),
       export_slot_range_(0, -1),
       import_slot_range_(0, -1),
       auto_scaling_host_(auto_scaling_host),
-      auto_scaling_port_(auto_scaling_port) {
+      auto_scaling_port_(auto_scaling_port),
+      tier_threshold_(1.0),
+      tier_min_value_size_(0),
+      eviction_threshold_(1.0),
+      expiring_(false),
+      next_expiry_(0) {
   ser_name_ = conf.get("hashtable.serializer", "csv");
   if (ser_name_ == "binary") {
     ser_ = std::make_shared<binary_serde>(binary_allocator_);
@@ -43,9 +49,38 @@ hash_table_partition::hash_table_partition(block_memory_manager *manager,
   auto_scale_ = conf.get_as<bool>("hashtable.auto_scale", true);
   auto r = utils::string_utils::split(name_, '_');
   slot_range(std::stoi(r[0]), std::stoi(r[1]));
-  temporary_data_manager_ = new block_memory_manager(HASH_TABLE_MAX_KEY_SIZE);
-  temporary_data_allocator_ = allocator<uint8_t>(temporary_data_manager_);
-
+  slot_index_.reserve(hash_table_type::num_stripes());
+  expiry_.reserve(hash_table_type::num_stripes());
+  for (std::size_t i = 0; i < hash_table_type::num_stripes(); ++i) {
+    slot_index_.emplace_back(build_allocator<hash_slot_index::slot_key>());
+    expiry_.emplace_back(build_allocator<hash_table_expiry::wheel_entry>());
+  }
+  // Size the table up front when the expected number of entries is known, so that it never has to grow
+  auto expected_entries = conf.get_as<std::size_t>("hashtable.expected_entries", 0);
+  if (expected_entries > 0) {
+    try {
+      block_.reserve(expected_entries);
+    } catch (std::bad_alloc &) {
+      LOG(log_level::warn) << "Could not size hash table for " << expected_entries << " entries; growing on demand";
+    }
+  }
+  // Keep keys and hot values in memory and spill cold values to a local value file
+  auto tier_path = conf.get("hashtable.tier_path", "");
+  if (!tier_path.empty() && conf.get_as<bool>("hashtable.tiering", true)) {
+    tier_threshold_ = conf.get_as<double>("hashtable.tier_threshold", 0.8);
+    tier_min_value_size_ = conf.get_as<std::size_t>("hashtable.tier_min_value_size", 128);
+    tier_.reset(new hash_table_value_tier(tier_path, hash_table_type::num_stripes(),
+                                          build_allocator<std::pair<const uint8_t *const,
+                                                                    hash_table_value_tier::location>>()));
+  }
+  // Run as a cache of fixed size: evict cold entries once full instead of failing writes or splitting
+  auto eviction = conf.get("hashtable.eviction", "none");
+  if (eviction != "none") {
+    eviction_threshold_ = conf.get_as<double>("hashtable.eviction_threshold", 0.95);
+    eviction_.reset(new hash_table_eviction(hash_table_eviction::parse_policy(eviction), storage_capacity(),
+                                            hash_table_type::num_stripes()));
+    auto_scale_ = false;
+  }
 }
 
 void hash_table_partition::exists(response &_return, const arg_list &args) {
@@ -53,12 +88,16 @@ void hash_table_partition::exists(response &_return, const arg_list &args) {
     RETURN("!args_error");
   }
   auto hash = hash_slot::get(args[1]);
+  shared_lock state_lock(state_lock_);
   if (in_slot_range(hash) || (in_import_slot_range(hash) && args[2] == "!redirected")) {
+    auto stripe_id = block_.stripe_index(args[1]);
+    auto &stripe = block_.stripe_at(stripe_id);
+    shared_lock stripe_lock(stripe.mutex);
     BEGIN_CATCH_HANDLER;
-      if (it != block_.end()) {
+      if (it != table.end() && !expired(stripe_id, it->first)) {
         RETURN_OK();
       } else {
-        if (metadata_ == "exporting" && in_export_slot_range(hash)) {
+        if (state_ == state_exporting && in_export_slot_range(hash)) {
           RETURN_ERR("!exporting", export_target_str_);
         }
         RETURN_ERR("!key_not_found");
@@ -72,24 +111,46 @@ void hash_table_partition::put(response &_return, const arg_list &args) {
   if (!(args.size() == 3 || (args.size() == 4 && args[3] == "!redirected"))) {
     RETURN_ERR("!args_error");
   }
+  put_entry(_return, args, args.size() == 4, 0);
+}
+
+void hash_table_partition::put_ttl(response &_return, const arg_list &args) {
+  if (!(args.size() == 4 || (args.size() == 5 && args[4] == "!redirected"))) {
+    RETURN_ERR("!args_error");
+  }
+  auto ttl = int_arg(args, 3);
+  if (ttl <= 0) {
+    RETURN_ERR("!args_error");
+  }
+  put_entry(_return, args, args.size() == 5, hash_table_expiry::now_ms() + static_cast<uint64_t>(ttl));
+}
+
+void hash_table_partition::put_entry(response &_return, const arg_list &args, bool redirected, uint64_t deadline) {
   auto hash = hash_slot::get(args[1]);
-  if (in_slot_range(hash) || (in_import_slot_range(hash) && args[3] == "!redirected")) {
-    if (storage_size() + args[1].size() > storage_capacity()) {
+  shared_lock state_lock(state_lock_);
+  if (in_slot_range(hash) || (in_import_slot_range(hash) && redirected)) {
+    if (eviction_ == nullptr && storage_size() + args[1].size() > storage_capacity()) {
       RETURN_ERR("!redo");
     }
+    auto stripe_id = block_.stripe_index(args[1]);
+    auto &stripe = block_.stripe_at(stripe_id);
+    unique_lock stripe_lock(stripe.mutex);
+    if (eviction_ != nullptr && !make_room(stripe_id, args[1], args[1].size() + args[2].size())) {
+      RETURN_ERR("!full");
+    }
     BEGIN_CATCH_HANDLER;
-      if (it != block_.end()) {
+      if (it != table.end() && !erase_if_expired(stripe_id, hash, args[1], it->first)) {
         RETURN_ERR("!duplicate_key");
       }
-      if (metadata_ == "exporting" && in_export_slot_range(hash)) {
+      if (state_ == state_exporting && in_export_slot_range(hash)) {
         RETURN_ERR("!exporting", export_target_str_);
       }
       if (storage_size() + args[1].size() + args[2].size() > storage_capacity()) {
         RETURN_ERR("!full");
       }
-      if (block_.emplace(make_binary(args[1]), make_binary(args[2])).second) {
-        if (remove_cache_.find(args[1]) != remove_cache_.end())
-          remove_cache_.erase(args[1]);
+      if (insert_entry(stripe_id, hash, args[1], args[2], deadline)) {
+        touch(args[1]);
+        clear_buffered_remove(args[1]);
         RETURN_OK();
       }
     END_CATCH_HANDLER;
@@ -101,43 +162,81 @@ void hash_table_partition::upsert(response &_return, const arg_list &args) {
   if (!(args.size() == 3 || (args.size() == 6 && args[5] == "!redirected"))) {
     RETURN_ERR("!args_error");
   }
+  upsert_entry(_return, args, 3, 0);
+}
+
+void hash_table_partition::upsert_ttl(response &_return, const arg_list &args) {
+  if (!(args.size() == 4 || (args.size() == 7 && args[6] == "!redirected"))) {
+    RETURN_ERR("!args_error");
+  }
+  auto ttl = int_arg(args, 3);
+  if (ttl <= 0) {
+    RETURN_ERR("!args_error");
+  }
+  upsert_entry(_return, args, 4, hash_table_expiry::now_ms() + static_cast<uint64_t>(ttl));
+}
+
+void hash_table_partition::upsert_entry(response &_return,
+                                        const arg_list &args,
+                                        std::size_t redirect_arg,
+                                        uint64_t deadline) {
   auto hash = hash_slot::get(args[1]);
   bool found = false;
   std::string old_val;
+  shared_lock state_lock(state_lock_);
+  auto stripe_id = block_.stripe_index(args[1]);
+  auto &stripe = block_.stripe_at(stripe_id);
   // Redirected upsert
-  if (in_import_slot_range(hash) && args.size() == 6 && args[5] == "!redirected" && metadata() == "importing") {
-    found = static_cast<bool>(std::stoi(args[3]));
+  if (in_import_slot_range(hash) && args.size() == redirect_arg + 3 && args[redirect_arg + 2] == "!redirected"
+      && state_ == state_importing) {
+    found = static_cast<bool>(std::stoi(args[redirect_arg]));
+    unique_lock stripe_lock(stripe.mutex);
+    if (eviction_ != nullptr && !make_room(stripe_id, args[1], args[1].size() + args[2].size())) {
+      RETURN_ERR("!full");
+    }
     BEGIN_CATCH_HANDLER;
-      if (it != block_.end()) {
-        old_val = to_string(it->second);
-        it->second = make_binary(args[2]);
-        RETURN_OK(old_val);
+      if (it != table.end() && erase_if_expired(stripe_id, hash, args[1], it->first)) {
+        it = table.end();
       }
-      if (found && block_.emplace(make_binary(args[1]), make_binary(args[2])).second) {
-        RETURN_OK(args[4]);
+      if (it != table.end()) {
+        old_val = read_value(stripe_id, *it);
+        write_value(stripe_id, *it, args[2]);
+        set_deadline(stripe_id, it->first, deadline);
+        RETURN_OK(std::move(old_val));
       }
-      block_.emplace(make_binary(args[1]), make_binary(args[2]));
+      if (found && insert_entry(stripe_id, hash, args[1], args[2], deadline)) {
+        RETURN_OK(args[redirect_arg + 1]);
+      }
+      insert_entry(stripe_id, hash, args[1], args[2], deadline);
     END_CATCH_HANDLER;
-    if (remove_cache_.find(args[1]) != remove_cache_.end())
-      remove_cache_.erase(args[1]);
+    clear_buffered_remove(args[1]);
     RETURN_OK();
   }
   // Ordinary upsert
   if (in_slot_range(hash)) {
+    unique_lock stripe_lock(stripe.mutex);
+    if (eviction_ != nullptr && !make_room(stripe_id, args[1], args[1].size() + args[2].size())) {
+      RETURN_ERR("!full");
+    }
     BEGIN_CATCH_HANDLER;
-      if (it != block_.end()) {
+      if (it != table.end() && erase_if_expired(stripe_id, hash, args[1], it->first)) {
+        it = table.end();
+      }
+      if (it != table.end()) {
         found = true;
-        old_val = to_string(it->second);
-        it->second = make_binary(args[2]);
-        if (metadata_ == "exporting" && in_export_slot_range(hash)) {
+        old_val = read_value(stripe_id, *it);
+        write_value(stripe_id, *it, args[2]);
+        set_deadline(stripe_id, it->first, deadline);
+        touch(args[1]);
+        if (state_ == state_exporting && in_export_slot_range(hash)) {
           RETURN_ERR("!exporting", export_target_str_, std::to_string(found), old_val);
         }
-        RETURN_OK(old_val);
+        RETURN_OK(std::move(old_val));
       }
-      if (metadata_ == "exporting" && in_export_slot_range(hash)) {
+      if (state_ == state_exporting && in_export_slot_range(hash)) {
         RETURN_ERR("!exporting", export_target_str_, std::to_string(found), old_val);
       }
-      block_.emplace(make_binary(args[1]), make_binary(args[2]));
+      insert_entry(stripe_id, hash, args[1], args[2], deadline);
     END_CATCH_HANDLER;
     RETURN_OK();
   }
@@ -149,12 +248,17 @@ void hash_table_partition::get(response &_return, const arg_list &args) {
     RETURN("!args_error");
   }
   auto hash = hash_slot::get(args[1]);
+  shared_lock state_lock(state_lock_);
   if (in_slot_range(hash) || (in_import_slot_range(hash) && args[2] == "!redirected")) {
+    auto stripe_id = block_.stripe_index(args[1]);
+    auto &stripe = block_.stripe_at(stripe_id);
+    shared_lock stripe_lock(stripe.mutex);
     BEGIN_CATCH_HANDLER;
-      if (it != block_.end()) {
-        RETURN_OK(to_string(it->second));
+      if (it != table.end() && !expired(stripe_id, it->first)) {
+        touch(args[1]);
+        RETURN_OK(read_value(stripe_id, *it));
       } else {
-        if (metadata_ == "exporting" && in_export_slot_range(hash)) {
+        if (state_ == state_exporting && in_export_slot_range(hash)) {
           RETURN_ERR("!exporting", export_target_str_);
         }
         RETURN_ERR("!key_not_found");
@@ -171,18 +275,27 @@ void hash_table_partition::update(response &_return, const arg_list &args) {
   auto hash = hash_slot::get(args[1]);
   bool found = false;
   std::string old_val;
+  shared_lock state_lock(state_lock_);
+  auto stripe_id = block_.stripe_index(args[1]);
+  auto &stripe = block_.stripe_at(stripe_id);
   // Redirected update
-  if (in_import_slot_range(hash) && args.size() == 6 && args[5] == "!redirected" && metadata() == "importing") {
+  if (in_import_slot_range(hash) && args.size() == 6 && args[5] == "!redirected" && state_ == state_importing) {
     found = static_cast<bool>(std::stoi(args[3]));
+    unique_lock stripe_lock(stripe.mutex);
+    if (eviction_ != nullptr && !make_room(stripe_id, args[1], args[1].size() + args[2].size())) {
+      RETURN_ERR("!full");
+    }
     BEGIN_CATCH_HANDLER;
-      if (it != block_.end()) {
-        old_val = to_string(it->second);
-        it->second = make_binary(args[2]);
+      if (it != table.end() && erase_if_expired(stripe_id, hash, args[1], it->first)) {
+        it = table.end();
+      }
+      if (it != table.end()) {
+        old_val = read_value(stripe_id, *it);
+        write_value(stripe_id, *it, args[2]);
         RETURN_OK();
       }
-      if (found && block_.emplace(make_binary(args[1]), make_binary(args[2])).second) {
-        if (remove_cache_.find(args[1]) != remove_cache_.end())
-          remove_cache_.erase(args[1]);
+      if (found && insert_entry(stripe_id, hash, args[1], args[2])) {
+        clear_buffered_remove(args[1]);
         RETURN_OK();
       }
     END_CATCH_HANDLER;
@@ -190,17 +303,25 @@ void hash_table_partition::update(response &_return, const arg_list &args) {
   }
   // Ordinary update
   if (in_slot_range(hash)) {
+    unique_lock stripe_lock(stripe.mutex);
+    if (eviction_ != nullptr && !make_room(stripe_id, args[1], args[1].size() + args[2].size())) {
+      RETURN_ERR("!full");
+    }
     BEGIN_CATCH_HANDLER;
-      if (it != block_.end()) {
+      if (it != table.end() && erase_if_expired(stripe_id, hash, args[1], it->first)) {
+        it = table.end();
+      }
+      if (it != table.end()) {
         found = true;
-        old_val = to_string(it->second);
-        it->second = make_binary(args[2]);
-        if (metadata_ == "exporting" && in_export_slot_range(hash)) {
+        old_val = read_value(stripe_id, *it);
+        write_value(stripe_id, *it, args[2]);
+        touch(args[1]);
+        if (state_ == state_exporting && in_export_slot_range(hash)) {
           RETURN_ERR("!exporting", export_target_str_, std::to_string(found), old_val);
         }
         RETURN_OK();
       }
-      if (metadata_ == "exporting" && in_export_slot_range(hash)) {
+      if (state_ == state_exporting && in_export_slot_range(hash)) {
         RETURN_ERR("!exporting", export_target_str_, std::to_string(found), old_val);
       }
       RETURN_ERR("!key_not_found");
@@ -215,16 +336,20 @@ void hash_table_partition::remove(response &_return, const arg_list &args) {
     RETURN_ERR("!args_error");
   }
   auto hash = hash_slot::get(args[1]);
+  shared_lock state_lock(state_lock_);
+  auto stripe_id = block_.stripe_index(args[1]);
+  auto &stripe = block_.stripe_at(stripe_id);
   // Ordinary remove or buffered remove
   if (in_slot_range(hash) || (in_import_slot_range(hash) && args[2] == "!buffered")) {
+    unique_lock stripe_lock(stripe.mutex);
     try {
-      if (block_.erase(make_temporary_binary(args[1]))) {
-        if (metadata_ == "exporting" && in_export_slot_range(hash)) {
+      if (erase_entry(stripe_id, hash, args[1])) {
+        if (state_ == state_exporting && in_export_slot_range(hash)) {
           RETURN_ERR("!exporting", export_target_str_);
         }
         RETURN_OK();
       }
-      if (metadata_ == "exporting" && in_export_slot_range(hash)) {
+      if (state_ == state_exporting && in_export_slot_range(hash)) {
         RETURN_ERR("!exporting", export_target_str_);
       }
       RETURN_OK();
@@ -232,11 +357,13 @@ void hash_table_partition::remove(response &_return, const arg_list &args) {
   }
   // Redirected remove
   if (in_import_slot_range(hash) && args[2] == "!redirected") {
+    unique_lock stripe_lock(stripe.mutex);
     try {
-      if (block_.erase(make_temporary_binary(args[1]))) {
+      if (erase_entry(stripe_id, hash, args[1])) {
         RETURN_OK();
       }
     END_CATCH_HANDLER;
+    std::unique_lock<std::mutex> cache_lock(remove_cache_lock_);
     remove_cache_.emplace(std::make_pair(args[1], 1));
     RETURN_OK();
   }
@@ -247,460 +374,124 @@ void hash_table_partition::exists_ls(response &_return, const arg_list &args) {
   if (args.size() != 2) {
     RETURN("!args_error");
   }
-  std::string file_path, line, key, value;
-  file_path = directory_utils::remove_uri(backing_path());
-  directory_utils::push_path_element(file_path,name());
-  if (ser_name_ == "csv") {
-    std::ifstream in(file_path);
-    if (in) {
-      while(getline(in,line)) {
-        int split_index = line.find(",");
-        key = line.substr(0,split_index);
-        if (key == args[1]) {
-          RETURN_OK();
-        }
-      }
-      in.close();
-      RETURN_ERR("!key_not_found");
-    }
-    else {
-      RETURN_ERR("!hash_table_does_not_exist");
-    }
+  shared_lock state_lock(state_lock_);
+  auto store = ls_store();
+  if (store == nullptr) {
+    RETURN_ERR("!hash_table_does_not_exist");
   }
-  else if (ser_name_ == "binary") {
-    std::string offset_path = file_path;
-    offset_path.append("_offset");
-    std::ifstream offset_in(offset_path,std::ios::binary);
-    std::size_t key_size = 0;
-    std::size_t value_size = 0;
-    if (offset_in) {
-      while (offset_in.peek() != EOF) {
-        offset_in.read(reinterpret_cast<char *>(&key_size), sizeof(key_size));
-        key.resize(key_size);
-        offset_in.read(&key[0], key_size);
-        offset_in.read(reinterpret_cast<char *>(&value_size), sizeof(value_size));
-        if (key == args[1]) {
-          offset_in.close();
-          RETURN_OK();
-        }
-      }
-      offset_in.close();
-      RETURN_ERR("!key_not_found");
-    }
-    else {
-      RETURN_ERR("!fifo_queue_does_not_exist");
-    }
+  if (store->exists(args[1])) {
+    RETURN_OK();
   }
+  RETURN_ERR("!key_not_found");
 }
 
 void hash_table_partition::put_ls(response &_return, const arg_list &args) {
   if (args.size() != 3) {
     RETURN_ERR("!args_error");
   }
-  std::string file_path, line, key, value;
-  file_path = directory_utils::remove_uri(backing_path());
-  directory_utils::push_path_element(file_path,name());
-  if (ser_name_ == "csv") {
-    std::ifstream in(file_path);
-    if (in) {
-      while(getline(in,line)) {
-        int split_index = line.find(",");
-        key = line.substr(0,split_index);
-        if (key == args[1]) {
-          in.close();
-          RETURN_ERR("!duplicate_key");
-        }
-      }
-      in.close();
-      std::ofstream out(file_path,std::ios::app);
-      out << args[1] << "," << args[2] << std::endl;
-      out.close();
-      RETURN_OK();
-    }
-    else {
-      RETURN_ERR("!hash_table_does_not_exist");
-    }
+  shared_lock state_lock(state_lock_);
+  auto store = ls_store();
+  if (store == nullptr) {
+    RETURN_ERR("!hash_table_does_not_exist");
   }
-  else if (ser_name_ == "binary") {
-    std::string offset_path = file_path;
-    offset_path.append("_offset");
-    std::ifstream offset_in(offset_path,std::ios::binary);
-    std::size_t key_size = 0;
-    std::size_t value_size = 0;
-    if (offset_in) {
-      while (offset_in.peek() != EOF) {
-        offset_in.read(reinterpret_cast<char *>(&key_size), sizeof(key_size));
-        key.resize(key_size);
-        offset_in.read(&key[0], key_size);
-        offset_in.read(reinterpret_cast<char *>(&value_size), sizeof(value_size));
-        if (key == args[1]) {
-          offset_in.close();
-          RETURN_ERR("!duplicate_key");
-        }
-      }
-      offset_in.close();
-      std::ofstream out(file_path,std::ios::app);
-      std::ofstream offset_out(offset_path,std::ios::app);
-      key_size = args[1].size();
-      value_size = args[2].size();
-      offset_out.write(reinterpret_cast<const char *>(&key_size), sizeof(size_t));
-      offset_out.write(reinterpret_cast<const char *>(args[1].data()), key_size);
-      offset_out.write(reinterpret_cast<const char *>(&value_size), sizeof(size_t));
-      out.write(reinterpret_cast<const char *>(args[2].data()), value_size);
-      out.close();
-      offset_out.close();
-      RETURN_OK();
-    }
-    else {
-      RETURN_ERR("!fifo_queue_does_not_exist");
-    }
+  if (store->put(args[1], args[2])) {
+    RETURN_OK();
   }
+  RETURN_ERR("!duplicate_key");
 }
 
 void hash_table_partition::upsert_ls(response &_return, const arg_list &args) {
   if (args.size() != 3) {
     RETURN_ERR("!args_error");
   }
-  std::unordered_map<std::string,std::string> ht;
-  std::string file_path, line, key, value;
-  int key_exist = 0;
-  file_path = directory_utils::remove_uri(backing_path());
-  directory_utils::push_path_element(file_path,name());
-  if (ser_name_ == "csv") {
-    std::ifstream in(file_path);
-    if (in) {
-      while(getline(in,line)) {
-        int split_index = line.find(",");
-        key = line.substr(0,split_index);
-        if (key == args[1]) {
-          key_exist = 1;
-          value = args[2];
-          ht.insert({key,value});
-          continue;
-        }
-        value = line.substr(split_index+1);
-        ht.insert({key,value});
-      }
-      in.close();
-    }
-    else {
-      RETURN_ERR("!hash_table_does_not_exist");
-    }
-    if (key_exist == 0) {
-      ht.insert({args[1],args[2]});
-    }
-    std::ofstream out(file_path);
-    for (auto x: ht) {
-      out << (x.first) << "," << (x.second) << std::endl;
-    }
-    out.close();
-    RETURN_OK();
-  }
-  else if (ser_name_ == "binary") {
-    std::ifstream in(file_path,std::ios::binary);
-    std::string offset_path = file_path;
-    offset_path.append("_offset");
-    std::ifstream offset_in(offset_path,std::ios::binary);
-    std::size_t key_size = 0;
-    std::size_t value_size = 0;
-    if (in && offset_in) {
-      while (offset_in.peek() != EOF) {
-        offset_in.read(reinterpret_cast<char *>(&key_size), sizeof(key_size));
-        key.resize(key_size);
-        offset_in.read(&key[0], key_size);
-        offset_in.read(reinterpret_cast<char *>(&value_size), sizeof(value_size));
-        if (key == args[1]) {
-          key_exist = 1;
-          in.read(&value[0], value_size);
-          ht.insert({key,args[2]});
-          continue;
-        }
-        value.resize(value_size);
-        in.read(&value[0], value_size);
-        ht.insert({key,value});
-      }
-      in.close();
-      offset_in.close();
-    }
-    else {
-      RETURN_ERR("!hash_table_does_not_exist");
-    }
-    if (key_exist == 0) {
-      ht.insert({args[1],args[2]});
-    }
-    std::ofstream out(file_path,std::ios::binary);
-    std::ofstream offset_out(offset_path,std::ios::binary);
-    for (auto x: ht) {
-      key_size = x.first.size();
-      value_size = x.second.size();
-      offset_out.write(reinterpret_cast<const char *>(&key_size), sizeof(size_t));
-      offset_out.write(reinterpret_cast<const char *>(x.first.data()), key_size);
-      offset_out.write(reinterpret_cast<const char *>(&value_size), sizeof(size_t));
-      out.write(reinterpret_cast<const char *>(x.second.data()), value_size);
-    }
-    out.close();
-    offset_out.close();
-    RETURN_OK();
+  shared_lock state_lock(state_lock_);
+  auto store = ls_store();
+  if (store == nullptr) {
+    RETURN_ERR("!hash_table_does_not_exist");
   }
-  
+  store->upsert(args[1], args[2]);
+  RETURN_OK();
 }
 
 void hash_table_partition::get_ls(response &_return, const arg_list &args) {
   if (args.size() != 2) {
     RETURN("!args_error");
   }
-  std::string file_path, line, key, value;
-  file_path = directory_utils::remove_uri(backing_path());
-  directory_utils::push_path_element(file_path,name());
-  if (ser_name_ == "csv") {
-    std::ifstream in(file_path);
-    if (in) {
-      while(getline(in,line)) {
-        int split_index = line.find(",");
-        key = line.substr(0,split_index);
-        if (key == args[1]) {
-          value = line.substr(split_index+1);
-          RETURN_OK(value);
-        }
-      }
-      in.close();
-      RETURN_ERR("!key_not_found");
-    }
-    else {
-      RETURN_ERR("!hash_table_does_not_exist");
-    }
+  shared_lock state_lock(state_lock_);
+  auto store = ls_store();
+  if (store == nullptr) {
+    RETURN_ERR("!hash_table_does_not_exist");
   }
-  else if (ser_name_ == "binary") {
-    std::ifstream in(file_path,std::ios::binary);
-    std::string offset_path = file_path;
-    offset_path.append("_offset");
-    std::ifstream offset_in(offset_path,std::ios::binary);
-    std::size_t offset = 0;
-    std::size_t key_size = 0;
-    std::size_t value_size = 0;
-    if (in && offset_in) {
-      while (offset_in.peek() != EOF) {
-        offset_in.read(reinterpret_cast<char *>(&key_size), sizeof(key_size));
-        key.resize(key_size);
-        offset_in.read(&key[0], key_size);
-        offset_in.read(reinterpret_cast<char *>(&value_size), sizeof(value_size));
-        if (key == args[1]) {
-          value.resize(value_size);
-          in.seekg(offset,std::ios::beg);
-          in.read(&value[0], value_size);
-          RETURN_OK(value);
-        }
-        offset += value_size;
-      }
-      in.close();
-      offset_in.close();
-      RETURN_ERR("!key_not_found");
-    }
-    else {
-      RETURN_ERR("!hash_table_does_not_exist");
-    }
+  std::string value;
+  if (store->get(value, args[1])) {
+    RETURN_OK(std::move(value));
   }
+  RETURN_ERR("!key_not_found");
 }
 
 void hash_table_partition::update_ls(response &_return, const arg_list &args) {
   if (args.size() != 3) {
     RETURN_ERR("!args_error");
   }
-  
-  std::unordered_map<std::string,std::string> ht;
-  std::string file_path, line, key, value;
-  int key_exist = 0;
-  file_path = directory_utils::remove_uri(backing_path());
-  directory_utils::push_path_element(file_path,name());
-  if (ser_name_ == "csv") {
-    std::ifstream in(file_path);
-    if (in) {
-      while(getline(in,line)) {
-        int split_index = line.find(",");
-        key = line.substr(0,split_index);
-        if (key == args[1]) {
-          key_exist = 1;
-          value = args[2];
-          ht.insert({key,value});
-          continue;
-        }
-        value = line.substr(split_index+1);
-        ht.insert({key,value});
-      }
-      in.close();
-    }
-    else {
-      RETURN_ERR("!hash_table_does_not_exist");
-    }
-    if (key_exist == 1) {
-      std::ofstream out(file_path);
-      for (auto x: ht) {
-        out << (x.first) << "," << (x.second) << std::endl;
-      }
-      out.close();
-      RETURN_OK();
-    }
-    else {
-      RETURN_ERR("!key_not_found");
-    }
+  shared_lock state_lock(state_lock_);
+  auto store = ls_store();
+  if (store == nullptr) {
+    RETURN_ERR("!hash_table_does_not_exist");
   }
-  else if (ser_name_ == "binary") {
-    std::ifstream in(file_path,std::ios::binary);
-    std::string offset_path = file_path;
-    offset_path.append("_offset");
-    std::ifstream offset_in(offset_path,std::ios::binary);
-    std::size_t key_size = 0;
-    std::size_t value_size = 0;
-    if (in && offset_in) {
-      while (offset_in.peek() != EOF) {
-        offset_in.read(reinterpret_cast<char *>(&key_size), sizeof(key_size));
-        key.resize(key_size);
-        offset_in.read(&key[0], key_size);
-        offset_in.read(reinterpret_cast<char *>(&value_size), sizeof(value_size));
-        if (key == args[1]) {
-          key_exist = 1;
-          in.read(&value[0], value_size);
-          ht.insert({key,args[2]});
-          continue;
-        }
-        value.resize(value_size);
-        in.read(&value[0], value_size);
-        ht.insert({key,value});
-      }
-      in.close();
-      offset_in.close();
-    }
-    else {
-      RETURN_ERR("!hash_table_does_not_exist");
-    }
-    if (key_exist == 0) {
-      RETURN_ERR("!key_not_found");
-    }
-    std::ofstream out(file_path,std::ios::binary);
-    std::ofstream offset_out(offset_path,std::ios::binary);
-    for (auto x: ht) {
-      key_size = x.first.size();
-      value_size = x.second.size();
-      offset_out.write(reinterpret_cast<const char *>(&key_size), sizeof(size_t));
-      offset_out.write(reinterpret_cast<const char *>(x.first.data()), key_size);
-      offset_out.write(reinterpret_cast<const char *>(&value_size), sizeof(size_t));
-      out.write(reinterpret_cast<const char *>(x.second.data()), value_size);
-    }
-    out.close();
-    offset_out.close();
+  if (store->update(args[1], args[2])) {
     RETURN_OK();
   }
+  RETURN_ERR("!key_not_found");
 }
 
 void hash_table_partition::remove_ls(response &_return, const arg_list &args) {
   if (args.size() != 2) {
     RETURN_ERR("!args_error");
   }
-  // Ordinary remove or buffered remove
-  std::unordered_map<std::string,std::string> ht;
-  std::string file_path, line, key, value;
-  int key_exist = 0;
-  file_path = directory_utils::remove_uri(backing_path());
-  directory_utils::push_path_element(file_path,name());
-  if (ser_name_ == "csv") {
-    std::ifstream in(file_path);
-    if (in) {
-      while(getline(in,line)) {
-        int split_index = line.find(",");
-        key = line.substr(0,split_index);
-        if (key == args[1]) {
-          key_exist = 1;
-          continue;
-        }
-        value = line.substr(split_index+1);
-        ht.insert({key,value});
-      }
-      in.close();
-    }
-    else {
-      RETURN_ERR("!hash_table_does_not_exist");
-    }
-    if (key_exist == 1) {
-      std::ofstream out(file_path);
-      for (auto x: ht) {
-        out << (x.first) << "," << (x.second) << std::endl;
-      }
-      out.close();
-      RETURN_OK();
-    }
-    else {
-      RETURN_ERR("!key_not_found");
-    }
+  shared_lock state_lock(state_lock_);
+  auto store = ls_store();
+  if (store == nullptr) {
+    RETURN_ERR("!hash_table_does_not_exist");
   }
-  else if (ser_name_ == "binary") {
-    std::ifstream in(file_path,std::ios::binary);
-    std::string offset_path = file_path;
-    offset_path.append("_offset");
-    std::ifstream offset_in(offset_path,std::ios::binary);
-    std::size_t key_size = 0;
-    std::size_t value_size = 0;
-    if (in && offset_in) {
-      while (offset_in.peek() != EOF) {
-        offset_in.read(reinterpret_cast<char *>(&key_size), sizeof(key_size));
-        key.resize(key_size);
-        offset_in.read(&key[0], key_size);
-        offset_in.read(reinterpret_cast<char *>(&value_size), sizeof(value_size));
-        if (key == args[1]) {
-          key_exist = 1;
-          in.read(&value[0], value_size);
-          continue;
-        }
-        value.resize(value_size);
-        in.read(&value[0], value_size);
-        ht.insert({key,value});
-      }
-      in.close();
-      offset_in.close();
-    }
-    else {
-      RETURN_ERR("!hash_table_does_not_exist");
-    }
-    if (key_exist == 0) {
-      RETURN_ERR("!key_not_found");
-    }
-    std::ofstream out(file_path,std::ios::binary);
-    std::ofstream offset_out(offset_path,std::ios::binary);
-    for (auto x: ht) {
-      key_size = x.first.size();
-      value_size = x.second.size();
-      offset_out.write(reinterpret_cast<const char *>(&key_size), sizeof(size_t));
-      offset_out.write(reinterpret_cast<const char *>(x.first.data()), key_size);
-      offset_out.write(reinterpret_cast<const char *>(&value_size), sizeof(size_t));
-      out.write(reinterpret_cast<const char *>(x.second.data()), value_size);
-    }
-    out.close();
-    offset_out.close();
+  if (store->remove(args[1])) {
     RETURN_OK();
   }
+  RETURN_ERR("!key_not_found");
 }
 
 void hash_table_partition::scale_remove(response &_return, const arg_list &args) {
+  shared_lock state_lock(state_lock_);
   for (size_t i = 1; i < args.size(); ++i) {
-    try {
-      if (!block_.erase(make_temporary_binary(args[i]))) {
-        LOG(log_level::info) << "Unsuccessful scale remove";
-      }
-    } catch (std::bad_alloc &e) {
-      throw std::logic_error("Exceed max key size!");
+    auto stripe_id = block_.stripe_index(args[i]);
+    unique_lock stripe_lock(block_.stripe_at(stripe_id).mutex);
+    if (!erase_entry(stripe_id, hash_slot::get(args[i]), args[i])) {
+      LOG(log_level::info) << "Unsuccessful scale remove";
     }
   }
   RETURN_OK();
 }
 
 void hash_table_partition::scale_put(response &_return, const arg_list &args) {
-  for (size_t i = 1; i < args.size(); i += 2) {
-    auto it = remove_cache_.find(args[i]);
-    if (it != remove_cache_.end()) {
-      remove_cache_.erase(args[i]);
-      continue;
+  if (args.size() % 3 != 1) {
+    RETURN_ERR("!args_error");
+  }
+  auto now = hash_table_expiry::now_ms();
+  shared_lock state_lock(state_lock_);
+  for (size_t i = 1; i < args.size(); i += 3) {
+    auto stripe_id = block_.stripe_index(args[i]);
+    unique_lock stripe_lock(block_.stripe_at(stripe_id).mutex);
+    {
+      // Removed while importing; the buffered remove stays so that a resent batch skips it too
+      std::unique_lock<std::mutex> cache_lock(remove_cache_lock_);
+      if (remove_cache_.count(args[i])) {
+        continue;
+      }
     }
+    // Re-arm the time left at the source on our own clock
+    auto ttl = int_arg(args, i + 2);
+    auto deadline = ttl > 0 ? now + static_cast<uint64_t>(ttl) : 0;
     try {
-      if (!block_.emplace(make_binary(args[i]), make_binary(args[i + 1])).second) {
+      if (!insert_entry(stripe_id, hash_slot::get(args[i]), args[i], args[i + 1], deadline)) {
         LOG(log_level::info) << "Unsuccessful scale put";
       }
     } catch (std::bad_alloc &e) {
@@ -711,25 +502,52 @@ void hash_table_partition::scale_put(response &_return, const arg_list &args) {
 }
 
 void hash_table_partition::get_data_in_slot_range(response &_return, const arg_list &args) {
-  if (args.size() != 4) {
+  if (args.size() != 4 && args.size() != 5) {
     RETURN_ERR("!args_error");
   }
   std::size_t n_items = 0;
-  auto slot_begin = std::stoi(args[1]);
-  auto slot_end = std::stoi(args[2]);
-  auto batch_size = std::stoull(args[3]);
-  for (const auto &entry: block_) {
-    auto slot = hash_slot::get(entry.first);
-    if (slot >= slot_begin && slot < slot_end) {
-      if (_return.empty())
-        _return.emplace_back("!ok");
-      _return.emplace_back(to_string(entry.first));
-      _return.emplace_back(to_string(entry.second));
-      n_items += 2;
-      if (n_items == static_cast<std::size_t>(batch_size)) {
-        return;
-      }
-    }
+  std::size_t n_bytes = 0;
+  auto slot_begin = static_cast<int32_t>(int_arg(args, 1));
+  auto slot_end = static_cast<int32_t>(int_arg(args, 2));
+  auto batch_size = static_cast<std::size_t>(int_arg(args, 3));
+  auto now = hash_table_expiry::now_ms();
+  auto visit = [&](std::size_t stripe, const hash_slot_index::slot_key &key) {
+    auto it = block_.stripe_at(stripe).table.find(key);
+    uint64_t deadline = 0;
+    if (expiring_ && expiry_[stripe].deadline(it->first, deadline) && deadline <= now)
+      return true;
+    if (_return.empty())
+      _return.emplace_back("!ok");
+    _return.emplace_back(key.to_string());
+    _return.emplace_back(read_value(stripe, *it));
+    n_bytes += key.size() + _return.back().size();
+    // Ship the time left rather than the deadline, as the destination's clock need not agree with ours
+    _return.emplace_back(std::to_string(deadline > 0 ? deadline - now : 0));
+    n_items += 2;
+    return n_items < batch_size && n_bytes < HASH_TABLE_TRANSFER_BATCH_BYTES;
+  };
+  shared_lock state_lock(state_lock_);
+  // Keys are scanned stripe by stripe in slot order, so the last key of the previous batch
+  // locates where the scan stopped: its stripe, then its position in that stripe's index
+  std::size_t i = 0;
+  if (args.size() == 5) {
+    const auto &after = args[4];
+    i = block_.stripe_index(after);
+    const auto &stripe = block_.stripe_at(i);
+    shared_lock stripe_lock(stripe.mutex);
+    hash_slot_index::slot_key after_key(hash_slot::get(after), reinterpret_cast<const uint8_t *>(after.data()),
+                                        after.size());
+    slot_index_[i].for_each_after(after_key, slot_end, [&](const hash_slot_index::slot_key &key) {
+      return visit(i, key);
+    });
+    ++i;
+  }
+  for (; i < slot_index_.size() && n_items < batch_size && n_bytes < HASH_TABLE_TRANSFER_BATCH_BYTES; ++i) {
+    const auto &stripe = block_.stripe_at(i);
+    shared_lock stripe_lock(stripe.mutex);
+    slot_index_[i].for_each(slot_begin, slot_end, [&](const hash_slot_index::slot_key &key) {
+      return visit(i, key);
+    });
   }
   if (_return.empty()) {
     RETURN_ERR("!empty");
@@ -740,18 +558,16 @@ void hash_table_partition::update_partition(response &_return, const arg_list &a
   if (args.size() != 3) {
     RETURN_ERR("!args_error");
   }
-  update_lock_.lock();
+  unique_lock state_lock(state_lock_);
   auto new_name = args[1];
   auto new_metadata = args[2];
   if (new_name == "merging" && new_metadata == "merging") {
-    if (metadata() == "regular" && name() != "0_65536" && underload()) {
+    if (state_ == state_regular && name() != "0_65536" && underload()) {
       metadata("exporting");
-      update_lock_.unlock();
       RETURN_OK(name());
     }
     scaling_up_ = false;
     scaling_down_ = false;
-    update_lock_.unlock();
     RETURN_ERR("!fail");
   }
   auto s = utils::string_utils::split(new_metadata, '$');
@@ -762,15 +578,14 @@ void hash_table_partition::update_partition(response &_return, const arg_list &a
     auto range = utils::string_utils::split(s[1], '_');
     export_slot_range(std::stoi(range[0]), std::stoi(range[1]));
   } else if (status == "importing") {
-    if ((metadata() != "regular" && !(metadata() == "split_importing" && s[1] == name())) || new_name != name()
+    if ((state_ != state_regular && !(state_ == state_split_importing && s[1] == name())) || new_name != name()
         || scaling_up_ || scaling_down_) {
-      update_lock_.unlock();
       RETURN_ERR("!fail");
     }
     auto range = utils::string_utils::split(s[1], '_');
     import_slot_range(std::stoi(range[0]), std::stoi(range[1]));
   } else {
-    if (metadata() == "importing") {
+    if (state_ == state_importing) {
       buffer_remove();
       if (!underload()) {
         scaling_down_ = false;
@@ -787,7 +602,6 @@ void hash_table_partition::update_partition(response &_return, const arg_list &a
   name(new_name);
   metadata(status);
   slot_range(new_name);
-  update_lock_.unlock();
   RETURN_ERR(name());
 }
 
@@ -802,12 +616,13 @@ void hash_table_partition::get_metadata(response &_return, const arg_list &args)
   if (args.size() != 1) {
     RETURN_ERR("!args_error");
   }
+  shared_lock state_lock(state_lock_);
   RETURN_OK(metadata_);
 }
 
 void hash_table_partition::run_command(response &_return, const arg_list &args) {
-  auto cmd_name = args[0];
-  switch (command_id(cmd_name)) {
+  auto cmd_id = command_id(args[0]);
+  switch (cmd_id) {
     case hash_table_cmd_id::ht_exists:exists(_return, args);
       break;
     case hash_table_cmd_id::ht_get:get(_return, args);
@@ -844,54 +659,84 @@ void hash_table_partition::run_command(response &_return, const arg_list &args)
       break;
     case hash_table_cmd_id::ht_scale_remove:scale_remove(_return, args);
       break;
+    case hash_table_cmd_id::ht_put_ttl:put_ttl(_return, args);
+      break;
+    case hash_table_cmd_id::ht_upsert_ttl:upsert_ttl(_return, args);
+      break;
     default: {
       _return.emplace_back("!no_such_command");
       return;
     }
   }
-  if (is_mutator(cmd_name)) {
+  bool mutator = is_mutator(cmd_id);
+  if (mutator) {
     dirty_ = true;
   }
-  if (auto_scale_ && is_mutator(cmd_name) && overload() && metadata_ != "exporting" && metadata_ != "importing"
-      && is_tail() && !scaling_up_ && !scaling_down_) {
-    LOG(log_level::info) << "Overloaded partition; storage = " << storage_size() << " capacity = " << storage_capacity()
-                         << " slot range = (" << slot_begin() << ", " << slot_end() << ")";
-    try {
-      scaling_up_ = true;
-      std::map<std::string, std::string> scale_conf;
-      scale_conf.emplace(std::make_pair(std::string("slot_range_begin"), std::to_string(slot_range_.first)));
-      scale_conf.emplace(std::make_pair(std::string("slot_range_end"), std::to_string(slot_range_.second)));
-      scale_conf.emplace(std::make_pair(std::string("type"), std::string("hash_table_split")));
-      auto scale = std::make_shared<auto_scaling::auto_scaling_client>(auto_scaling_host_, auto_scaling_port_);
-      scale->auto_scaling(chain(), path(), scale_conf);
-    } catch (std::exception &e) {
-      scaling_up_ = false;
-      LOG(log_level::warn) << "Split slot range failed: " << e.what();
+  if (eviction_ != nullptr && mutator && is_head() && !_return.empty() && _return[0] == "!redo") {
+    // The table could not grow; free a slice of the partition before the client retries
+    shared_lock state_lock(state_lock_);
+    evict(hash_table_type::num_stripes(), nullptr,
+          static_cast<std::size_t>(static_cast<double>(storage_size()) * HASH_TABLE_EVICTION_TARGET));
+  }
+  if (tier_ != nullptr && mutator) {
+    spill_cold_values();
+  }
+  if (expiring_) {
+    // Turn the wheel at most once a tick from the data path; the storage server turns it when idle
+    auto now = hash_table_expiry::now_ms();
+    auto next = next_expiry_.load();
+    if (now >= next && next_expiry_.compare_exchange_strong(next, now + HASH_TABLE_TTL_TICK_MS)) {
+      expire();
     }
   }
-  if (auto_scale_ && cmd_name == "remove" && underload() && metadata_ != "exporting" && metadata_ != "importing"
-      && name() != "0_65536" && is_tail() && !scaling_down_ && !scaling_up_) {
-    LOG(log_level::info) << "Underloaded partition; storage = " << storage_size() << " capacity = "
-                         << storage_capacity() << " slot range = (" << slot_begin() << ", " << slot_end() << ")";
-    try {
-      scaling_down_ = true;
-      std::map<std::string, std::string> scale_conf;
-      scale_conf.emplace(std::make_pair(std::string("type"), std::string("hash_table_merge")));
-      scale_conf.emplace(std::make_pair(std::string("storage_capacity"), std::to_string(storage_capacity())));
-      auto scale = std::make_shared<auto_scaling::auto_scaling_client>(auto_scaling_host_, auto_scaling_port_);
-      scale->auto_scaling(chain(), path(), scale_conf);
-    } catch (std::exception &e) {
-      scaling_down_ = false;
-      LOG(log_level::warn) << "Merge slot range failed: " << e.what();
+  if (auto_scale_ && mutator && overload()) {
+    shared_lock state_lock(state_lock_);
+    bool idle = false;
+    if (state_ != state_exporting && state_ != state_importing && is_tail() && !scaling_down_
+        && scaling_up_.compare_exchange_strong(idle, true)) {
+      LOG(log_level::info) << "Overloaded partition; storage = " << storage_size() << " capacity = "
+                           << storage_capacity() << " slot range = (" << slot_begin() << ", " << slot_end() << ")";
+      try {
+        std::map<std::string, std::string> scale_conf;
+        scale_conf.emplace(std::make_pair(std::string("slot_range_begin"), std::to_string(slot_range_.first)));
+        scale_conf.emplace(std::make_pair(std::string("slot_range_end"), std::to_string(slot_range_.second)));
+        scale_conf.emplace(std::make_pair(std::string("type"), std::string("hash_table_split")));
+        auto scale = std::make_shared<auto_scaling::auto_scaling_client>(auto_scaling_host_, auto_scaling_port_);
+        scale->auto_scaling(chain(), path(), scale_conf);
+      } catch (std::exception &e) {
+        scaling_up_ = false;
+        LOG(log_level::warn) << "Split slot range failed: " << e.what();
+      }
+    }
+  }
+  if (auto_scale_ && cmd_id == hash_table_cmd_id::ht_remove && underload()) {
+    shared_lock state_lock(state_lock_);
+    bool idle = false;
+    if (state_ != state_exporting && state_ != state_importing && name() != "0_65536" && is_tail() && !scaling_up_
+        && scaling_down_.compare_exchange_strong(idle, true)) {
+      LOG(log_level::info) << "Underloaded partition; storage = " << storage_size() << " capacity = "
+                           << storage_capacity() << " slot range = (" << slot_begin() << ", " << slot_end() << ")";
+      try {
+        std::map<std::string, std::string> scale_conf;
+        scale_conf.emplace(std::make_pair(std::string("type"), std::string("hash_table_merge")));
+        scale_conf.emplace(std::make_pair(std::string("storage_capacity"), std::to_string(storage_capacity())));
+        auto scale = std::make_shared<auto_scaling::auto_scaling_client>(auto_scaling_host_, auto_scaling_port_);
+        scale->auto_scaling(chain(), path(), scale_conf);
+      } catch (std::exception &e) {
+        scaling_down_ = false;
+        LOG(log_level::warn) << "Merge slot range failed: " << e.what();
+      }
     }
   }
 }
 
 std::size_t hash_table_partition::size() const {
+  auto stripe_locks = block_.lock_all_shared();
   return block_.size();
 }
 
 bool hash_table_partition::empty() const {
+  auto stripe_locks = block_.lock_all_shared();
   return block_.empty();
 }
 
@@ -902,14 +747,28 @@ bool hash_table_partition::is_dirty() const {
 void hash_table_partition::load(const std::string &path) {
   auto remote = persistent::persistent_store::instance(path, ser_);
   auto decomposed = persistent::persistent_store::decompose_path(path);
+  unique_lock state_lock(state_lock_);
+  if (decomposed.first == "local" && decomposed.second == ls_path()) {
+    // Merge mutations made while the table was spilled into the file before reading it
+    std::unique_lock<std::mutex> store_lock(ls_store_lock_);
+    if (ls_store_ == nullptr && hash_table_log_store::has_log(decomposed.second)
+        && hash_table_log_store::base_exists(decomposed.second, ser_name_)) {
+      ls_store_ = std::make_shared<hash_table_log_store>(decomposed.second, ser_name_);
+    }
+    if (ls_store_ != nullptr) {
+      ls_store_->compact();
+    }
+  }
+  auto stripe_locks = block_.lock_all();
   remote->read<hash_table_type>(decomposed.second, block_);
+  rebuild_slot_index();
 }
 
 bool hash_table_partition::sync(const std::string &path) {
+  shared_lock state_lock(state_lock_);
+  auto stripe_locks = block_.lock_all_shared();
   if (dirty_) {
-    auto remote = persistent::persistent_store::instance(path, ser_);
-    auto decomposed = persistent::persistent_store::decompose_path(path);
-    remote->write<hash_table_type>(block_, decomposed.second);
+    write_table(path);
     dirty_ = false;
     return true;
   }
@@ -917,14 +776,30 @@ bool hash_table_partition::sync(const std::string &path) {
 }
 
 bool hash_table_partition::dump(const std::string &path) {
+  unique_lock state_lock(state_lock_);
+  auto stripe_locks = block_.lock_all();
   bool flushed = false;
   if (dirty_) {
-    auto remote = persistent::persistent_store::instance(path, ser_);
     auto decomposed = persistent::persistent_store::decompose_path(path);
-    remote->write<hash_table_type>(block_, decomposed.second);
+    if (decomposed.first == "local" && decomposed.second == ls_path()) {
+      // The file is rewritten from memory, so earlier spilled mutations are dropped
+      std::unique_lock<std::mutex> store_lock(ls_store_lock_);
+      ls_store_.reset();
+      hash_table_log_store::discard_log(decomposed.second);
+    }
+    write_table(path);
     flushed = true;
   }
-  block_.clear();
+  // Everything the partition allocated lives in the block, so drop the containers and
+  // return the block memory at once instead of freeing entry by entry
+  for (auto &index: slot_index_)
+    index.abandon();
+  for (auto &expiry: expiry_)
+    expiry.abandon();
+  if (tier_ != nullptr)
+    tier_->abandon();
+  block_.abandon();
+  manager_->mb_release_all();
   next_->reset("nil");
   path_ = "";
   sub_map_.clear();
@@ -934,16 +809,27 @@ bool hash_table_partition::dump(const std::string &path) {
   role_ = singleton;
   scaling_up_ = false;
   scaling_down_ = false;
+  expiring_ = false;
   dirty_ = false;
   return flushed;
 }
 
 void hash_table_partition::forward_all() {
-  int64_t i = 0;
-  for (const auto &entry: block_) {
-    std::vector<std::string> result;
-    run_command_on_next(result, {"put", to_string(entry.first), to_string(entry.second)});
-    ++i;
+  shared_lock state_lock(state_lock_);
+  auto stripe_locks = block_.lock_all_shared();
+  auto now = hash_table_expiry::now_ms();
+  for (std::size_t i = 0; i < slot_index_.size(); ++i) {
+    for (const auto &entry: block_.stripe_at(i).table) {
+      std::vector<std::string> result;
+      uint64_t deadline = 0;
+      if (!expiring_ || !expiry_[i].deadline(entry.first, deadline)) {
+        run_command_on_next(result, {"put", to_string(entry.first), read_value(i, entry)});
+      } else if (deadline > now) {
+        // Forward the time left, as the next replica's clock need not agree with ours
+        run_command_on_next(result, {"put_ttl", to_string(entry.first), read_value(i, entry),
+                                     std::to_string(deadline - now)});
+      }
+    }
   }
 }
 
@@ -956,17 +842,330 @@ bool hash_table_partition::underload() {
 }
 
 void hash_table_partition::buffer_remove() {
-  response ret;
+  // Called with the state lock held exclusively, so no data operation can touch the stripes
+  std::unique_lock<std::mutex> cache_lock(remove_cache_lock_);
   for (const auto &x : remove_cache_) {
-    arg_list args;
-    args.push_back("remove");
-    args.push_back(x.first);
-    args.push_back("!buffered");
-    remove(ret, args);
+    erase_entry(block_.stripe_index(x.first), hash_slot::get(x.first), x.first);
   }
   remove_cache_.clear();
 }
 
+void hash_table_partition::clear_buffered_remove(const std::string &key) {
+  // Removes are only buffered while importing
+  if (state_ != state_importing)
+    return;
+  std::unique_lock<std::mutex> cache_lock(remove_cache_lock_);
+  remove_cache_.erase(key);
+}
+
+bool hash_table_partition::insert_entry(std::size_t stripe,
+                                        int32_t slot,
+                                        const std::string &key,
+                                        const std::string &value,
+                                        uint64_t deadline) {
+  auto &table = block_.stripe_at(stripe).table;
+  auto ret = table.emplace(make_binary(key), make_binary(value));
+  if (!ret.second)
+    return false;
+  try {
+    slot_index_[stripe].add(slot, ret.first->first);
+  } catch (std::bad_alloc &e) {
+    table.erase(ret.first);
+    throw;
+  }
+  try {
+    set_deadline(stripe, ret.first->first, deadline);
+  } catch (std::bad_alloc &e) {
+    slot_index_[stripe].remove(slot, ret.first->first);
+    table.erase(ret.first);
+    throw;
+  }
+  if (eviction_ != nullptr)
+    eviction_->admit(hash_type()(key));
+  return true;
+}
+
+bool hash_table_partition::erase_entry(std::size_t stripe, int32_t slot, const std::string &key) {
+  auto &table = block_.stripe_at(stripe).table;
+  auto it = table.find(key);
+  if (it == table.end())
+    return false;
+  // The indexes point into the key, so drop it from them first
+  slot_index_[stripe].remove(slot, it->first);
+  expiry_[stripe].clear(it->first);
+  if (tier_ != nullptr)
+    tier_->drop(stripe, it->first);
+  table.erase(it);
+  return true;
+}
+
+void hash_table_partition::set_deadline(std::size_t stripe, const binary &key, uint64_t deadline) {
+  if (deadline == 0) {
+    expiry_[stripe].clear(key);
+    return;
+  }
+  expiry_[stripe].set(key, deadline);
+  expiring_ = true;
+}
+
+bool hash_table_partition::expired(std::size_t stripe, const binary &key) const {
+  return expiring_ && expiry_[stripe].expired(key, hash_table_expiry::now_ms());
+}
+
+bool hash_table_partition::erase_if_expired(std::size_t stripe,
+                                            int32_t slot,
+                                            const std::string &key,
+                                            const binary &stored_key) {
+  if (!expired(stripe, stored_key))
+    return false;
+  erase_entry(stripe, slot, key);
+  return true;
+}
+
+void hash_table_partition::expire() {
+  if (!expiring_)
+    return;
+  shared_lock state_lock(state_lock_);
+  bool erased = false;
+  for (std::size_t i = 0; i < expiry_.size(); ++i) {
+    auto &stripe = block_.stripe_at(i);
+    std::size_t n;
+    // Release the stripe lock between batches so that a burst of expiring keys does not stall requests
+    do {
+      unique_lock stripe_lock(stripe.mutex);
+      n = expiry_[i].expire(hash_table_expiry::now_ms(), HASH_TABLE_TTL_EXPIRE_BATCH,
+                            [&](const uint8_t *data, std::size_t size) {
+                              std::string key(reinterpret_cast<const char *>(data), size);
+                              erased |= erase_entry(i, hash_slot::get(key), key);
+                            });
+    } while (n == HASH_TABLE_TTL_EXPIRE_BATCH);
+  }
+  if (erased)
+    dirty_ = true;
+}
+
+std::string hash_table_partition::ls_path() const {
+  auto file_path = directory_utils::remove_uri(backing_path());
+  directory_utils::push_path_element(file_path, name());
+  return file_path;
+}
+
+std::shared_ptr<hash_table_log_store> hash_table_partition::ls_store() {
+  auto path = ls_path();
+  std::unique_lock<std::mutex> lock(ls_store_lock_);
+  if (ls_store_ == nullptr || ls_store_->path() != path) {
+    ls_store_.reset();
+    if (!hash_table_log_store::base_exists(path, ser_name_)) {
+      return nullptr;
+    }
+    ls_store_ = std::make_shared<hash_table_log_store>(path, ser_name_);
+  }
+  return ls_store_;
+}
+
+void hash_table_partition::rebuild_slot_index() {
+  for (std::size_t i = 0; i < slot_index_.size(); ++i) {
+    slot_index_[i].clear();
+    for (const auto &entry: block_.stripe_at(i).table) {
+      slot_index_[i].add(hash_slot::get(entry.first), entry.first);
+    }
+  }
+}
+
+std::string hash_table_partition::read_value(std::size_t stripe, const flat_hash_table_type::value_type &entry) const {
+  std::string value;
+  // Spilled values are left empty in the table
+  if (tier_ != nullptr && entry.second.size() == 0 && tier_->read(value, stripe, entry.first)) {
+    return value;
+  }
+  return to_string(entry.second);
+}
+
+void hash_table_partition::write_value(std::size_t stripe,
+                                       flat_hash_table_type::value_type &entry,
+                                       const std::string &value) {
+  auto bin = make_binary(value);
+  if (tier_ != nullptr)
+    tier_->drop(stripe, entry.first);
+  entry.second = std::move(bin);
+}
+
+void hash_table_partition::touch(const std::string &key) {
+  if (tier_ == nullptr && eviction_ == nullptr)
+    return;
+  auto hash = hash_type()(key);
+  if (tier_ != nullptr)
+    tier_->touch(hash);
+  if (eviction_ != nullptr)
+    eviction_->touch(hash);
+}
+
+void hash_table_partition::spill_cold_values() {
+  auto threshold = static_cast<double>(storage_capacity()) * tier_threshold_;
+  if (storage_size() <= static_cast<std::size_t>(threshold))
+    return;
+  std::unique_lock<std::mutex> sweep_lock(tier_->sweep_lock(), std::try_to_lock);
+  if (!sweep_lock.owns_lock())
+    return;
+  auto target = static_cast<std::size_t>(threshold * HASH_TABLE_TIER_SPILL_TARGET);
+  shared_lock state_lock(state_lock_);
+  // Two turns of a stripe's hand give every recently used key its second chance, so stop after that
+  std::vector<std::size_t> swept(slot_index_.size(), 0);
+  bool sweeping = true;
+  while (sweeping && storage_size() > target) {
+    sweeping = false;
+    for (std::size_t i = 0; i < slot_index_.size() && storage_size() > target; ++i) {
+      auto &stripe = block_.stripe_at(i);
+      unique_lock stripe_lock(stripe.mutex);
+      auto &table = stripe.table;
+      auto num_slots = table.num_slots();
+      if (swept[i] >= 2 * num_slots)
+        continue;
+      sweeping = true;
+      auto &hand = tier_->hand(i);
+      if (hand >= num_slots)
+        hand = 0;
+      auto batch_end = std::min(hand + HASH_TABLE_TIER_SWEEP_BATCH, num_slots);
+      try {
+        for (auto it = table.from_slot(hand); it != table.end() && table.slot_position(it) < batch_end; ++it) {
+          auto &value = it->second;
+          if (value.size() < std::max<std::size_t>(tier_min_value_size_, 1)
+              || tier_->test_and_clear(hash_type()(it->first)))
+            continue;
+          tier_->spill(i, it->first, value);
+          value = make_binary("");
+        }
+      } catch (std::exception &e) {
+        LOG(log_level::warn) << "Could not spill values of partition " << name() << ": " << e.what();
+        return;
+      }
+      swept[i] += batch_end - hand;
+      hand = batch_end;
+    }
+  }
+}
+
+bool hash_table_partition::make_room(std::size_t held, const std::string &key, std::size_t bytes) {
+  // Replicas picking victims of their own would drift apart; the head's removes precede this write
+  if (!is_head())
+    return true;
+  auto limit = static_cast<std::size_t>(static_cast<double>(storage_capacity()) * eviction_threshold_);
+  if (storage_size() + bytes <= limit)
+    return true;
+  if (bytes >= limit)
+    return false;
+  auto goal = static_cast<std::size_t>(static_cast<double>(limit) * HASH_TABLE_EVICTION_TARGET);
+  evict(held, &key, goal > bytes ? goal - bytes : 0);
+  return storage_size() + bytes <= limit;
+}
+
+void hash_table_partition::evict(std::size_t held, const std::string *spare, std::size_t goal) {
+  auto num_stripes = hash_table_type::num_stripes();
+  std::size_t evicted = 0;
+  bool evicting = true;
+  while (evicting && storage_size() > goal) {
+    evicting = false;
+    auto first = eviction_->next_stripe();
+    for (std::size_t k = 0; k < num_stripes && storage_size() > goal; ++k) {
+      auto i = (first + k) % num_stripes;
+      std::size_t n = 0;
+      if (i == held) {
+        n = evict_stripe(i, spare, goal);
+      } else {
+        unique_lock stripe_lock(block_.stripe_at(i).mutex, std::try_to_lock);
+        if (!stripe_lock.owns_lock())
+          continue;
+        n = evict_stripe(i, nullptr, goal);
+      }
+      evicted += n;
+      evicting |= n > 0;
+    }
+  }
+  if (evicted > 0) {
+    eviction_->count_evicted(evicted);
+    dirty_ = true;
+  }
+}
+
+std::size_t hash_table_partition::evict_stripe(std::size_t stripe, const std::string *spare, std::size_t goal) {
+  auto &table = block_.stripe_at(stripe).table;
+  auto spared = [&](const flat_hash_table_type::value_type &entry) {
+    return spare != nullptr && equal_type()(entry.first, *spare);
+  };
+  auto evict_entry = [&](const flat_hash_table_type::value_type &entry) {
+    auto key = to_string(entry.first);
+    auto slot = hash_slot::get(key);
+    erase_entry(stripe, slot, key);
+    // Imported keys are outside the slot range an ordinary remove accepts
+    if (in_import_slot_range(slot)) {
+      forward({"remove", key, "!buffered"});
+    } else {
+      forward({"remove", key});
+    }
+  };
+  std::size_t evicted = 0;
+  if (eviction_->policy() == hash_table_eviction::clock) {
+    // Two turns of the hand clear every reference bit, after which any key is a victim
+    auto &hand = eviction_->hand(stripe);
+    std::size_t visited = 0;
+    while (evicted < HASH_TABLE_EVICTION_BATCH && !table.empty() && storage_size() > goal
+        && visited < 2 * table.num_slots()) {
+      if (hand >= table.num_slots())
+        hand = 0;
+      auto it = table.from_slot(hand);
+      if (it == table.end()) {
+        visited += table.num_slots() - hand;
+        hand = table.num_slots();
+        continue;
+      }
+      auto pos = table.slot_position(it);
+      visited += pos + 1 - hand;
+      hand = pos + 1;
+      if (spared(*it))
+        continue;
+      if (!expired(stripe, it->first) && eviction_->second_chance(hash_type()(it->first)))
+        continue;
+      evict_entry(*it);
+      ++evicted;
+    }
+    return evicted;
+  }
+  // Entries are laid out by hash, so neighbours of a random slot are a random sample
+  while (evicted < HASH_TABLE_EVICTION_BATCH && !table.empty() && storage_size() > goal) {
+    auto it = table.from_slot(hash_table_eviction::random_slot(table.num_slots()));
+    auto victim = table.end();
+    uint32_t coldest = 0;
+    auto samples = std::min(HASH_TABLE_EVICTION_SAMPLES, table.size());
+    for (std::size_t i = 0; i < samples; ++i, ++it) {
+      if (it == table.end())
+        it = table.begin();
+      if (spared(*it))
+        continue;
+      // Expired keys go first
+      auto coldness = expired(stripe, it->first) ? UINT32_MAX : eviction_->coldness(hash_type()(it->first));
+      if (victim == table.end() || coldness > coldest) {
+        victim = it;
+        coldest = coldness;
+      }
+    }
+    if (victim == table.end())
+      break;
+    evict_entry(*victim);
+    ++evicted;
+  }
+  return evicted;
+}
+
+void hash_table_partition::write_table(const std::string &path) {
+  auto remote = persistent::persistent_store::instance(path, ser_);
+  auto decomposed = persistent::persistent_store::decompose_path(path);
+  if (tier_ != nullptr && tier_->spilled() > 0) {
+    remote->write<tiered_hash_table_type>(tiered_hash_table_type(block_, *tier_), decomposed.second);
+  } else {
+    remote->write<hash_table_type>(block_, decomposed.second);
+  }
+}
+
 REGISTER_IMPLEMENTATION("hashtable", hash_table_partition);
 
 }
@@ -9,13 +9,19 @@
 #include "jiffy/storage/chain_module.h"
 #include "jiffy/storage/hashtable/hash_table_ops.h"
 #include "hash_table_defs.h"
+#include "hash_slot_index.h"
+#include "hash_table_log_store.h"
+#include "hash_table_value_tier.h"
+#include "hash_table_expiry.h"
+#include "hash_table_eviction.h"
 
 namespace jiffy {
 namespace storage {
 
 #define BEGIN_CATCH_HANDLER                       \
   try {                                           \
-  auto it = block_.find(make_binary(args[1]))
+  auto &table = stripe.table;                     \
+  auto it = table.find(args[1])
 
 
 
@@ -175,6 +181,23 @@ class hash_table_partition : public chain_module {
    */
   void upsert(response &_return, const arg_list &args);
 
+  /**
+   * @brief Insert new key value pair that expires after a time to live
+   * Arguments are the key, the value and the time to live in milliseconds.
+   * @param _return Response
+   * @param args Arguments
+   */
+  void put_ttl(response &_return, const arg_list &args);
+
+  /**
+   * @brief Insert or update key value pair, setting a time to live
+   * Arguments are the key, the value and the time to live in milliseconds.
+   * A plain upsert clears the time to live; update keeps it.
+   * @param _return Response
+   * @param args Arguments
+   */
+  void upsert_ttl(response &_return, const arg_list &args);
+
   /**
    * @brief Get value for specified key
    * @param _return Response
@@ -247,14 +270,18 @@ class hash_table_partition : public chain_module {
 
   /**
    * @brief Insert key value pair to hash table during scaling
+   * Arguments are triples of key, value and time to live in milliseconds, 0 for none,
+   * as returned by get_data_in_slot_range.
    * @param _return Response
    * @param args Arguments
    */
   void scale_put(response &_return, const arg_list &args);
 
   /**
-   * @brief Fetch data from keys which lie in slot range
-   * @param data Data to be fetched
+   * @brief Fetch data from keys which lie in slot range, in batches
+   * Arguments are the slot range, the batch size and optionally the last key of
+   * the previous batch; the scan resumes after that key instead of restarting.
+   * Each key is followed by its value and its time to live in milliseconds, 0 for none.
    * @param _return Response
    * @param args Arguments
    */
@@ -331,7 +358,23 @@ class hash_table_partition : public chain_module {
    */
   void forward_all() override;
 
+  /**
+   * @brief Free entries whose time to live has passed, a batch per stripe lock acquisition
+   */
+  void expire() override;
+
+  /**
+   * @brief Check if the partition supports running commands from several threads at once
+   * @return Bool value, always true since the hash table is striped
+   */
+  bool is_concurrent() const override {
+    return true;
+  }
+
  private:
+  typedef hash_table_type::shared_lock shared_lock;
+  typedef hash_table_type::unique_lock unique_lock;
+
   /**
    * @brief Check if block is overloaded
    * @return Bool value, true if block size is over the high threshold capacity
@@ -350,16 +393,153 @@ class hash_table_partition : public chain_module {
   void buffer_remove();
 
   /**
-   * @brief Construct binary string for temporary values
-   * @param str String
-   * @return Binary string
+   * @brief Insert new key value pair
+   * @param _return Response
+   * @param args Arguments
+   * @param redirected Bool value, true if redirected from the exporting partition
+   * @param deadline Expiry deadline in milliseconds, 0 if the key does not expire
    */
-  binary make_temporary_binary(const std::string &str) {
-    return binary(str, temporary_data_allocator_);
-  }
+  void put_entry(response &_return, const arg_list &args, bool redirected, uint64_t deadline);
+
+  /**
+   * @brief Insert or update key value pair
+   * @param _return Response
+   * @param args Arguments
+   * @param redirect_arg Position of the arguments a redirected upsert appends
+   * @param deadline Expiry deadline in milliseconds, 0 if the key does not expire
+   */
+  void upsert_entry(response &_return, const arg_list &args, std::size_t redirect_arg, uint64_t deadline);
+
+  /**
+   * @brief Insert key value pair into a stripe and the stripe's slot index; the stripe must be locked
+   * @param stripe Stripe index
+   * @param slot Hash slot of the key
+   * @param key Key
+   * @param value Value
+   * @param deadline Expiry deadline in milliseconds, 0 if the key does not expire
+   * @return Bool value, true if inserted
+   */
+  bool insert_entry(std::size_t stripe, int32_t slot, const std::string &key, const std::string &value,
+                    uint64_t deadline = 0);
+
+  /**
+   * @brief Erase key from a stripe and the stripe's slot index; the stripe must be locked
+   * @param stripe Stripe index
+   * @param slot Hash slot of the key
+   * @param key Key
+   * @return Bool value, true if erased
+   */
+  bool erase_entry(std::size_t stripe, int32_t slot, const std::string &key);
+
+  /**
+   * @brief Rebuild slot indexes from the stripes; all stripes must be locked
+   */
+  void rebuild_slot_index();
+
+  /**
+   * @brief Fetch value of an entry, reading it from the value tier if it was spilled; the stripe must be locked
+   * @param stripe Stripe index
+   * @param entry Entry
+   * @return Value
+   */
+  std::string read_value(std::size_t stripe, const flat_hash_table_type::value_type &entry) const;
+
+  /**
+   * @brief Overwrite value of an entry, dropping its spilled value if any; the stripe must be locked exclusively
+   * @param stripe Stripe index
+   * @param entry Entry
+   * @param value New value
+   */
+  void write_value(std::size_t stripe, flat_hash_table_type::value_type &entry, const std::string &value);
 
-  /* Cuckoo hash map partition */
-  std::unordered_map<key_type, value_type, hash_type, equal_type> block_;
+  /**
+   * @brief Set or clear expiry deadline of a key; the stripe must be locked exclusively
+   * @param stripe Stripe index
+   * @param key Key owned by the hash table
+   * @param deadline Expiry deadline in milliseconds, 0 to clear it
+   */
+  void set_deadline(std::size_t stripe, const binary &key, uint64_t deadline);
+
+  /**
+   * @brief Check if key has expired; the stripe must be locked
+   * @param stripe Stripe index
+   * @param key Key owned by the hash table
+   * @return Bool value, true if the key's time to live has passed
+   */
+  bool expired(std::size_t stripe, const binary &key) const;
+
+  /**
+   * @brief Erase key if it has expired, so that a write finds it absent; the stripe must be locked exclusively
+   * @param stripe Stripe index
+   * @param slot Hash slot of the key
+   * @param key Key
+   * @param stored_key Key owned by the hash table
+   * @return Bool value, true if the key expired and was erased
+   */
+  bool erase_if_expired(std::size_t stripe, int32_t slot, const std::string &key, const binary &stored_key);
+
+  /**
+   * @brief Mark key as recently used, so that its value is not spilled by the next sweep
+   * @param key Key
+   */
+  void touch(const std::string &key);
+
+  /**
+   * @brief Spill cold values to the value tier until memory usage is back under the tier threshold.
+   * Sweeps the stripes a batch of slots at a time, skipping the sweep if another thread is at it.
+   */
+  void spill_cold_values();
+
+  /**
+   * @brief Evict cold entries if writing bytes would take memory usage over the eviction threshold.
+   * Only the head picks victims; the other replicas apply the removes it forwards ahead of the write.
+   * @param held Stripe the caller holds exclusively
+   * @param key Key being written, which is never evicted
+   * @param bytes Bytes about to be written
+   * @return Bool value, true if the bytes fit under the eviction threshold
+   */
+  bool make_room(std::size_t held, const std::string &key, std::size_t bytes);
+
+  /**
+   * @brief Evict cold entries until memory usage is down to a goal, visiting the stripes in turn.
+   * Stripes other threads hold are skipped, so that writers never wait for each other.
+   * @param held Stripe the caller holds exclusively, the number of stripes if none
+   * @param spare Key never evicted, nullptr if none
+   * @param goal Memory usage to evict down to
+   */
+  void evict(std::size_t held, const std::string *spare, std::size_t goal);
+
+  /**
+   * @brief Evict up to a batch of cold entries from a stripe; the stripe must be locked exclusively.
+   * Each evicted key is forwarded down the chain as a remove.
+   * @param stripe Stripe index
+   * @param spare Key never evicted, nullptr if none
+   * @param goal Memory usage to evict down to
+   * @return Number of entries evicted
+   */
+  std::size_t evict_stripe(std::size_t stripe, const std::string *spare, std::size_t goal);
+
+  /**
+   * @brief Write table to persistent storage, along with spilled values; all stripes must be locked
+   * @param path Persistent storage path
+   */
+  void write_table(const std::string &path);
+
+  std::string ls_path() const;
+
+  std::shared_ptr<hash_table_log_store> ls_store();
+
+  /**
+   * @brief Drop key from the remove buffer once it has been written again
+   * @param key Key
+   */
+  void clear_buffered_remove(const std::string &key);
+
+  /* Striped flat hash map partition */
+  hash_table_type block_;
+
+  /* Per stripe index of keys by hash slot, guarded by the stripe lock */
+  std::vector<hash_slot_index> slot_index_;
 
   /* Custom serializer/deserializer */
   std::shared_ptr<serde> ser_;
@@ -374,13 +554,13 @@ class hash_table_partition : public chain_module {
   double threshold_hi_;
 
   /* Bool for partition hash slot range splitting */
-  bool scaling_up_;
+  std::atomic<bool> scaling_up_;
 
   /* Bool for partition hash slot range merging */
-  bool scaling_down_;
+  std::atomic<bool> scaling_down_;
 
   /* Bool partition dirty bit */
-  bool dirty_;
+  std::atomic<bool> dirty_;
 
   /* Hash slot range */
   std::pair<int32_t, int32_t> slot_range_;
@@ -406,17 +586,45 @@ class hash_table_partition : public chain_module {
   /* Auto scaling server port number */
   int auto_scaling_port_;
 
-  /* Data update mutex, we want only one update function happen at a time */
-  std::mutex update_lock_;
+  /* Partition state mutex; held shared by data operations on the stripes and exclusively by
+   * operations that change the name, metadata or slot ranges, or touch the whole table */
+  mutable hash_table_type::mutex_type state_lock_;
+
+  /* Buffer remove cache mutex */
+  std::mutex remove_cache_lock_;
 
   /* Buffer remove cache */
   std::map<std::string, int> remove_cache_;
 
-  /* Temporary data allocator */
-  allocator<uint8_t> temporary_data_allocator_;
+  /* Guards opening and closing of the on-disk store */
+  std::mutex ls_store_lock_;
+
+  /* On-disk store serving the *_ls commands once the table is spilled, opened on first use */
+  std::shared_ptr<hash_table_log_store> ls_store_;
+
+  /* Local SSD tier for cold values, null unless a tier directory is configured */
+  std::unique_ptr<hash_table_value_tier> tier_;
+
+  /* Fraction of capacity above which cold values are spilled to the tier */
+  double tier_threshold_;
+
+  /* Values smaller than this stay in memory */
+  std::size_t tier_min_value_size_;
+
+  /* Access metadata of cache partitions, which evict cold entries instead of filling up; null otherwise */
+  std::unique_ptr<hash_table_eviction> eviction_;
+
+  /* Fraction of capacity above which cache partitions evict */
+  double eviction_threshold_;
+
+  /* Per stripe expiry deadlines, guarded by the stripe lock */
+  std::vector<hash_table_expiry> expiry_;
+
+  /* Bool value, true once a key was given a time to live */
+  std::atomic<bool> expiring_;
 
-  /* Temporary data manager */
-  block_memory_manager* temporary_data_manager_;
+  /* Time in milliseconds after which a request next runs expiry */
+  std::atomic<uint64_t> next_expiry_;
 
 };
 
@@ -0,0 +1,163 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include "hash_table_value_tier.h"
+
+namespace jiffy {
+namespace storage {
+
+namespace {
+
+void check_io(bool ok, const std::string &what, const std::string &path) {
+  if (!ok) {
+    throw std::runtime_error("Could not " + what + " value tier file in " + path + ": " + std::strerror(errno));
+  }
+}
+
+}
+
+hash_table_value_tier::hash_table_value_tier(const std::string &dir,
+                                             std::size_t num_stripes,
+                                             const allocator_type &alloc)
+    : dir_(dir),
+      fd_(-1),
+      tail_(0),
+      spilled_(0),
+      spilled_bytes_(0),
+      hands_(num_stripes, 0),
+      references_(HASH_TABLE_TIER_REFERENCE_BITS / 64) {
+  std::string path = dir_ + "/jiffy_values_XXXXXX";
+  fd_ = ::mkstemp(&path[0]);
+  check_io(fd_ >= 0, "create", dir_);
+  // Unlink right away, so that the file never outlives its descriptor
+  ::unlink(path.c_str());
+  index_.reserve(num_stripes);
+  for (std::size_t i = 0; i < num_stripes; ++i) {
+    index_.emplace_back(0, std::hash<const uint8_t *>(), std::equal_to<const uint8_t *>(), alloc);
+  }
+}
+
+hash_table_value_tier::~hash_table_value_tier() {
+  ::close(fd_);
+}
+
+void hash_table_value_tier::touch(std::size_t hash) {
+  auto bit = hash % HASH_TABLE_TIER_REFERENCE_BITS;
+  auto &word = references_[bit / 64];
+  auto mask = uint64_t(1) << (bit % 64);
+  // Skip the write when the bit is set already, as it is for hot keys
+  if ((word.load(std::memory_order_relaxed) & mask) == 0) {
+    word.fetch_or(mask, std::memory_order_relaxed);
+  }
+}
+
+bool hash_table_value_tier::test_and_clear(std::size_t hash) {
+  auto bit = hash % HASH_TABLE_TIER_REFERENCE_BITS;
+  auto mask = uint64_t(1) << (bit % 64);
+  return (references_[bit / 64].fetch_and(~mask, std::memory_order_relaxed) & mask) != 0;
+}
+
+void hash_table_value_tier::spill(std::size_t stripe, const binary &key, const binary &value) {
+  location loc{tail_.fetch_add(value.size()), value.size()};
+  auto data = reinterpret_cast<const char *>(value.data());
+  std::size_t done = 0;
+  while (done < loc.size) {
+    auto n = ::pwrite(fd_, data + done, loc.size - done, static_cast<off_t>(loc.offset + done));
+    if (n < 0 && errno == EINTR)
+      continue;
+    check_io(n > 0, "write", dir_);
+    done += static_cast<std::size_t>(n);
+  }
+  std::pair<index_type::iterator, bool> ret;
+  try {
+    ret = index_[stripe].emplace(key.data(), loc);
+  } catch (std::bad_alloc &) {
+    punch(loc);
+    throw;
+  }
+  if (!ret.second) {
+    // Spilled again: the old value is released and the new one counted below
+    release(ret.first->second);
+    ret.first->second = loc;
+  }
+  ++spilled_;
+  spilled_bytes_ += loc.size;
+}
+
+bool hash_table_value_tier::read(std::string &value, std::size_t stripe, const binary &key) const {
+  auto it = index_[stripe].find(key.data());
+  if (it == index_[stripe].end()) {
+    return false;
+  }
+  const auto &loc = it->second;
+  value.resize(loc.size);
+  std::size_t done = 0;
+  while (done < value.size()) {
+    auto n = ::pread(fd_, &value[done], value.size() - done, static_cast<off_t>(loc.offset + done));
+    if (n < 0 && errno == EINTR)
+      continue;
+    check_io(n > 0, "read", dir_);
+    done += static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+bool hash_table_value_tier::drop(std::size_t stripe, const binary &key) {
+  auto it = index_[stripe].find(key.data());
+  if (it == index_[stripe].end()) {
+    return false;
+  }
+  release(it->second);
+  index_[stripe].erase(it);
+  return true;
+}
+
+std::size_t &hash_table_value_tier::hand(std::size_t stripe) {
+  return hands_[stripe];
+}
+
+std::size_t hash_table_value_tier::spilled() const {
+  return spilled_.load();
+}
+
+std::size_t hash_table_value_tier::spilled_bytes() const {
+  return spilled_bytes_.load();
+}
+
+std::mutex &hash_table_value_tier::sweep_lock() {
+  return sweep_lock_;
+}
+
+void hash_table_value_tier::abandon() {
+  for (auto &index: index_) {
+    auto alloc = index.get_allocator();
+    // Replace the index without running its destructor, which would free every node
+    new(&index) index_type(0, std::hash<const uint8_t *>(), std::equal_to<const uint8_t *>(), alloc);
+  }
+  std::fill(hands_.begin(), hands_.end(), 0);
+  check_io(::ftruncate(fd_, 0) == 0, "truncate", dir_);
+  tail_ = 0;
+  spilled_ = 0;
+  spilled_bytes_ = 0;
+}
+
+void hash_table_value_tier::release(const location &loc) {
+  --spilled_;
+  spilled_bytes_ -= loc.size;
+  punch(loc);
+}
+
+void hash_table_value_tier::punch(const location &loc) {
+#ifdef FALLOC_FL_PUNCH_HOLE
+  // Return the space to the file system; the file keeps its size so other offsets stay valid
+  ::fallocate(fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, static_cast<off_t>(loc.offset),
+              static_cast<off_t>(loc.size));
+#endif
+}
+
+}
+}
@@ -0,0 +1,283 @@
+#ifndef JIFFY_HASH_TABLE_VALUE_TIER_H
+#define JIFFY_HASH_TABLE_VALUE_TIER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "jiffy/storage/block_memory_allocator.h"
+#include "jiffy/storage/types/binary.h"
+#include "jiffy/storage/hashtable/hash_table_defs.h"
+
+namespace jiffy {
+namespace storage {
+
+// Number of reference bits a value tier tracks recently used keys with
+constexpr std::size_t HASH_TABLE_TIER_REFERENCE_BITS = 1 << 20;
+
+// Number of slots a sweep visits per stripe lock acquisition
+constexpr std::size_t HASH_TABLE_TIER_SWEEP_BATCH = 256;
+
+// Fraction of the tier threshold a sweep brings memory usage down to, so that sweeps are not triggered by every put
+constexpr double HASH_TABLE_TIER_SPILL_TARGET = 0.9;
+
+/**
+ * @brief Local SSD tier for cold hash table values.
+ *
+ * Values spilled out of a partition's memory are appended to an unnamed file
+ * in the tier directory, so the file goes away with the partition or the
+ * process. Each stripe indexes its spilled values by key, pointing into the
+ * key the hash table owns, and the table keeps the entry with an empty value
+ * in its place; reading a spilled value takes a single pread. The space of
+ * dropped values is punched out of the file.
+ *
+ * Recently used keys are tracked with reference bits addressed by key hash,
+ * which a CLOCK hand per stripe clears as it sweeps the table, giving keys
+ * touched since the last sweep a second chance before their value is spilled.
+ *
+ * The index of a stripe is guarded by the stripe lock: spilling and dropping
+ * need it exclusively, reading shared.
+ */
+class hash_table_value_tier {
+ public:
+  /* Location of a spilled value in the file */
+  struct location {
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  typedef block_memory_allocator<std::pair<const uint8_t *const, location>> allocator_type;
+
+  /**
+   * @brief Constructor, creates the value file
+   * @param dir Tier directory
+   * @param num_stripes Number of hash table stripes
+   * @param alloc Allocator for index entries
+   */
+  hash_table_value_tier(const std::string &dir, std::size_t num_stripes, const allocator_type &alloc);
+
+  /**
+   * @brief Destructor, closes and so deletes the value file
+   */
+  ~hash_table_value_tier();
+
+  hash_table_value_tier(const hash_table_value_tier &) = delete;
+  hash_table_value_tier &operator=(const hash_table_value_tier &) = delete;
+
+  /**
+   * @brief Mark key as recently used
+   * @param hash Key hash
+   */
+  void touch(std::size_t hash);
+
+  /**
+   * @brief Check if key was used since its reference bit was last cleared, and clear it
+   * @param hash Key hash
+   * @return Bool value, true if recently used
+   */
+  bool test_and_clear(std::size_t hash);
+
+  /**
+   * @brief Write value to the file and index it; the caller then empties the value in the table
+   * @param stripe Stripe
+   * @param key Key owned by the hash table
+   * @param value Value
+   */
+  void spill(std::size_t stripe, const binary &key, const binary &value);
+
+  /**
+   * @brief Fetch value of a key from the file
+   * @param value Value
+   * @param stripe Stripe
+   * @param key Key owned by the hash table
+   * @return Bool value, true if the key's value is spilled
+   */
+  bool read(std::string &value, std::size_t stripe, const binary &key) const;
+
+  /**
+   * @brief Drop the spilled value of a key, e.g. before it is overwritten or erased
+   * @param stripe Stripe
+   * @param key Key owned by the hash table
+   * @return Bool value, true if the key's value was spilled
+   */
+  bool drop(std::size_t stripe, const binary &key);
+
+  /**
+   * @brief Fetch CLOCK hand of a stripe, the slot position its sweep resumes at
+   * @param stripe Stripe
+   * @return Slot position
+   */
+  std::size_t &hand(std::size_t stripe);
+
+  /**
+   * @brief Fetch number of spilled values
+   * @return Number of spilled values
+   */
+  std::size_t spilled() const;
+
+  /**
+   * @brief Fetch bytes of spilled values
+   * @return Bytes of spilled values
+   */
+  std::size_t spilled_bytes() const;
+
+  /**
+   * @brief Fetch lock held by the thread sweeping the table
+   * @return Sweep lock
+   */
+  std::mutex &sweep_lock();
+
+  /**
+   * @brief Forget all spilled values and empty the file; all stripes must be locked.
+   * Index entries are not freed, so the allocator's memory must be released in bulk right after.
+   */
+  void abandon();
+
+ private:
+  typedef std::unordered_map<const uint8_t *, location, std::hash<const uint8_t *>,
+                             std::equal_to<const uint8_t *>, allocator_type> index_type;
+
+  void release(const location &loc);
+
+  void punch(const location &loc);
+
+  /* Tier directory */
+  std::string dir_;
+
+  /* Value file descriptor */
+  int fd_;
+
+  /* End of the value file */
+  std::atomic<uint64_t> tail_;
+
+  /* Number of spilled values */
+  std::atomic<std::size_t> spilled_;
+
+  /* Bytes of spilled values */
+  std::atomic<std::size_t> spilled_bytes_;
+
+  /* Per stripe index of spilled values by key */
+  std::vector<index_type> index_;
+
+  /* Per stripe CLOCK hands */
+  std::vector<std::size_t> hands_;
+
+  /* Reference bits, addressed by key hash */
+  std::vector<std::atomic<uint64_t>> references_;
+
+  /* Held by the thread sweeping the table */
+  std::mutex sweep_lock_;
+};
+
+/* Value of a hash table entry as persisted, read back from the tier if spilled */
+struct tiered_value {
+  std::string value;
+
+  const char *data() const {
+    return value.data();
+  }
+
+  std::size_t size() const {
+    return value.size();
+  }
+};
+
+inline std::string to_string(const tiered_value &v) {
+  return v.value;
+}
+
+/**
+ * @brief Hash table viewed together with the tier holding its spilled values,
+ * so that it is persisted with all of its values. All stripes must be locked.
+ */
+class tiered_hash_table {
+ public:
+  typedef std::pair<const binary &, tiered_value> value_type;
+
+  class const_iterator {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef tiered_hash_table::value_type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const value_type *pointer;
+    typedef value_type reference;
+
+    const_iterator() : parent_(nullptr), stripe_(hash_table_type::num_stripes()) {}
+
+    value_type operator*() const {
+      tiered_value v;
+      if (it_->second.size() != 0 || !parent_->tier_.read(v.value, stripe_, it_->first)) {
+        v.value = to_string(it_->second);
+      }
+      return value_type(it_->first, std::move(v));
+    }
+
+    const_iterator &operator++() {
+      ++it_;
+      skip_empty();
+      return *this;
+    }
+
+    bool operator==(const const_iterator &other) const {
+      return stripe_ == other.stripe_ && (stripe_ == hash_table_type::num_stripes() || it_ == other.it_);
+    }
+
+    bool operator!=(const const_iterator &other) const {
+      return !(*this == other);
+    }
+
+   private:
+    friend class tiered_hash_table;
+
+    explicit const_iterator(const tiered_hash_table *parent)
+        : parent_(parent), stripe_(0), it_(parent->table_.stripe_at(0).table.begin()) {
+      skip_empty();
+    }
+
+    void skip_empty() {
+      while (it_ == parent_->table_.stripe_at(stripe_).table.end()) {
+        if (++stripe_ == hash_table_type::num_stripes())
+          return;
+        it_ = parent_->table_.stripe_at(stripe_).table.begin();
+      }
+    }
+
+    const tiered_hash_table *parent_;
+    std::size_t stripe_;
+    flat_hash_table_type::const_iterator it_;
+  };
+
+  /**
+   * @brief Constructor
+   * @param table Hash table
+   * @param tier Value tier of the table
+   */
+  tiered_hash_table(const hash_table_type &table, const hash_table_value_tier &tier) : table_(table), tier_(tier) {}
+
+  const_iterator begin() const {
+    return const_iterator(this);
+  }
+
+  const_iterator end() const {
+    return const_iterator();
+  }
+
+ private:
+  /* Hash table */
+  const hash_table_type &table_;
+
+  /* Value tier */
+  const hash_table_value_tier &tier_;
+};
+
+typedef tiered_hash_table tiered_hash_table_type;
+
+}
+}
+
+#endif //JIFFY_HASH_TABLE_VALUE_TIER_H
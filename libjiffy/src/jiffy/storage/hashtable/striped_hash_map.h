@@ -0,0 +1,305 @@
+#ifndef JIFFY_STRIPED_HASH_MAP_H
+#define JIFFY_STRIPED_HASH_MAP_H
+
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace jiffy {
+namespace storage {
+
+/**
+ * @brief Hash map split into independently locked stripes.
+ *
+ * A key always maps to the same stripe, chosen from the top bits of its hash
+ * so that the bits used for probing inside the stripe stay uniform. Readers
+ * and writers on different stripes never contend, and readers on the same
+ * stripe share its lock.
+ *
+ * Single key operations lock one stripe through stripe_for(); whole table
+ * operations (iteration, size, bulk emplace) expect the caller to hold
+ * lock_all() or lock_all_shared(), or to otherwise have exclusive access.
+ */
+template<typename Map, std::size_t NumStripes>
+class striped_hash_map {
+  static_assert(NumStripes > 0 && (NumStripes & (NumStripes - 1)) == 0, "Number of stripes must be a power of 2");
+
+ public:
+  typedef typename Map::key_type key_type;
+  typedef typename Map::mapped_type mapped_type;
+  typedef typename Map::value_type value_type;
+  typedef typename Map::size_type size_type;
+  typedef typename Map::hasher hasher;
+  typedef typename Map::allocator_type allocator_type;
+  typedef std::shared_timed_mutex mutex_type;
+  typedef std::shared_lock<mutex_type> shared_lock;
+  typedef std::unique_lock<mutex_type> unique_lock;
+
+  /* Stripe: a lock and the part of the map it guards */
+  struct stripe {
+    explicit stripe(const allocator_type &alloc) : table(alloc) {}
+
+    /* Stripe lock */
+    mutable mutex_type mutex;
+    /* Stripe entries */
+    Map table;
+  };
+
+  template<bool IsConst>
+  class iterator_base {
+   public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef typename striped_hash_map::value_type value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef typename std::conditional<IsConst, const value_type *, value_type *>::type pointer;
+    typedef typename std::conditional<IsConst, const value_type &, value_type &>::type reference;
+
+    iterator_base() : parent_(nullptr), stripe_(NumStripes) {}
+
+    reference operator*() const {
+      return *it_;
+    }
+
+    pointer operator->() const {
+      return &(*it_);
+    }
+
+    iterator_base &operator++() {
+      ++it_;
+      skip_empty();
+      return *this;
+    }
+
+    iterator_base operator++(int) {
+      auto tmp = *this;
+      ++(*this);
+      return tmp;
+    }
+
+    bool operator==(const iterator_base &other) const {
+      return stripe_ == other.stripe_ && (stripe_ == NumStripes || it_ == other.it_);
+    }
+
+    bool operator!=(const iterator_base &other) const {
+      return !(*this == other);
+    }
+
+   private:
+    friend class striped_hash_map;
+    typedef typename std::conditional<IsConst, const striped_hash_map *, striped_hash_map *>::type parent_ptr;
+    typedef typename std::conditional<IsConst, typename Map::const_iterator, typename Map::iterator>::type inner;
+
+    explicit iterator_base(parent_ptr parent) : parent_(parent), stripe_(0), it_(table().begin()) {
+      skip_empty();
+    }
+
+    auto table() const -> decltype(parent_ptr()->stripes_[0]->table) & {
+      return parent_->stripes_[stripe_]->table;
+    }
+
+    void skip_empty() {
+      while (it_ == table().end()) {
+        if (++stripe_ == NumStripes)
+          return;
+        it_ = table().begin();
+      }
+    }
+
+    parent_ptr parent_;
+    std::size_t stripe_;
+    inner it_;
+  };
+
+  typedef iterator_base<false> iterator;
+  typedef iterator_base<true> const_iterator;
+
+  /**
+   * @brief Constructor
+   * @param alloc Allocator shared by all stripes
+   */
+  explicit striped_hash_map(const allocator_type &alloc = allocator_type()) {
+    for (std::size_t i = 0; i < NumStripes; ++i)
+      stripes_[i].reset(new stripe(alloc));
+  }
+
+  /**
+   * @brief Fetch number of stripes
+   * @return Number of stripes
+   */
+  static constexpr std::size_t num_stripes() {
+    return NumStripes;
+  }
+
+  /**
+   * @brief Fetch index of the stripe responsible for key
+   * @param key Key
+   * @return Stripe index
+   */
+  template<typename K>
+  std::size_t stripe_index(const K &key) const {
+    constexpr int shift = std::numeric_limits<std::size_t>::digits - stripe_bits();
+    return shift == std::numeric_limits<std::size_t>::digits ? 0 : static_cast<std::size_t>(hasher()(key) >> shift);
+  }
+
+  /**
+   * @brief Fetch stripe responsible for key
+   * @param key Key
+   * @return Stripe
+   */
+  template<typename K>
+  stripe &stripe_for(const K &key) {
+    return *stripes_[stripe_index(key)];
+  }
+
+  template<typename K>
+  const stripe &stripe_for(const K &key) const {
+    return *stripes_[stripe_index(key)];
+  }
+
+  /**
+   * @brief Fetch stripe by index
+   * @param i Stripe index
+   * @return Stripe
+   */
+  stripe &stripe_at(std::size_t i) {
+    return *stripes_[i];
+  }
+
+  const stripe &stripe_at(std::size_t i) const {
+    return *stripes_[i];
+  }
+
+  /**
+   * @brief Lock all stripes for reading, in stripe order
+   * @return Stripe locks
+   */
+  std::vector<shared_lock> lock_all_shared() const {
+    std::vector<shared_lock> locks;
+    locks.reserve(NumStripes);
+    for (std::size_t i = 0; i < NumStripes; ++i)
+      locks.emplace_back(stripes_[i]->mutex);
+    return locks;
+  }
+
+  /**
+   * @brief Lock all stripes for writing, in stripe order
+   * @return Stripe locks
+   */
+  std::vector<unique_lock> lock_all() {
+    std::vector<unique_lock> locks;
+    locks.reserve(NumStripes);
+    for (std::size_t i = 0; i < NumStripes; ++i)
+      locks.emplace_back(stripes_[i]->mutex);
+    return locks;
+  }
+
+  iterator begin() {
+    return iterator(this);
+  }
+
+  iterator end() {
+    return iterator();
+  }
+
+  const_iterator begin() const {
+    return const_iterator(this);
+  }
+
+  const_iterator end() const {
+    return const_iterator();
+  }
+
+  /**
+   * @brief Fetch number of entries across all stripes
+   * @return Number of entries
+   */
+  size_type size() const {
+    size_type n = 0;
+    for (std::size_t i = 0; i < NumStripes; ++i)
+      n += stripes_[i]->table.size();
+    return n;
+  }
+
+  /**
+   * @brief Check if all stripes are empty
+   * @return Bool value, true if empty
+   */
+  bool empty() const {
+    return size() == 0;
+  }
+
+  /**
+   * @brief Remove all entries from all stripes
+   */
+  void clear() {
+    for (std::size_t i = 0; i < NumStripes; ++i)
+      stripes_[i]->table.clear();
+  }
+
+  /**
+   * @brief Forget all entries in all stripes without destroying them or returning their memory
+   */
+  void abandon() {
+    for (std::size_t i = 0; i < NumStripes; ++i)
+      stripes_[i]->table.abandon();
+  }
+
+  /**
+   * @brief Make room for at least n entries, spread evenly across stripes, without growing
+   * @param n Number of entries
+   */
+  void reserve(size_type n) {
+    // Keys are not spread exactly evenly; leave each stripe some headroom
+    auto per_stripe = (n + NumStripes - 1) / NumStripes;
+    per_stripe += per_stripe / 8;
+    for (std::size_t i = 0; i < NumStripes; ++i)
+      stripes_[i]->table.reserve(per_stripe);
+  }
+
+  /**
+   * @brief Insert key value pair into its stripe
+   * @param kv Key value pair
+   * @return Bool value, true if inserted
+   */
+  bool emplace(value_type &&kv) {
+    return stripe_for(kv.first).table.emplace(std::move(kv)).second;
+  }
+
+  /**
+   * @brief Fetch value for key
+   * @param key Key
+   * @return Value
+   */
+  template<typename K>
+  const mapped_type &at(const K &key) const {
+    return stripe_for(key).table.at(key);
+  }
+
+  /**
+   * @brief Remove entry for key
+   * @param key Key
+   * @return Number of entries removed
+   */
+  template<typename K>
+  size_type erase(const K &key) {
+    return stripe_for(key).table.erase(key);
+  }
+
+ private:
+  static constexpr int stripe_bits(std::size_t n = NumStripes) {
+    return n <= 1 ? 0 : 1 + stripe_bits(n / 2);
+  }
+
+  std::unique_ptr<stripe> stripes_[NumStripes];
+};
+
+}
+}
+
+#endif //JIFFY_STRIPED_HASH_MAP_H
@@ -7,21 +7,32 @@ namespace jiffy {
 namespace storage {
 
 block_id block_id_parser::parse(const std::string &name) {
-  std::string host, service_port, management_port, block_id;
+  std::string host, service_port, management_port, block_id, numa_node;
   try {
     std::istringstream in(name);
     std::getline(in, host, ':');
     std::getline(in, service_port, ':');
     std::getline(in, management_port, ':');
     std::getline(in, block_id, ':');
-    return {host, std::stoi(service_port), std::stoi(management_port), std::stoi(block_id)};
+    std::getline(in, numa_node, ':');
+    return {host, std::stoi(service_port), std::stoi(management_port), std::stoi(block_id),
+            numa_node.empty() ? -1 : std::stoi(numa_node)};
   } catch (std::exception &e) {
     throw std::invalid_argument("Could not parse partition name: " + name + "; " + e.what());
   }
 }
 
-std::string block_id_parser::make(const std::string &host, int32_t service_port, int32_t management_port, int32_t id) {
-  return host + ":" + std::to_string(service_port) + ":" + std::to_string(management_port) + ":" + std::to_string(id);
+std::string block_id_parser::make(const std::string &host,
+                                  int32_t service_port,
+                                  int32_t management_port,
+                                  int32_t id,
+                                  int32_t numa_node) {
+  auto name = host + ":" + std::to_string(service_port) + ":" + std::to_string(management_port) + ":"
+      + std::to_string(id);
+  if (numa_node >= 0) {
+    name += ":" + std::to_string(numa_node);
+  }
+  return name;
 }
 
 }
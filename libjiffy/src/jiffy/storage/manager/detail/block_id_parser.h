@@ -11,6 +11,8 @@ struct block_id {
   int32_t service_port;
   int32_t management_port;
   int32_t id;
+  /* NUMA node the block's memory and service threads are placed on, -1 if unplaced */
+  int32_t numa_node;
 };
 /* Block name parser class */
 class block_id_parser {
@@ -30,10 +32,15 @@ class block_id_parser {
    * @param service_port Service port number
    * @param management_port Management port number
    * @param id Block identifier
+   * @param numa_node NUMA node the block is placed on, -1 to leave it out of the name
    * @return Block name
    */
 
-  static std::string make(const std::string &host, int32_t service_port, int32_t management_port, int32_t id);
+  static std::string make(const std::string &host,
+                          int32_t service_port,
+                          int32_t management_port,
+                          int32_t id,
+                          int32_t numa_node = -1);
 };
 
 }
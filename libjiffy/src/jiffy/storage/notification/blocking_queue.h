@@ -46,6 +46,22 @@ class blocking_queue {
     return item;
   }
 
+  /**
+   * @brief Pop element out of queue if there is one, without waiting
+   * @param item Oldest element in the queue, if any
+   * @return Bool value, true if an element was popped
+   */
+
+  bool try_pop(T &item) {
+    std::unique_lock<std::mutex> mlock(mutex_);
+    if (queue_.empty()) {
+      return false;
+    }
+    item = queue_.front();
+    queue_.pop();
+    return true;
+  }
+
   /**
    * @brief Push item in the queue using lvalue reference
    * @param item Item to be pushed
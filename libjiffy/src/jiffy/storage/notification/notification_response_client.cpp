@@ -3,16 +3,19 @@
 namespace jiffy {
 namespace storage {
 
-notification_response_client::notification_response_client(std::shared_ptr<::apache::thrift::protocol::TProtocol> prot)
-    : client_(prot) {}
+notification_response_client::notification_response_client(std::shared_ptr<::apache::thrift::protocol::TProtocol> prot,
+                                                           std::shared_ptr<std::mutex> write_lock)
+    : write_lock_(std::move(write_lock)), client_(prot) {}
 
 void notification_response_client::notification(const std::string &op, const std::string &data) {
+  std::unique_lock<std::mutex> lock(*write_lock_);
   client_.notification(op, data);
 }
 
 void notification_response_client::control(const response_type type,
                                            const std::vector<std::string> &ops,
                                            const std::string &error) {
+  std::unique_lock<std::mutex> lock(*write_lock_);
   client_.control(type, ops, error);
 }
 
@@ -1,6 +1,7 @@
 #ifndef JIFFY_NOTIFICATION_RESPONSE_CLIENT_H
 #define JIFFY_NOTIFICATION_RESPONSE_CLIENT_H
 
+#include <mutex>
 #include <jiffy/storage/service/block_response_service.h>
 
 namespace jiffy {
@@ -8,7 +9,13 @@ namespace storage {
 
 class notification_response_client {
  public:
-  notification_response_client(std::shared_ptr<::apache::thrift::protocol::TProtocol> prot);
+  /**
+   * @brief Constructor
+   * @param prot Protocol
+   * @param write_lock Lock serializing writes on the connection, shared with other clients on it
+   */
+  notification_response_client(std::shared_ptr<::apache::thrift::protocol::TProtocol> prot,
+                               std::shared_ptr<std::mutex> write_lock = std::make_shared<std::mutex>());
 
   /**
    * @brief Send notification
@@ -25,6 +32,8 @@ class notification_response_client {
    */
   void control(response_type type, const std::vector<std::string> &ops, const std::string &msg);
  private:
+  /* Connection write lock */
+  std::shared_ptr<std::mutex> write_lock_;
   block_response_serviceClient client_;
 };
 
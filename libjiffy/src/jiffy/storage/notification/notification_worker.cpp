@@ -33,9 +33,14 @@ void notification_worker::start() {
         }
       } catch (TTransportException &e) {
         LOG(log_level::info) << "Connection no longer active: " << e.what();
+        // Let subscribers know no more notifications will arrive
+        if (!stop_.load())
+          notifications_.push(std::make_pair("error", "!block_moved"));
         return;
       } catch (std::exception &e) {
         LOG(log_level::warn) << "Encountered exception: " << e.what();
+        if (!stop_.load())
+          notifications_.push(std::make_pair("error", "!block_moved"));
         return;
       }
     }
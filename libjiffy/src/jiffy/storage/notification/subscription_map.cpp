@@ -8,21 +8,30 @@ subscription_map::subscription_map() = default;
 
 void subscription_map::add_subscriptions(const std::vector<std::string> &ops,
                                          const std::shared_ptr<notification_response_client>& client) {
-  for (const auto &op: ops)
-    subs_[op].insert(client);
+  {
+    std::unique_lock<std::mutex> lock(mtx_);
+    for (const auto &op: ops)
+      subs_[op].insert(client);
+  }
   client->control(response_type::subscribe, ops, "");
 }
 
 void subscription_map::remove_subscriptions(const std::vector<std::string> &ops,
                                             const std::shared_ptr<notification_response_client>& client,
                                             bool inform) {
-  for (const auto &op: ops) {
-    auto &clients = subs_[op];
-    auto it = clients.find(client);
-    if (it != clients.end()) {
-      clients.erase(it);
-      if (clients.empty())
-        subs_.erase(op);
+  {
+    std::unique_lock<std::mutex> lock(mtx_);
+    for (const auto &op: ops) {
+      auto sub = subs_.find(op);
+      if (sub == subs_.end())
+        continue;
+      auto &clients = sub->second;
+      auto it = clients.find(client);
+      if (it != clients.end()) {
+        clients.erase(it);
+        if (clients.empty())
+          subs_.erase(sub);
+      }
     }
   }
   if (inform)
@@ -31,18 +40,24 @@ void subscription_map::remove_subscriptions(const std::vector<std::string> &ops,
 
 void subscription_map::notify(const std::string &op, const std::string &msg) {
   if (op == "default_partition") return;
-  for (const auto &client: subs_[op]) {
+  std::unique_lock<std::mutex> lock(mtx_);
+  auto sub = subs_.find(op);
+  if (sub == subs_.end())
+    return;
+  for (const auto &client: sub->second) {
     client->notification(op, msg);
   }
 }
 
 void subscription_map::clear() {
+  std::unique_lock<std::mutex> lock(mtx_);
   subs_.clear();
 }
 
 // TODO fix this function so that we could let the
 // subscribed blocks know whenever the partition is destroyed
 void subscription_map::end_connections() {
+  std::unique_lock<std::mutex> lock(mtx_);
   for (const auto &sub: subs_) {
     for (const auto &client: sub.second) {
       client->notification("error", "!block_moved");
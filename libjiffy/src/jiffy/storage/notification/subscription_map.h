@@ -61,6 +61,8 @@ class subscription_map {
   void end_connections();
 
  private:
+  /* Subscription map mutex, commands may notify from several threads */
+  std::mutex mtx_;
   /* Subscription map */
   std::map<std::string, std::set<std::shared_ptr<notification_response_client>>> subs_{};
 };
@@ -8,13 +8,22 @@ partition::partition(block_memory_manager *manager,
                      const std::string &name,
                      const std::string &metadata,
                      const command_map &supported_commands)
-    : name_(name),
+    : backing_path_(backing_path),
+      name_(name),
       metadata_(metadata),
-      backing_path_(backing_path),
+      state_(parse_state(metadata)),
       supported_commands_(supported_commands),
       manager_(manager),
       binary_allocator_(build_allocator<uint8_t>()) {
   default_ = supported_commands_.empty();
+  for (const auto &op: supported_commands_) {
+    if (op.second.id >= commands_by_id_.size()) {
+      commands_by_id_.resize(op.second.id + 1, command_info{command_type::accessor, UINT32_MAX});
+      command_names_.resize(op.second.id + 1);
+    }
+    commands_by_id_[op.second.id] = op.second;
+    command_names_[op.second.id] = op.first;
+  }
 }
 
 void partition::path(const std::string &path) {
@@ -44,29 +53,83 @@ const std::string &partition::name() const {
 
 void partition::metadata(const std::string &metadata) {
   metadata_ = metadata;
+  state_ = parse_state(metadata);
 }
 
 const std::string &partition::metadata() const {
   return metadata_;
 }
 
+partition_state partition::state() const {
+  return state_;
+}
+
+partition_state partition::parse_state(const std::string &metadata) {
+  if (metadata == "regular")
+    return state_regular;
+  if (metadata == "importing")
+    return state_importing;
+  if (metadata == "exporting")
+    return state_exporting;
+  if (metadata == "split_importing")
+    return state_split_importing;
+  return state_other;
+}
+
 bool partition::is_accessor(const std::string &cmd) const {
+  if (batch_frame::is_batch(cmd))
+    return batch_frame::info(cmd).is_accessor();
   // Does not require lock since block_ops don't change
+  if (command_codec::is_opcode(cmd))
+    return !is_mutator(cmd);
   return supported_commands_.at(cmd).is_accessor();
 }
 
 bool partition::is_mutator(const std::string &cmd) const {
+  if (batch_frame::is_batch(cmd))
+    return batch_frame::info(cmd).is_mutator();
   // Does not require lock since block_ops don't change
+  if (command_codec::is_opcode(cmd)) {
+    auto id = command_id(cmd);
+    if (id == UINT32_MAX)
+      throw std::out_of_range("No such command");
+    return is_mutator(id);
+  }
   return supported_commands_.at(cmd).is_mutator();
 }
 
-uint32_t partition::command_id(const std::string &cmd_name) {
+bool partition::is_mutator(uint32_t cmd_id) const {
+  return cmd_id < commands_by_id_.size() && commands_by_id_[cmd_id].is_mutator();
+}
+
+uint32_t partition::command_id(const std::string &cmd_name) const {
+  if (command_codec::is_opcode(cmd_name)) {
+    auto id = command_codec::opcode_id(cmd_name);
+    if (id >= commands_by_id_.size() || commands_by_id_[id].id != id)
+      return UINT32_MAX;
+    return id;
+  }
   auto it = supported_commands_.find(cmd_name);
   if (it == supported_commands_.end())
     return UINT32_MAX;
   return it->second.id;
 }
 
+const std::string &partition::command_name(const std::string &cmd) const {
+  if (command_codec::is_opcode(cmd)) {
+    auto id = command_id(cmd);
+    if (id != UINT32_MAX)
+      return command_names_[id];
+  }
+  return cmd;
+}
+
+int64_t partition::int_arg(const arg_list &args, std::size_t i) {
+  if (command_codec::is_opcode(args.front()))
+    return command_codec::decode_int(args.at(i));
+  return std::stoll(args.at(i));
+}
+
 std::size_t partition::storage_capacity() {
   return manager_->mb_capacity();
 }
@@ -86,10 +149,30 @@ block_response_client_map &partition::clients() {
 void partition::set_name_and_metadata(const std::string &name, const std::string &metadata) {
   name_ = name;
   metadata_ = metadata;
+  state_ = parse_state(metadata);
+}
+
+void partition::execute(response &_return, const arg_list &args) {
+  if (!batch_frame::is_batch(args.front())) {
+    run_command(_return, args);
+    return;
+  }
+  auto cmds = batch_frame::decode(args);
+  std::vector<response> responses(cmds.size());
+  for (std::size_t i = 0; i < cmds.size(); ++i) {
+    run_command(responses[i], cmds[i]);
+  }
+  _return = batch_frame::encode_responses(responses);
 }
 
 void partition::notify(const arg_list &args) {
-  subscriptions().notify(args.front(), args[1]);
+  if (batch_frame::is_batch(args.front())) {
+    for (const auto &cmd: batch_frame::decode(args)) {
+      notify(cmd);
+    }
+    return;
+  }
+  subscriptions().notify(command_name(args.front()), args[1]);
 }
 
 binary partition::make_binary(const std::string &str) {
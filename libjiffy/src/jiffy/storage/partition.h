@@ -13,12 +13,13 @@
 #include "jiffy/storage/notification/subscription_map.h"
 #include "jiffy/storage/service/block_response_client_map.h"
 #include "jiffy/storage/command.h"
+#include "jiffy/storage/batch_frame.h"
 #include "jiffy/storage/block_memory_manager.h"
 #include "jiffy/storage/block_memory_allocator.h"
 #include "jiffy/utils/logger.h"
 
-#define RETURN(...)           \
-  _return = { __VA_ARGS__ };  \
+#define RETURN(...)                                         \
+  ::jiffy::storage::make_response(_return, { __VA_ARGS__ });  \
   return
 
 #define RETURN_OK(...) RETURN("!ok", ##__VA_ARGS__)
@@ -32,6 +33,64 @@ using namespace utils;
 typedef std::vector<std::string> arg_list;
 typedef std::vector<std::string> response;
 
+/**
+ * @brief Field of a response built by RETURN
+ * Refers to the string passed to RETURN and remembers whether it may be moved
+ * from, so a value read from storage is copied into the response exactly once.
+ */
+class response_field {
+ public:
+  response_field(const char *str) : literal_(str), str_(nullptr), movable_(false) {}
+
+  response_field(const std::string &str) : literal_(nullptr), str_(&str), movable_(false) {}
+
+  response_field(std::string &&str) : literal_(nullptr), str_(&str), movable_(true) {}
+
+  /**
+   * @brief Append field to response
+   * @param _return Response
+   */
+  void append_to(std::vector<std::string> &_return) const {
+    if (literal_ != nullptr) {
+      _return.emplace_back(literal_);
+    } else if (movable_) {
+      _return.emplace_back(std::move(*const_cast<std::string *>(str_)));
+    } else {
+      _return.emplace_back(*str_);
+    }
+  }
+
+ private:
+  const char *literal_;
+  const std::string *str_;
+  bool movable_;
+};
+
+/**
+ * @brief Fill response in place
+ * @param _return Response
+ * @param fields Response fields
+ */
+inline void make_response(response &_return, std::initializer_list<response_field> fields) {
+  _return.clear();
+  _return.reserve(fields.size());
+  for (const auto &field: fields) {
+    field.append_to(_return);
+  }
+}
+
+/**
+ * Partition state
+ * Parsed from the leading part of the partition metadata
+ */
+enum partition_state : uint8_t {
+  state_regular = 0,
+  state_importing = 1,
+  state_exporting = 2,
+  state_split_importing = 3,
+  state_other = 4
+};
+
 /* Partition class */
 class partition {
  public:
@@ -68,6 +127,13 @@ class partition {
    */
   virtual void run_command(response &_return, const arg_list &args) = 0;
 
+  /**
+   * @brief Run a command, or each command in a batch frame back-to-back
+   * @param _return Response, or packed responses for a batch frame
+   * @param args Command arguments or batch frame
+   */
+  void execute(response &_return, const arg_list &args);
+
   /**
    * @brief Set block path
    * @param path Block path
@@ -116,26 +182,54 @@ class partition {
    */
   const std::string &metadata() const;
 
+  /**
+   * @brief Fetch partition state
+   * @return Partition state
+   */
+  partition_state state() const;
+
   /**
    * @brief Check if ith command type is accessor
-   * @param cmd Command name
+   * @param cmd Command name or opcode
    * @return Bool value, true if block is accessor
    */
   bool is_accessor(const std::string& cmd) const;
 
   /**
    * @brief Check if ith command  type is mutator
-   * @param cmd Command name
+   * @param cmd Command name or opcode
    * @return Bool value, true if is mutator
    */
   bool is_mutator(const std::string& cmd) const;
 
+  /**
+   * @brief Check if command is a mutator
+   * @param cmd_id Command ID
+   * @return Bool value, true if is mutator
+   */
+  bool is_mutator(uint32_t cmd_id) const;
+
   /**
    * @brief Fetch command id
-   * @param cmd_name Name of the command
+   * @param cmd_name Name of the command or opcode
    * @return Command ID
    */
-  uint32_t command_id(const std::string& cmd_name);
+  uint32_t command_id(const std::string& cmd_name) const;
+
+  /**
+   * @brief Fetch command name
+   * @param cmd Name of the command or opcode
+   * @return Command name
+   */
+  const std::string &command_name(const std::string &cmd) const;
+
+  /**
+   * @brief Fetch numeric argument, a native integer if the command is an opcode
+   * @param args Command arguments
+   * @param i Argument index
+   * @return Argument value
+   */
+  static int64_t int_arg(const arg_list &args, std::size_t i);
 
   /**
    * Management Operations
@@ -157,6 +251,11 @@ class partition {
    */
   virtual bool dump(const std::string &path) = 0;
 
+  /**
+   * @brief Free entries whose time to live has passed; partitions without expiring entries have nothing to free
+   */
+  virtual void expire() {}
+
   /**
    * @brief Get the storage capacity of the partition.
    * @return The storage capacity of the partition.
@@ -201,12 +300,19 @@ class partition {
   void set_name_and_metadata(const std::string &name, const std::string &metadata);
 
   /**
-   * @brief Notify the listener
+   * @brief Notify the listener, once per command in a batch frame
    * @param args Arguments
    */
   void notify(const arg_list & args);
 
  protected:
+  /**
+   * @brief Parse partition state from partition metadata
+   * @param metadata Partition metadata
+   * @return Partition state
+   */
+  static partition_state parse_state(const std::string &metadata);
+
   /**
    * @brief Construct binary string
    * @param str String
@@ -220,10 +326,16 @@ class partition {
   std::string name_;
   /* Partition metadata */
   std::string metadata_;
+  /* Partition state, kept in step with the metadata */
+  partition_state state_;
   /* Partition path */
   std::string path_;
   /* Supported commands */
   const command_map &supported_commands_;
+  /* Supported commands indexed by command ID, for opcodes */
+  std::vector<command_info> commands_by_id_;
+  /* Supported command names indexed by command ID */
+  std::vector<std::string> command_names_;
   /* Subscription map */
   subscription_map sub_map_{};
   /* Block response client map */
@@ -2,6 +2,7 @@
 #define JIFFY_SERDE_H
 
 #include "jiffy/storage/hashtable/hash_table_defs.h"
+#include "jiffy/storage/hashtable/hash_table_value_tier.h"
 #include "jiffy/storage/file/file_defs.h"
 #include "jiffy/storage/fifoqueue/fifo_queue_defs.h"
 #include "jiffy/storage/shared_log/shared_log_defs.h"
@@ -10,6 +11,7 @@
 #include <sstream>
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 
 using namespace jiffy::utils;
 
@@ -65,6 +67,20 @@ class serde {
     return binary(str, allocator_);
   }
 
+ protected:
+  /**
+   * @brief Write the full contents of a file one chunk at a time
+   * @param table File
+   * @param out Output stream
+   */
+
+  void write_chunks(const file_type &table, std::ostream &out) {
+    for (std::size_t off = 0; off < table.size(); off += CHUNKED_BUFFER_CHUNK_SIZE) {
+      auto chunk = table.read(off, CHUNKED_BUFFER_CHUNK_SIZE).second;
+      out.write(chunk.data(), chunk.size());
+    }
+  }
+
  private:
 
   /**
@@ -76,6 +92,15 @@ class serde {
 
   virtual std::size_t virtual_serialize(const hash_table_type &table, const std::string &out_path) = 0;
 
+  /**
+   * @brief Virtual serialize function for hash table with spilled values
+   * @param table Tiered hash table
+   * @param out Output stream
+   * @return Output stream position
+   */
+
+  virtual std::size_t virtual_serialize(const tiered_hash_table_type &table, const std::string &out_path) = 0;
+
   /**
    * @brief Virtual serialize function for fifo queue
    * @param table Fifo queue
@@ -171,6 +196,17 @@ class derived : public impl {
     return impl::serialize_impl(table, out_path);
   }
 
+  /**
+   * @brief Virtual serialize function for hash table with spilled values
+   * @param table Tiered hash table
+   * @param out Output stream
+   * @return Output stream position
+   */
+
+  std::size_t virtual_serialize(const tiered_hash_table_type &table, const std::string &out_path) final {
+    return impl::serialize_impl(table, out_path);
+  }
+
   /**
    * @brief Virtual serialize function for fifo queue
    * @param table Fifo queue
@@ -309,7 +345,8 @@ class csv_serde_impl : public serde {
 
   std::size_t serialize_impl(const file_type &table, const std::string &out_path) {
     std::ofstream out(out_path, std::ios::out);
-    out << std::string(table.data(), table.size()) << "\n";
+    write_chunks(table, out);
+    out << "\n";
     out.flush();
     auto sz = out.tellp();
     out.close();
@@ -519,8 +556,7 @@ class binary_serde_impl : public serde {
 
   size_t serialize_impl(const file_type &table, const std::string &out_path) {
     std::ofstream out(out_path, std::ios::binary);
-    std::size_t msg_size = table.size();
-    out.write(reinterpret_cast<const char *>(table.data()), msg_size);
+    write_chunks(table, out);
     out.flush();
     auto sz = out.tellp();
     out.close();
@@ -648,11 +684,16 @@ class binary_serde_impl : public serde {
 
   size_t deserialize_impl(file_type &table, const std::string &in_path) {
     std::ifstream in(in_path, std::ios::binary);
-    std::size_t msg_size = table.size();
     std::string msg;
-    msg.resize(msg_size);
-    in.read(&msg[0], msg_size);
-    table.write(msg, 0);
+    for (std::size_t off = 0; off < table.size() && in; off += msg.size()) {
+      msg.resize(std::min(CHUNKED_BUFFER_CHUNK_SIZE, table.size() - off));
+      in.read(&msg[0], msg.size());
+      msg.resize(static_cast<std::size_t>(in.gcount()));
+      // Runs of zeros are left uncommitted in the loaded file
+      if (msg.find_first_not_of('\0') != std::string::npos) {
+        table.write(msg, off);
+      }
+    }
     auto sz = in.tellg();
     in.close();
     return static_cast<std::size_t>(sz);
@@ -1,4 +1,6 @@
 #include "block_request_handler.h"
+#include <algorithm>
+#include "jiffy/storage/client_registration.h"
 #include "jiffy/utils/logger.h"
 namespace jiffy {
 namespace storage {
@@ -7,10 +9,9 @@ block_request_handler::block_request_handler(std::shared_ptr<::apache::thrift::p
                                              std::atomic<int64_t> &client_id_gen,
                                              std::map<int, std::shared_ptr<block>> &blocks)
     : prot_(std::move(prot)),
-      client_(std::make_shared<block_response_client>(prot_)),
-      notification_client_(std::make_shared<notification_response_client>(prot_)),
-      registered_block_id_(-1),
-      registered_client_id_(-1),
+      write_lock_(std::make_shared<std::mutex>()),
+      client_(std::make_shared<block_response_client>(prot_, write_lock_)),
+      notification_client_(std::make_shared<notification_response_client>(prot_, write_lock_)),
       client_id_gen_(client_id_gen),
       blocks_(blocks) {}
 
@@ -19,23 +20,42 @@ int64_t block_request_handler::get_client_id() {
 }
 
 void block_request_handler::register_client_id(const int32_t block_id, const int64_t client_id) {
-  registered_client_id_ = client_id;
-  registered_block_id_ = block_id;
+  registrations_.emplace_back(block_id, client_id);
   blocks_[static_cast<std::size_t>(block_id)]->impl()->clients().add_client(client_id, client_);
 }
 
 void block_request_handler::command_request(const sequence_id &seq,
                                             const int32_t block_id,
                                             const std::vector<std::string> &args) {
+  if (client_registration::is_registration(args)) {
+    registration_request(seq, block_id, args);
+    return;
+  }
   blocks_[static_cast<std::size_t>(block_id)]->impl()->request(seq, args);
 }
 
-int32_t block_request_handler::registered_block_id() const {
-  return registered_block_id_;
+const std::vector<std::pair<int32_t, int64_t>> &block_request_handler::registrations() const {
+  return registrations_;
 }
 
-int64_t block_request_handler::registered_client_id() const {
-  return registered_client_id_;
+void block_request_handler::registration_request(const sequence_id &seq,
+                                                 const int32_t block_id,
+                                                 const std::vector<std::string> &args) {
+  auto &clients = blocks_[static_cast<std::size_t>(block_id)]->impl()->clients();
+  if (args.front() == client_registration::UNREGISTER) {
+    auto it = std::find(registrations_.begin(), registrations_.end(),
+                        std::pair<int32_t, int64_t>(block_id, seq.client_id));
+    if (it != registrations_.end()) {
+      registrations_.erase(it);
+      clients.remove_client(seq.client_id);
+    }
+    return;
+  }
+  // The client is told its identifier in a response addressed to the one it registered with
+  auto client_id = client_id_gen_.fetch_add(1L);
+  registrations_.emplace_back(block_id, client_id);
+  clients.add_client(client_id, client_);
+  client_->response(seq, {"!ok", std::to_string(client_id)});
 }
 
 void block_request_handler::chain_request(const sequence_id &seq,
@@ -51,8 +71,12 @@ void block_request_handler::chain_request(const sequence_id &seq,
 void block_request_handler::run_command(std::vector<std::string> &_return,
                                         const int32_t block_id,
                                         const std::vector<std::string> &args) {
-  blocks_[static_cast<std::size_t>(block_id)]->impl()->run_command(_return, args);
-  blocks_[static_cast<std::size_t>(block_id)]->impl()->notify(args);
+  auto impl = blocks_[static_cast<std::size_t>(block_id)]->impl();
+  {
+    auto lock = impl->serialize();
+    impl->execute(_return, args);
+  }
+  impl->notify(args);
 }
 
 void block_request_handler::subscribe(int32_t block_id,
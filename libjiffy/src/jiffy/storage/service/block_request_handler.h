@@ -2,6 +2,7 @@
 #define JIFFY_BLOCK_REQUEST_HANDLER_H
 
 #include <atomic>
+#include <mutex>
 #include <jiffy/storage/notification/notification_response_client.h>
 
 #include "block_request_service.h"
@@ -43,6 +44,7 @@ class block_request_handler : public block_request_serviceIf {
 
   /**
    * @brief Request a command, starting from either the head or tail of the chain
+   * Registration commands are served by the handler itself, see client_registration
    * @param seq Sequence identifier
    * @param block_id Block identifier
    * @param args Command arguments
@@ -50,16 +52,10 @@ class block_request_handler : public block_request_serviceIf {
   void command_request(const sequence_id &seq, int32_t block_id, const std::vector<std::string> &args) override;
 
   /**
-   * @brief Fetch the registered block identifier
-   * @return Registered block identifier
+   * @brief Fetch the clients registered on this connection
+   * @return Pairs of block identifier and client identifier
    */
-  int32_t registered_block_id() const;
-
-  /**
-   * @brief Fetch the registered client identifier
-   * @return Registered client identifier
-   */
-  int64_t registered_client_id() const;
+  const std::vector<std::pair<int32_t, int64_t>> &registrations() const;
 
   /**
    * @brief Send chain request
@@ -103,18 +99,26 @@ class block_request_handler : public block_request_serviceIf {
   void unsubscribe(int32_t block_id, const std::vector<std::string> &ops) override;
 
  private:
+  /**
+   * @brief Serve a registration command
+   * @param seq Sequence identifier
+   * @param block_id Block identifier
+   * @param args Command arguments
+   */
+  void registration_request(const sequence_id &seq, int32_t block_id, const std::vector<std::string> &args);
+
   /* Local subscription set for pairs of partition and operation */
   std::set<std::pair<int32_t, std::string>> local_subs_;
   /* Protocol */
   std::shared_ptr<::apache::thrift::protocol::TProtocol> prot_;
+  /* Write lock shared by all clients responding on this connection */
+  std::shared_ptr<std::mutex> write_lock_;
   /* Block response client */
   std::shared_ptr<block_response_client> client_;
   /* Notification response client */
   std::shared_ptr<notification_response_client> notification_client_;
-  /* Registered partition identifier */
-  int32_t registered_block_id_;
-  /* Registered client identifier */
-  int64_t registered_client_id_;
+  /* Clients registered on this connection, pairs of block identifier and client identifier */
+  std::vector<std::pair<int32_t, int64_t>> registrations_;
   /* Client identifier generator */
   std::atomic<int64_t> &client_id_gen_;
   /* Data blocks */
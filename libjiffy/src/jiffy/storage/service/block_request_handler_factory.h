@@ -26,7 +26,7 @@ class block_request_handler_factory : public block_request_serviceIfFactory {
 
   /**
    * @brief Release handler
-   * Remove the registered client from the block response client list
+   * Remove the clients registered on the connection from the block response client lists
    * @param anIf Block request handler
    */
 
@@ -8,10 +8,12 @@ using namespace ::apache::thrift::protocol;
 namespace jiffy {
 namespace storage {
 
-block_response_client::block_response_client(std::shared_ptr<TProtocol> protocol)
-    : client_(std::make_shared<thrift_client>(protocol)) {}
+block_response_client::block_response_client(std::shared_ptr<TProtocol> protocol,
+                                             std::shared_ptr<std::mutex> write_lock)
+    : write_lock_(std::move(write_lock)), client_(std::make_shared<thrift_client>(protocol)) {}
 
 void block_response_client::response(const sequence_id &seq, const std::vector<std::string> &result) {
+  std::unique_lock<std::mutex> lock(*write_lock_);
   client_->response(seq, result);
 }
 
@@ -1,6 +1,7 @@
 #ifndef JIFFY_BLOCK_RESPONSE_CLIENT_H
 #define JIFFY_BLOCK_RESPONSE_CLIENT_H
 
+#include <mutex>
 #include <thrift/transport/TSocket.h>
 #include "block_response_service.h"
 
@@ -14,9 +15,11 @@ class block_response_client {
   /**
    * @brief Constructor
    * @param protocol Protocol
+   * @param write_lock Lock serializing writes on the connection, shared with other clients on it
    */
 
-  explicit block_response_client(std::shared_ptr<apache::thrift::protocol::TProtocol> protocol);
+  explicit block_response_client(std::shared_ptr<apache::thrift::protocol::TProtocol> protocol,
+                                 std::shared_ptr<std::mutex> write_lock = std::make_shared<std::mutex>());
 
   /**
    * @brief Response
@@ -27,6 +30,8 @@ class block_response_client {
   void response(const sequence_id &seq, const std::vector<std::string> &result);
 
  private:
+  /* Connection write lock */
+  std::shared_ptr<std::mutex> write_lock_;
   /* Block response service client */
   std::shared_ptr<thrift_client> client_{};
 };
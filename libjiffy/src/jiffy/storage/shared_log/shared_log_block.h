@@ -7,6 +7,7 @@
 #include <map>
 #include <iterator>
 #include "jiffy/storage/block_memory_allocator.h"
+#include "jiffy/storage/types/chunked_buffer.h"
 
 namespace jiffy {
 namespace storage {
@@ -96,21 +97,14 @@ class shared_log_block {
   void clear();
 
   /**
-   * @brief Fetch data pointer
-   * @return Data pointer of the block
+   * @brief Fetch number of bytes of memory committed to the block
+   * @return Committed bytes
    */
-
-  char *data() const;
+  std::size_t committed() const;
 
  private:
-  /* Block memory allocator */
-  block_memory_allocator<char> alloc_;
-
-  /* Maximum capacity */
-  std::size_t max_{};
-
-  /* Data pointer */
-  char *data_{};
+  /* Data, committed in chunks as it is written */
+  chunked_buffer data_;
 
 };
 
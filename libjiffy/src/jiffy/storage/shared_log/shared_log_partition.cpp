@@ -41,7 +41,7 @@ void shared_log_partition::write(response &_return, const arg_list &args) {
   if (args.size() < 4) {
     RETURN_ERR("!args_error");
   }
-  auto position = std::stoi(args[1]);
+  auto position = static_cast<int>(int_arg(args, 1));
   if (log_info_.size() == 0) {
     seq_no_ = position;
   }
@@ -69,8 +69,8 @@ void shared_log_partition::scan(response &_return, const arg_list &args) {
   if (args.size() < 4) {
     RETURN_ERR("!args_error");
   }
-  auto start_pos = std::stoi(args[1]) - seq_no_;
-  auto end_pos = std::stoi(args[2]) - seq_no_;
+  auto start_pos = static_cast<int>(int_arg(args, 1)) - seq_no_;
+  auto end_pos = static_cast<int>(int_arg(args, 2)) - seq_no_;
   if (static_cast<size_t>(end_pos) > log_info_.size()) end_pos = log_info_.size() - 1;
   std::vector<std::string> logical_streams = {};
   for (std::size_t i = 3; i < args.size(); i++) {
@@ -115,10 +115,10 @@ void shared_log_partition::trim(response &_return, const arg_list &args) {
     RETURN_ERR("!args_error");
   }
   if (log_info_.size() == 0) {
-    RETURN_OK(0);
+    RETURN_OK("0");
   }
-  auto start_pos = std::stoi(args[1]) - seq_no_;
-  auto end_pos = std::stoi(args[2]) - seq_no_;
+  auto start_pos = static_cast<int>(int_arg(args, 1)) - seq_no_;
+  auto end_pos = static_cast<int>(int_arg(args, 2)) - seq_no_;
   if (start_pos < 0 || static_cast<size_t>(start_pos) >= log_info_.size() || end_pos < 0 || end_pos < start_pos)
     throw std::invalid_argument("trim position invalid");
   if (static_cast<size_t>(end_pos) > log_info_.size()) end_pos = log_info_.size() - 1;
@@ -174,8 +174,8 @@ void shared_log_partition::get_storage_capacity(response &_return, const arg_lis
 }
 
 void shared_log_partition::run_command(response &_return, const arg_list &args) {
-  auto cmd_name = args[0];
-  switch (command_id(cmd_name)) {
+  auto cmd_id = command_id(args[0]);
+  switch (cmd_id) {
     case shared_log_cmd_id::shared_log_write:write(_return, args);
       break;
     case shared_log_cmd_id::shared_log_scan:scan(_return, args);
@@ -194,7 +194,8 @@ void shared_log_partition::run_command(response &_return, const arg_list &args)
     }
   }
 
-  if (is_mutator(cmd_name)) {
+  bool mutator = is_mutator(cmd_id);
+  if (mutator) {
     dirty_ = true;
   }
 }
@@ -248,7 +249,7 @@ bool shared_log_partition::dump(const std::string &path) {
 
 void shared_log_partition::forward_all() {
   std::vector<std::string> result;
-  run_command_on_next(result, {"write", std::string(partition_.data(), partition_.size())});
+  run_command_on_next(result, {"write", partition_.read(0, partition_.size()).second});
 }
 
 REGISTER_IMPLEMENTATION("shared_log", shared_log_partition);
@@ -139,10 +139,15 @@ byte_string &byte_string::operator--() {
 }
 
 byte_string &byte_string::operator=(const byte_string &other) {
+  if (this == &other)
+    return *this;
+  auto allocator = other.allocator_;
+  auto data = allocator.allocate(other.size_);
+  memcpy(data, other.data_, other.size_);
+  allocator_.deallocate(data_, size_);
   size_ = other.size_;
-  allocator_ = other.allocator_;
-  data_ = allocator_.allocate(size_);
-  memcpy(data_, other.data_, size_);
+  allocator_ = allocator;
+  data_ = data;
   return *this;
 }
 
@@ -169,6 +174,9 @@ std::string byte_string::to_string() const {
 }
 
 byte_string &byte_string::operator=(byte_string &&other) {
+  if (this == &other)
+    return *this;
+  allocator_.deallocate(data_, size_);
   size_ = other.size_;
   allocator_ = other.allocator_;
   data_ = other.data_;
@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "chunked_buffer.h"
+
+namespace jiffy {
+namespace storage {
+
+chunked_buffer::chunked_buffer(std::size_t max_size, block_memory_allocator<char> alloc)
+    : alloc_(alloc),
+      max_(max_size),
+      chunk_(std::max(CHUNKED_BUFFER_CHUNK_SIZE, alloc.page_size())),
+      chunks_((max_size + chunk_ - 1) / chunk_, nullptr) {}
+
+chunked_buffer::~chunked_buffer() {
+  clear();
+}
+
+chunked_buffer::chunked_buffer(const chunked_buffer &other)
+    : alloc_(other.alloc_), max_(other.max_), chunk_(other.chunk_), chunks_(other.chunks_.size(), nullptr) {
+  for (std::size_t i = 0; i < chunks_.size(); ++i) {
+    if (other.chunks_[i] != nullptr) {
+      std::memcpy(commit(i), other.chunks_[i], chunk_size(i));
+    }
+  }
+}
+
+chunked_buffer &chunked_buffer::operator=(const chunked_buffer &other) {
+  if (this != &other) {
+    chunked_buffer copy(other);
+    clear();
+    alloc_ = copy.alloc_;
+    max_ = copy.max_;
+    chunk_ = copy.chunk_;
+    chunks_.swap(copy.chunks_);
+    std::swap(committed_, copy.committed_);
+  }
+  return *this;
+}
+
+bool chunked_buffer::operator==(const chunked_buffer &other) const {
+  if (max_ != other.max_ || chunk_ != other.chunk_) {
+    return false;
+  }
+  for (std::size_t i = 0; i < chunks_.size(); ++i) {
+    auto a = chunks_[i];
+    auto b = other.chunks_[i];
+    if (a == nullptr && b == nullptr) {
+      continue;
+    }
+    auto n = chunk_size(i);
+    if (a != nullptr && b != nullptr) {
+      if (std::memcmp(a, b, n) != 0) {
+        return false;
+      }
+      continue;
+    }
+    // An uncommitted chunk reads as zeros
+    auto p = a != nullptr ? a : b;
+    if (std::any_of(p, p + n, [](char c) { return c != 0; })) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void chunked_buffer::write(std::size_t offset, const char *data, std::size_t len) {
+  if (offset > max_ || len > max_ - offset) {
+    throw std::out_of_range("Write exceeds partition capacity");
+  }
+  while (len > 0) {
+    auto chunk = offset / chunk_;
+    auto pos = offset % chunk_;
+    auto n = std::min(len, chunk_size(chunk) - pos);
+    auto ptr = chunks_[chunk] != nullptr ? chunks_[chunk] : commit(chunk);
+    std::memcpy(ptr + pos, data, n);
+    offset += n;
+    data += n;
+    len -= n;
+  }
+}
+
+std::size_t chunked_buffer::read(std::size_t offset, char *out, std::size_t len) const {
+  if (offset >= max_) {
+    return 0;
+  }
+  len = std::min(len, max_ - offset);
+  auto remaining = len;
+  while (remaining > 0) {
+    auto chunk = offset / chunk_;
+    auto pos = offset % chunk_;
+    auto n = std::min(remaining, chunk_size(chunk) - pos);
+    if (chunks_[chunk] != nullptr) {
+      std::memcpy(out, chunks_[chunk] + pos, n);
+    } else {
+      std::memset(out, 0, n);
+    }
+    offset += n;
+    out += n;
+    remaining -= n;
+  }
+  return len;
+}
+
+std::string chunked_buffer::read(std::size_t offset, std::size_t len) const {
+  std::string out(offset >= max_ ? 0 : std::min(len, max_ - offset), '\0');
+  if (!out.empty()) {
+    read(offset, &out[0], out.size());
+  }
+  return out;
+}
+
+std::size_t chunked_buffer::size() const {
+  return max_;
+}
+
+std::size_t chunked_buffer::chunk_size() const {
+  return chunk_;
+}
+
+std::size_t chunked_buffer::committed() const {
+  return committed_;
+}
+
+void chunked_buffer::clear() {
+  for (std::size_t i = 0; i < chunks_.size(); ++i) {
+    if (chunks_[i] != nullptr) {
+      alloc_.deallocate(chunks_[i], chunk_size(i));
+      chunks_[i] = nullptr;
+    }
+  }
+  committed_ = 0;
+}
+
+std::size_t chunked_buffer::chunk_size(std::size_t chunk) const {
+  return std::min(chunk_, max_ - chunk * chunk_);
+}
+
+char *chunked_buffer::commit(std::size_t chunk) {
+  auto size = chunk_size(chunk);
+  auto ptr = alloc_.allocate(size);
+  std::memset(ptr, 0, size);
+  chunks_[chunk] = ptr;
+  committed_ += size;
+  return ptr;
+}
+
+}
+}
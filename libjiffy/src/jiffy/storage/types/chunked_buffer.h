@@ -0,0 +1,136 @@
+#ifndef JIFFY_CHUNKED_BUFFER_H
+#define JIFFY_CHUNKED_BUFFER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "jiffy/storage/block_memory_allocator.h"
+
+namespace jiffy {
+namespace storage {
+
+// Smallest size of the extents a chunked buffer commits memory in
+constexpr std::size_t CHUNKED_BUFFER_CHUNK_SIZE = 65536;
+
+/**
+ * @brief Fixed size byte buffer backed by lazily committed chunks.
+ *
+ * The buffer spans max_size bytes but holds no memory until written to; each
+ * write commits the chunks it touches, zero filled, from the block memory
+ * allocator. Chunks are CHUNKED_BUFFER_CHUNK_SIZE bytes, or one page when the
+ * allocator is backed by larger (huge) pages. Bytes in uncommitted chunks read as zero.
+ * Clearing the buffer returns all chunks, so the memory used follows the data
+ * written rather than the buffer size.
+ */
+class chunked_buffer {
+ public:
+  /**
+   * @brief Constructor
+   */
+  chunked_buffer() = default;
+
+  /**
+   * @brief Constructor
+   * @param max_size Buffer size
+   * @param alloc Block memory allocator
+   */
+  chunked_buffer(std::size_t max_size, block_memory_allocator<char> alloc);
+
+  /**
+   * @brief Destructor, returns all chunks
+   */
+  ~chunked_buffer();
+
+  /**
+   * @brief Copy constructor, commits its own copy of every committed chunk
+   * @param other Another chunked buffer
+   */
+  chunked_buffer(const chunked_buffer &other);
+
+  /**
+   * @brief Copy assignment operator, commits its own copy of every committed chunk
+   * @param other Another chunked buffer
+   * @return Chunked buffer
+   */
+  chunked_buffer &operator=(const chunked_buffer &other);
+
+  /**
+   * @brief Operator ==
+   * @param other Another chunked buffer
+   * @return Boolean, true if both buffers hold the same bytes
+   */
+  bool operator==(const chunked_buffer &other) const;
+
+  /**
+   * @brief Write bytes, committing the chunks they fall in
+   * @param offset Write offset
+   * @param data Bytes
+   * @param len Number of bytes
+   */
+  void write(std::size_t offset, const char *data, std::size_t len);
+
+  /**
+   * @brief Read bytes, up to the end of the buffer
+   * @param offset Read offset
+   * @param out Output, receives the bytes read
+   * @param len Number of bytes
+   * @return Number of bytes read
+   */
+  std::size_t read(std::size_t offset, char *out, std::size_t len) const;
+
+  /**
+   * @brief Read bytes, up to the end of the buffer
+   * @param offset Read offset
+   * @param len Number of bytes
+   * @return Bytes read
+   */
+  std::string read(std::size_t offset, std::size_t len) const;
+
+  /**
+   * @brief Fetch buffer size
+   * @return Size
+   */
+  std::size_t size() const;
+
+  /**
+   * @brief Fetch size of the chunks memory is committed in
+   * @return Chunk size
+   */
+  std::size_t chunk_size() const;
+
+  /**
+   * @brief Fetch number of bytes of committed chunks
+   * @return Committed bytes
+   */
+  std::size_t committed() const;
+
+  /**
+   * @brief Return all chunks, leaving every byte zero
+   */
+  void clear();
+
+ private:
+  std::size_t chunk_size(std::size_t chunk) const;
+
+  char *commit(std::size_t chunk);
+
+  /* Block memory allocator */
+  block_memory_allocator<char> alloc_;
+
+  /* Buffer size */
+  std::size_t max_{};
+
+  /* Chunk size */
+  std::size_t chunk_{CHUNKED_BUFFER_CHUNK_SIZE};
+
+  /* Chunk pointers, null if uncommitted */
+  std::vector<char *> chunks_;
+
+  /* Committed bytes */
+  std::size_t committed_{};
+};
+
+}
+}
+
+#endif //JIFFY_CHUNKED_BUFFER_H
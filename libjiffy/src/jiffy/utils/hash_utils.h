@@ -0,0 +1,111 @@
+#ifndef JIFFY_HASH_UTILS_H
+#define JIFFY_HASH_UTILS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace jiffy {
+namespace utils {
+/* Hash utility class */
+class hash_utils {
+ public:
+  /**
+   * @brief Hash a sequence of bytes (xxHash64).
+   *
+   * Consumes 32 bytes per iteration across four independent 64-bit lanes,
+   * so the compiler can keep all of them in flight for long keys.
+   *
+   * @param data Bytes to hash
+   * @param len Number of bytes
+   * @param seed Hash seed
+   * @return 64-bit hash value
+   */
+  static uint64_t hash_bytes(const void *data, std::size_t len, uint64_t seed = 0) {
+    auto p = static_cast<const uint8_t *>(data);
+    const uint8_t *end = p + len;
+    uint64_t h;
+    if (len >= 32) {
+      const uint8_t *limit = end - 32;
+      uint64_t v1 = seed + P1 + P2;
+      uint64_t v2 = seed + P2;
+      uint64_t v3 = seed;
+      uint64_t v4 = seed - P1;
+      do {
+        v1 = round(v1, load64(p));
+        v2 = round(v2, load64(p + 8));
+        v3 = round(v3, load64(p + 16));
+        v4 = round(v4, load64(p + 24));
+        p += 32;
+      } while (p <= limit);
+      h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+      h = merge_round(h, v1);
+      h = merge_round(h, v2);
+      h = merge_round(h, v3);
+      h = merge_round(h, v4);
+    } else {
+      h = seed + P5;
+    }
+    h += static_cast<uint64_t>(len);
+    while (p + 8 <= end) {
+      h ^= round(0, load64(p));
+      h = rotl(h, 27) * P1 + P4;
+      p += 8;
+    }
+    if (p + 4 <= end) {
+      h ^= static_cast<uint64_t>(load32(p)) * P1;
+      h = rotl(h, 23) * P2 + P3;
+      p += 4;
+    }
+    while (p < end) {
+      h ^= static_cast<uint64_t>(*p) * P5;
+      h = rotl(h, 11) * P1;
+      ++p;
+    }
+    h ^= h >> 33;
+    h *= P2;
+    h ^= h >> 29;
+    h *= P3;
+    h ^= h >> 32;
+    return h;
+  }
+
+ private:
+  static constexpr uint64_t P1 = 11400714785074694791ULL;
+  static constexpr uint64_t P2 = 14029467366897019727ULL;
+  static constexpr uint64_t P3 = 1609587929392839161ULL;
+  static constexpr uint64_t P4 = 9650029242287828579ULL;
+  static constexpr uint64_t P5 = 2870177450012600261ULL;
+
+  static inline uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+  }
+
+  static inline uint64_t load64(const uint8_t *p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+  }
+
+  static inline uint32_t load32(const uint8_t *p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+  }
+
+  static inline uint64_t round(uint64_t acc, uint64_t input) {
+    acc += input * P2;
+    acc = rotl(acc, 31);
+    return acc * P1;
+  }
+
+  static inline uint64_t merge_round(uint64_t acc, uint64_t val) {
+    acc ^= round(0, val);
+    return acc * P1 + P4;
+  }
+};
+
+}
+}
+
+#endif //JIFFY_HASH_UTILS_H
@@ -0,0 +1,145 @@
+#ifndef JIFFY_NUMA_UTILS_H
+#define JIFFY_NUMA_UTILS_H
+
+#include <cerrno>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+namespace jiffy {
+namespace utils {
+
+/* NUMA topology and placement helpers, read from sysfs so that no libnuma is needed */
+class numa_utils {
+ public:
+  /**
+   * @brief Fetch number of online NUMA nodes
+   * @return Number of nodes, 1 if the topology is unknown
+   */
+  static int num_nodes() {
+    auto nodes = parse_list(read_line("/sys/devices/system/node/online"));
+    return nodes.empty() ? 1 : nodes.back() + 1;
+  }
+
+  /**
+   * @brief Fetch the CPUs of a NUMA node
+   * @param node NUMA node
+   * @return CPU identifiers, empty if the node is unknown
+   */
+  static std::vector<int> node_cpus(int node) {
+    return parse_list(read_line("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"));
+  }
+
+  /**
+   * @brief Restrict the calling thread to the CPUs of a NUMA node and prefer that node for
+   * the memory it touches first. Threads it creates afterwards inherit both.
+   * @param node NUMA node
+   * @return 0 on success, error number otherwise
+   */
+  static int set_self_node_affinity(int node) {
+#if defined(_GNU_SOURCE) && defined(__linux__)
+    auto cpus = node_cpus(node);
+    if (cpus.empty()) {
+      return EINVAL;
+    }
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    for (auto cpu: cpus) {
+      CPU_SET(cpu, &cpuset);
+    }
+    int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+    if (ret != 0) {
+      return ret;
+    }
+    auto mask = node_mask(node);
+    if (syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask, MASK_BITS) != 0) {
+      return errno;
+    }
+    return 0;
+#else
+    (void) node;
+    return 0;
+#endif
+  }
+
+  /**
+   * @brief Place the whole pages of a memory range on a NUMA node, moving pages already touched
+   * @param ptr Start of range
+   * @param size Size of range
+   * @param node NUMA node
+   * @return 0 on success, error number otherwise
+   */
+  static int bind_memory(void *ptr, std::size_t size, int node) {
+#ifdef __linux__
+    auto page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    auto begin = (reinterpret_cast<uintptr_t>(ptr) + page - 1) & ~(page - 1);
+    auto end = (reinterpret_cast<uintptr_t>(ptr) + size) & ~(page - 1);
+    if (begin >= end) {
+      return 0;
+    }
+    auto mask = node_mask(node);
+    if (syscall(SYS_mbind, begin, end - begin, MPOL_PREFERRED, &mask, MASK_BITS, MPOL_MF_MOVE) != 0) {
+      return errno;
+    }
+    return 0;
+#else
+    (void) ptr;
+    (void) size;
+    (void) node;
+    return 0;
+#endif
+  }
+
+ private:
+  /* Memory policy constants from linux/mempolicy.h */
+  static const int MPOL_PREFERRED = 1;
+  static const unsigned MPOL_MF_MOVE = 1 << 1;
+  /* Largest node number a node mask can hold */
+  static const int MAX_NODES = 63;
+  /* Node mask length passed to the kernel, which reads one bit less than it is given */
+  static const unsigned long MASK_BITS = MAX_NODES + 2;
+
+  static unsigned long node_mask(int node) {
+    return node >= 0 && node <= MAX_NODES ? 1UL << node : 0;
+  }
+
+  static std::string read_line(const std::string &path) {
+    std::ifstream in(path);
+    std::string line;
+    std::getline(in, line);
+    return line;
+  }
+
+  /* Parse a sysfs list such as "0-3,8-11" */
+  static std::vector<int> parse_list(const std::string &list) {
+    std::vector<int> ids;
+    std::istringstream in(list);
+    std::string range;
+    while (std::getline(in, range, ',')) {
+      try {
+        auto dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int id = first; id <= last; ++id) {
+          ids.push_back(id);
+        }
+      } catch (std::exception &) {
+        return {};
+      }
+    }
+    return ids;
+  }
+};
+
+}
+}
+
+#endif //JIFFY_NUMA_UTILS_H
@@ -6,8 +6,11 @@
 #include <string>
 #include "jiffy/storage/manager/storage_management_server.h"
 #include "jiffy/storage/manager/storage_manager.h"
+#include "jiffy/storage/partition_manager.h"
 #include "jiffy/storage/file/file_partition.h"
 #include "jiffy/storage/hashtable/hash_slot.h"
+#include "jiffy/storage/hashtable/hash_table_ops.h"
+#include "jiffy/storage/hashtable/hash_table_partition.h"
 #include "test_utils.h"
 #include "jiffy/storage/service/block_server.h"
 #include "jiffy/directory/fs/directory_tree.h"
@@ -19,6 +22,7 @@
 #include "jiffy/directory/fs/sync_worker.h"
 #include "jiffy/directory/lease/lease_expiry_worker.h"
 #include "jiffy/auto_scaling/auto_scaling_server.h"
+#include "jiffy/auto_scaling/auto_scaling_service_handler.h"
 #include "jiffy/utils/rand_utils.h"
 
 using namespace jiffy::client;
@@ -34,6 +38,33 @@ using namespace ::apache::thrift::transport;
 #define STORAGE_MANAGEMENT_PORT 9092
 #define AUTO_SCALING_SERVICE_PORT 9095
 
+namespace jiffy {
+namespace storage {
+
+// Hash table partition that fails every scale_remove, to test transfers from a failing source
+class remove_failing_partition : public hash_table_partition {
+ public:
+  using hash_table_partition::hash_table_partition;
+
+  void run_command(response &_return, const arg_list &args) override {
+    if (args.front() == "scale_remove") {
+      ++failed_removes;
+      _return = {"!error", "Injected failure"};
+      return;
+    }
+    hash_table_partition::run_command(_return, args);
+  }
+
+  static std::atomic<std::size_t> failed_removes;
+};
+
+std::atomic<std::size_t> remove_failing_partition::failed_removes(0);
+
+REGISTER_IMPLEMENTATION("remove_failing_hashtable", remove_failing_partition);
+
+}
+}
+
 TEST_CASE("hash_table_auto_scale_up_test", "[directory_service][storage_server][management_server]") {
   auto alloc = std::make_shared<sequential_block_allocator>();
   auto block_names = test_utils::init_block_names(100, STORAGE_SERVICE_PORT, STORAGE_MANAGEMENT_PORT);
@@ -348,6 +379,63 @@ TEST_CASE("hash_table_auto_scale_large_data_test", "[directory_service][storage_
   }
 }
 
+TEST_CASE("hash_table_transfer_data_test", "[storage_server][get_range_data][scale_put][scale_remove]") {
+  auto alloc = std::make_shared<sequential_block_allocator>();
+  auto block_names = test_utils::init_block_names(3, STORAGE_SERVICE_PORT, STORAGE_MANAGEMENT_PORT);
+  alloc->add_blocks(block_names);
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  auto blocks = test_utils::init_hash_table_blocks(block_names, memory_mode, mem_kind);
+  // Block 0 rejects the removes of transferred keys
+  blocks[0]->setup("remove_failing_hashtable", "local://tmp", "0_65536", "regular", {});
+  for (std::size_t b = 0; b < 2; ++b) {
+    for (std::size_t i = 0; i < 1000; ++i) {
+      response resp;
+      blocks[b]->impl()->run_command(resp, {"put", std::to_string(i), std::to_string(i)});
+      REQUIRE(resp[0] == "!ok");
+    }
+  }
+
+  auto storage_server = block_server::create(blocks, STORAGE_SERVICE_PORT);
+  std::thread storage_serve_thread([&storage_server] { storage_server->serve(); });
+  test_utils::wait_till_server_ready(HOST, STORAGE_SERVICE_PORT);
+
+  auto sm = std::make_shared<storage_manager>();
+  auto t = std::make_shared<directory_tree>(alloc, sm);
+  auto client = [&](std::size_t b) {
+    return std::make_shared<replica_chain_client>(t, "/sandbox/transfer.txt", replica_chain({block_names[b]}), HT_OPS);
+  };
+
+  // Every key moves, and the source is left empty
+  REQUIRE(auto_scaling_service_handler::hash_table_transfer_data(t, "/sandbox/transfer.txt", client(1), client(2),
+                                                                 0, 65536, 64));
+  response resp;
+  for (std::size_t i = 0; i < 1000; ++i) {
+    resp.clear();
+    blocks[1]->impl()->run_command(resp, {"get", std::to_string(i)});
+    REQUIRE(resp[0] == "!key_not_found");
+    resp.clear();
+    blocks[2]->impl()->run_command(resp, {"get", std::to_string(i)});
+    REQUIRE(resp[1] == std::to_string(i));
+  }
+
+  // A source that keeps failing removes stops the transfer after a bounded number of attempts,
+  // rather than moving the keys it still holds again and again
+  REQUIRE_FALSE(auto_scaling_service_handler::hash_table_transfer_data(t, "/sandbox/transfer.txt", client(0),
+                                                                       client(2), 0, 65536, 64));
+  REQUIRE(remove_failing_partition::failed_removes == HASH_TABLE_TRANSFER_ATTEMPTS);
+  for (std::size_t i = 0; i < 1000; ++i) {
+    resp.clear();
+    blocks[0]->impl()->run_command(resp, {"get", std::to_string(i)});
+    REQUIRE(resp[1] == std::to_string(i));
+  }
+
+  storage_server->stop();
+  if (storage_serve_thread.joinable()) {
+    storage_serve_thread.join();
+  }
+}
+
 TEST_CASE("file_auto_scale_test", "[directory_service][storage_server][management_server]") {
   auto alloc = std::make_shared<sequential_block_allocator>();
   auto block_names = test_utils::init_block_names(21, STORAGE_SERVICE_PORT, STORAGE_MANAGEMENT_PORT);
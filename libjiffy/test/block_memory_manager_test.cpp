@@ -0,0 +1,175 @@
+#include "catch.hpp"
+#include <cstring>
+#include <vector>
+#include "test_utils.h"
+#include "jiffy/storage/block_memory_allocator.h"
+
+using namespace ::jiffy::storage;
+
+TEST_CASE("block_memory_manager_size_class_test", "[mb_malloc][mb_free]") {
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  block_memory_manager manager(134217728, memory_mode, mem_kind);
+
+  // Small allocations are charged their size class
+  auto p1 = manager.mb_malloc(1);
+  REQUIRE(p1 != nullptr);
+  REQUIRE(manager.mb_used() == 16);
+  auto p2 = manager.mb_malloc(100);
+  REQUIRE(p2 != nullptr);
+  REQUIRE(manager.mb_used() == 16 + 112);
+  auto p3 = manager.mb_malloc(SLAB_MAX_SIZE);
+  REQUIRE(p3 != nullptr);
+  REQUIRE(manager.mb_used() == 16 + 112 + SLAB_MAX_SIZE);
+
+  // Large allocations are charged at least their size
+  auto p4 = manager.mb_malloc(SLAB_MAX_SIZE + 1);
+  REQUIRE(p4 != nullptr);
+  REQUIRE(manager.mb_used() >= 16 + 112 + 2 * SLAB_MAX_SIZE + 1);
+
+  manager.mb_free(p1, 1);
+  manager.mb_free(p2);
+  manager.mb_free(p3, SLAB_MAX_SIZE);
+  manager.mb_free(p4);
+  REQUIRE(manager.mb_used() == 0);
+
+  // Freed chunks are reused
+  auto p5 = manager.mb_malloc(100);
+  REQUIRE(p5 == p2);
+  manager.mb_free(p5, 100);
+  REQUIRE(manager.mb_used() == 0);
+}
+
+TEST_CASE("block_memory_manager_capacity_test", "[mb_malloc][mb_free]") {
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  block_memory_manager manager(1024, memory_mode, mem_kind);
+  block_memory_allocator<uint8_t> allocator(&manager);
+
+  std::vector<uint8_t *> ptrs;
+  for (int i = 0; i < 16; ++i) {
+    ptrs.push_back(allocator.allocate(64));
+  }
+  REQUIRE(manager.mb_used() == 1024);
+  REQUIRE_THROWS_AS(allocator.allocate(1), memory_block_overflow);
+  REQUIRE(manager.mb_used() == 1024);
+  REQUIRE(manager.mb_malloc(2048) == nullptr);
+  allocator.deallocate(ptrs.back(), 64);
+  ptrs.pop_back();
+  REQUIRE_NOTHROW(ptrs.push_back(allocator.allocate(64)));
+  for (auto p: ptrs) {
+    allocator.deallocate(p, 64);
+  }
+  REQUIRE(manager.mb_used() == 0);
+}
+
+TEST_CASE("block_memory_manager_free_list_test", "[mb_malloc][mb_free]") {
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  block_memory_manager manager(SLAB_PAGE_SIZE, memory_mode, mem_kind);
+
+  // A page of 64 byte chunks fills the capacity
+  std::vector<void *> ptrs;
+  for (std::size_t i = 0; i < SLAB_PAGE_SIZE / 64; ++i) {
+    ptrs.push_back(manager.mb_malloc(64));
+    REQUIRE(ptrs.back() != nullptr);
+  }
+  REQUIRE(manager.mb_malloc(64) == nullptr);
+
+  // Free chunks stay charged, as only their size class can reuse them
+  for (std::size_t i = 0; i < ptrs.size(); i += 2) {
+    manager.mb_free(ptrs[i], 64);
+  }
+  REQUIRE(manager.mb_used() == SLAB_PAGE_SIZE / 2);
+  REQUIRE(manager.mb_malloc(SLAB_MAX_SIZE) == nullptr);
+  REQUIRE_FALSE(manager.mb_fits(SLAB_MAX_SIZE));
+  auto p = manager.mb_malloc(64);
+  REQUIRE(p == ptrs[ptrs.size() - 2]);
+  manager.mb_free(p, 64);
+
+  // Once every chunk of the page is free, the page goes back and another size class can use it
+  for (std::size_t i = 1; i < ptrs.size(); i += 2) {
+    manager.mb_free(ptrs[i], 64);
+  }
+  REQUIRE(manager.mb_used() == 0);
+  ptrs.clear();
+  for (std::size_t i = 0; i < SLAB_PAGE_SIZE / SLAB_MAX_SIZE; ++i) {
+    ptrs.push_back(manager.mb_malloc(SLAB_MAX_SIZE));
+    REQUIRE(ptrs.back() != nullptr);
+  }
+  REQUIRE(manager.mb_used() == SLAB_PAGE_SIZE);
+  REQUIRE(manager.mb_malloc(16) == nullptr);
+  for (auto ptr: ptrs) {
+    manager.mb_free(ptr, SLAB_MAX_SIZE);
+  }
+  REQUIRE(manager.mb_used() == 0);
+}
+
+TEST_CASE("block_memory_manager_release_all_test", "[mb_malloc][mb_release_all]") {
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  block_memory_manager manager(134217728, memory_mode, mem_kind);
+
+  for (std::size_t i = 0; i < 100000; ++i) {
+    REQUIRE(manager.mb_malloc(i % 1024 + 1) != nullptr);
+  }
+  REQUIRE(manager.mb_used() > 0);
+  manager.mb_release_all();
+  REQUIRE(manager.mb_used() == 0);
+  auto p = manager.mb_malloc(64);
+  REQUIRE(p != nullptr);
+  REQUIRE(manager.mb_used() == 64);
+  manager.mb_free(p, 64);
+  REQUIRE(manager.mb_used() == 0);
+}
+
+TEST_CASE("block_memory_manager_numa_node_test", "[mb_malloc][mb_free]") {
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  block_memory_manager manager(134217728, memory_mode, mem_kind, 0);
+  REQUIRE(manager.numa_node() == (memory_mode == "DRAM" || memory_mode == "HUGEPAGE" ? 0 : -1));
+
+  // Slab pages and page sized allocations are bound to the node; accounting is unchanged
+  std::vector<std::pair<void *, std::size_t>> ptrs;
+  for (std::size_t size: {16, 512, 4096, 65536, 1048576}) {
+    auto p = manager.mb_malloc(size);
+    REQUIRE(p != nullptr);
+    std::memset(p, 1, size);
+    ptrs.emplace_back(p, size);
+  }
+  REQUIRE(manager.mb_used() >= 16 + 512 + 4096 + 65536 + 1048576);
+  for (auto &p: ptrs) {
+    manager.mb_free(p.first, p.second);
+  }
+  REQUIRE(manager.mb_used() == 0);
+}
+
+TEST_CASE("block_memory_manager_hugepage_test", "[mb_malloc][mb_free]") {
+  block_memory_manager manager(134217728, "HUGEPAGE", nullptr, -1, true);
+  REQUIRE(manager.mb_page_size() == HUGE_PAGE_SIZE);
+
+  // Huge page sized allocations are mapped on aligned huge pages and charged whole pages
+  auto p1 = manager.mb_malloc(HUGE_PAGE_SIZE);
+  REQUIRE(p1 != nullptr);
+  REQUIRE(reinterpret_cast<uintptr_t>(p1) % HUGE_PAGE_SIZE == 0);
+  auto p2 = manager.mb_malloc(HUGE_PAGE_SIZE + 1);
+  REQUIRE(p2 != nullptr);
+  REQUIRE(reinterpret_cast<uintptr_t>(p2) % HUGE_PAGE_SIZE == 0);
+  std::memset(p2, 1, HUGE_PAGE_SIZE + 1);
+  REQUIRE(manager.mb_used() == 3 * HUGE_PAGE_SIZE);
+
+  // Smaller allocations are served as in DRAM mode
+  auto p3 = manager.mb_malloc(65536);
+  REQUIRE(p3 != nullptr);
+  manager.mb_free(p3, 65536);
+  REQUIRE(manager.mb_used() == 3 * HUGE_PAGE_SIZE);
+
+  manager.mb_free(p1, HUGE_PAGE_SIZE);
+  manager.mb_free(p2);
+  REQUIRE(manager.mb_used() == 0);
+
+  // Huge page mappings are returned with the manager's other memory
+  REQUIRE(manager.mb_malloc(HUGE_PAGE_SIZE) != nullptr);
+  manager.mb_release_all();
+  REQUIRE(manager.mb_used() == 0);
+}
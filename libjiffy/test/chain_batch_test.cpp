@@ -0,0 +1,46 @@
+#include "catch.hpp"
+#include <stdexcept>
+#include "jiffy/storage/chain/chain_batch.h"
+
+using namespace ::jiffy::storage;
+
+TEST_CASE("chain_batch_encode_decode_test", "[append][decode]") {
+  std::vector<chain_op> ops;
+  for (int64_t i = 0; i < 100; ++i) {
+    chain_op op;
+    op.seq.client_id = i % 3;
+    op.seq.client_seq_no = i * 7;
+    op.seq.server_seq_no = i + 1;
+    op.args = {"put", std::to_string(i), std::string(static_cast<std::size_t>(i), 'v')};
+    if (i % 10 == 0)
+      op.args.emplace_back();
+    ops.push_back(op);
+  }
+
+  std::vector<std::string> frame{"stale"};
+  chain_batch::begin(frame);
+  REQUIRE(chain_batch::is_batch(frame));
+  REQUIRE(chain_batch::decode(frame).empty());
+  for (const auto &op: ops) {
+    chain_batch::append(frame, op);
+  }
+  REQUIRE(chain_batch::is_batch(frame));
+  REQUIRE_FALSE(chain_batch::is_batch(ops.front().args));
+  REQUIRE_FALSE(chain_batch::is_batch({}));
+
+  auto decoded = chain_batch::decode(frame);
+  REQUIRE(decoded.size() == ops.size());
+  for (std::size_t i = 0; i < ops.size(); ++i) {
+    REQUIRE(decoded[i].seq.client_id == ops[i].seq.client_id);
+    REQUIRE(decoded[i].seq.client_seq_no == ops[i].seq.client_seq_no);
+    REQUIRE(decoded[i].seq.server_seq_no == ops[i].seq.server_seq_no);
+    REQUIRE(decoded[i].args == ops[i].args);
+  }
+  REQUIRE(chain_batch::size(ops[5]) == 3 + 1 + 5);
+
+  // Truncated frames are rejected
+  frame.pop_back();
+  REQUIRE_THROWS_AS(chain_batch::decode(frame), std::logic_error);
+  frame.resize(3);
+  REQUIRE_THROWS_AS(chain_batch::decode(frame), std::logic_error);
+}
@@ -104,6 +104,110 @@ TEST_CASE("chain_replication_no_failure_test", "[put][get]") {
   }
 }
 
+TEST_CASE("chain_replication_pipelined_test", "[put][get]") {
+  std::vector<std::vector<std::string>> block_names(NUM_BLOCKS);
+  std::vector<std::vector<std::shared_ptr<block>>> blocks(NUM_BLOCKS);
+  std::vector<std::shared_ptr<TServer>> management_servers(NUM_BLOCKS);
+  std::vector<std::shared_ptr<TServer>> chain_servers(NUM_BLOCKS);
+  std::vector<std::shared_ptr<TServer>> storage_servers(NUM_BLOCKS);
+  std::vector<std::thread> server_threads;
+
+  auto alloc = std::make_shared<sequential_block_allocator>();
+  for (int32_t i = 0; i < NUM_BLOCKS; i++) {
+    block_names[i] = test_utils::init_block_names(1,
+                                                  STORAGE_SERVICE_PORT_N(i),
+                                                  STORAGE_MANAGEMENT_PORT_N(i));
+    alloc->add_blocks(block_names[i]);
+    std::string memory_mode = getenv("JIFFY_TEST_MODE");
+    void* mem_kind = test_utils::init_kind();
+    blocks[i] = test_utils::init_hash_table_blocks(block_names[i], memory_mode, mem_kind);
+
+    management_servers[i] = storage_management_server::create(blocks[i], HOST, STORAGE_MANAGEMENT_PORT_N(i));
+    server_threads.emplace_back([i, &management_servers] { management_servers[i]->serve(); });
+    test_utils::wait_till_server_ready(HOST, STORAGE_MANAGEMENT_PORT_N(i));
+
+    chain_servers[i] = block_server::create(blocks[i], STORAGE_CHAIN_PORT_N(i));
+    server_threads.emplace_back([i, &chain_servers] { chain_servers[i]->serve(); });
+    test_utils::wait_till_server_ready(HOST, STORAGE_CHAIN_PORT_N(i));
+
+    storage_servers[i] = block_server::create(blocks[i], STORAGE_SERVICE_PORT_N(i));
+    server_threads.emplace_back([i, &storage_servers] { storage_servers[i]->serve(); });
+    test_utils::wait_till_server_ready(HOST, STORAGE_SERVICE_PORT_N(i));
+  }
+
+  auto sm = std::make_shared<storage_manager>();
+  auto t = std::make_shared<directory_tree>(alloc, sm);
+
+  auto dserver = directory_server::create(t, HOST, DIRECTORY_SERVICE_PORT);
+  server_threads.emplace_back([&] { dserver->serve(); });
+  test_utils::wait_till_server_ready(HOST, DIRECTORY_SERVICE_PORT);
+
+  t->create("/file", "hashtable", "/tmp", 1, 3, 0, 0, {"0_65536"}, {"regular"});
+  auto chain = t->dstatus("/file").data_blocks()[0];
+
+  replica_chain_client client(t, "/file", chain, HT_OPS, 100, 16);
+  std::vector<int64_t> seq_nos;
+  for (std::size_t i = 0; i < 16; ++i) {
+    seq_nos.push_back(client.send_command({"put", std::to_string(i), std::to_string(i)}));
+  }
+  REQUIRE(client.in_flight() == 16);
+  REQUIRE_THROWS_AS(client.send_command({"get", "0"}), std::length_error);
+  // A full window is not mistaken for a moved block
+  REQUIRE_THROWS_AS(client.run_command({"get", "0"}), std::length_error);
+  REQUIRE(client.in_flight() == 16);
+
+  // Responses are matched by sequence number, whatever order they are received in
+  for (auto it = seq_nos.rbegin(); it != seq_nos.rend(); ++it) {
+    REQUIRE(client.recv_response(*it).front() == "!ok");
+  }
+  REQUIRE(client.in_flight() == 0);
+
+  // Reads routed to the tail and writes routed to the head share the window
+  std::vector<std::pair<int64_t, std::size_t>> reads, writes;
+  for (std::size_t i = 0; i < 8; ++i) {
+    reads.emplace_back(client.send_command({"get", std::to_string(i)}), i);
+    writes.emplace_back(client.send_command({"put", std::to_string(16 + i), std::to_string(16 + i)}), 16 + i);
+  }
+  for (const auto &w: writes) {
+    REQUIRE(client.recv_response(w.first).front() == "!ok");
+  }
+  for (const auto &r: reads) {
+    auto ret = client.recv_response(r.first);
+    REQUIRE(ret[0] == "!ok");
+    REQUIRE(ret[1] == std::to_string(r.second));
+  }
+  REQUIRE(client.in_flight() == 0);
+
+  for (std::size_t i = 0; i < 16; ++i) {
+    client.send_command({"get", std::to_string(i)});
+  }
+  for (std::size_t i = 0; i < 16; ++i) {
+    auto ret = client.recv_response();
+    REQUIRE(ret[0] == "!ok");
+    REQUIRE(ret[1] == std::to_string(i));
+  }
+  REQUIRE_THROWS_AS(client.recv_response(seq_nos.front()), std::logic_error);
+
+  for (const auto &s: storage_servers) {
+    s->stop();
+  }
+
+  for (const auto &c: chain_servers) {
+    c->stop();
+  }
+
+  for (const auto &m: management_servers) {
+    m->stop();
+  }
+
+  dserver->stop();
+
+  for (auto &st: server_threads) {
+    if (st.joinable())
+      st.join();
+  }
+}
+
 TEST_CASE("chain_replication_head_failure_test", "[put][get]") {
   std::vector<std::vector<std::string>> block_names(NUM_BLOCKS);
   std::vector<std::vector<std::shared_ptr<block>>> blocks(NUM_BLOCKS);
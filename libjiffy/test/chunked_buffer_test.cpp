@@ -0,0 +1,104 @@
+#include "catch.hpp"
+#include <algorithm>
+#include <string>
+#include "test_utils.h"
+#include "jiffy/storage/types/chunked_buffer.h"
+#include "jiffy/storage/file/file_block.h"
+#include "jiffy/storage/fifoqueue/string_array.h"
+
+using namespace ::jiffy::storage;
+
+TEST_CASE("chunked_buffer_lazy_commit_test", "[write][read][clear]") {
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  block_memory_manager manager(134217728, memory_mode, mem_kind);
+  block_memory_allocator<char> alloc(&manager);
+  // Chunks span a page when the allocator is backed by huge pages
+  auto chunk = std::max(CHUNKED_BUFFER_CHUNK_SIZE, alloc.page_size());
+  {
+    chunked_buffer buf(10 * chunk + 100, alloc);
+    REQUIRE(buf.size() == 10 * chunk + 100);
+    REQUIRE(buf.committed() == 0);
+    REQUIRE(manager.mb_used() == 0);
+
+    // Uncommitted bytes read as zeros
+    REQUIRE(buf.read(0, 16) == std::string(16, '\0'));
+    REQUIRE(buf.committed() == 0);
+
+    // A write spanning a chunk boundary commits both chunks
+    std::string data(200, 'a');
+    buf.write(chunk - 100, data.data(), data.size());
+    REQUIRE(buf.committed() == 2 * chunk);
+    REQUIRE(manager.mb_used() >= 2 * chunk);
+    REQUIRE(buf.read(chunk - 100, 200) == data);
+    REQUIRE(buf.read(chunk - 101, 1) == std::string(1, '\0'));
+
+    // The last chunk is only as large as the buffer
+    buf.write(buf.size() - 10, data.data(), 10);
+    REQUIRE(buf.committed() == 2 * chunk + 100);
+    REQUIRE(buf.read(buf.size() - 10, 100) == std::string(10, 'a'));
+    REQUIRE_THROWS_AS(buf.write(buf.size() - 10, data.data(), 11), std::out_of_range);
+
+    // Copies hold their own chunks
+    chunked_buffer copy(buf);
+    REQUIRE(copy == buf);
+    REQUIRE(copy.committed() == buf.committed());
+    copy.write(0, "b", 1);
+    REQUIRE_FALSE(copy == buf);
+    copy.clear();
+
+    buf.clear();
+    REQUIRE(buf.committed() == 0);
+    REQUIRE(buf.read(chunk - 100, 200) == std::string(200, '\0'));
+    REQUIRE(manager.mb_used() == 0);
+  }
+  REQUIRE(manager.mb_used() == 0);
+}
+
+TEST_CASE("chunked_buffer_partition_storage_test", "[write][push_back][clear]") {
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  block_memory_manager manager(134217728, memory_mode, mem_kind);
+  block_memory_allocator<char> alloc(&manager);
+  // Chunks span a page when the allocator is backed by huge pages
+  auto chunk = std::max(CHUNKED_BUFFER_CHUNK_SIZE, alloc.page_size());
+
+  file_block file(64 * chunk, alloc);
+  REQUIRE(manager.mb_used() == 0);
+  REQUIRE(file.write("hello", 3 * chunk).first);
+  REQUIRE(file.committed() == chunk);
+  REQUIRE(file.read(3 * chunk, 5).second == "hello");
+  REQUIRE_FALSE(file.write("hello", file.size() - 4).first);
+  file.clear();
+  REQUIRE(manager.mb_used() == 0);
+
+  string_array array(64 * chunk, alloc);
+  REQUIRE(manager.mb_used() == 0);
+  std::string big(chunk, 'x');
+  REQUIRE(array.push_back("a").first);
+  REQUIRE(array.push_back(big).first);
+  REQUIRE(array.push_back("b").first);
+  REQUIRE(array.at(0).second == "a");
+  auto off = array.find_next(0);
+  REQUIRE(array.at(off).second == big);
+  REQUIRE(array.at(array.find_next(off)).second == "b");
+  REQUIRE(manager.mb_used() >= 2 * chunk);
+  array.clear();
+  REQUIRE(array.empty());
+  REQUIRE(manager.mb_used() == 0);
+}
+
+TEST_CASE("chunked_buffer_hugepage_test", "[write][read][clear]") {
+  block_memory_manager manager(134217728, "HUGEPAGE");
+  block_memory_allocator<char> alloc(&manager);
+  chunked_buffer buf(8 * HUGE_PAGE_SIZE, alloc);
+
+  // Chunks span a huge page
+  REQUIRE(buf.chunk_size() == HUGE_PAGE_SIZE);
+  buf.write(HUGE_PAGE_SIZE + 10, "hello", 5);
+  REQUIRE(buf.committed() == HUGE_PAGE_SIZE);
+  REQUIRE(manager.mb_used() == HUGE_PAGE_SIZE);
+  REQUIRE(buf.read(HUGE_PAGE_SIZE + 10, 5) == "hello");
+  buf.clear();
+  REQUIRE(manager.mb_used() == 0);
+}
@@ -0,0 +1,54 @@
+#include "catch.hpp"
+#include "jiffy/storage/client/file_cache.h"
+
+using namespace ::jiffy::storage;
+
+TEST_CASE("file_cache_put_find_test", "[put][find]") {
+  file_cache cache(1024, 16);
+  REQUIRE(cache.find(0, 0) == nullptr);
+  cache.put(0, 0, std::string(40, 'a'));
+  REQUIRE(cache.bytes() == 40);
+  REQUIRE(*cache.find(0, 0) == std::string(16, 'a'));
+  REQUIRE(*cache.find(0, 16) == std::string(16, 'a'));
+  REQUIRE(*cache.find(0, 32) == std::string(8, 'a'));
+  REQUIRE(cache.find(1, 0) == nullptr);
+  REQUIRE(cache.hits() == 3);
+  REQUIRE(cache.misses() == 2);
+
+  // Least recently used blocks make room first
+  file_cache small(32, 16);
+  small.put(0, 0, std::string(32, 'a'));
+  REQUIRE(small.find(0, 0) != nullptr);
+  small.put(1, 0, std::string(16, 'b'));
+  REQUIRE(small.find(0, 16) == nullptr);
+  REQUIRE(small.find(0, 0) != nullptr);
+  REQUIRE(*small.find(1, 0) == std::string(16, 'b'));
+
+  cache.clear();
+  REQUIRE(cache.bytes() == 0);
+  REQUIRE(cache.find(0, 0) == nullptr);
+}
+
+TEST_CASE("file_cache_write_test", "[put][write][find]") {
+  file_cache cache(1024, 16);
+  cache.put(0, 0, std::string(20, 'a'));
+
+  // Writes patch the cached blocks they overlap
+  cache.write(0, 14, "bbbb");
+  REQUIRE(*cache.find(0, 0) == std::string(14, 'a') + "bb");
+  REQUIRE(*cache.find(0, 16) == "bbaa");
+
+  // Writes continuing a short block extend it
+  cache.write(0, 20, "cc");
+  REQUIRE(*cache.find(0, 16) == "bbaacc");
+  REQUIRE(cache.bytes() == 22);
+
+  // Writes leaving a gap drop the block
+  cache.write(0, 24, "d");
+  REQUIRE(cache.find(0, 16) == nullptr);
+  REQUIRE(cache.bytes() == 16);
+
+  // Writes to blocks not cached are ignored
+  cache.write(1, 0, "e");
+  REQUIRE(cache.find(1, 0) == nullptr);
+}
@@ -88,6 +88,77 @@ TEST_CASE("file_client_write_read_seek_test", "[write][read][seek]") {
 }
 
 
+TEST_CASE("file_client_cached_write_read_seek_test", "[write][read][seek]") {
+  auto alloc = std::make_shared<sequential_block_allocator>();
+  auto block_names = test_utils::init_block_names(NUM_BLOCKS, STORAGE_SERVICE_PORT, STORAGE_MANAGEMENT_PORT);
+  alloc->add_blocks(block_names);
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  auto blocks = test_utils::init_file_blocks(block_names, memory_mode, mem_kind, 134217728);
+
+  auto storage_server = block_server::create(blocks, STORAGE_SERVICE_PORT);
+  std::thread storage_serve_thread([&storage_server] { storage_server->serve(); });
+  test_utils::wait_till_server_ready(HOST, STORAGE_SERVICE_PORT);
+
+  auto mgmt_server = storage_management_server::create(blocks, HOST, STORAGE_MANAGEMENT_PORT);
+  std::thread mgmt_serve_thread([&mgmt_server] { mgmt_server->serve(); });
+  test_utils::wait_till_server_ready(HOST, STORAGE_MANAGEMENT_PORT);
+
+  auto sm = std::make_shared<storage_manager>();
+  auto tree = std::make_shared<directory_tree>(alloc, sm);
+
+  data_status status = tree->create("/sandbox/file.txt", "file", "/tmp", NUM_BLOCKS, 1, 0, 0,
+                                  {"0"}, {"regular"});
+
+  file_client client(tree, "/sandbox/file.txt", status);
+  client.enable_cache(4096, 64, 4, 256);
+
+  for (std::size_t i = 0; i < 1000; ++i) {
+    REQUIRE(client.write(std::to_string(i)) == std::to_string(i).size());
+  }
+
+  REQUIRE_NOTHROW(client.seek(0));
+
+  std::string buffer;
+
+  for (std::size_t i = 0; i < 1000; ++i) {
+    buffer.clear();
+    REQUIRE(client.read(buffer, std::to_string(i).size()) == std::to_string(i).size());
+    REQUIRE(buffer == std::to_string(i));
+  }
+  REQUIRE(client.cache()->hits() > client.cache()->misses());
+
+  for (std::size_t i = 1000; i < 2000; ++i) {
+    REQUIRE(client.read(buffer, std::to_string(i).size()) == -1);
+  }
+
+  // Writes over cached data are read back
+  REQUIRE_NOTHROW(client.seek(0));
+  REQUIRE(client.write("abc") == 3);
+  REQUIRE_NOTHROW(client.seek(0));
+  buffer.clear();
+  REQUIRE(client.read(buffer, 4) == 4);
+  REQUIRE(buffer == "abc3");
+
+  REQUIRE(client.disable_cache() == 0);
+  REQUIRE(client.cache() == nullptr);
+  REQUIRE_NOTHROW(client.seek(0));
+  buffer.clear();
+  REQUIRE(client.read(buffer, 4) == 4);
+  REQUIRE(buffer == "abc3");
+
+  storage_server->stop();
+  if (storage_serve_thread.joinable()) {
+    storage_serve_thread.join();
+  }
+
+  mgmt_server->stop();
+  if (mgmt_serve_thread.joinable()) {
+    mgmt_serve_thread.join();
+  }
+}
+
+
 TEST_CASE("file_client_concurrent_write_read_seek_test", "[write][read][seek]") {
 
 
@@ -145,6 +216,107 @@ TEST_CASE("file_client_concurrent_write_read_seek_test", "[write][read][seek]")
   REQUIRE(buffer.substr(4096, 4096) == std::string(4096, 'y'));
 
 
+  as_server->stop();
+  if (auto_scaling_thread.joinable()) {
+    auto_scaling_thread.join();
+  }
+
+  storage_server->stop();
+  if (storage_serve_thread.joinable()) {
+    storage_serve_thread.join();
+  }
+
+  mgmt_server->stop();
+  if (mgmt_serve_thread.joinable()) {
+    mgmt_serve_thread.join();
+  }
+
+  dir_server->stop();
+  if (dir_serve_thread.joinable()) {
+    dir_serve_thread.join();
+  }
+}
+
+TEST_CASE("file_client_striped_write_read_test", "[write][read][seek]") {
+  auto alloc = std::make_shared<sequential_block_allocator>();
+  auto block_names = test_utils::init_block_names(20, STORAGE_SERVICE_PORT, STORAGE_MANAGEMENT_PORT);
+  alloc->add_blocks(block_names);
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  auto blocks = test_utils::init_file_blocks(block_names, memory_mode, mem_kind, BLOCK_SIZE);
+  auto storage_server = block_server::create(blocks, STORAGE_SERVICE_PORT);
+  std::thread storage_serve_thread([&storage_server] { storage_server->serve(); });
+  test_utils::wait_till_server_ready(HOST, STORAGE_SERVICE_PORT);
+
+  auto mgmt_server = storage_management_server::create(blocks, HOST, STORAGE_MANAGEMENT_PORT);
+  std::thread mgmt_serve_thread([&mgmt_server] { mgmt_server->serve(); });
+  test_utils::wait_till_server_ready(HOST, STORAGE_MANAGEMENT_PORT);
+
+  auto as_server = auto_scaling_server::create(HOST, DIRECTORY_SERVICE_PORT, HOST, AUTO_SCALING_SERVICE_PORT);
+  std::thread auto_scaling_thread([&as_server] { as_server->serve(); });
+  test_utils::wait_till_server_ready(HOST, AUTO_SCALING_SERVICE_PORT);
+
+  auto sm = std::make_shared<storage_manager>();
+  auto t = std::make_shared<directory_tree>(alloc, sm);
+
+  auto dir_server = directory_server::create(t, HOST, DIRECTORY_SERVICE_PORT);
+  std::thread dir_serve_thread([&dir_server] { dir_server->serve(); });
+  test_utils::wait_till_server_ready(HOST, DIRECTORY_SERVICE_PORT);
+
+  std::map<std::string, std::string> tags{{file_layout::STRIPE_WIDTH_TAG, "4"}, {file_layout::STRIPE_UNIT_TAG, "100"}};
+  auto status = t->create("/sandbox/striped.txt", "file", "/tmp", 4, 1, 0, perms::all(), {"0", "1", "2", "3"},
+                          {"regular", "regular", "regular", "regular"}, tags);
+
+  file_client client(t, "/sandbox/striped.txt", status);
+  REQUIRE(client.layout().striped());
+  REQUIRE(client.layout().stripe_width() == 4);
+  REQUIRE(client.layout().stripe_unit() == 100);
+
+  std::string data;
+  for (std::size_t i = 0; data.size() < 3000; ++i) {
+    data += std::to_string(i);
+  }
+  data.resize(3000);
+
+  // Writing past the first group adds a whole group of partitions
+  REQUIRE(client.write(data) == 3000);
+  REQUIRE(t->dstatus("/sandbox/striped.txt").data_blocks().size() == 8);
+
+  REQUIRE_NOTHROW(client.seek(0));
+  std::string buffer;
+  REQUIRE(client.read(buffer, 3000) == 3000);
+  REQUIRE(buffer == data);
+
+  // Consecutive stripe units are held by consecutive partitions
+  auto chains = t->dstatus("/sandbox/striped.txt").data_blocks();
+  for (std::size_t i = 0; i < 4; ++i) {
+    replica_chain_client chain(t, "/sandbox/striped.txt", chains[i], FILE_OPS);
+    auto ret = chain.run_command({"read", "0", "100"});
+    REQUIRE(ret[0] == "!ok");
+    REQUIRE(ret[1] == data.substr(i * 100, 100));
+  }
+
+  REQUIRE_NOTHROW(client.seek(950));
+  buffer.clear();
+  REQUIRE(client.read(buffer, 500) == 500);
+  REQUIRE(buffer == data.substr(950, 500));
+
+  // Stripe units small enough to put far more than a window of units on each chain
+  std::map<std::string, std::string> fine_tags{{file_layout::STRIPE_WIDTH_TAG, "2"}, {file_layout::STRIPE_UNIT_TAG, "2"}};
+  auto fine_status = t->create("/sandbox/fine.txt", "file", "/tmp", 2, 1, 0, perms::all(), {"0", "1"},
+                               {"regular", "regular"}, fine_tags);
+  file_client fine(t, "/sandbox/fine.txt", fine_status);
+  REQUIRE(data.size() / fine.layout().stripe_unit() / 4 > REPLICA_CHAIN_MAX_IN_FLIGHT);
+  REQUIRE(fine.write(data.substr(0, 2000)) == 2000);
+  REQUIRE(fine.write_async(data.substr(2000)).get() == 1000);
+  REQUIRE(t->dstatus("/sandbox/fine.txt").data_blocks().size() == 6);
+
+  REQUIRE_NOTHROW(fine.seek(0));
+  buffer.clear();
+  REQUIRE(fine.read(buffer, 2000) == 2000);
+  REQUIRE(fine.read_async(1000).get() == data.substr(2000));
+  REQUIRE(buffer == data.substr(0, 2000));
+
   as_server->stop();
   if (auto_scaling_thread.joinable()) {
     auto_scaling_thread.join();
@@ -0,0 +1,108 @@
+#include "catch.hpp"
+#include <stdexcept>
+#include "jiffy/storage/client/file_layout.h"
+
+using namespace ::jiffy::storage;
+
+TEST_CASE("file_layout_sequential_test", "[locate][split]") {
+  file_layout layout(100);
+  REQUIRE_FALSE(layout.striped());
+  REQUIRE(layout.stripe_unit() == 100);
+  REQUIRE(layout.stripe_width() == 1);
+
+  auto e = layout.locate(3, 40);
+  REQUIRE(e.partition == 3);
+  REQUIRE(e.offset == 40);
+  REQUIRE(e.size == 60);
+
+  auto extents = layout.split(2, 10, 90);
+  REQUIRE(extents.size() == 1);
+  REQUIRE(extents[0].partition == 2);
+  REQUIRE(extents[0].offset == 10);
+  REQUIRE(extents[0].size == 90);
+
+  // Stripe units of a single partition are merged back
+  file_layout units(100, 25);
+  extents = units.split(1, 10, 80);
+  REQUIRE(extents.size() == 1);
+  REQUIRE(extents[0].partition == 1);
+  REQUIRE(extents[0].offset == 10);
+  REQUIRE(extents[0].size == 80);
+
+  REQUIRE(layout.round_up(5) == 5);
+  REQUIRE_THROWS_AS(file_layout(100, 30), std::invalid_argument);
+  REQUIRE_THROWS_AS(file_layout(100, 200), std::invalid_argument);
+  REQUIRE_THROWS_AS(file_layout(100, 10, 0), std::invalid_argument);
+}
+
+TEST_CASE("file_layout_striped_test", "[locate][split]") {
+  // Groups of 4 partitions of 100 bytes, striped in units of 25 bytes
+  file_layout layout(100, 25, 4);
+  REQUIRE(layout.striped());
+
+  // Every byte of the first group maps to exactly one byte of its partitions
+  std::vector<std::vector<bool>> used(4, std::vector<bool>(100, false));
+  for (std::size_t pos = 0; pos < 400; ++pos) {
+    auto e = layout.locate(pos / 100, pos % 100);
+    REQUIRE(e.partition < 4);
+    REQUIRE(e.offset < 100);
+    REQUIRE_FALSE(used[e.partition][e.offset]);
+    used[e.partition][e.offset] = true;
+    REQUIRE(e.partition == (pos / 25) % 4);
+    REQUIRE(e.size == 25 - pos % 25);
+  }
+
+  auto e = layout.locate(0, 110);
+  REQUIRE(e.partition == 0);
+  REQUIRE(e.offset == 35);
+
+  // The second group follows on partitions 4 to 7
+  e = layout.locate(5, 30);
+  REQUIRE(e.partition == 4 + (130 / 25) % 4);
+  REQUIRE(e.offset == (130 / 25 / 4) * 25 + 5);
+
+  auto extents = layout.split(0, 20, 60);
+  REQUIRE(extents.size() == 4);
+  REQUIRE(extents[0].partition == 0);
+  REQUIRE(extents[0].offset == 20);
+  REQUIRE(extents[0].size == 5);
+  REQUIRE(extents[1].partition == 1);
+  REQUIRE(extents[1].offset == 0);
+  REQUIRE(extents[1].size == 25);
+  REQUIRE(extents[2].partition == 2);
+  REQUIRE(extents[2].size == 25);
+  REQUIRE(extents[3].partition == 3);
+  REQUIRE(extents[3].offset == 0);
+  REQUIRE(extents[3].size == 5);
+
+  REQUIRE(layout.round_up(0) == 0);
+  REQUIRE(layout.round_up(1) == 4);
+  REQUIRE(layout.round_up(4) == 4);
+  REQUIRE(layout.round_up(5) == 8);
+}
+
+TEST_CASE("file_layout_merge_test", "[split][merge]") {
+  file_layout layout(100, 10, 4);
+
+  // A range of the file is one contiguous extent of every partition it touches
+  auto extents = layout.split(0, 35, 65);
+  auto range = layout.split(1, 0, 100);
+  extents.insert(extents.end(), range.begin(), range.end());
+  REQUIRE(extents.size() == 17);
+  auto merged = file_layout::merge(extents);
+  REQUIRE(merged.size() == 4);
+  REQUIRE(merged[0].partition == 3);
+  REQUIRE(merged[0].offset == 5);
+  REQUIRE(merged[0].size == 45);
+  REQUIRE(merged[1].partition == 0);
+  REQUIRE(merged[1].offset == 10);
+  REQUIRE(merged[1].size == 40);
+  REQUIRE(merged[2].partition == 1);
+  REQUIRE(merged[2].offset == 10);
+  REQUIRE(merged[2].size == 40);
+  REQUIRE(merged[3].partition == 2);
+  REQUIRE(merged[3].offset == 10);
+  REQUIRE(merged[3].size == 40);
+
+  REQUIRE(file_layout::merge({}).empty());
+}
@@ -0,0 +1,144 @@
+#include "catch.hpp"
+#include "test_utils.h"
+#include "jiffy/storage/hashtable/hash_table_defs.h"
+
+using namespace ::jiffy::storage;
+
+TEST_CASE("flat_hash_map_emplace_find_test", "[emplace][find]") {
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  size_t capacity = 134217728;
+  block_memory_manager manager(capacity, memory_mode, mem_kind);
+  block_memory_allocator<uint8_t> binary_allocator(&manager);
+  flat_hash_table_type table{block_memory_allocator<kv_pair_type>(&manager)};
+  for (std::size_t i = 0; i < 10000; ++i) {
+    auto ret = table.emplace(binary(std::to_string(i), binary_allocator),
+                             binary(std::to_string(i), binary_allocator));
+    REQUIRE(ret.second);
+  }
+  REQUIRE(table.size() == 10000);
+  for (std::size_t i = 0; i < 10000; ++i) {
+    REQUIRE_FALSE(table.emplace(binary(std::to_string(i), binary_allocator),
+                                binary("x", binary_allocator)).second);
+    auto it = table.find(std::to_string(i));
+    REQUIRE(it != table.end());
+    REQUIRE(to_string(it->second) == std::to_string(i));
+  }
+  for (std::size_t i = 10000; i < 20000; ++i) {
+    REQUIRE(table.find(std::to_string(i)) == table.end());
+  }
+  std::size_t n = 0;
+  for (const auto &e: table) {
+    REQUIRE(to_string(e.first) == to_string(e.second));
+    ++n;
+  }
+  REQUIRE(n == 10000);
+}
+
+TEST_CASE("flat_hash_map_erase_reuse_test", "[emplace][erase][find]") {
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  size_t capacity = 134217728;
+  block_memory_manager manager(capacity, memory_mode, mem_kind);
+  block_memory_allocator<uint8_t> binary_allocator(&manager);
+  flat_hash_table_type table{block_memory_allocator<kv_pair_type>(&manager)};
+  for (int round = 0; round < 10; ++round) {
+    for (std::size_t i = 0; i < 1000; ++i) {
+      REQUIRE(table.emplace(binary(std::to_string(i), binary_allocator),
+                            binary(std::to_string(round), binary_allocator)).second);
+    }
+    auto slots = table.capacity();
+    for (std::size_t i = 0; i < 1000; i += 2) {
+      REQUIRE(table.erase(std::to_string(i)) == 1);
+      REQUIRE(table.erase(std::to_string(i)) == 0);
+    }
+    for (std::size_t i = 0; i < 1000; ++i) {
+      REQUIRE((table.find(std::to_string(i)) != table.end()) == (i % 2 == 1));
+    }
+    for (std::size_t i = 1; i < 1000; i += 2) {
+      REQUIRE(table.erase(std::to_string(i)) == 1);
+    }
+    REQUIRE(table.empty());
+    REQUIRE(table.capacity() == slots);
+  }
+  table.clear();
+  REQUIRE(table.capacity() == 0);
+  REQUIRE(manager.mb_used() == 0);
+}
+
+TEST_CASE("flat_hash_map_incremental_resize_test", "[emplace][erase][find]") {
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  size_t capacity = 134217728;
+  block_memory_manager manager(capacity, memory_mode, mem_kind);
+  block_memory_allocator<uint8_t> binary_allocator(&manager);
+  flat_hash_table_type table{block_memory_allocator<kv_pair_type>(&manager)};
+  bool resized = false;
+  for (std::size_t i = 0; i < 20000; ++i) {
+    REQUIRE(table.emplace(binary(std::to_string(i), binary_allocator),
+                          binary(std::to_string(i), binary_allocator)).second);
+    if (!table.resizing())
+      continue;
+    resized = true;
+    // Entries in both old and new slots stay visible while they are being moved
+    REQUIRE(table.find(std::to_string(i / 2)) != table.end());
+    std::size_t n = 0;
+    for (const auto &e: table) {
+      REQUIRE(to_string(e.first) == to_string(e.second));
+      ++n;
+    }
+    REQUIRE(n == i + 1);
+    REQUIRE(table.erase(std::to_string(i)) == 1);
+    REQUIRE(table.emplace(binary(std::to_string(i), binary_allocator),
+                          binary(std::to_string(i), binary_allocator)).second);
+  }
+  REQUIRE(resized);
+  REQUIRE(table.size() == 20000);
+  for (std::size_t i = 0; i < 20000; ++i) {
+    REQUIRE(table.at(std::to_string(i)) == binary(std::to_string(i), binary_allocator));
+  }
+
+  flat_hash_table_type sized{block_memory_allocator<kv_pair_type>(&manager)};
+  sized.reserve(20000);
+  auto slots = sized.capacity();
+  for (std::size_t i = 0; i < 20000; ++i) {
+    sized.emplace(binary(std::to_string(i), binary_allocator), binary(std::to_string(i), binary_allocator));
+    REQUIRE_FALSE(sized.resizing());
+  }
+  REQUIRE(sized.capacity() == slots);
+  table.clear();
+  sized.clear();
+  REQUIRE(manager.mb_used() == 0);
+}
+
+TEST_CASE("flat_hash_map_erase_iterator_resize_test", "[emplace][erase]") {
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  size_t capacity = 134217728;
+  block_memory_manager manager(capacity, memory_mode, mem_kind);
+  block_memory_allocator<uint8_t> binary_allocator(&manager);
+  flat_hash_table_type table{block_memory_allocator<kv_pair_type>(&manager)};
+  // Large enough for the old slots to be freed rather than kept in a slab page
+  std::size_t n = 0;
+  while (n < 10000 || !table.resizing()) {
+    table.emplace(binary(std::to_string(n), binary_allocator), binary(std::to_string(n), binary_allocator));
+    ++n;
+  }
+  // Erase by iterator in reverse iteration order, so that the old slots are
+  // released on erasing their first entry, with only tombstones after it
+  std::vector<std::string> keys;
+  for (const auto &e: table) {
+    keys.push_back(to_string(e.first));
+  }
+  REQUIRE(keys.size() == n);
+  for (auto k = keys.rbegin(); k != keys.rend(); ++k) {
+    auto it = table.find(*k);
+    REQUIRE(it != table.end());
+    // Entries after it were erased already
+    REQUIRE(table.erase(it) == table.end());
+  }
+  REQUIRE(table.empty());
+  REQUIRE_FALSE(table.resizing());
+  table.clear();
+  REQUIRE(manager.mb_used() == 0);
+}
@@ -0,0 +1,32 @@
+#include "catch.hpp"
+#include <random>
+#include "jiffy/storage/hashtable/hash_slot.h"
+
+using namespace ::jiffy::storage;
+
+TEST_CASE("hash_slot_crc16_test", "[crc16]") {
+  REQUIRE(hash_slot::crc16_bytewise("123456789", 9) == 0x31C3);
+  REQUIRE(hash_slot::get(std::string("123456789")) == 0x31C3);
+
+  std::mt19937 gen(0);
+  std::string buf(65536 + 64, '\0');
+  for (auto &c: buf) {
+    c = static_cast<char>(gen());
+  }
+  // Unaligned buffers of every length up to a few folding blocks, then long keys
+  std::vector<std::size_t> lengths;
+  for (std::size_t len = 0; len <= 1024; ++len) {
+    lengths.push_back(len);
+  }
+  for (std::size_t len = 2048; len <= 65536; len *= 2) {
+    lengths.push_back(len - 1);
+    lengths.push_back(len);
+    lengths.push_back(len + 17);
+  }
+  for (auto len: lengths) {
+    auto expected = hash_slot::crc16_bytewise(buf.data() + 1, len);
+    REQUIRE(hash_slot::crc16_sliced(buf.data() + 1, len) == expected);
+    REQUIRE(hash_slot::crc16_clmul(buf.data() + 1, len) == expected);
+    REQUIRE(hash_slot::crc16(buf.data() + 1, len) == expected);
+  }
+}
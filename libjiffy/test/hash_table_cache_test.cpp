@@ -0,0 +1,65 @@
+#include "catch.hpp"
+#include <thread>
+#include "jiffy/storage/client/hash_table_cache.h"
+
+using namespace ::jiffy::storage;
+
+TEST_CASE("hash_table_cache_get_put_test", "[get][put][invalidate]") {
+  hash_table_cache cache(1024, -1);
+  std::string value;
+  REQUIRE_FALSE(cache.get("a", value));
+  cache.put("a", "1");
+  cache.put("b", "22");
+  REQUIRE(cache.get("a", value));
+  REQUIRE(value == "1");
+  REQUIRE(cache.size() == 2);
+  REQUIRE(cache.bytes() == 2 + 3);
+
+  cache.put("a", "333");
+  REQUIRE(cache.get("a", value));
+  REQUIRE(value == "333");
+  REQUIRE(cache.bytes() == 4 + 3);
+
+  cache.invalidate("a");
+  REQUIRE_FALSE(cache.get("a", value));
+  REQUIRE(cache.bytes() == 3);
+  REQUIRE(cache.hits() == 2);
+  REQUIRE(cache.misses() == 2);
+
+  cache.clear();
+  REQUIRE(cache.size() == 0);
+  REQUIRE(cache.bytes() == 0);
+  REQUIRE_FALSE(cache.get("b", value));
+}
+
+TEST_CASE("hash_table_cache_eviction_test", "[put][get]") {
+  hash_table_cache cache(100, -1);
+  for (int i = 0; i < 10; ++i) {
+    cache.put(std::to_string(i), std::string(9, 'v'));
+  }
+  REQUIRE(cache.size() == 10);
+  std::string value;
+  REQUIRE(cache.get("0", value));
+
+  // Least recently used keys make room first
+  cache.put("10", std::string(8, 'v'));
+  REQUIRE(cache.bytes() <= cache.capacity());
+  REQUIRE(cache.get("0", value));
+  REQUIRE_FALSE(cache.get("1", value));
+  REQUIRE(cache.get("10", value));
+
+  // Values larger than the cache are not cached
+  cache.put("big", std::string(200, 'v'));
+  REQUIRE_FALSE(cache.get("big", value));
+  REQUIRE(cache.size() == 10);
+}
+
+TEST_CASE("hash_table_cache_max_age_test", "[get][put]") {
+  hash_table_cache cache(1024, 10);
+  std::string value;
+  cache.put("a", "1");
+  REQUIRE(cache.get("a", value));
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  REQUIRE_FALSE(cache.get("a", value));
+  REQUIRE(cache.size() == 0);
+}
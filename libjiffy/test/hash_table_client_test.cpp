@@ -8,6 +8,7 @@
 #include "jiffy/storage/service/block_server.h"
 #include "jiffy/storage/hashtable/hash_slot.h"
 #include "jiffy/storage/client/hash_table_client.h"
+#include "jiffy/storage/client/block_connection_pool.h"
 #include "jiffy/auto_scaling/auto_scaling_server.h"
 
 using namespace ::jiffy::storage;
@@ -64,6 +65,253 @@ TEST_CASE("hash_table_client_put_get_test", "[put][get]") {
   }
 }
 
+TEST_CASE("hash_table_client_cache_test", "[put][get][update][remove]") {
+  auto alloc = std::make_shared<sequential_block_allocator>();
+  auto block_names = test_utils::init_block_names(NUM_BLOCKS, STORAGE_SERVICE_PORT, STORAGE_MANAGEMENT_PORT);
+  alloc->add_blocks(block_names);
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  auto blocks = test_utils::init_hash_table_blocks(block_names, memory_mode, mem_kind, 134217728, 0, 1);
+  auto storage_server = block_server::create(blocks, STORAGE_SERVICE_PORT);
+  std::thread storage_serve_thread([&storage_server] { storage_server->serve(); });
+  test_utils::wait_till_server_ready(HOST, STORAGE_SERVICE_PORT);
+
+  auto mgmt_server = storage_management_server::create(blocks, HOST, STORAGE_MANAGEMENT_PORT);
+  std::thread mgmt_serve_thread([&mgmt_server] { mgmt_server->serve(); });
+  test_utils::wait_till_server_ready(HOST, STORAGE_MANAGEMENT_PORT);
+
+  auto sm = std::make_shared<storage_manager>();
+  auto tree = std::make_shared<directory_tree>(alloc, sm);
+  data_status status = tree->create("/sandbox/file.txt", "hashtable", "/tmp", NUM_BLOCKS, 1, 0, 0,
+      {"0_21845", "21845_43690", "43690_65536"}, {"regular", "regular", "regular"});
+
+  hash_table_client client(tree, "/sandbox/file.txt", status);
+  hash_table_client writer(tree, "/sandbox/file.txt", status);
+  client.enable_cache(1024 * 1024, -1);
+  REQUIRE(client.cache() != nullptr);
+
+  for (std::size_t i = 0; i < 100; ++i) {
+    REQUIRE_NOTHROW(writer.put(std::to_string(i), std::to_string(i)));
+  }
+  for (std::size_t i = 0; i < 100; ++i) {
+    REQUIRE(client.get(std::to_string(i)) == std::to_string(i));
+    REQUIRE(client.get(std::to_string(i)) == std::to_string(i));
+  }
+  REQUIRE(client.cache()->misses() == 100);
+  REQUIRE(client.cache()->hits() == 100);
+  REQUIRE(client.get(std::vector<std::string>{"0", "1", "2"}) == std::vector<std::string>{"0", "1", "2"});
+  REQUIRE(client.cache()->hits() == 103);
+
+  // Writes by other clients invalidate cached keys once notified
+  REQUIRE(writer.update("0", "a") == "!ok");
+  std::string value;
+  for (int attempt = 0; attempt < 100 && (value = client.get("0")) != "a"; ++attempt) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  REQUIRE(value == "a");
+  REQUIRE(writer.remove("1") == "!ok");
+  bool removed = false;
+  for (int attempt = 0; attempt < 100 && !removed; ++attempt) {
+    try {
+      client.get("1");
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    } catch (std::logic_error &e) {
+      removed = true;
+    }
+  }
+  REQUIRE(removed);
+
+  // Writes by the client itself are seen right away
+  REQUIRE(client.update("2", "b") == "!ok");
+  REQUIRE(client.get("2") == "b");
+
+  client.disable_cache();
+  REQUIRE(client.cache() == nullptr);
+  REQUIRE(client.get("3") == "3");
+
+  storage_server->stop();
+  if (storage_serve_thread.joinable()) {
+    storage_serve_thread.join();
+  }
+
+  mgmt_server->stop();
+  if (mgmt_serve_thread.joinable()) {
+    mgmt_serve_thread.join();
+  }
+}
+
+TEST_CASE("hash_table_client_async_put_get_test", "[put][get]") {
+  auto alloc = std::make_shared<sequential_block_allocator>();
+  auto block_names = test_utils::init_block_names(NUM_BLOCKS, STORAGE_SERVICE_PORT, STORAGE_MANAGEMENT_PORT);
+  alloc->add_blocks(block_names);
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  auto blocks = test_utils::init_hash_table_blocks(block_names, memory_mode, mem_kind, 134217728, 0, 1);
+  auto storage_server = block_server::create(blocks, STORAGE_SERVICE_PORT);
+  std::thread storage_serve_thread([&storage_server] { storage_server->serve(); });
+  test_utils::wait_till_server_ready(HOST, STORAGE_SERVICE_PORT);
+
+  auto mgmt_server = storage_management_server::create(blocks, HOST, STORAGE_MANAGEMENT_PORT);
+  std::thread mgmt_serve_thread([&mgmt_server] { mgmt_server->serve(); });
+  test_utils::wait_till_server_ready(HOST, STORAGE_MANAGEMENT_PORT);
+
+  auto sm = std::make_shared<storage_manager>();
+  auto tree = std::make_shared<directory_tree>(alloc, sm);
+  data_status status = tree->create("/sandbox/file.txt", "hashtable", "/tmp", NUM_BLOCKS, 1, 0, 0,
+      {"0_21845", "21845_43690", "43690_65536"}, {"regular", "regular", "regular"});
+
+  hash_table_client client(tree, "/sandbox/file.txt", status);
+  std::vector<async_result<std::string>> puts;
+  for (std::size_t i = 0; i < 1000; ++i) {
+    puts.push_back(client.put_async(std::to_string(i), std::to_string(i)));
+  }
+  for (auto &r: puts) {
+    REQUIRE(r.get() == "!ok");
+  }
+
+  std::size_t completed = 0;
+  std::vector<async_result<std::string>> gets;
+  for (std::size_t i = 0; i < 1000; ++i) {
+    auto r = client.get_async(std::to_string(i));
+    r.then([&completed, i](async_result<std::string> res) {
+      REQUIRE(res.get() == std::to_string(i));
+      ++completed;
+    });
+    gets.push_back(r);
+  }
+  event_loop::instance().run();
+  REQUIRE(completed == 1000);
+  REQUIRE(event_loop::instance().pending() == 0);
+
+  auto missing = client.get_async("1000");
+  REQUIRE_THROWS_AS(missing.get(), std::logic_error);
+  REQUIRE(client.exists_async("0").get());
+  REQUIRE_FALSE(client.exists_async("1000").get());
+  REQUIRE(client.update_async("0", "a").get() == "!ok");
+  REQUIRE(client.remove_async("0").get() == "!ok");
+  REQUIRE_FALSE(client.exists("0"));
+
+  storage_server->stop();
+  if (storage_serve_thread.joinable()) {
+    storage_serve_thread.join();
+  }
+
+  mgmt_server->stop();
+  if (mgmt_serve_thread.joinable()) {
+    mgmt_serve_thread.join();
+  }
+}
+
+TEST_CASE("hash_table_client_shared_connection_test", "[put][get]") {
+  auto alloc = std::make_shared<sequential_block_allocator>();
+  auto block_names = test_utils::init_block_names(NUM_BLOCKS, STORAGE_SERVICE_PORT, STORAGE_MANAGEMENT_PORT);
+  alloc->add_blocks(block_names);
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  auto blocks = test_utils::init_hash_table_blocks(block_names, memory_mode, mem_kind, 134217728, 0, 1);
+  auto storage_server = block_server::create(blocks, STORAGE_SERVICE_PORT);
+  std::thread storage_serve_thread([&storage_server] { storage_server->serve(); });
+  test_utils::wait_till_server_ready(HOST, STORAGE_SERVICE_PORT);
+
+  auto mgmt_server = storage_management_server::create(blocks, HOST, STORAGE_MANAGEMENT_PORT);
+  std::thread mgmt_serve_thread([&mgmt_server] { mgmt_server->serve(); });
+  test_utils::wait_till_server_ready(HOST, STORAGE_MANAGEMENT_PORT);
+
+  auto sm = std::make_shared<storage_manager>();
+  auto tree = std::make_shared<directory_tree>(alloc, sm);
+  data_status status = tree->create("/sandbox/file.txt", "hashtable", "/tmp", NUM_BLOCKS, 1, 0, 0,
+      {"0_21845", "21845_43690", "43690_65536"}, {"regular", "regular", "regular"});
+
+  auto &pool = block_connection_pool::instance();
+  {
+    // Chains of many clients share a few connections to the server
+    std::vector<std::unique_ptr<hash_table_client>> clients;
+    for (std::size_t c = 0; c < 16; ++c) {
+      clients.emplace_back(new hash_table_client(tree, "/sandbox/file.txt", status));
+    }
+    REQUIRE(pool.connections(HOST, STORAGE_SERVICE_PORT) == BLOCK_CONNECTIONS_PER_SERVER);
+
+    for (std::size_t i = 0; i < 1000; ++i) {
+      REQUIRE_NOTHROW(clients[i % clients.size()]->put(std::to_string(i), std::to_string(i)));
+    }
+    for (std::size_t i = 0; i < 1000; ++i) {
+      REQUIRE(clients[(i + 1) % clients.size()]->get(std::to_string(i)) == std::to_string(i));
+    }
+
+    // Responses reach the client that sent the request
+    std::vector<async_result<std::string>> gets;
+    for (std::size_t i = 0; i < 1000; ++i) {
+      gets.push_back(clients[i % clients.size()]->get_async(std::to_string(i)));
+    }
+    for (std::size_t i = 0; i < 1000; ++i) {
+      REQUIRE(gets[i].get() == std::to_string(i));
+    }
+
+    clients.resize(1);
+    REQUIRE(clients.front()->get("0") == "0");
+  }
+  REQUIRE(pool.connections(HOST, STORAGE_SERVICE_PORT) == 0);
+
+  storage_server->stop();
+  if (storage_serve_thread.joinable()) {
+    storage_serve_thread.join();
+  }
+
+  mgmt_server->stop();
+  if (mgmt_serve_thread.joinable()) {
+    mgmt_serve_thread.join();
+  }
+}
+
+TEST_CASE("hash_table_client_batch_put_get_test", "[put][get]") {
+  auto alloc = std::make_shared<sequential_block_allocator>();
+  auto block_names = test_utils::init_block_names(NUM_BLOCKS, STORAGE_SERVICE_PORT, STORAGE_MANAGEMENT_PORT);
+  alloc->add_blocks(block_names);
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  auto blocks = test_utils::init_hash_table_blocks(block_names, memory_mode, mem_kind, 134217728, 0, 1);
+  auto storage_server = block_server::create(blocks, STORAGE_SERVICE_PORT);
+  std::thread storage_serve_thread([&storage_server] { storage_server->serve(); });
+  test_utils::wait_till_server_ready(HOST, STORAGE_SERVICE_PORT);
+
+  auto mgmt_server = storage_management_server::create(blocks, HOST, STORAGE_MANAGEMENT_PORT);
+  std::thread mgmt_serve_thread([&mgmt_server] { mgmt_server->serve(); });
+  test_utils::wait_till_server_ready(HOST, STORAGE_MANAGEMENT_PORT);
+
+  auto sm = std::make_shared<storage_manager>();
+  auto tree = std::make_shared<directory_tree>(alloc, sm);
+  data_status status = tree->create("/sandbox/file.txt", "hashtable", "/tmp", NUM_BLOCKS, 1, 0, 0,
+      {"0_21845", "21845_43690", "43690_65536"}, {"regular", "regular", "regular"});
+
+  hash_table_client client(tree, "/sandbox/file.txt", status);
+  std::vector<std::pair<std::string, std::string>> kvs;
+  std::vector<std::string> keys;
+  for (std::size_t i = 0; i < 1000; ++i) {
+    kvs.emplace_back(std::to_string(i), std::to_string(i));
+    keys.push_back(std::to_string(i));
+  }
+  REQUIRE_NOTHROW(client.put(kvs));
+  auto values = client.get(keys);
+  REQUIRE(values.size() == 1000);
+  for (std::size_t i = 0; i < 1000; ++i) {
+    REQUIRE(values[i] == std::to_string(i));
+    REQUIRE(client.get(std::to_string(i)) == std::to_string(i));
+  }
+  REQUIRE_THROWS_AS(client.put(kvs), std::logic_error);
+  keys.emplace_back("1000");
+  REQUIRE_THROWS_AS(client.get(keys), std::logic_error);
+
+  storage_server->stop();
+  if (storage_serve_thread.joinable()) {
+    storage_serve_thread.join();
+  }
+
+  mgmt_server->stop();
+  if (mgmt_serve_thread.joinable()) {
+    mgmt_serve_thread.join();
+  }
+}
+
 TEST_CASE("hash_table_client_put_update_get_test", "[put][update][get]") {
   auto alloc = std::make_shared<sequential_block_allocator>();
   auto block_names = test_utils::init_block_names(NUM_BLOCKS, STORAGE_SERVICE_PORT, STORAGE_MANAGEMENT_PORT);
@@ -0,0 +1,53 @@
+#include "catch.hpp"
+#include <stdexcept>
+#include "jiffy/storage/hashtable/hash_table_eviction.h"
+
+using namespace ::jiffy::storage;
+
+TEST_CASE("hash_table_eviction_parse_policy_test", "[parse_policy]") {
+  REQUIRE(hash_table_eviction::parse_policy("clock") == hash_table_eviction::clock);
+  REQUIRE(hash_table_eviction::parse_policy("lru") == hash_table_eviction::lru);
+  REQUIRE(hash_table_eviction::parse_policy("sampled-lfu") == hash_table_eviction::sampled_lfu);
+  REQUIRE_THROWS_AS(hash_table_eviction::parse_policy("fifo"), std::invalid_argument);
+}
+
+TEST_CASE("hash_table_eviction_clock_test", "[admit][touch][second_chance]") {
+  hash_table_eviction eviction(hash_table_eviction::clock, 134217728, 16);
+  REQUIRE_FALSE(eviction.second_chance(42));
+  eviction.admit(42);
+  REQUIRE(eviction.second_chance(42));
+  REQUIRE_FALSE(eviction.second_chance(42));
+  eviction.touch(42);
+  REQUIRE(eviction.second_chance(42));
+  REQUIRE_FALSE(eviction.second_chance(43));
+}
+
+TEST_CASE("hash_table_eviction_lru_lfu_test", "[admit][touch][coldness]") {
+  hash_table_eviction lru(hash_table_eviction::lru, 134217728, 16);
+  lru.admit(42);
+  lru.admit(43);
+  REQUIRE(lru.coldness(42) == 0);
+  // The clock ticks with admissions, however little time they take
+  for (std::size_t i = 0; i < 1024 * 1024; ++i) {
+    lru.admit(1000 + i % 1000);
+  }
+  lru.touch(42);
+  REQUIRE(lru.coldness(42) == 0);
+  REQUIRE(lru.coldness(43) > 0);
+
+  hash_table_eviction lfu(hash_table_eviction::sampled_lfu, 134217728, 16);
+  lfu.admit(42);
+  lfu.admit(43);
+  REQUIRE(lfu.coldness(42) == 255u - HASH_TABLE_LFU_INIT);
+  for (std::size_t i = 0; i < 10000; ++i) {
+    lfu.touch(42);
+  }
+  // Counters grow logarithmically, so a hot key ends up only a few steps warmer
+  REQUIRE(lfu.coldness(42) + 3 < lfu.coldness(43));
+  REQUIRE(lfu.coldness(42) > 0);
+
+  for (std::size_t i = 0; i < 1000; ++i) {
+    REQUIRE(hash_table_eviction::random_slot(100) < 100);
+  }
+  REQUIRE(lfu.next_stripe() != lfu.next_stripe());
+}
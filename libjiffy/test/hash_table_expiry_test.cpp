@@ -0,0 +1,67 @@
+#include "catch.hpp"
+#include <set>
+#include "test_utils.h"
+#include "jiffy/storage/hashtable/hash_table_expiry.h"
+
+using namespace ::jiffy::storage;
+
+TEST_CASE("hash_table_expiry_wheel_test", "[set][clear][expire]") {
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  block_memory_manager manager(134217728, memory_mode, mem_kind);
+  block_memory_allocator<uint8_t> binary_allocator(&manager);
+  hash_table_expiry expiry{hash_table_expiry::allocator_type(&manager)};
+  auto now = hash_table_expiry::now_ms();
+
+  // Deadlines spread over every wheel level and the overflow list
+  std::vector<binary> keys;
+  std::vector<uint64_t> deadlines;
+  uint64_t span = HASH_TABLE_TTL_TICK_MS;
+  for (std::size_t l = 0; l <= HASH_TABLE_TTL_WHEEL_LEVELS; ++l) {
+    span <<= HASH_TABLE_TTL_WHEEL_BITS;
+    for (std::size_t i = 0; i < 100; ++i) {
+      keys.emplace_back(std::to_string(keys.size()), binary_allocator);
+      deadlines.push_back(now + 1 + (span / 100) * i);
+    }
+  }
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    expiry.set(keys[i], deadlines[i]);
+  }
+  // Rescheduled and cleared keys leave stale entries on the wheel
+  for (std::size_t i = 0; i < keys.size(); i += 7) {
+    deadlines[i] += 12345;
+    expiry.set(keys[i], deadlines[i]);
+  }
+  for (std::size_t i = 3; i < keys.size(); i += 11) {
+    REQUIRE(expiry.clear(keys[i]));
+    deadlines[i] = 0;
+  }
+  std::size_t remaining = 0;
+  for (auto d: deadlines) {
+    remaining += d != 0;
+  }
+  REQUIRE(expiry.size() == remaining);
+
+  std::set<const uint8_t *> erased;
+  auto erase = [&](const uint8_t *key, std::size_t) {
+    REQUIRE(erased.insert(key).second);
+  };
+  uint64_t t = now;
+  while (expiry.size() > 0) {
+    t += span / 997;
+    while (expiry.expire(t, HASH_TABLE_TTL_EXPIRE_BATCH, erase) == HASH_TABLE_TTL_EXPIRE_BATCH);
+    for (std::size_t i = 0; i < keys.size(); ++i) {
+      if (deadlines[i] == 0)
+        continue;
+      // Keys come due no earlier than their deadline and no later than a tick after it
+      bool gone = erased.count(keys[i].data()) != 0;
+      if (deadlines[i] > t) {
+        REQUIRE_FALSE(gone);
+        REQUIRE_FALSE(expiry.expired(keys[i], t));
+      } else if (deadlines[i] + HASH_TABLE_TTL_TICK_MS <= t) {
+        REQUIRE(gone);
+      }
+    }
+  }
+  REQUIRE(erased.size() == remaining);
+}
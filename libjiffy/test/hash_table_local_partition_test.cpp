@@ -420,4 +420,62 @@ TEST_CASE("hash_table_ls_put_remove_get_binary_test", "[put][update][get]") {
     REQUIRE(resp[0] == "!key_not_found");
   }
   remove("/tmp/0_65536");
-}
\ No newline at end of file
+}
+TEST_CASE("hash_table_ls_reopen_load_binary_test", "[put][update][remove][get][load]") {
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  size_t capacity = 134217728;
+  block_memory_manager manager(capacity, memory_mode, mem_kind);
+  property_map conf;
+  conf.set("hashtable.serializer", "binary");
+  {
+    hash_table_partition block(&manager, "local://tmp", "0_65536", "regular", conf);
+    block.slot_range(0, hash_slot::MAX);
+    for (std::size_t i = 0; i < 500; ++i) {
+      response resp;
+      REQUIRE_NOTHROW(block.run_command(resp, {"put", std::to_string(i), std::to_string(i)}));
+      REQUIRE(resp[0] == "!ok");
+    }
+    REQUIRE(block.dump("local://tmp/0_65536"));
+
+    for (std::size_t i = 0; i < 500; i += 2) {
+      response resp;
+      REQUIRE_NOTHROW(block.update_ls(resp, {"update_ls", std::to_string(i), std::to_string(i + 1000)}));
+      REQUIRE(resp[0] == "!ok");
+    }
+    for (std::size_t i = 1; i < 500; i += 10) {
+      response resp;
+      REQUIRE_NOTHROW(block.remove_ls(resp, {"remove_ls", std::to_string(i)}));
+      REQUIRE(resp[0] == "!ok");
+    }
+  }
+
+  // A new partition on the same file sees the spilled mutations, and loading merges them
+  block_memory_manager manager2(capacity, memory_mode, mem_kind);
+  hash_table_partition block(&manager2, "local://tmp", "0_65536", "regular", conf);
+  block.slot_range(0, hash_slot::MAX);
+  for (std::size_t i = 0; i < 500; ++i) {
+    response resp;
+    REQUIRE_NOTHROW(block.get_ls(resp, {"get_ls", std::to_string(i)}));
+    if (i % 10 == 1) {
+      REQUIRE(resp[0] == "!key_not_found");
+    } else {
+      REQUIRE(resp[0] == "!ok");
+      REQUIRE(resp[1] == std::to_string(i % 2 == 0 ? i + 1000 : i));
+    }
+  }
+  REQUIRE_NOTHROW(block.load("local://tmp/0_65536"));
+  for (std::size_t i = 0; i < 500; ++i) {
+    response resp;
+    REQUIRE_NOTHROW(block.run_command(resp, {"get", std::to_string(i)}));
+    if (i % 10 == 1) {
+      REQUIRE(resp[0] == "!key_not_found");
+    } else {
+      REQUIRE(resp[0] == "!ok");
+      REQUIRE(resp[1] == std::to_string(i % 2 == 0 ? i + 1000 : i));
+    }
+  }
+  remove("/tmp/0_65536");
+  remove("/tmp/0_65536_offset");
+  remove("/tmp/0_65536_log");
+}
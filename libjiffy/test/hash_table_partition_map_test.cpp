@@ -0,0 +1,97 @@
+#include "catch.hpp"
+#include "jiffy/storage/client/hash_table_partition_map.h"
+
+using namespace ::jiffy::storage;
+using namespace ::jiffy::directory;
+
+namespace {
+
+struct fake_chain_client {
+  bool is_connected() const {
+    return connected;
+  }
+
+  bool connected{true};
+};
+
+typedef hash_table_partition_map<fake_chain_client> partition_map;
+
+replica_chain chain(const std::string &name, const std::string &block, const std::string &metadata = "regular") {
+  replica_chain c({block});
+  c.name = name;
+  c.metadata = metadata;
+  return c;
+}
+
+data_status status(const std::vector<replica_chain> &chains) {
+  return data_status("hashtable", "/tmp", 1, chains, 0, {});
+}
+
+}
+
+TEST_CASE("hash_table_partition_map_route_test", "[update][route]") {
+  partition_map map;
+  REQUIRE_THROWS_AS(map.route(0), std::logic_error);
+
+  std::size_t connects = 0;
+  auto connect = [&connects](const replica_chain &) {
+    ++connects;
+    return std::make_shared<fake_chain_client>();
+  };
+
+  // Partitions importing their slots are not routed to
+  auto before_split = status({chain("32768_65536", "b"), chain("0_32768", "a"),
+                              chain("49152_65536", "c", "split_importing")});
+  REQUIRE(map.update(before_split, connect) == 2);
+  REQUIRE(map.version() == 1);
+  REQUIRE(map.size() == 2);
+  REQUIRE(map.route(0).chain.name == "0_32768");
+  REQUIRE(map.route(32767).chain.name == "0_32768");
+  REQUIRE(map.route(32768).chain.name == "32768_65536");
+  REQUIRE(map.route(65535).chain.name == "32768_65536");
+
+  // Nothing changed
+  auto a = map.route(0).client;
+  REQUIRE(map.update(before_split, connect) == 0);
+  REQUIRE(map.version() == 1);
+  REQUIRE(map.route(0).client == a);
+
+  // Only the split partitions are reconnected
+  auto after_split = status({chain("0_32768", "a"), chain("32768_49152", "b"), chain("49152_65536", "c")});
+  REQUIRE(map.update(after_split, connect) == 2);
+  REQUIRE(map.version() == 2);
+  REQUIRE(map.route(0).client == a);
+  REQUIRE(map.route(49151).chain.name == "32768_49152");
+  REQUIRE(map.route(49152).chain.name == "49152_65536");
+  REQUIRE(map.index(65535) == 2);
+  REQUIRE(connects == 4);
+}
+
+TEST_CASE("hash_table_partition_map_reconnect_test", "[update][route]") {
+  partition_map map;
+  auto connect = [](const replica_chain &) {
+    return std::make_shared<fake_chain_client>();
+  };
+  auto s = status({chain("0_32768", "a"), chain("32768_65536", "b")});
+  map.update(s, connect);
+
+  // Chains whose blocks changed, or whose client lost its connection, are reconnected
+  auto b = map.route(65535).client;
+  REQUIRE(map.update(status({chain("0_32768", "a2"), chain("32768_65536", "b")}), connect) == 1);
+  REQUIRE(map.route(0).chain.tail() == "a2");
+  REQUIRE(map.route(65535).client == b);
+  b->connected = false;
+  REQUIRE(map.update(status({chain("0_32768", "a2"), chain("32768_65536", "b")}), connect) == 1);
+  REQUIRE(map.route(65535).client != b);
+  REQUIRE(map.version() == 3);
+
+  // A failed connection leaves the map as it was
+  auto failing = [](const replica_chain &) -> std::shared_ptr<fake_chain_client> {
+    throw std::logic_error("connection refused");
+  };
+  REQUIRE_THROWS_AS(map.update(status({chain("0_16384", "a2"), chain("16384_32768", "c"),
+                                       chain("32768_65536", "b")}), failing), std::logic_error);
+  REQUIRE(map.version() == 3);
+  REQUIRE(map.size() == 2);
+  REQUIRE(map.route(16384).chain.name == "0_32768");
+}
@@ -1,3 +1,6 @@
+#include <atomic>
+#include <set>
+#include <thread>
 #include "catch.hpp"
 #include "test_utils.h"
 #include "jiffy/storage/hashtable/hash_slot.h"
@@ -31,6 +34,110 @@ TEST_CASE("hash_table_put_get_test", "[put][get]") {
   }
 }
 
+TEST_CASE("hash_table_response_test", "[put][get][upsert]") {
+  // Temporaries are moved into the response, named strings are copied
+  std::string kept(100, 'k');
+  std::string moved(100, 'm');
+  response resp;
+  make_response(resp, {"!ok", kept, std::move(moved), std::string(100, 't')});
+  REQUIRE(resp == response({"!ok", std::string(100, 'k'), std::string(100, 'm'), std::string(100, 't')}));
+  REQUIRE(kept == std::string(100, 'k'));
+  REQUIRE(moved.empty());
+
+  // Values handed over to responses leave the stored values intact
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  block_memory_manager manager(134217728, memory_mode, mem_kind);
+  hash_table_partition block(&manager);
+  std::string value(1048576, 'a');
+  std::string new_value(1048576, 'b');
+  REQUIRE_NOTHROW(block.put(resp, {"put", "key", value}));
+  REQUIRE(resp == response({"!ok"}));
+  for (int i = 0; i < 2; ++i) {
+    REQUIRE_NOTHROW(block.get(resp, {"get", "key"}));
+    REQUIRE(resp == response({"!ok", value}));
+  }
+  REQUIRE_NOTHROW(block.upsert(resp, {"upsert", "key", new_value}));
+  REQUIRE(resp == response({"!ok", value}));
+  REQUIRE_NOTHROW(block.get(resp, {"get", "key"}));
+  REQUIRE(resp == response({"!ok", new_value}));
+}
+
+
+TEST_CASE("hash_table_batch_frame_test", "[put][get][batch]") {
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  size_t capacity = 134217728;
+  block_memory_manager manager(capacity, memory_mode, mem_kind);
+  hash_table_partition block(&manager);
+  std::vector<arg_list> puts, gets;
+  for (std::size_t i = 0; i < 1000; ++i) {
+    puts.push_back({"put", std::to_string(i), std::to_string(i)});
+    gets.push_back({"get", std::to_string(i)});
+  }
+  gets.push_back({"get", "1000"});
+
+  auto put_frame = batch_frame::encode(puts, HT_OPS);
+  REQUIRE(put_frame[0] == batch_frame::MUTATOR);
+  REQUIRE(block.is_mutator(put_frame[0]));
+  response resp;
+  REQUIRE_NOTHROW(block.execute(resp, put_frame));
+  auto put_resps = batch_frame::decode_responses(resp, puts.size());
+  for (const auto &r: put_resps) {
+    REQUIRE(r[0] == "!ok");
+  }
+
+  auto get_frame = batch_frame::encode(gets, HT_OPS);
+  REQUIRE(get_frame[0] == batch_frame::ACCESSOR);
+  REQUIRE(block.is_accessor(get_frame[0]));
+  REQUIRE_NOTHROW(block.execute(resp, get_frame));
+  auto get_resps = batch_frame::decode_responses(resp, gets.size());
+  for (std::size_t i = 0; i < 1000; ++i) {
+    REQUIRE(get_resps[i][0] == "!ok");
+    REQUIRE(get_resps[i][1] == std::to_string(i));
+  }
+  REQUIRE(get_resps[1000][0] == "!key_not_found");
+
+  auto failed = batch_frame::decode_responses({"!block_moved"}, 3);
+  REQUIRE(failed.size() == 3);
+  for (const auto &r: failed) {
+    REQUIRE(r == response{"!block_moved"});
+  }
+}
+
+TEST_CASE("hash_table_opcode_test", "[put][get][get_range_data]") {
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  size_t capacity = 134217728;
+  block_memory_manager manager(capacity, memory_mode, mem_kind);
+  hash_table_partition block(&manager);
+  REQUIRE(block.state() == state_regular);
+  auto put = command_codec::opcode(hash_table_cmd_id::ht_put);
+  auto get = command_codec::opcode(hash_table_cmd_id::ht_get);
+  REQUIRE(block.is_mutator(put));
+  REQUIRE(block.is_accessor(get));
+  REQUIRE(block.command_name(put) == "put");
+  REQUIRE(block.command_id(command_codec::opcode(1000)) == UINT32_MAX);
+  for (std::size_t i = 0; i < 1000; ++i) {
+    response resp;
+    REQUIRE_NOTHROW(block.run_command(resp, {put, std::to_string(i), std::to_string(i)}));
+    REQUIRE(resp[0] == "!ok");
+  }
+  for (std::size_t i = 0; i < 1000; ++i) {
+    response resp;
+    REQUIRE_NOTHROW(block.run_command(resp, {get, std::to_string(i)}));
+    REQUIRE(resp[0] == "!ok");
+    REQUIRE(resp[1] == std::to_string(i));
+  }
+  response resp;
+  REQUIRE_NOTHROW(block.run_command(resp, {command_codec::opcode(hash_table_cmd_id::ht_get_range_data),
+                                           command_codec::encode_int(0),
+                                           command_codec::encode_int(hash_slot::MAX),
+                                           command_codec::encode_int(4000)}));
+  REQUIRE(resp[0] == "!ok");
+  REQUIRE(resp.size() == 3001);
+  REQUIRE(command_codec::decode_int(command_codec::encode_int(-42)) == -42);
+}
 
 TEST_CASE("hash_table_put_update_get_test", "[put][update][get]") {
   std::string memory_mode = getenv("JIFFY_TEST_MODE");
@@ -197,3 +304,364 @@ TEST_CASE("hash_table_flush_load_test", "[put][sync][reset][load][get]") {
     REQUIRE(resp[1] == std::to_string(i));
   }
 }
+
+TEST_CASE("hash_table_concurrent_get_upsert_test", "[put][get][upsert]") {
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  size_t capacity = 134217728;
+  block_memory_manager manager(capacity, memory_mode, mem_kind);
+  hash_table_partition block(&manager);
+  REQUIRE(block.is_concurrent());
+  for (std::size_t i = 0; i < 1000; ++i) {
+    response resp;
+    REQUIRE_NOTHROW(block.put(resp, {"put", std::to_string(i), std::to_string(i)}));
+    REQUIRE(resp[0] == "!ok");
+  }
+
+  const std::size_t num_readers = 4;
+  const std::size_t num_writers = 2;
+  std::atomic<std::size_t> failures(0);
+  std::vector<std::thread> workers;
+  for (std::size_t t = 0; t < num_readers; ++t) {
+    workers.emplace_back([&block, &failures] {
+      for (std::size_t round = 0; round < 20; ++round) {
+        for (std::size_t i = 0; i < 1000; ++i) {
+          response resp;
+          block.get(resp, {"get", std::to_string(i)});
+          // Values are either the original or one written by a writer, never torn
+          if (resp[0] != "!ok" || (resp[1] != std::to_string(i) && resp[1] != std::to_string(i + 1000)))
+            ++failures;
+        }
+      }
+    });
+  }
+  for (std::size_t t = 0; t < num_writers; ++t) {
+    workers.emplace_back([&block, &failures, t] {
+      for (std::size_t i = t; i < 2000; i += num_writers) {
+        response resp;
+        if (i < 1000) {
+          block.upsert(resp, {"upsert", std::to_string(i), std::to_string(i + 1000)});
+        } else {
+          block.put(resp, {"put", std::to_string(i), std::to_string(i)});
+        }
+        if (resp[0] != "!ok")
+          ++failures;
+      }
+    });
+  }
+  for (auto &w: workers)
+    w.join();
+
+  REQUIRE(failures.load() == 0);
+  REQUIRE(block.size() == 2000);
+  for (std::size_t i = 0; i < 2000; ++i) {
+    response resp;
+    REQUIRE_NOTHROW(block.get(resp, {"get", std::to_string(i)}));
+    REQUIRE(resp[0] == "!ok");
+    REQUIRE(resp[1] == std::to_string(i < 1000 ? i + 1000 : i));
+  }
+}
+
+TEST_CASE("hash_table_get_range_data_scale_remove_test", "[put][get_range_data][scale_remove]") {
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  size_t capacity = 134217728;
+  block_memory_manager manager(capacity, memory_mode, mem_kind);
+  hash_table_partition block(&manager);
+  std::size_t in_range = 0;
+  for (std::size_t i = 0; i < 1000; ++i) {
+    response resp;
+    REQUIRE_NOTHROW(block.put(resp, {"put", std::to_string(i), std::to_string(i)}));
+    REQUIRE(resp[0] == "!ok");
+    if (hash_slot::get(std::to_string(i)) < 32768)
+      ++in_range;
+  }
+
+  std::set<std::string> exported;
+  while (true) {
+    response resp;
+    REQUIRE_NOTHROW(block.get_data_in_slot_range(resp, {"get_range_data", "0", "32768", "100"}));
+    if (resp[0] == "!empty")
+      break;
+    REQUIRE(resp[0] == "!ok");
+    REQUIRE(resp.size() <= 151);
+    arg_list remove_args{"scale_remove"};
+    for (std::size_t i = 1; i < resp.size(); i += 3) {
+      REQUIRE(resp[i] == resp[i + 1]);
+      REQUIRE(resp[i + 2] == "0");
+      REQUIRE(hash_slot::get(resp[i]) < 32768);
+      REQUIRE(exported.insert(resp[i]).second);
+      remove_args.push_back(resp[i]);
+    }
+    response remove_resp;
+    REQUIRE_NOTHROW(block.scale_remove(remove_resp, remove_args));
+    REQUIRE(remove_resp[0] == "!ok");
+  }
+  REQUIRE(exported.size() == in_range);
+  REQUIRE(block.size() == 1000 - in_range);
+  for (std::size_t i = 0; i < 1000; ++i) {
+    response resp;
+    REQUIRE_NOTHROW(block.get(resp, {"get", std::to_string(i)}));
+    REQUIRE(resp[0] == (exported.count(std::to_string(i)) ? "!key_not_found" : "!ok"));
+  }
+}
+
+TEST_CASE("hash_table_get_range_data_resume_test", "[put][get_range_data][remove]") {
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  size_t capacity = 134217728;
+  block_memory_manager manager(capacity, memory_mode, mem_kind);
+  hash_table_partition block(&manager);
+  std::size_t in_range = 0;
+  for (std::size_t i = 0; i < 1000; ++i) {
+    response resp;
+    REQUIRE_NOTHROW(block.put(resp, {"put", std::to_string(i), std::to_string(i)}));
+    REQUIRE(resp[0] == "!ok");
+    if (hash_slot::get(std::to_string(i)) < 32768)
+      ++in_range;
+  }
+
+  // Resume each batch after the last key of the previous one, removing that key in between
+  std::set<std::string> exported;
+  arg_list read_args{"get_range_data", "0", "32768", "100"};
+  while (true) {
+    response resp;
+    REQUIRE_NOTHROW(block.get_data_in_slot_range(resp, read_args));
+    if (resp[0] == "!empty")
+      break;
+    REQUIRE(resp[0] == "!ok");
+    REQUIRE(resp.size() <= 151);
+    for (std::size_t i = 1; i < resp.size(); i += 3) {
+      REQUIRE(hash_slot::get(resp[i]) < 32768);
+      REQUIRE(exported.insert(resp[i]).second);
+    }
+    response remove_resp;
+    REQUIRE_NOTHROW(block.remove(remove_resp, {"remove", resp[resp.size() - 3]}));
+    REQUIRE(remove_resp[0] == "!ok");
+    read_args.resize(4);
+    read_args.push_back(resp[resp.size() - 3]);
+  }
+  REQUIRE(exported.size() == in_range);
+}
+
+TEST_CASE("hash_table_get_range_data_scale_put_ttl_test", "[put_ttl][get_range_data][scale_put]") {
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  size_t capacity = 134217728;
+  block_memory_manager manager(capacity, memory_mode, mem_kind);
+  hash_table_partition src(&manager);
+  for (std::size_t i = 0; i < 100; ++i) {
+    response resp;
+    if (i % 2 == 0) {
+      REQUIRE_NOTHROW(src.put_ttl(resp, {"put_ttl", std::to_string(i), std::to_string(i), "200"}));
+    } else {
+      REQUIRE_NOTHROW(src.put(resp, {"put", std::to_string(i), std::to_string(i)}));
+    }
+    REQUIRE(resp[0] == "!ok");
+  }
+
+  // Keys carry the time they have left across the transfer
+  block_memory_manager manager2(capacity, memory_mode, mem_kind);
+  hash_table_partition dst(&manager2);
+  response resp;
+  REQUIRE_NOTHROW(src.get_data_in_slot_range(resp, {"get_range_data", "0", "65536", "1000"}));
+  REQUIRE(resp[0] == "!ok");
+  REQUIRE(resp.size() == 301);
+  for (std::size_t i = 1; i < resp.size(); i += 3) {
+    auto ttl = std::stoll(resp[i + 2]);
+    if (std::stoul(resp[i]) % 2 == 0) {
+      REQUIRE(ttl > 0);
+      REQUIRE(ttl <= 200);
+    } else {
+      REQUIRE(ttl == 0);
+    }
+  }
+  resp[0] = "scale_put";
+  response put_resp;
+  REQUIRE_NOTHROW(dst.scale_put(put_resp, resp));
+  REQUIRE(put_resp[0] == "!ok");
+  REQUIRE(dst.size() == 100);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(400));
+  for (std::size_t i = 0; i < 100; ++i) {
+    response get_resp;
+    REQUIRE_NOTHROW(dst.get(get_resp, {"get", std::to_string(i)}));
+    REQUIRE(get_resp[0] == (i % 2 == 0 ? "!key_not_found" : "!ok"));
+  }
+  response bad_resp;
+  REQUIRE_NOTHROW(dst.scale_put(bad_resp, {"scale_put", "a", "b"}));
+  REQUIRE(bad_resp[0] == "!args_error");
+}
+
+TEST_CASE("hash_table_value_tier_spill_test", "[put][get][update][remove][sync]") {
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  size_t capacity = 8388608;
+  block_memory_manager manager(capacity, memory_mode, mem_kind);
+  jiffy::utils::property_map conf;
+  conf.set("hashtable.auto_scale", "false");
+  conf.set("hashtable.tier_path", "/tmp");
+  conf.set("hashtable.tier_threshold", "0.5");
+  hash_table_partition block(&manager, "local://tmp", "0_65536", "regular", conf);
+  // Twice as many values as fit under the tier threshold
+  std::string value(1024, 'x');
+  for (std::size_t i = 0; i < 8192; ++i) {
+    response resp;
+    block.run_command(resp, {"put", std::to_string(i), value + std::to_string(i)});
+    REQUIRE(resp[0] == "!ok");
+  }
+  REQUIRE(block.storage_size() < capacity * 3 / 4);
+  for (std::size_t i = 0; i < 8192; ++i) {
+    response resp;
+    REQUIRE_NOTHROW(block.get(resp, {"get", std::to_string(i)}));
+    REQUIRE(resp[0] == "!ok");
+    REQUIRE(resp[1] == value + std::to_string(i));
+  }
+  for (std::size_t i = 0; i < 8192; i += 2) {
+    response resp;
+    block.run_command(resp, {"update", std::to_string(i), std::to_string(i)});
+    REQUIRE(resp[0] == "!ok");
+  }
+  for (std::size_t i = 1; i < 8192; i += 4) {
+    response resp;
+    block.run_command(resp, {"remove", std::to_string(i)});
+    REQUIRE(resp[0] == "!ok");
+  }
+  REQUIRE(block.sync("local://tmp/tier_test"));
+  block_memory_manager manager2(134217728, memory_mode, mem_kind);
+  hash_table_partition loaded(&manager2);
+  REQUIRE_NOTHROW(loaded.load("local://tmp/tier_test"));
+  for (std::size_t i = 0; i < 8192; ++i) {
+    for (auto *p: {&block, &loaded}) {
+      response resp;
+      REQUIRE_NOTHROW(p->get(resp, {"get", std::to_string(i)}));
+      if (i % 4 == 1) {
+        REQUIRE(resp[0] == "!key_not_found");
+      } else {
+        REQUIRE(resp[0] == "!ok");
+        REQUIRE(resp[1] == (i % 2 == 0 ? std::to_string(i) : value + std::to_string(i)));
+      }
+    }
+  }
+}
+
+TEST_CASE("hash_table_ttl_test", "[put_ttl][upsert_ttl][get][expire]") {
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  block_memory_manager manager(134217728, memory_mode, mem_kind);
+  jiffy::utils::property_map conf;
+  conf.set("hashtable.auto_scale", "false");
+  hash_table_partition block(&manager, "local://tmp", "0_65536", "regular", conf);
+  for (std::size_t i = 0; i < 1000; ++i) {
+    response resp;
+    if (i % 2 == 0) {
+      block.run_command(resp, {"put_ttl", std::to_string(i), std::to_string(i), "100"});
+    } else {
+      block.run_command(resp, {"put", std::to_string(i), std::to_string(i)});
+    }
+    REQUIRE(resp[0] == "!ok");
+  }
+  for (std::size_t i = 0; i < 1000; i += 4) {
+    response resp;
+    // A plain upsert makes the key permanent again
+    block.run_command(resp, {"upsert", std::to_string(i), std::to_string(i)});
+    REQUIRE(resp[0] == "!ok");
+  }
+  {
+    response resp;
+    block.run_command(resp, {"put_ttl", "x", "x", "0"});
+    REQUIRE(resp[0] == "!args_error");
+  }
+  for (std::size_t i = 0; i < 1000; ++i) {
+    response resp;
+    REQUIRE_NOTHROW(block.get(resp, {"get", std::to_string(i)}));
+    REQUIRE(resp[0] == "!ok");
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  for (std::size_t i = 0; i < 1000; ++i) {
+    response resp;
+    REQUIRE_NOTHROW(block.get(resp, {"get", std::to_string(i)}));
+    REQUIRE(resp[0] == (i % 4 == 2 ? "!key_not_found" : "!ok"));
+  }
+  {
+    // An expired key can be put again
+    response resp;
+    block.run_command(resp, {"put", "2", "two"});
+    REQUIRE(resp[0] == "!ok");
+  }
+  block.expire();
+  REQUIRE(block.size() == 751);
+  response resp;
+  REQUIRE_NOTHROW(block.get(resp, {"get", "2"}));
+  REQUIRE(resp[1] == "two");
+}
+
+TEST_CASE("hash_table_eviction_test", "[put][get][evict]") {
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  for (auto policy: {"clock", "lru", "sampled-lfu"}) {
+    size_t capacity = 8388608;
+    block_memory_manager manager(capacity, memory_mode, mem_kind);
+    jiffy::utils::property_map conf;
+    conf.set("hashtable.eviction", policy);
+    hash_table_partition block(&manager, "local://tmp", "0_65536", "regular", conf);
+    // Three times as many values as fit, with a hot set read between puts
+    std::string value(1024, 'x');
+    for (std::size_t i = 0; i < 24576; ++i) {
+      response resp;
+      block.run_command(resp, {"put", std::to_string(i), value});
+      REQUIRE(resp[0] == "!ok");
+      REQUIRE(block.storage_size() <= capacity);
+      if (i >= 100 && i % 10 == 0) {
+        for (std::size_t j = 0; j < 100; ++j) {
+          // Like a cache client, put back what was evicted
+          response get_resp;
+          block.run_command(get_resp, {"get", std::to_string(j)});
+          if (get_resp[0] != "!ok") {
+            response put_resp;
+            block.run_command(put_resp, {"put", std::to_string(j), value});
+            REQUIRE(put_resp[0] == "!ok");
+          }
+        }
+      }
+    }
+    REQUIRE(block.size() < 24576);
+    std::size_t hot = 0;
+    for (std::size_t j = 0; j < 100; ++j) {
+      response get_resp;
+      block.run_command(get_resp, {"get", std::to_string(j)});
+      hot += get_resp[0] == "!ok";
+    }
+    REQUIRE(hot >= 90);
+    response resp;
+    block.run_command(resp, {"get", "24575"});
+    REQUIRE(resp[0] == "!ok");
+  }
+  {
+    // Replicas behind the head leave picking victims to it, and fill up rather than drift apart
+    block_memory_manager manager(8388608, memory_mode, mem_kind);
+    jiffy::utils::property_map conf;
+    conf.set("hashtable.eviction", "lru");
+    hash_table_partition block(&manager, "local://tmp", "0_65536", "regular", conf);
+    block.role(chain_role::tail);
+    std::string value(1024, 'x');
+    std::size_t n = 0;
+    response resp;
+    do {
+      resp.clear();
+      block.run_command(resp, {"put", std::to_string(n), value});
+    } while (resp[0] == "!ok" && ++n < 24576);
+    REQUIRE((resp[0] == "!full" || resp[0] == "!redo"));
+    REQUIRE(block.size() == n);
+    resp.clear();
+    block.run_command(resp, {"get", "0"});
+    REQUIRE(resp[0] == "!ok");
+  }
+  {
+    jiffy::utils::property_map conf;
+    conf.set("hashtable.eviction", "fifo");
+    block_memory_manager manager(8388608, memory_mode, mem_kind);
+    REQUIRE_THROWS_AS(hash_table_partition(&manager, "local://tmp", "0_65536", "regular", conf), std::invalid_argument);
+  }
+}
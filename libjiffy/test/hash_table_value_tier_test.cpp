@@ -0,0 +1,107 @@
+#include "catch.hpp"
+#include <map>
+#include "test_utils.h"
+#include "jiffy/storage/hashtable/hash_table_value_tier.h"
+
+using namespace ::jiffy::storage;
+
+TEST_CASE("hash_table_value_tier_spill_read_drop_test", "[spill][read][drop]") {
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  size_t capacity = 134217728;
+  block_memory_manager manager(capacity, memory_mode, mem_kind);
+  block_memory_allocator<uint8_t> binary_allocator(&manager);
+  hash_table_type table{block_memory_allocator<kv_pair_type>(&manager)};
+  hash_table_value_tier tier("/tmp", hash_table_type::num_stripes(),
+                             hash_table_value_tier::allocator_type(&manager));
+  for (std::size_t i = 0; i < 1000; ++i) {
+    table.emplace(kv_pair_type(binary(std::to_string(i), binary_allocator),
+                               binary(std::string(1024, 'a' + i % 26), binary_allocator)));
+  }
+  auto used = manager.mb_used();
+
+  // Spill every other value and empty it in the table
+  for (std::size_t i = 0; i < hash_table_type::num_stripes(); ++i) {
+    for (auto &entry: table.stripe_at(i).table) {
+      if (std::stoul(to_string(entry.first)) % 2 == 0) {
+        tier.spill(i, entry.first, entry.second);
+        entry.second = binary(binary_allocator);
+      }
+    }
+  }
+  REQUIRE(tier.spilled() == 500);
+  REQUIRE(tier.spilled_bytes() == 500 * 1024);
+  REQUIRE(manager.mb_used() < used);
+
+  for (std::size_t i = 0; i < 1000; ++i) {
+    auto key = std::to_string(i);
+    auto stripe = table.stripe_index(key);
+    auto it = table.stripe_at(stripe).table.find(key);
+    std::string value;
+    REQUIRE(tier.read(value, stripe, it->first) == (i % 2 == 0));
+    if (i % 2 == 0) {
+      REQUIRE(value == std::string(1024, 'a' + i % 26));
+    }
+  }
+
+  // Persisting the table reads spilled values back
+  std::map<std::string, std::string> persisted;
+  for (const auto &e: tiered_hash_table_type(table, tier)) {
+    persisted.emplace(to_string(e.first), to_string(e.second));
+  }
+  REQUIRE(persisted.size() == 1000);
+  for (std::size_t i = 0; i < 1000; ++i) {
+    REQUIRE(persisted[std::to_string(i)] == std::string(1024, 'a' + i % 26));
+  }
+
+  for (std::size_t i = 0; i < 1000; i += 4) {
+    auto key = std::to_string(i);
+    auto stripe = table.stripe_index(key);
+    auto it = table.stripe_at(stripe).table.find(key);
+    REQUIRE(tier.drop(stripe, it->first));
+    REQUIRE_FALSE(tier.drop(stripe, it->first));
+  }
+  REQUIRE(tier.spilled() == 250);
+  REQUIRE(tier.spilled_bytes() == 250 * 1024);
+
+  // Spilling a key again replaces its value
+  {
+    auto key = std::to_string(2);
+    auto stripe = table.stripe_index(key);
+    auto it = table.stripe_at(stripe).table.find(key);
+    tier.spill(stripe, it->first, binary(std::string(512, 'x'), binary_allocator));
+    REQUIRE(tier.spilled() == 250);
+    REQUIRE(tier.spilled_bytes() == 249 * 1024 + 512);
+    tier.spill(stripe, it->first, binary(std::string(2048, 'y'), binary_allocator));
+    REQUIRE(tier.spilled() == 250);
+    REQUIRE(tier.spilled_bytes() == 249 * 1024 + 2048);
+    std::string value;
+    REQUIRE(tier.read(value, stripe, it->first));
+    REQUIRE(value == std::string(2048, 'y'));
+    REQUIRE(tier.drop(stripe, it->first));
+    REQUIRE(tier.spilled() == 249);
+    REQUIRE(tier.spilled_bytes() == 249 * 1024);
+  }
+
+  tier.abandon();
+  table.abandon();
+  manager.mb_release_all();
+  REQUIRE(tier.spilled() == 0);
+  REQUIRE(tier.spilled_bytes() == 0);
+  REQUIRE(manager.mb_used() == 0);
+}
+
+TEST_CASE("hash_table_value_tier_reference_bits_test", "[touch][test_and_clear]") {
+  std::string memory_mode = getenv("JIFFY_TEST_MODE");
+  void* mem_kind = test_utils::init_kind();
+  block_memory_manager manager(134217728, memory_mode, mem_kind);
+  hash_table_value_tier tier("/tmp", hash_table_type::num_stripes(),
+                             hash_table_value_tier::allocator_type(&manager));
+  REQUIRE_FALSE(tier.test_and_clear(42));
+  tier.touch(42);
+  tier.touch(42 + 64);
+  REQUIRE(tier.test_and_clear(42));
+  REQUIRE_FALSE(tier.test_and_clear(42));
+  REQUIRE(tier.test_and_clear(42 + 64));
+  REQUIRE_FALSE(tier.test_and_clear(43));
+}
@@ -19,7 +19,8 @@ TEST_CASE("local_write_test", "[write]") {
   size_t capacity = 134217728;
   block_memory_manager manager(capacity, memory_mode, mem_kind);
   block_memory_allocator<uint8_t> binary_allocator(&manager);
-  hash_table_type table;
+  block_memory_allocator<kv_pair_type> allocator(&manager);
+  hash_table_type table(allocator);
   auto bkey = binary("key", binary_allocator);
   auto bval = binary("value", binary_allocator);
   table.emplace(std::make_pair(bkey, bval));
@@ -45,7 +46,7 @@ TEST_CASE("local_read_test", "[read]") {
   block_memory_allocator<uint8_t> binary_allocator(&manager);
   auto ser = std::make_shared<csv_serde>(binary_allocator);
   local_store store(ser);
-  hash_table_type table;
+  hash_table_type table(allocator);
   auto bkey = make_binary("key", binary_allocator);
   auto bval = make_binary("value", binary_allocator);
   REQUIRE_NOTHROW(store.read("/tmp/a.txt", table));
@@ -40,6 +40,8 @@ class FileClient(DataStructureClient):
             self.auto_scale = True
         else:
             self.auto_scale = self.block_info.tags.get("file.auto_scale")
+        if int(self.block_info.tags.get("file.stripe_width", 1)) > 1:
+            raise ValueError("Striped file layout is not supported")
 
     def _handle_redirect(self, args, response):
         return response
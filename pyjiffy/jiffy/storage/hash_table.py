@@ -26,6 +26,8 @@ class HashTableOps:
     remove_ls = b('remove_ls')
     update_ls = b('update_ls')
     upsert_ls = b('upsert_ls')
+    put_ttl = b('put_ttl')
+    upsert_ttl = b('upsert_ttl')
 
     op_types = {exists: CommandType.accessor,
                 get: CommandType.accessor,
@@ -38,7 +40,9 @@ class HashTableOps:
                 put_ls: CommandType.mutator,
                 remove_ls: CommandType.mutator,
                 update_ls: CommandType.accessor,
-                upsert_ls: CommandType.mutator}
+                upsert_ls: CommandType.mutator,
+                put_ttl: CommandType.mutator,
+                upsert_ttl: CommandType.mutator}
 
 
 def encode(value):
@@ -78,7 +82,7 @@ class HashTable(DataStructureClient):
     def _handle_redirect(self, args, response):
         while b(response[0]) == b('!exporting'):
             args_copy = copy.deepcopy(args)
-            if args[0] == b("update") or args[0] == b("upsert"):
+            if args[0] == b("update") or args[0] == b("upsert") or args[0] == b("upsert_ttl"):
                 args_copy += [response[2], response[3]]
             block_ids = [bytes_to_str(x) for x in response[1].split(b('!'))]
             chain = ReplicaChain(block_ids, 0, 0, rpc_storage_mode.rpc_in_memory)
@@ -130,6 +134,15 @@ class HashTable(DataStructureClient):
         if self._run_repeated([HashTableOps.upsert, key, value])[0] == b'!ok':
             self.cache.miss_handling([key,value])
 
+    def put_ttl(self, key, value, ttl_ms):
+        # Expiring keys are not cached, so that reads never outlive the time to live
+        self._run_repeated([HashTableOps.put_ttl, key, value, encode(ttl_ms)])
+        self.cache.delete(key)
+
+    def upsert_ttl(self, key, value, ttl_ms):
+        self._run_repeated([HashTableOps.upsert_ttl, key, value, encode(ttl_ms)])
+        self.cache.delete(key)
+
     def remove(self, key):
         resp = self._run_repeated([HashTableOps.remove, key])
         if resp[0] == b'!ok':
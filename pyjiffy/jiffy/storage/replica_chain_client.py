@@ -24,13 +24,13 @@ class ReplicaChainClient:
 
     def _init(self):
         self.seq = block_request_service.sequence_id(-1, 0, -1)
-        h_host, h_port, _, h_bid = self.chain.block_ids[0].split(':')
+        h_host, h_port, _, h_bid = self.chain.block_ids[0].split(':')[:4]
         self.head = BlockClient(self.client_cache, h_host, int(h_port), int(h_bid))
         self.seq.client_id = self.head.get_client_id()
         if len(self.chain.block_ids) == 1:
             self.tail = self.head
         else:
-            t_host, t_port, _, t_bid = self.chain.block_ids[-1].split(':')
+            t_host, t_port, _, t_bid = self.chain.block_ids[-1].split(':')[:4]
             self.tail = BlockClient(self.client_cache, t_host, int(t_port), int(t_bid))
         self.response_reader = self.tail.get_response_reader(self.seq.client_id)
         self.response_cache = {}
@@ -38,7 +38,7 @@ class ReplicaChainClient:
 
     def _invalidate_cache(self):
         for block in self.chain.block_ids:
-            host, port, _, _ = block.split(':')
+            host, port, _, _ = block.split(':')[:4]
             self.client_cache.remove(host, int(port))
 
     def get_chain(self):
@@ -52,7 +52,7 @@ class ReplicaChainClient:
             raise RuntimeError("Cannot have more than one request in-flight")
         try:
             self.accessor = True
-            client.send_run_command(int(self.chain.block_ids[-1].split(":")[-1]), args)
+            client.send_run_command(int(self.chain.block_ids[-1].split(":")[3]), args)
         except:
             self.send_run_command_exception_ = True
         self.in_flight = True
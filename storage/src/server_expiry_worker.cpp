@@ -0,0 +1,50 @@
+#include "server_expiry_worker.h"
+#include <jiffy/utils/logger.h>
+
+namespace jiffy {
+namespace storage {
+
+using namespace utils;
+
+server_expiry_worker::server_expiry_worker(std::vector<std::shared_ptr<block>> &blocks, uint64_t periodicity_ms)
+    : blocks_(blocks), periodicity_ms_(periodicity_ms) {}
+
+server_expiry_worker::~server_expiry_worker() {
+  stop();
+}
+
+void server_expiry_worker::start() {
+  worker_ = std::thread([&] {
+    while (!stop_.load()) {
+      auto start = std::chrono::steady_clock::now();
+      expire_blocks();
+      auto end = std::chrono::steady_clock::now();
+      auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+
+      auto time_to_wait = std::chrono::duration_cast<std::chrono::milliseconds>(periodicity_ms_ - elapsed);
+      if (time_to_wait > std::chrono::milliseconds::zero()) {
+        std::this_thread::sleep_for(time_to_wait);
+      }
+    }
+  });
+}
+
+void server_expiry_worker::stop() {
+  stop_.store(true);
+  if (worker_.joinable())
+    worker_.join();
+}
+
+void server_expiry_worker::expire_blocks() {
+  for (const auto &block: blocks_) {
+    try {
+      if (block->valid())
+        block->impl()->expire();
+    } catch (std::exception &e) {
+      LOG(log_level::error) << "Could not expire entries of block " << block->id() << ": " << e.what();
+    }
+  }
+}
+
+}
+}
@@ -0,0 +1,58 @@
+#ifndef JIFFY_SERVER_EXPIRY_WORKER_H
+#define JIFFY_SERVER_EXPIRY_WORKER_H
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <jiffy/storage/block.h>
+
+namespace jiffy {
+namespace storage {
+
+/* Server expiry worker class, frees expired entries of idle partitions */
+class server_expiry_worker {
+ public:
+  /**
+   * @brief Constructor
+   * @param blocks Data blocks
+   * @param periodicity_ms Periodicity
+   */
+
+  server_expiry_worker(std::vector<std::shared_ptr<block>> &blocks, uint64_t periodicity_ms);
+
+  /**
+   * @brief Destructor
+   */
+
+  ~server_expiry_worker();
+
+  /**
+   * @brief Start worker thread and periodically expire entries
+   */
+
+  void start();
+
+  /**
+   * @brief Set stop bit and stop worker thread
+   */
+
+  void stop();
+
+ private:
+  /**
+   * @brief Free expired entries of all blocks
+   */
+  void expire_blocks();
+  /* Data blocks */
+  std::vector<std::shared_ptr<block>> &blocks_;
+  /* Periodicity */
+  std::chrono::milliseconds periodicity_ms_;
+  /* Atomic stop bool */
+  std::atomic_bool stop_{false};
+  /* Worker thread */
+  std::thread worker_;
+};
+}
+}
+
+#endif //JIFFY_SERVER_EXPIRY_WORKER_H
@@ -1,4 +1,5 @@
 #include <atomic>
+#include <cstring>
 #include <iostream>
 #include <jiffy/directory/block/block_registration_client.h>
 #include <jiffy/storage/hashtable/hash_table_partition.h>
@@ -8,9 +9,11 @@
 #include <jiffy/utils/signal_handling.h>
 #include <jiffy/utils/logger.h>
 #include <jiffy/utils/mem_utils.h>
+#include <jiffy/utils/numa_utils.h>
 #include <boost/program_options.hpp>
 #include <ifaddrs.h>
 #include "server_storage_tracker.h"
+#include "server_expiry_worker.h"
 
 using namespace ::jiffy::directory;
 using namespace ::jiffy::storage;
@@ -70,9 +73,14 @@ int main(int argc, char **argv) {
   int32_t service_port = 9095;
   std::string memory_mode = "DRAM";
   std::string pmem_path = "";
+  bool hugepage_prefault = false;
+  std::string tier_path = "";
+  uint64_t expiry_period_ms = 100;
   int32_t dir_port = 9090;
   std::size_t num_blocks = 64;
   std::size_t num_block_groups = std::thread::hardware_concurrency() / 2;
+  std::size_t num_io_threads = 1;
+  bool numa_aware = true;
   std::size_t block_capacity = 134217728;
   double blk_thresh_lo = 0.25;
   double blk_thresh_hi = 0.75;
@@ -99,12 +107,17 @@ int main(int argc, char **argv) {
         ("storage.service_port", po::value<int>(&service_port)->default_value(9095))
         ("storage.memory_mode", po::value<std::string>(&memory_mode)->default_value("DRAM"))
         ("storage.pmem_path", po::value<std::string>(&pmem_path)->default_value(""))
+        ("storage.hugepage_prefault", po::value<bool>(&hugepage_prefault)->default_value(false))
+        ("storage.tier_path", po::value<std::string>(&tier_path)->default_value(""))
+        ("storage.expiry_period_ms", po::value<uint64_t>(&expiry_period_ms)->default_value(100))
         ("directory.host", po::value<std::string>(&dir_host)->default_value("127.0.0.1"))
         ("directory.service_port", po::value<int>(&dir_port)->default_value(9090))
         ("directory.block_port", po::value<int>(&block_port)->default_value(9092))
         ("storage.block.num_blocks", po::value<size_t>(&num_blocks)->default_value(64))
         ("storage.block.num_block_groups",
          po::value<size_t>(&num_block_groups)->default_value(std::thread::hardware_concurrency() / 2))
+        ("storage.block.num_io_threads", po::value<size_t>(&num_io_threads)->default_value(1))
+        ("storage.block.numa_aware", po::value<bool>(&numa_aware)->default_value(true))
         ("storage.block.capacity", po::value<size_t>(&block_capacity)->default_value(134217728))
         ("storage.block.capacity_threshold_lo", po::value<double>(&blk_thresh_lo)->default_value(0.25))
         ("storage.block.capacity_threshold_hi", po::value<double>(&blk_thresh_hi)->default_value(0.75));
@@ -163,8 +176,13 @@ int main(int argc, char **argv) {
     LOG(log_level::info) << "storage.auto_scaling_port: " << auto_scaling_port;
     LOG(log_level::info) << "storage.memory_mode: " << memory_mode;
     LOG(log_level::info) << "storage.pmem_path: " << pmem_path;
+    LOG(log_level::info) << "storage.hugepage_prefault: " << hugepage_prefault;
+    LOG(log_level::info) << "storage.tier_path: " << tier_path;
+    LOG(log_level::info) << "storage.expiry_period_ms: " << expiry_period_ms;
     LOG(log_level::info) << "storage.block.num_blocks: " << num_blocks;
     LOG(log_level::info) << "storage.block.num_block_groups: " << num_block_groups;
+    LOG(log_level::info) << "storage.block.num_io_threads: " << num_io_threads;
+    LOG(log_level::info) << "storage.block.numa_aware: " << numa_aware;
     LOG(log_level::info) << "storage.block.capacity: " << block_capacity;
     LOG(log_level::info) << "storage.block.capacity_threshold_lo: " << blk_thresh_lo;
     LOG(log_level::info) << "storage.block.capacity_threshold_hi: " << blk_thresh_hi;
@@ -190,8 +208,19 @@ int main(int argc, char **argv) {
 
   LOG(log_level::info) << "Hostname: " << hostname;
 
+  // Block-groups are spread round-robin across NUMA nodes; -1 leaves placement to the OS
+  std::vector<int> group_nodes(num_block_groups, -1);
+  int num_numa_nodes = numa_aware ? numa_utils::num_nodes() : 1;
+  if (num_numa_nodes > 1 && (memory_mode == "DRAM" || memory_mode == "HUGEPAGE")) {
+    for (size_t i = 0; i < num_block_groups; i++) {
+      group_nodes[i] = static_cast<int>(i % num_numa_nodes);
+    }
+    LOG(log_level::info) << "Placing " << num_block_groups << " block-groups on " << num_numa_nodes << " NUMA nodes";
+  }
+
   for (int i = 0; i < static_cast<int>(num_blocks); i++) {
-    block_ids.push_back(block_id_parser::make(hostname, service_port + i % num_block_groups, mgmt_port, i));
+    block_ids.push_back(block_id_parser::make(hostname, service_port + i % num_block_groups, mgmt_port, i,
+                                              group_nodes[i % num_block_groups]));
   }
 
   std::vector<std::shared_ptr<block>> blocks;
@@ -200,8 +229,9 @@ int main(int argc, char **argv) {
   void* mem_kind = mem_utils::init_kind(memory_mode, pmem_path);
 
   for (size_t i = 0; i < blocks.size(); ++i) {
-    blocks[i] =
-        std::make_shared<block>(block_ids[i], block_capacity, memory_mode, mem_kind, address, auto_scaling_port);
+    blocks[i] = std::make_shared<block>(block_ids[i], block_capacity, memory_mode, mem_kind, address,
+                                        auto_scaling_port, group_nodes[i % num_block_groups], hugepage_prefault,
+                                        tier_path);
   }
   LOG(log_level::info) << "Created " << blocks.size() << " blocks";
 
@@ -251,9 +281,18 @@ int main(int argc, char **argv) {
     auto block_group = std::vector < std::shared_ptr < block >> ();
     for (size_t j = i; j < num_blocks; j += num_block_groups)
       block_group.push_back(blocks[j]);
-    storage_server[i] = block_server::create(block_group, service_port + i);
+    storage_server[i] = block_server::create(block_group, service_port + i, num_io_threads);
+    auto numa_node = group_nodes[i];
     storage_serve_thread[i] =
-        std::thread([&storage_exception, &storage_server, &failing_thread, &failure_condition, i] {
+        std::thread([&storage_exception, &storage_server, &failing_thread, &failure_condition, i, numa_node] {
+          // IO threads started by serve() inherit the node's CPUs and memory policy
+          if (numa_node >= 0) {
+            auto err = numa_utils::set_self_node_affinity(numa_node);
+            if (err != 0) {
+              LOG(log_level::warn) << "Could not pin block-group " << i << " to NUMA node " << numa_node
+                                   << ": " << std::strerror(err);
+            }
+          }
           try {
             storage_server[i]->serve();
           } catch (...) {
@@ -271,6 +310,11 @@ int main(int argc, char **argv) {
     tracker.start();
   }
 
+  server_expiry_worker expiry_worker(blocks, expiry_period_ms);
+  if (expiry_period_ms > 0) {
+    expiry_worker.start();
+  }
+
   std::unique_lock<std::mutex> failure_condition_lock{failure_mtx};
   failure_condition.wait(failure_condition_lock, [&failing_thread] {
     return failing_thread != -1;